@@ -0,0 +1,273 @@
+/*
+ *  Portable Agile C++ Classes (PACC)
+ *  Copyright (C) 2001-2003 by Marc Parizeau
+ *  http://manitou.gel.ulaval.ca/~parizeau/PACC
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *  Contact:
+ *  Laboratoire de Vision et Systemes Numeriques
+ *  Departement de genie electrique et de genie informatique
+ *  Universite Laval, Quebec, Canada, G1K 7P4
+ *  http://vision.gel.ulaval.ca
+ *
+ */
+
+/*!
+ * \file bench/CoroutineStress.cpp
+ * \brief Stress test of the coroutine tasks and of the reactor (requires a C++20 compiler).
+ * \author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+ *
+ * Usage:
+ * \verbatim
+ pacc-stress-coroutines [SLAVES] [COROUTINES]
+ \endverbatim
+ * For each scheduling mode of ThreadPool, in a pool of SLAVES slaves (default 4), the program 
+ * checks a deeply recursive coroutine, COROUTINES (default 2000) coroutines that await 
+ * futures, the propagation of exceptions through co_await and CoTask::start, the adapters of 
+ * existing tasks (runTask) and of thread pools (resumeOn), the delays of a Reactor, which 
+ * must never resume a coroutine early, and, except under Windows, an echo of socket pairs 
+ * served by coroutines that wait for readiness. The program returns a non-zero status if 
+ * any check fails.
+ */
+
+#include "PACC/Threading.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+#ifdef PACC_THREADS_COROUTINES
+
+#ifndef PACC_THREADS_WIN32
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+using namespace PACC;
+using namespace PACC::Threading;
+
+namespace {
+	
+	//! Return the current time (seconds of the steady clock).
+	double getTime(void)
+	{
+		return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+	}
+	
+	//! Return Fibonacci number \c inN, computed recursively by coroutines.
+	CoTask<long> fibonacci(int inN)
+	{
+		if(inN < 2) co_return inN;
+		const long lFirst = co_await fibonacci(inN-1);
+		const long lSecond = co_await fibonacci(inN-2);
+		co_return lFirst + lSecond;
+	}
+	
+	//! Return twice value \c inValue, computed by a function submitted to pool \c ioPool.
+	CoTask<long> doubleValue(ThreadPool& ioPool, long inValue)
+	{
+		Future<long> lFuture = ioPool.submit([inValue](void) {return 2*inValue;});
+		co_return co_await lFuture;
+	}
+	
+	//! Throw an exception.
+	CoTask<void> fail(void)
+	{
+		throw runtime_error("coroutine failure");
+		co_return;
+	}
+	
+	//! Return whether the exception of an awaited coroutine is caught.
+	CoTask<bool> catchFailure(void)
+	{
+		try {co_await fail();}
+		catch(runtime_error&) {co_return true;}
+		co_return false;
+	}
+	
+	//! Task that sets a value.
+	class SetTask : public Task {
+	 public:
+		SetTask(void) : mValue(0) {}
+		int mValue; //!< Value set by task.
+		void main(void) {mValue = 7;}
+	};
+	
+	//! Task that throws an exception.
+	class FailTask : public LightTask {
+	 public:
+		void main(void) {throw logic_error("task failure");}
+	};
+	
+	//! Return whether existing tasks are run and their exceptions rethrown by runTask.
+	CoTask<bool> adaptTasks(ThreadPool& ioPool)
+	{
+		SetTask lTask;
+		co_await runTask(ioPool, lTask);
+		if(!lTask.isCompleted() || lTask.mValue != 7) co_return false;
+		FailTask lFailure;
+		try {co_await runTask(ioPool, lFailure);}
+		catch(logic_error&) {co_return true;}
+		co_return false;
+	}
+	
+	//! Return the number of hops of a coroutine between pools \c ioFirst and \c ioSecond.
+	CoTask<int> hop(ThreadPool& ioFirst, ThreadPool& ioSecond)
+	{
+		int lHops = 0;
+		for(unsigned int i = 0; i < 10; ++i) {
+			co_await resumeOn(i % 2 == 0 ? ioSecond : ioFirst);
+			++lHops;
+		}
+		co_return lHops;
+	}
+	
+	//! Wait for \c inDelay seconds of reactor \c ioReactor, and return whether the coroutine was resumed early.
+	CoTask<bool> sleepEarly(Reactor& ioReactor, double inDelay)
+	{
+		const double lTime = getTime() + inDelay;
+		co_await ioReactor.delay(inDelay);
+		co_return getTime() < lTime;
+	}
+	
+#ifndef PACC_THREADS_WIN32
+	//! Echo the bytes of non-blocking descriptor \c inDescriptor until it is closed, and return their number.
+	CoTask<long> echo(Reactor& ioReactor, int inDescriptor)
+	{
+		char lBuffer[16];
+		long lTotal = 0;
+		for(;;) {
+			co_await ioReactor.readable(inDescriptor);
+			const ssize_t lRead = ::read(inDescriptor, lBuffer, sizeof(lBuffer));
+			if(lRead < 0) continue;
+			if(lRead == 0) break;
+			lTotal += lRead;
+			for(ssize_t lWritten = 0; lWritten < lRead;) {
+				co_await ioReactor.writable(inDescriptor);
+				const ssize_t lCount = ::write(inDescriptor, lBuffer+lWritten, lRead-lWritten);
+				if(lCount > 0) lWritten += lCount;
+			}
+		}
+		ioReactor.unwatch(inDescriptor);
+		co_return lTotal;
+	}
+	
+	//! Echo 3 messages through each of \c inPairs socket pairs, and return the number of failed checks.
+	unsigned int stressEcho(ThreadPool& ioPool, Reactor& ioReactor, unsigned int inPairs)
+	{
+		unsigned int lErrors = 0;
+		vector<int> lClients, lServers;
+		vector<Future<long> > lEchoes;
+		for(unsigned int i = 0; i < inPairs; ++i) {
+			int lPair[2];
+			if(::socketpair(AF_UNIX, SOCK_STREAM, 0, lPair) != 0) return lErrors+1;
+			::fcntl(lPair[1], F_SETFL, O_NONBLOCK);
+			lClients.push_back(lPair[0]);
+			lServers.push_back(lPair[1]);
+			lEchoes.push_back(echo(ioReactor, lPair[1]).start(ioPool));
+		}
+		for(unsigned int lRound = 0; lRound < 3; ++lRound) {
+			for(unsigned int i = 0; i < inPairs; ++i) if(::write(lClients[i], "hello", 5) != 5) ++lErrors;
+			for(unsigned int i = 0; i < inPairs; ++i) {
+				char lBuffer[5];
+				ssize_t lRead = 0;
+				while(lRead < 5) {
+					const ssize_t lCount = ::read(lClients[i], lBuffer+lRead, 5-lRead);
+					if(lCount <= 0) break;
+					lRead += lCount;
+				}
+				if(lRead != 5) ++lErrors;
+			}
+		}
+		for(unsigned int i = 0; i < inPairs; ++i) ::close(lClients[i]);
+		for(unsigned int i = 0; i < inPairs; ++i) {
+			if(lEchoes[i].get() != 15) ++lErrors;
+			::close(lServers[i]);
+		}
+		return lErrors;
+	}
+#endif
+	
+	//! Run the checks in a pool of \c inSlaves slaves using mode \c inMode, with \c inCoroutines concurrent coroutines, and return the number of failed checks.
+	unsigned int stress(const char* inName, ThreadPool::Mode inMode, unsigned int inSlaves, unsigned int inCoroutines)
+	{
+		unsigned int lErrors = 0;
+		ThreadPool lPool(inSlaves, inMode);
+		// deep recursion (symmetric transfer)
+		if(fibonacci(20).start(lPool).get() != 6765) ++lErrors;
+		// concurrent coroutines that await futures
+		vector<Future<long> > lValues;
+		for(unsigned int i = 0; i < inCoroutines; ++i) lValues.push_back(doubleValue(lPool, i).start(lPool));
+		for(unsigned int i = 0; i < inCoroutines; ++i) if(lValues[i].get() != 2*long(i)) ++lErrors;
+		// exceptions
+		if(!catchFailure().start(lPool).get()) ++lErrors;
+		try {
+			fail().start(lPool).get();
+			++lErrors;
+		}
+		catch(runtime_error&) {}
+		// adapters
+		if(!adaptTasks(lPool).start(lPool).get()) ++lErrors;
+		{
+			ThreadPool lOther(1, inMode);
+			if(hop(lPool, lOther).start(lPool).get() != 10) ++lErrors;
+		}
+		// reactor
+		{
+			Reactor lReactor(lPool);
+			vector<Future<bool> > lSleeps;
+			for(unsigned int i = 0; i < inCoroutines; ++i) lSleeps.push_back(sleepEarly(lReactor, 0.001*(i % 50)).start(lPool));
+			for(unsigned int i = 0; i < inCoroutines; ++i) if(lSleeps[i].get()) ++lErrors;
+#ifndef PACC_THREADS_WIN32
+			lErrors += stressEcho(lPool, lReactor, 200);
+#endif
+		}
+		cout << inName << ": " << lErrors << " errors" << endl;
+		return lErrors;
+	}
+	
+}
+
+int main(int argc, char** argv)
+{
+	const unsigned int lSlaves = (argc > 1) ? atoi(argv[1]) : 4;
+	const unsigned int lCoroutines = (argc > 2) ? atoi(argv[2]) : 2000;
+	if(lSlaves == 0) {
+		cerr << "usage: " << argv[0] << " [SLAVES] [COROUTINES]" << endl;
+		return 1;
+	}
+	unsigned int lErrors = 0;
+	lErrors += stress("global queue", ThreadPool::eGlobalQueue, lSlaves, lCoroutines);
+	lErrors += stress("work stealing", ThreadPool::eWorkStealing, lSlaves, lCoroutines);
+	lErrors += stress("lock-free queue", ThreadPool::eLockFreeQueue, lSlaves, lCoroutines);
+	cout << (lErrors == 0 ? "PASSED" : "FAILED") << endl;
+	return lErrors == 0 ? 0 : 1;
+}
+
+#else
+
+int main(void)
+{
+	std::cerr << "coroutines are not supported by this compiler" << std::endl;
+	return 1;
+}
+
+#endif // PACC_THREADS_COROUTINES
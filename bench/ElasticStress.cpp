@@ -0,0 +1,160 @@
+/*
+ *  Portable Agile C++ Classes (PACC)
+ *  Copyright (C) 2001-2003 by Marc Parizeau
+ *  http://manitou.gel.ulaval.ca/~parizeau/PACC
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *  Contact:
+ *  Laboratoire de Vision et Systemes Numeriques
+ *  Departement de genie electrique et de genie informatique
+ *  Universite Laval, Quebec, Canada, G1K 7P4
+ *  http://vision.gel.ulaval.ca
+ *
+ */
+
+/*!
+ * \file bench/ElasticStress.cpp
+ * \brief Stress test of the growth, retirement and resizing of elastic thread pools.
+ * \author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+ *
+ * Usage:
+ * \verbatim
+ pacc-stress-elastic [MAX_SLAVES]
+ \endverbatim
+ * For each scheduling mode of ThreadPool, an elastic pool of 1 to MAX_SLAVES slaves (default 4) 
+ * must grow under a backlog of slow tasks, and its idle slaves must retire down to the minimum. 
+ * The pool is then resized up and down, and resized continuously by another thread while 
+ * tasks are pushed; every task must run exactly once, and the pool must settle on its last 
+ * size. Finally, the pool is deleted while tasks still wait, which must run them all. The 
+ * program returns a non-zero status if any check fails.
+ */
+
+#include "PACC/Threading.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+using namespace PACC;
+
+namespace {
+	
+	//! Task that sleeps, and counts its runs.
+	class Counted : public Threading::LightTask {
+	 public:
+		Counted(void) : mRuns(0), mSleep(0) {}
+		
+		atomic<unsigned int> mRuns; //!< Number of times the task ran.
+		double mSleep; //!< Sleep time of task (seconds).
+		
+		void main(void) {
+			if(mSleep > 0) Threading::Thread::sleep(mSleep);
+			++mRuns;
+		}
+	};
+	
+	//! Thread that resizes a thread pool continuously.
+	class Resizer : public Threading::Thread {
+	 public:
+		Resizer(Threading::ThreadPool& ioPool) : mPool(ioPool) {}
+		~Resizer(void) {wait();}
+		
+	 protected:
+		Threading::ThreadPool& mPool; //!< Resized pool.
+		
+		void main(void) {
+			for(unsigned int i = 0; i < 200; ++i) {
+				mPool.resize(1 + i % mPool.getMaxSlaves());
+				sleep(0.0005);
+			}
+		}
+	};
+	
+	//! Return whether pool \c inPool runs \c inSlaves slaves within 5 seconds.
+	bool settle(const Threading::ThreadPool& inPool, unsigned int inSlaves)
+	{
+		for(unsigned int i = 0; i < 500 && inPool.getSlaves() != inSlaves; ++i) Threading::Thread::sleep(0.01);
+		return inPool.getSlaves() == inSlaves;
+	}
+	
+	//! Run the checks on an elastic pool of 1 to \c inMax slaves using mode \c inMode, and return the number of failed checks.
+	unsigned int stress(const char* inName, Threading::ThreadPool::Mode inMode, unsigned int inMax)
+	{
+		unsigned int lErrors = 0;
+		atomic<unsigned int> lDrained(0);
+		unsigned int lPeak = 0;
+		{
+			Threading::ThreadPool lPool(1, inMax, inMode);
+			lPool.setIdleTimeout(0.1);
+			// growth under a backlog of slow tasks
+			vector<Counted> lSlow(200);
+			for(unsigned int i = 0; i < lSlow.size(); ++i) {
+				lSlow[i].mSleep = 0.002;
+				lPool.push(lSlow[i]);
+			}
+			for(unsigned int i = 0; i < lSlow.size(); ++i) {
+				lPeak = max(lPeak, lPool.getSlaves());
+				lSlow[i].wait();
+				if(lSlow[i].mRuns != 1) ++lErrors;
+			}
+			if(lPeak < 2 || lPeak > inMax) ++lErrors;
+			// retirement of idle slaves
+			if(!settle(lPool, 1)) ++lErrors;
+			// explicit resizes
+			lPool.resize(inMax);
+			if(!settle(lPool, inMax)) ++lErrors;
+			lPool.resize(1);
+			if(!settle(lPool, 1)) ++lErrors;
+			// pushes during continuous resizes
+			vector<Counted> lFast(20000);
+			{
+				Resizer lResizer(lPool);
+				lResizer.run();
+				for(unsigned int i = 0; i < lFast.size(); ++i) lPool.push(lFast[i]);
+			}
+			for(unsigned int i = 0; i < lFast.size(); ++i) {
+				lFast[i].wait();
+				if(lFast[i].mRuns != 1) ++lErrors;
+			}
+			lPool.setGrowth(0, 0);
+			lPool.resize(2);
+			if(!settle(lPool, 2)) ++lErrors;
+			// deletion of the pool while tasks wait
+			for(unsigned int i = 0; i < 100; ++i) lPool.submit([&lDrained](void) {++lDrained;});
+		}
+		if(lDrained != 100) ++lErrors;
+		cout << inName << ": peak of " << lPeak << " slaves, " << lErrors << " errors" << endl;
+		return lErrors;
+	}
+	
+}
+
+int main(int argc, char** argv)
+{
+	const unsigned int lMax = (argc > 1) ? atoi(argv[1]) : 4;
+	if(lMax < 2) {
+		cerr << "usage: " << argv[0] << " [MAX_SLAVES (at least 2)]" << endl;
+		return 1;
+	}
+	unsigned int lErrors = 0;
+	lErrors += stress("global queue", Threading::ThreadPool::eGlobalQueue, lMax);
+	lErrors += stress("work stealing", Threading::ThreadPool::eWorkStealing, lMax);
+	lErrors += stress("lock-free queue", Threading::ThreadPool::eLockFreeQueue, lMax);
+	cout << (lErrors == 0 ? "PASSED" : "FAILED") << endl;
+	return lErrors == 0 ? 0 : 1;
+}
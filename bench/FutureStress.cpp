@@ -0,0 +1,155 @@
+/*
+ *  Portable Agile C++ Classes (PACC)
+ *  Copyright (C) 2001-2003 by Marc Parizeau
+ *  http://manitou.gel.ulaval.ca/~parizeau/PACC
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *  Contact:
+ *  Laboratoire de Vision et Systemes Numeriques
+ *  Departement de genie electrique et de genie informatique
+ *  Universite Laval, Quebec, Canada, G1K 7P4
+ *  http://vision.gel.ulaval.ca
+ *
+ */
+/*!
+ * \file bench/FutureStress.cpp
+ * \brief Stress test of the futures and continuations of the thread pool.
+ * \author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+ *
+ * Usage:
+ * \verbatim
+ pacc-stress-futures [SLAVES] [TASKS]
+ \endverbatim
+ * For each scheduling mode of ThreadPool, a pool of SLAVES slaves (default 4) runs TASKS 
+ * functions (default 20000) through ThreadPool::submit, every third of which throws an 
+ * exception: Future::get must return the value of the others, and rethrow the exception of 
+ * the failed ones. Each future is then continued by a chain of continuations (see 
+ * Future::then), which must add up the values, and must propagate an exception without 
+ * calling the following functions. Continuations of futures without result, continuations 
+ * added to futures that are already ready, and functions that return a reference are also 
+ * checked. The program returns a non-zero status if any check fails.
+ */
+
+#include "PACC/Threading.hpp"
+#include "PACC/Util/Timer.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+using namespace std;
+using namespace PACC;
+
+namespace {
+	
+	//! Run the checks of the futures of a pool of \c inSlaves slaves using mode \c inMode with \c inTasks functions, and return the number of failed checks.
+	unsigned int stress(const char* inName, Threading::ThreadPool::Mode inMode, unsigned int inSlaves, unsigned int inTasks)
+	{
+		const unsigned int lLinks = 8;
+		unsigned int lErrors = 0;
+		atomic<unsigned int> lCalls(0);
+		Timer lTimer;
+		{
+			Threading::ThreadPool lPool(inSlaves, inMode, 256);
+			// values and exceptions, each continued by a chain of continuations
+			vector<Threading::Future<long> > lFutures, lChains;
+			for(unsigned int i = 0; i < inTasks; ++i) {
+				lFutures.push_back(lPool.submit([i]() -> long {
+					if(i % 3 == 2) throw runtime_error("odd task");
+					return (long) i*i;
+				}));
+				Threading::Future<long> lChain = lFutures.back();
+				for(unsigned int j = 0; j < lLinks; ++j) lChain = lChain.then([&lCalls](long inValue) {++lCalls; return inValue+1;});
+				lChains.push_back(lChain);
+			}
+			unsigned int lFailed = 0;
+			for(unsigned int i = 0; i < inTasks; ++i) {
+				const bool lThrows = i % 3 == 2;
+				lFailed += lThrows;
+				try {
+					if(lFutures[i].get() != (long) i*i || lThrows) ++lErrors;
+				} catch(runtime_error&) {
+					if(!lThrows) ++lErrors;
+				}
+				try {
+					if(lChains[i].get() != (long) i*i+lLinks || lThrows) ++lErrors;
+				} catch(runtime_error&) {
+					if(!lThrows) ++lErrors;
+				}
+				if(!lFutures[i].isReady() || !lChains[i].isReady()) ++lErrors;
+			}
+			// the functions of a failed chain are never called
+			if(lCalls != (inTasks-lFailed)*lLinks) ++lErrors;
+			// a continuation that throws fails the rest of its chain
+			lCalls = 0;
+			Threading::Future<long> lBroken = lPool.submit([]() {return 1L;}).then([](long inValue) -> long {
+				if(inValue == 1) throw runtime_error("broken link");
+				return inValue;
+			}).then([&lCalls](long inValue) {++lCalls; return inValue;});
+			try {
+				lBroken.get();
+				++lErrors;
+			} catch(runtime_error&) {}
+			if(lCalls != 0) ++lErrors;
+			// futures without result, continued by a function with and without result
+			atomic<unsigned int> lDone(0);
+			vector<Threading::Future<unsigned int> > lCounts;
+			for(unsigned int i = 0; i < inTasks; ++i) {
+				Threading::Future<void> lVoid = lPool.submit([&lDone]() {++lDone;});
+				if(i % 2 == 0) lCounts.push_back(lVoid.then([&lDone]() {return lDone.load();}));
+				else lVoid.then([&lDone]() {++lDone;}).wait();
+			}
+			for(unsigned int i = 0; i < lCounts.size(); ++i) {
+				if(lCounts[i].get() == 0) ++lErrors;
+			}
+			if(lDone != inTasks + inTasks/2) ++lErrors;
+			// continuation of a future that is already ready
+			Threading::Future<long> lReady = lPool.submit([]() {return 41L;});
+			lReady.wait();
+			if(lReady.then([](long inValue) {return inValue+1;}).get() != 42) ++lErrors;
+			// a function that returns a reference gives a future of a copy
+			long lValue = 7;
+			Threading::Future<long> lCopy = lPool.submit([&lValue]() -> const long& {return lValue;});
+			auto lReference = [&lValue](long inValue) -> long& {lValue += inValue; return lValue;};
+			static_assert(is_same<decltype(lCopy.then(lReference)), Threading::Future<long> >::value, "the future of a reference must hold a copy");
+			Threading::Future<long> lSum = lCopy.then(lReference);
+			if(lCopy.get() != 7 || lSum.get() != 14) ++lErrors;
+		}
+		const double lTime = lTimer.getValue();
+		cout << inName << ": " << inTasks*(lLinks+1) << " futures in " << lTime << " s, " << lErrors << " errors" << endl;
+		return lErrors;
+	}
+	
+}
+
+int main(int argc, char** argv)
+{
+	const unsigned int lSlaves = (argc > 1) ? atoi(argv[1]) : 4;
+	const unsigned int lTasks = (argc > 2) ? atoi(argv[2]) : 20000;
+	if(lSlaves == 0) {
+		cerr << "usage: " << argv[0] << " [SLAVES] [TASKS]" << endl;
+		return 1;
+	}
+	unsigned int lErrors = 0;
+	lErrors += stress("global queue", Threading::ThreadPool::eGlobalQueue, lSlaves, lTasks);
+	lErrors += stress("work stealing", Threading::ThreadPool::eWorkStealing, lSlaves, lTasks);
+	lErrors += stress("lock-free queue", Threading::ThreadPool::eLockFreeQueue, lSlaves, lTasks);
+	cout << (lErrors == 0 ? "PASSED" : "FAILED") << endl;
+	return lErrors == 0 ? 0 : 1;
+}
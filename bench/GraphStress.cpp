@@ -0,0 +1,147 @@
+/*
+ *  Portable Agile C++ Classes (PACC)
+ *  Copyright (C) 2001-2003 by Marc Parizeau
+ *  http://manitou.gel.ulaval.ca/~parizeau/PACC
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *  Contact:
+ *  Laboratoire de Vision et Systemes Numeriques
+ *  Departement de genie electrique et de genie informatique
+ *  Universite Laval, Quebec, Canada, G1K 7P4
+ *  http://vision.gel.ulaval.ca
+ *
+ */
+
+/*!
+ * \file bench/GraphStress.cpp
+ * \brief Stress test of the task graph scheduler on random dependency graphs.
+ * \author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+ *
+ * Usage:
+ * \verbatim
+ pacc-stress-graph [SLAVES] [TASKS] [ROUNDS]
+ \endverbatim
+ * For each scheduling mode of ThreadPool, a random graph of TASKS tasks (default 2000), each 
+ * depending on up to three earlier tasks, is run ROUNDS times (default 5) in a pool of SLAVES 
+ * slaves (default 4). Each run checks that no task is reported as completed before it runs, 
+ * that every task ran exactly once and after all of its predecessors, and that 
+ * TaskGraph::waitAny returned every task once. A graph with a cycle 
+ * must also be rejected. The program returns a non-zero status if any check fails.
+ */
+
+#include "PACC/Threading.hpp"
+#include "PACC/Util/Timer.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+using namespace PACC;
+
+namespace {
+	
+	atomic<unsigned int> gClock(0); //!< Global clock of task events.
+	
+	//! Task that records the clock at its start and end.
+	class Stamp : public Threading::LightTask {
+	 public:
+		Stamp(void) : mRuns(0), mStart(0), mEnd(0) {}
+		
+		atomic<unsigned int> mRuns; //!< Number of times the task ran.
+		unsigned int mStart; //!< Clock at task start.
+		unsigned int mEnd; //!< Clock at task end.
+		
+		void main(void) {
+			++mRuns;
+			mStart = gClock++;
+			mEnd = gClock++;
+		}
+	};
+	
+	//! Run a random graph of \c inTasks tasks \c inRounds times in a pool of \c inSlaves slaves using mode \c inMode, and return the number of failed checks.
+	unsigned int stress(const char* inName, Threading::ThreadPool::Mode inMode, unsigned int inSlaves, unsigned int inTasks, unsigned int inRounds)
+	{
+		Threading::ThreadPool lPool(inSlaves, inMode);
+		vector<Stamp> lTasks(inTasks);
+		vector<pair<unsigned int, unsigned int> > lEdges;
+		Threading::TaskGraph lGraph;
+		unsigned int lSeed = 2463534242u;
+		for(unsigned int i = 0; i < inTasks; ++i) {
+			lSeed ^= lSeed << 13; lSeed ^= lSeed >> 17; lSeed ^= lSeed << 5;
+			lGraph.add(lTasks[i], 1 + lSeed % 5);
+			for(unsigned int j = 0; i > 0 && j < lSeed % 4; ++j) {
+				const unsigned int lPredecessor = (lSeed >> (8*j)) % i;
+				lGraph.addDependency(i, lPredecessor);
+				lEdges.push_back(make_pair(i, lPredecessor));
+			}
+		}
+		unsigned int lErrors = 0;
+		Timer lTimer;
+		for(unsigned int lRound = 0; lRound < inRounds; ++lRound) {
+			for(unsigned int i = 0; i < inTasks; ++i) lTasks[i].mRuns = 0;
+			lGraph.run(lPool);
+			// a completed task has run in this round (its count is incremented before its completion)
+			for(unsigned int i = 0; i < inTasks; ++i) {
+				if(lTasks[i].isCompleted() && lTasks[i].mRuns == 0) ++lErrors;
+			}
+			vector<unsigned int> lReported(inTasks, 0);
+			for(unsigned int i = 0; i < inTasks; ++i) ++lReported[lGraph.waitAny()];
+			lGraph.waitAll();
+			for(unsigned int i = 0; i < inTasks; ++i) {
+				if(lTasks[i].mRuns != 1 || lReported[i] != 1 || !lTasks[i].isCompleted()) ++lErrors;
+			}
+			for(unsigned int i = 0; i < lEdges.size(); ++i) {
+				if(lTasks[lEdges[i].first].mStart < lTasks[lEdges[i].second].mEnd) ++lErrors;
+			}
+		}
+		const double lTime = lTimer.getValue();
+		// a cycle must be rejected
+		Stamp lFirst, lSecond;
+		Threading::TaskGraph lCycle;
+		lCycle.add(lFirst);
+		lCycle.add(lSecond);
+		lCycle.addDependency(0, 1);
+		lCycle.addDependency(1, 0);
+		try {
+			lCycle.run(lPool);
+			++lErrors;
+			lCycle.waitAll();
+		}
+		catch(Threading::Exception&) {}
+		cout << inName << ": " << inRounds << " runs of " << inTasks << " tasks in " << lTime << " s, " << lErrors << " errors" << endl;
+		return lErrors;
+	}
+	
+}
+
+int main(int argc, char** argv)
+{
+	const unsigned int lSlaves = (argc > 1) ? atoi(argv[1]) : 4;
+	const unsigned int lTasks = (argc > 2) ? atoi(argv[2]) : 2000;
+	const unsigned int lRounds = (argc > 3) ? atoi(argv[3]) : 5;
+	if(lSlaves == 0) {
+		cerr << "usage: " << argv[0] << " [SLAVES] [TASKS] [ROUNDS]" << endl;
+		return 1;
+	}
+	unsigned int lErrors = 0;
+	lErrors += stress("global queue", Threading::ThreadPool::eGlobalQueue, lSlaves, lTasks, lRounds);
+	lErrors += stress("work stealing", Threading::ThreadPool::eWorkStealing, lSlaves, lTasks, lRounds);
+	lErrors += stress("lock-free queue", Threading::ThreadPool::eLockFreeQueue, lSlaves, lTasks, lRounds);
+	cout << (lErrors == 0 ? "PASSED" : "FAILED") << endl;
+	return lErrors == 0 ? 0 : 1;
+}
@@ -0,0 +1,170 @@
+/*
+ *  Portable Agile C++ Classes (PACC)
+ *  Copyright (C) 2001-2003 by Marc Parizeau
+ *  http://manitou.gel.ulaval.ca/~parizeau/PACC
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *  Contact:
+ *  Laboratoire de Vision et Systemes Numeriques
+ *  Departement de genie electrique et de genie informatique
+ *  Universite Laval, Quebec, Canada, G1K 7P4
+ *  http://vision.gel.ulaval.ca
+ *
+ */
+/*!
+ * \file bench/GroupStress.cpp
+ * \brief Stress test of the batched pushes and of the task groups of the thread pool.
+ * \author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+ *
+ * Usage:
+ * \verbatim
+ pacc-stress-group [SLAVES] [ROUNDS]
+ \endverbatim
+ * For each scheduling mode of ThreadPool, a pool of SLAVES slaves (default 4) runs ROUNDS 
+ * rounds (default 20) through a single TaskGroup, which is reused from round to round: 
+ * lightweight tasks are pushed one by one and in batches, some of which push children onto 
+ * the same group from within their slave, and tasks of class Task are pushed in a batch. 
+ * After TaskGroup::waitAll, every task must have run exactly once, be completed, and the 
+ * group must have no pending task. The program also checks that ThreadPool::pushBatch runs 
+ * tasks of class Task without a group, and that the destructor of a group waits for its 
+ * pending tasks. It returns a non-zero status if any check fails.
+ */
+
+#include "PACC/Threading.hpp"
+#include "PACC/Util/Timer.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+using namespace PACC;
+
+namespace {
+	
+	//! Lightweight task that counts its runs, and pushes its children onto its group when it runs.
+	class Member : public Threading::LightTask {
+	 public:
+		Member(void) : mRuns(0), mGroup(0) {}
+		
+		atomic<unsigned int> mRuns; //!< Number of times the task ran.
+		vector<Threading::LightTask*> mChildren; //!< Children of the task.
+		Threading::TaskGroup* mGroup; //!< Group onto which the children are pushed.
+		
+		void main(void) {
+			++mRuns;
+			if(!mChildren.empty()) mGroup->push(&mChildren[0], mChildren.size());
+		}
+	};
+	
+	//! %Task that counts its runs, and lasts \c mSleep seconds.
+	class Work : public Threading::Task {
+	 public:
+		Work(void) : mRuns(0), mSleep(0) {}
+		
+		atomic<unsigned int> mRuns; //!< Number of times the task ran.
+		double mSleep; //!< Duration of a run (seconds).
+		
+		void main(void) {
+			if(mSleep > 0) Threading::Thread::sleep(mSleep);
+			++mRuns;
+		}
+	};
+	
+	//! Run \c inRounds rounds of a group in a pool of \c inSlaves slaves using mode \c inMode, and return the number of failed checks.
+	unsigned int stress(const char* inName, Threading::ThreadPool::Mode inMode, unsigned int inSlaves, unsigned int inRounds)
+	{
+		const unsigned int lParents = 512, lChildren = 8, lWorkCount = 256;
+		vector<Member> lMembers(lParents + lParents*lChildren);
+		vector<Work> lWorks(lWorkCount);
+		vector<Threading::LightTask*> lBatch;
+		vector<Threading::Task*> lWorkBatch;
+		unsigned int lErrors = 0;
+		Timer lTimer;
+		{
+			Threading::ThreadPool lPool(inSlaves, inMode, 256);
+			Threading::TaskGroup lGroup(lPool);
+			for(unsigned int i = 0; i < lParents; ++i) {
+				Member& lParent = lMembers[i];
+				lParent.mGroup = &lGroup;
+				// one parent out of two has children
+				if(i % 2 == 0) {
+					for(unsigned int j = 0; j < lChildren; ++j) lParent.mChildren.push_back(&lMembers[lParents + i*lChildren + j]);
+				}
+				if(i >= lParents/2) lBatch.push_back(&lParent);
+			}
+			for(unsigned int i = 0; i < lWorks.size(); ++i) lWorkBatch.push_back(&lWorks[i]);
+			for(unsigned int lRound = 0; lRound < inRounds; ++lRound) {
+				for(unsigned int i = 0; i < lMembers.size(); ++i) lMembers[i].mRuns = 0;
+				for(unsigned int i = 0; i < lWorks.size(); ++i) lWorks[i].mRuns = 0;
+				// the first half of the parents one by one, the second half in a batch
+				for(unsigned int i = 0; i < lParents/2; ++i) lGroup.push(lMembers[i]);
+				lGroup.push(&lBatch[0], lBatch.size());
+				lGroup.push(&lWorkBatch[0], lWorkBatch.size());
+				lGroup.waitAll();
+				if(lGroup.getPending() != 0) ++lErrors;
+				for(unsigned int i = 0; i < lMembers.size(); ++i) {
+					// children of the parents without children are never pushed
+					const bool lPushed = i < lParents || ((i-lParents)/lChildren) % 2 == 0;
+					if(lMembers[i].mRuns != (lPushed ? 1u : 0u) || lMembers[i].isCompleted() != lPushed || lMembers[i].isPending()) ++lErrors;
+				}
+				for(unsigned int i = 0; i < lWorks.size(); ++i) {
+					if(lWorks[i].mRuns != 1 || !lWorks[i].isCompleted()) ++lErrors;
+				}
+			}
+			// tasks of class Task pushed in a batch, without a group
+			for(unsigned int i = 0; i < lWorks.size(); ++i) lWorks[i].mRuns = 0;
+			lPool.pushBatch(&lWorkBatch[0], lWorkBatch.size());
+			for(unsigned int i = 0; i < lWorks.size(); ++i) {
+				lWorks[i].wait();
+				if(lWorks[i].mRuns != 1) ++lErrors;
+			}
+			// the destructor of a group waits for its pending tasks
+			for(unsigned int i = 0; i < lWorks.size(); ++i) {
+				lWorks[i].mRuns = 0;
+				lWorks[i].mSleep = (i % 16 == 0) ? 0.01 : 0;
+			}
+			{
+				Threading::TaskGroup lPending(lPool);
+				lPending.push(&lWorkBatch[0], lWorkBatch.size());
+			}
+			for(unsigned int i = 0; i < lWorks.size(); ++i) {
+				if(lWorks[i].mRuns != 1 || !lWorks[i].isCompleted()) ++lErrors;
+			}
+		}
+		const double lTime = lTimer.getValue();
+		cout << inName << ": " << inRounds*(lParents*(lChildren/2+1)+lWorkCount) << " tasks in " << lTime << " s, " << lErrors << " errors" << endl;
+		return lErrors;
+	}
+	
+}
+
+int main(int argc, char** argv)
+{
+	const unsigned int lSlaves = (argc > 1) ? atoi(argv[1]) : 4;
+	const unsigned int lRounds = (argc > 2) ? atoi(argv[2]) : 20;
+	if(lSlaves == 0) {
+		cerr << "usage: " << argv[0] << " [SLAVES] [ROUNDS]" << endl;
+		return 1;
+	}
+	unsigned int lErrors = 0;
+	lErrors += stress("global queue", Threading::ThreadPool::eGlobalQueue, lSlaves, lRounds);
+	lErrors += stress("work stealing", Threading::ThreadPool::eWorkStealing, lSlaves, lRounds);
+	lErrors += stress("lock-free queue", Threading::ThreadPool::eLockFreeQueue, lSlaves, lRounds);
+	cout << (lErrors == 0 ? "PASSED" : "FAILED") << endl;
+	return lErrors == 0 ? 0 : 1;
+}
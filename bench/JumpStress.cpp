@@ -0,0 +1,133 @@
+/*
+ *  Portable Agile C++ Classes (PACC)
+ *  Copyright (C) 2001-2003 by Marc Parizeau
+ *  http://manitou.gel.ulaval.ca/~parizeau/PACC
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *  Contact:
+ *  Laboratoire de Vision et Systemes Numeriques
+ *  Departement de genie electrique et de genie informatique
+ *  Universite Laval, Quebec, Canada, G1K 7P4
+ *  http://vision.gel.ulaval.ca
+ *
+ */
+/*!
+ * \file bench/JumpStress.cpp
+ * \brief Stress test of the jump ahead of the random number generator.
+ * \author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+ *
+ * Usage:
+ * \verbatim
+ pacc-stress-jump [DRAWS]
+ \endverbatim
+ * The program checks that the jump ahead of Randomizer by n draws gives the same sequence as 
+ * n calls to Randomizer::getInteger, for small values of n around the boundaries of the state 
+ * of the Mersenne Twister, from several positions within its state, and for DRAWS draws 
+ * (default 40000000, beyond which Randomizer::discard jumps instead of drawing). It then 
+ * checks that jumps of streams add up (see Randomizer::jump), that they commute with draws, 
+ * and that Randomizer::split gives the jumped streams. The program returns a non-zero status 
+ * if any check fails.
+ */
+
+#include "PACC/Util/Randomizer.hpp"
+#include "PACC/Util/Timer.hpp"
+
+#include <cstdlib>
+#include <iostream>
+
+using namespace std;
+using namespace PACC;
+
+namespace {
+	
+	//! Random number generator that gives access to the jump ahead by any number of draws.
+	class Jumper : public Randomizer {
+	 public:
+		explicit Jumper(unsigned long int inSeed) : Randomizer(inSeed) {}
+		
+		//! Jump ahead by \c inDraws draws, however small.
+		void jumpDraws(unsigned long long inDraws) {jumpAhead(inDraws, false);}
+	};
+	
+	//! Return whether generators \c ioFirst and \c ioSecond give the same next 2*N draws, which cover their whole state.
+	bool isSame(Randomizer& ioFirst, Randomizer& ioSecond)
+	{
+		bool lSame = true;
+		for(unsigned int i = 0; i < 2*624; ++i) lSame &= ioFirst.getInteger() == ioSecond.getInteger();
+		return lSame;
+	}
+	
+	//! Check jumps of \c inDraws draws from the positions \c inPositions of the state, and return the number of failed checks.
+	unsigned int checkDraws(unsigned long long inDraws, unsigned int inPositions)
+	{
+		unsigned int lErrors = 0;
+		for(unsigned int i = 0; i < inPositions; ++i) {
+			Jumper lJumped(5489UL+i), lDrawn(5489UL+i);
+			// start from various positions within the state (and at its very end)
+			const unsigned int lPosition = (i == 0 ? 0 : (i == 1 ? 624 : 211*i % 624));
+			for(unsigned int j = 0; j < lPosition; ++j) {
+				lJumped.getInteger();
+				lDrawn.getInteger();
+			}
+			lJumped.jumpDraws(inDraws);
+			for(unsigned long long j = 0; j < inDraws; ++j) lDrawn.getInteger();
+			if(!isSame(lJumped, lDrawn)) ++lErrors;
+		}
+		return lErrors;
+	}
+	
+}
+
+int main(int argc, char** argv)
+{
+	const unsigned long long lDraws = (argc > 1) ? strtoull(argv[1], 0, 10) : 40000000ULL;
+	Timer lTimer;
+	// small jumps, around the size of the state
+	unsigned int lErrors = 0;
+	const unsigned long long lSmall[] = {1, 2, 3, 396, 397, 398, 623, 624, 625, 1247, 1248, 1249, 100000};
+	for(unsigned int i = 0; i < sizeof(lSmall)/sizeof(lSmall[0]); ++i) lErrors += checkDraws(lSmall[i], 4);
+	cout << "small jumps: " << lErrors << " errors" << endl;
+	// large jump, through Randomizer::discard
+	unsigned int lLargeErrors = checkDraws(lDraws, 2);
+	Randomizer lDiscarded(4357UL), lDrawn(4357UL);
+	lDiscarded.discard(lDraws);
+	for(unsigned long long i = 0; i < lDraws; ++i) lDrawn.getInteger();
+	if(!isSame(lDiscarded, lDrawn)) ++lLargeErrors;
+	cout << "jumps of " << lDraws << " draws: " << lLargeErrors << " errors" << endl;
+	lErrors += lLargeErrors;
+	// jumps of streams add up, and commute with draws
+	unsigned int lStreamErrors = 0;
+	Randomizer lOnce(19650218UL), lTwice(19650218UL), lSplit(19650218UL);
+	lOnce.jump(3);
+	lTwice.jump(1);
+	lTwice.jump(2);
+	Randomizer lStream = lSplit.split(3);
+	if(!isSame(lOnce, lTwice)) ++lStreamErrors;
+	lOnce = Randomizer(19650218UL);
+	lOnce.jump(3);
+	if(!isSame(lOnce, lStream)) ++lStreamErrors;
+	Randomizer lBefore(271828UL), lAfter(271828UL);
+	lBefore.discard(1000);
+	lBefore.jump();
+	lAfter.jump();
+	lAfter.discard(1000);
+	if(!isSame(lBefore, lAfter)) ++lStreamErrors;
+	cout << "jumps of streams: " << lStreamErrors << " errors" << endl;
+	lErrors += lStreamErrors;
+	cout << "total time: " << lTimer.getValue() << " s" << endl;
+	cout << (lErrors == 0 ? "PASSED" : "FAILED") << endl;
+	return lErrors == 0 ? 0 : 1;
+}
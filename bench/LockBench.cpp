@@ -0,0 +1,178 @@
+/*
+ *  Portable Agile C++ Classes (PACC)
+ *  Copyright (C) 2001-2003 by Marc Parizeau
+ *  http://manitou.gel.ulaval.ca/~parizeau/PACC
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *  Contact:
+ *  Laboratoire de Vision et Systemes Numeriques
+ *  Departement de genie electrique et de genie informatique
+ *  Universite Laval, Quebec, Canada, G1K 7P4
+ *  http://vision.gel.ulaval.ca
+ *
+ */
+
+/*!
+ * \file bench/LockBench.cpp
+ * \brief Contention benchmark of the locks of the Threading classes on read-mostly data.
+ * \author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+ *
+ * Usage:
+ * \verbatim
+ pacc-bench-lock [THREADS] [OPERATIONS] [WRITE_PERIOD]
+ \endverbatim
+ * Each of THREADS threads (default 4) makes OPERATIONS accesses (default 1000000) to a small 
+ * shared table, one of every WRITE_PERIOD accesses (default 1000) being a write, and the 
+ * others a read of the whole table. The table is protected in turn by a Mutex, an 
+ * AdaptiveMutex, a RWMutex and a SeqLock, and the total throughput is reported for each.
+ */
+
+#include "PACC/Threading.hpp"
+#include "PACC/Util/Timer.hpp"
+
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+using namespace PACC;
+
+namespace {
+	
+	//! Shared table of values.
+	struct Table {
+		double mValues[8]; //!< Values of table.
+	};
+	
+	//! Abstract shared table protected by a lock.
+	class SharedTable {
+	 public:
+		virtual ~SharedTable(void) {}
+		//! Return the sum of the table values.
+		virtual double read(void) = 0;
+		//! Increment all table values.
+		virtual void write(void) = 0;
+		
+	 protected:
+		Table mTable; //!< Protected table.
+		
+		//! Return the sum of the values of table \c inTable.
+		static double sum(const Table& inTable) {
+			double lSum = 0;
+			for(unsigned int i = 0; i < 8; ++i) lSum += inTable.mValues[i];
+			return lSum;
+		}
+	};
+	
+	//! Table protected by a lock of class \c Lock (with lock and unlock methods).
+	template <class Lock>
+	class LockedTable : public SharedTable {
+	 public:
+		LockedTable(void) {for(unsigned int i = 0; i < 8; ++i) mTable.mValues[i] = 0;}
+		double read(void) {mLock.lock(); double lSum = sum(mTable); mLock.unlock(); return lSum;}
+		void write(void) {mLock.lock(); for(unsigned int i = 0; i < 8; ++i) ++mTable.mValues[i]; mLock.unlock();}
+		
+	 protected:
+		Lock mLock; //!< Lock of table.
+	};
+	
+	//! Table protected by a reader-writer mutex.
+	class RWTable : public SharedTable {
+	 public:
+		RWTable(void) {for(unsigned int i = 0; i < 8; ++i) mTable.mValues[i] = 0;}
+		double read(void) {Threading::ReadGuard lGuard(mLock); return sum(mTable);}
+		void write(void) {Threading::WriteGuard lGuard(mLock); for(unsigned int i = 0; i < 8; ++i) ++mTable.mValues[i];}
+		
+	 protected:
+		Threading::RWMutex mLock; //!< Lock of table.
+	};
+	
+	//! Table protected by a sequence lock.
+	class SeqTable : public SharedTable {
+	 public:
+		double read(void) {return sum(mLock.load());}
+		void write(void) {
+			// writers are serialized by the sequence lock, but two writers may read the same value
+			Table lTable = mLock.load();
+			for(unsigned int i = 0; i < 8; ++i) ++lTable.mValues[i];
+			mLock.store(lTable);
+		}
+		
+	 protected:
+		Threading::SeqLock<Table> mLock; //!< Lock of table.
+	};
+	
+	//! Thread that makes read and write accesses to a shared table.
+	class Worker : public Threading::Thread {
+	 public:
+		Worker(SharedTable& inTable, unsigned int inOperations, unsigned int inWritePeriod, unsigned int inSeed) : 
+			mTable(inTable), mOperations(inOperations), mWritePeriod(inWritePeriod), mSeed(inSeed), mSum(0) {}
+		~Worker(void) {wait();}
+		
+	 protected:
+		SharedTable& mTable; //!< Shared table.
+		unsigned int mOperations; //!< Number of accesses.
+		unsigned int mWritePeriod; //!< Mean number of accesses per write.
+		unsigned int mSeed; //!< State of the random selection of writes.
+		double mSum; //!< Sum of the values read (keeps reads from being optimized out).
+		
+		void main(void) {
+			for(unsigned int i = 0; i < mOperations; ++i) {
+				mSeed ^= mSeed << 13;
+				mSeed ^= mSeed >> 17;
+				mSeed ^= mSeed << 5;
+				if(mSeed % mWritePeriod == 0) mTable.write();
+				else mSum += mTable.read();
+			}
+		}
+	};
+	
+	//! Run \c inThreads workers on table \c ioTable, and print the throughput of lock \c inName.
+	void measure(const char* inName, SharedTable& ioTable, unsigned int inThreads, unsigned int inOperations, unsigned int inWritePeriod)
+	{
+		vector<Worker*> lWorkers;
+		for(unsigned int i = 0; i < inThreads; ++i) lWorkers.push_back(new Worker(ioTable, inOperations, inWritePeriod, 2463534242u+i*7919));
+		Timer lTimer;
+		for(unsigned int i = 0; i < inThreads; ++i) lWorkers[i]->run();
+		for(unsigned int i = 0; i < inThreads; ++i) lWorkers[i]->wait();
+		const double lTime = lTimer.getValue();
+		for(unsigned int i = 0; i < inThreads; ++i) delete lWorkers[i];
+		cout << inName << ": " << lTime << " s, " << inThreads*(double)inOperations/lTime/1e6 << " Maccesses/s" << endl;
+	}
+	
+}
+
+int main(int argc, char** argv)
+{
+	const unsigned int lThreads = (argc > 1) ? atoi(argv[1]) : 4;
+	const unsigned int lOperations = (argc > 2) ? atoi(argv[2]) : 1000000;
+	const unsigned int lWritePeriod = (argc > 3) ? atoi(argv[3]) : 1000;
+	if(lThreads == 0 || lWritePeriod == 0) {
+		cerr << "usage: " << argv[0] << " [THREADS] [OPERATIONS] [WRITE_PERIOD]" << endl;
+		return 1;
+	}
+	cout << lThreads << " threads, " << lOperations << " accesses per thread, 1 write per " << lWritePeriod << " accesses" << endl;
+	
+	LockedTable<Threading::Mutex> lMutexTable;
+	measure("Mutex", lMutexTable, lThreads, lOperations, lWritePeriod);
+	LockedTable<Threading::AdaptiveMutex> lAdaptiveTable;
+	measure("AdaptiveMutex", lAdaptiveTable, lThreads, lOperations, lWritePeriod);
+	RWTable lRWTable;
+	measure("RWMutex", lRWTable, lThreads, lOperations, lWritePeriod);
+	SeqTable lSeqTable;
+	measure("SeqLock", lSeqTable, lThreads, lOperations, lWritePeriod);
+	return 0;
+}
@@ -0,0 +1,142 @@
+/*
+ *  Portable Agile C++ Classes (PACC)
+ *  Copyright (C) 2001-2003 by Marc Parizeau
+ *  http://manitou.gel.ulaval.ca/~parizeau/PACC
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *  Contact:
+ *  Laboratoire de Vision et Systemes Numeriques
+ *  Departement de genie electrique et de genie informatique
+ *  Universite Laval, Quebec, Canada, G1K 7P4
+ *  http://vision.gel.ulaval.ca
+ *
+ */
+/*!
+ * \file bench/LockStress.cpp
+ * \brief Stress test of the mutual exclusion of the spin and adaptive mutexes.
+ * \author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+ *
+ * Usage:
+ * \verbatim
+ pacc-stress-lock [THREADS] [OPERATIONS]
+ \endverbatim
+ * Each of THREADS threads (default 4) enters OPERATIONS times (default 100000) a critical 
+ * section protected in turn by a Mutex, a SpinMutex, an AdaptiveMutex, and an AdaptiveMutex 
+ * that never spins, entered alternately with lock and with a loop on tryLock. Inside the 
+ * section, a thread checks that no other thread is there, and increments two plain counters 
+ * that must stay equal. One section out of 64 lasts long enough for the waiting threads of an 
+ * AdaptiveMutex to sleep. The counters must add up to the number of sections. The program 
+ * returns a non-zero status if any check fails, and hangs if a wake up is lost.
+ */
+
+#include "PACC/Threading.hpp"
+#include "PACC/Util/Timer.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+using namespace PACC;
+
+namespace {
+	
+	//! Data shared by the threads, protected by a lock of type \c LockType.
+	template <class LockType>
+	struct Shared {
+		LockType mLock; //!< Lock of the critical section.
+		atomic<unsigned int> mInside; //!< Number of threads in the critical section.
+		unsigned long mFirst; //!< First plain counter.
+		unsigned long mSecond; //!< Second plain counter.
+		atomic<unsigned int> mErrors; //!< Number of failed checks.
+		
+		Shared(void) : mInside(0), mFirst(0), mSecond(0), mErrors(0) {}
+	};
+	
+	//! Thread that enters the critical section of \c mShared \c mOperations times.
+	template <class LockType>
+	class Worker : public Threading::Thread {
+	 public:
+		Worker(Shared<LockType>& ioShared, unsigned int inOperations, unsigned int inIndex) : mShared(ioShared), mOperations(inOperations), mIndex(inIndex) {}
+		
+		Shared<LockType>& mShared; //!< Shared data.
+		unsigned int mOperations; //!< Number of critical sections.
+		unsigned int mIndex; //!< Index of thread.
+		
+		void main(void) {
+			for(unsigned int i = 0; i < mOperations; ++i) {
+				if((i+mIndex) % 2 == 0) mShared.mLock.lock();
+				else while(!mShared.mLock.tryLock()) Threading::SpinMutex::pause();
+				if(mShared.mInside.fetch_add(1, memory_order_relaxed) != 0) ++mShared.mErrors;
+				const unsigned long lFirst = mShared.mFirst;
+				if(lFirst != mShared.mSecond) ++mShared.mErrors;
+				// a long section, so that the waiting threads give up spinning
+				if((i+mIndex) % 64 == 0) {
+					for(unsigned int j = 0; j < 2000; ++j) Threading::SpinMutex::pause();
+				}
+				mShared.mFirst = lFirst+1;
+				mShared.mSecond = lFirst+1;
+				mShared.mInside.fetch_sub(1, memory_order_relaxed);
+				mShared.mLock.unlock();
+			}
+		}
+	};
+	
+	//! Run \c inThreads threads of \c inOperations sections on \c ioShared, and return the number of failed checks.
+	template <class LockType>
+	unsigned int stress(const char* inName, Shared<LockType>& ioShared, unsigned int inThreads, unsigned int inOperations)
+	{
+		Timer lTimer;
+		vector<Worker<LockType>*> lWorkers;
+		for(unsigned int i = 0; i < inThreads; ++i) lWorkers.push_back(new Worker<LockType>(ioShared, inOperations, i));
+		for(unsigned int i = 0; i < inThreads; ++i) lWorkers[i]->run();
+		for(unsigned int i = 0; i < inThreads; ++i) {
+			lWorkers[i]->wait();
+			delete lWorkers[i];
+		}
+		unsigned int lErrors = ioShared.mErrors;
+		if(ioShared.mFirst != (unsigned long) inThreads*inOperations || ioShared.mSecond != ioShared.mFirst) ++lErrors;
+		// the lock must be free
+		if(!ioShared.mLock.tryLock()) ++lErrors;
+		else ioShared.mLock.unlock();
+		cout << inName << ": " << ioShared.mFirst << " sections in " << lTimer.getValue() << " s, " << lErrors << " errors" << endl;
+		return lErrors;
+	}
+	
+}
+
+int main(int argc, char** argv)
+{
+	const unsigned int lThreads = (argc > 1) ? atoi(argv[1]) : 4;
+	const unsigned int lOperations = (argc > 2) ? atoi(argv[2]) : 100000;
+	if(lThreads == 0) {
+		cerr << "usage: " << argv[0] << " [THREADS] [OPERATIONS]" << endl;
+		return 1;
+	}
+	unsigned int lErrors = 0;
+	Shared<Threading::Mutex> lMutex;
+	lErrors += stress("mutex", lMutex, lThreads, lOperations);
+	Shared<Threading::SpinMutex> lSpinMutex;
+	lErrors += stress("spin mutex", lSpinMutex, lThreads, lOperations);
+	Shared<Threading::AdaptiveMutex> lAdaptiveMutex;
+	lErrors += stress("adaptive mutex", lAdaptiveMutex, lThreads, lOperations);
+	Shared<Threading::AdaptiveMutex> lSleepingMutex;
+	lSleepingMutex.mLock.setSpins(0);
+	lErrors += stress("adaptive mutex without spins", lSleepingMutex, lThreads, lOperations);
+	cout << (lErrors == 0 ? "PASSED" : "FAILED") << endl;
+	return lErrors == 0 ? 0 : 1;
+}
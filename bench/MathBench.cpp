@@ -0,0 +1,430 @@
+/*
+ *  Portable Agile C++ Classes (PACC)
+ *  Copyright (C) 2001-2003 by Marc Parizeau
+ *  http://manitou.gel.ulaval.ca/~parizeau/PACC
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *  Contact:
+ *  Laboratoire de Vision et Systemes Numeriques
+ *  Departement de genie electrique et de genie informatique
+ *  Universite Laval, Quebec, Canada, G1K 7P4
+ *  http://vision.gel.ulaval.ca
+ *
+ */
+
+/*!
+ * \file bench/MathBench.cpp
+ * \brief Micro-benchmarks of the Math classes.
+ * \author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+ *
+ * Usage:
+ * \verbatim
+ pacc-bench-math [--sizes 4,16,...] [--max-size N] [--samples N] [--min-time S] [--filter NAME] [--json FILE]
+ pacc-bench-math --compare BASE.json NEW.json [--threshold PERCENT]
+ \endverbatim
+ * Each benchmark is timed on square matrices (or sequences) of the given sizes. Each sample 
+ * repeats the operation during at least the minimum time, and the mean and standard deviation 
+ * of the time per operation over all samples are reported, together with the throughput in 
+ * GFLOP/s (floating point operations), GB/s (bytes read and written) and ns per element. 
+ * By default, the slowest benchmarks are limited to smaller sizes; option --max-size 
+ * overrides these limits. Option --json writes the results in JSON format ("-" for the 
+ * standard output), and option --compare prints the relative change of the mean times 
+ * between two such files.
+ */
+
+#include "PACC/Math.hpp"
+#include "PACC/Util/CPUFeatures.hpp"
+#include "PACC/Util/Randomizer.hpp"
+#include "PACC/Util/Timer.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace PACC;
+
+namespace {
+	
+	//! Matrix that exposes its text parser and serializer.
+	class TextMatrix : public Matrix {
+	 public:
+		using Matrix::parse;
+		using Matrix::serialize;
+	};
+	
+	//! Abstract micro-benchmark.
+	class Benchmark {
+	 public:
+		//! Construct benchmark \c inName limited to size \c inMaxSize by default.
+		Benchmark(const string& inName, unsigned int inMaxSize) : mName(inName), mMaxSize(inMaxSize), mSize(0) {}
+		virtual ~Benchmark(void) {}
+		
+		//! Return the number of bytes read and written by one operation.
+		virtual double getBytes(void) const {return 0;}
+		//! Return the number of elements processed by one operation.
+		virtual double getElements(void) const {return double(mSize)*mSize;}
+		//! Return the number of floating point operations of one operation.
+		virtual double getFlops(void) const {return 0;}
+		//! Return the default maximum size.
+		unsigned int getMaxSize(void) const {return mMaxSize;}
+		//! Return the benchmark name.
+		const string& getName(void) const {return mName;}
+		//! Run one operation.
+		virtual void run(void) = 0;
+		//! Prepare the operands for size \c inSize.
+		virtual void setup(unsigned int inSize) {
+			mSize = inSize;
+			Randomizer lRand(inSize);
+			mLeft = Matrix(inSize, inSize);
+			mRight = Matrix(inSize, inSize);
+			lRand.fillUniform(mLeft, -1, 1);
+			lRand.fillUniform(mRight, -1, 1);
+		}
+		
+	 protected:
+		string mName;          //!< Benchmark name.
+		unsigned int mMaxSize; //!< Default maximum size.
+		unsigned int mSize;    //!< Current size.
+		Matrix mLeft;          //!< Left operand.
+		Matrix mRight;         //!< Right operand.
+		Matrix mResult;        //!< Result.
+	};
+	
+	class MultiplyBenchmark : public Benchmark {
+	 public:
+		MultiplyBenchmark(void) : Benchmark("multiply", 1024) {}
+		double getBytes(void) const {return 3.*8*mSize*mSize;}
+		double getFlops(void) const {return 2.*mSize*mSize*mSize;}
+		void run(void) {mLeft.multiply(mResult, mRight);}
+	};
+	
+	class InvertBenchmark : public Benchmark {
+	 public:
+		InvertBenchmark(void) : Benchmark("invert", 1024) {}
+		double getBytes(void) const {return 2.*8*mSize*mSize;}
+		double getFlops(void) const {return 2.*mSize*mSize*mSize;}
+		void run(void) {mLeft.invert(mResult);}
+		void setup(unsigned int inSize) {
+			// diagonally dominant matrix
+			Benchmark::setup(inSize);
+			for(unsigned int i = 0; i < inSize; ++i) mLeft(i,i) += inSize;
+		}
+	};
+	
+	class EigensBenchmark : public Benchmark {
+	 public:
+		EigensBenchmark(void) : Benchmark("computeEigens", 512) {}
+		double getBytes(void) const {return 2.*8*mSize*mSize;}
+		double getFlops(void) const {return 9.*mSize*mSize*mSize;}
+		void run(void) {mLeft.computeEigens(mValues, mResult);}
+		void setup(unsigned int inSize) {
+			// symmetric matrix
+			Benchmark::setup(inSize);
+			mLeft += mLeft.transpose();
+		}
+	 protected:
+		Vector mValues;
+	};
+	
+	class TransposeBenchmark : public Benchmark {
+	 public:
+		TransposeBenchmark(void) : Benchmark("transpose", 4096) {}
+		double getBytes(void) const {return 2.*8*mSize*mSize;}
+		void run(void) {mLeft.transpose(mResult);}
+	};
+	
+	//! Benchmark of the reductions (\c inReduction is the Matrix method, \c inFlops the operations per element).
+	class ReductionBenchmark : public Benchmark {
+	 public:
+		typedef Matrix& (Matrix::*Reduction)(Matrix&) const;
+		ReductionBenchmark(const string& inName, Reduction inReduction, double inFlops) 
+		: Benchmark(inName, 4096), mReduction(inReduction), mFlopsPerElement(inFlops) {}
+		double getBytes(void) const {return 8.*mSize*mSize;}
+		double getFlops(void) const {return mFlopsPerElement*mSize*mSize;}
+		void run(void) {(mLeft.*mReduction)(mResult);}
+	 protected:
+		Reduction mReduction;
+		double mFlopsPerElement;
+	};
+	
+	class SerializeBenchmark : public Benchmark {
+	 public:
+		SerializeBenchmark(void) : Benchmark("serialize", 1024) {}
+		double getBytes(void) const {return 8.*mSize*mSize + mText.size();}
+		void run(void) {mText = mMatrix.serialize();}
+		void setup(unsigned int inSize) {
+			Benchmark::setup(inSize);
+			(Matrix&) mMatrix = mLeft;
+			mText = mMatrix.serialize();
+		}
+	 protected:
+		TextMatrix mMatrix;
+		string mText;
+	};
+	
+	class ParseBenchmark : public SerializeBenchmark {
+	 public:
+		ParseBenchmark(void) {mName = "parse";}
+		void run(void) {mMatrix.parse(mText);}
+	};
+	
+	//! Benchmark of the generation of \c size quasi-random vectors of dimensionality 16.
+	class QRandBenchmark : public Benchmark {
+	 public:
+		QRandBenchmark(bool inGaussian) : Benchmark(inGaussian ? "qrand-gaussian" : "qrand-uniform", 4096), mGaussian(inGaussian), mSequencer(cDimensionality) {}
+		double getBytes(void) const {return 8.*getElements();}
+		double getElements(void) const {return double(mSize)*cDimensionality;}
+		void run(void) {
+			if(mGaussian) mSequencer.getGaussianVectors(mResult, mSize);
+			else for(unsigned int i = 0; i < mSize; ++i) mSequencer.getUniformVector(mVector);
+		}
+		void setup(unsigned int inSize) {mSize = inSize;}
+	 protected:
+		static const unsigned int cDimensionality = 16;
+		bool mGaussian;
+		QRandSequencer mSequencer;
+		Vector mVector;
+	};
+	
+	//! Timing of one benchmark for one size.
+	struct Result {
+		string mName;       //!< Benchmark name.
+		unsigned int mSize; //!< Size.
+		double mMean;       //!< Mean time per operation (ns).
+		double mStdDev;     //!< Standard deviation of the time per operation (ns).
+		double mGFlops;     //!< Floating point operations per ns.
+		double mGBytes;     //!< Bytes per ns.
+		double mPerElement; //!< Time per element (ns).
+		unsigned int mSamples;     //!< Number of samples.
+		unsigned int mRepetitions; //!< Number of operations per sample.
+	};
+	
+	//! Command line options.
+	struct Options {
+		Options(void) : mMaxSize(0), mSamples(5), mMinTime(0.05), mThreshold(5) {
+			unsigned int lSizes[] = {4, 16, 64, 256, 1024, 4096};
+			mSizes.assign(lSizes, lSizes+6);
+		}
+		vector<unsigned int> mSizes;
+		unsigned int mMaxSize;
+		unsigned int mSamples;
+		double mMinTime;
+		double mThreshold;
+		string mFilter;
+		string mJSON;
+		vector<string> mCompare;
+	};
+	
+	//! Time benchmark \c ioBenchmark for size \c inSize.
+	Result measure(Benchmark& ioBenchmark, unsigned int inSize, const Options& inOptions)
+	{
+		ioBenchmark.setup(inSize);
+		Timer lTimer;
+		ioBenchmark.run();
+		const double lFirst = lTimer.getValue();
+		unsigned int lRepetitions = 1;
+		if(lFirst < inOptions.mMinTime) lRepetitions = (unsigned int) min(1e6, ceil(inOptions.mMinTime / max(lFirst, 1e-9)));
+		vector<double> lSamples(inOptions.mSamples);
+		for(unsigned int s = 0; s < lSamples.size(); ++s) {
+			lTimer.reset();
+			for(unsigned int r = 0; r < lRepetitions; ++r) ioBenchmark.run();
+			lSamples[s] = lTimer.getValue() * 1e9 / lRepetitions;
+		}
+		Result lResult;
+		lResult.mName = ioBenchmark.getName();
+		lResult.mSize = inSize;
+		lResult.mMean = 0;
+		for(unsigned int s = 0; s < lSamples.size(); ++s) lResult.mMean += lSamples[s];
+		lResult.mMean /= lSamples.size();
+		double lSum2 = 0;
+		for(unsigned int s = 0; s < lSamples.size(); ++s) lSum2 += (lSamples[s]-lResult.mMean)*(lSamples[s]-lResult.mMean);
+		lResult.mStdDev = lSamples.size() > 1 ? sqrt(lSum2 / (lSamples.size()-1)) : 0;
+		lResult.mGFlops = ioBenchmark.getFlops() / lResult.mMean;
+		lResult.mGBytes = ioBenchmark.getBytes() / lResult.mMean;
+		lResult.mPerElement = lResult.mMean / ioBenchmark.getElements();
+		lResult.mSamples = lSamples.size();
+		lResult.mRepetitions = lRepetitions;
+		return lResult;
+	}
+	
+	//! Write results \c inResults in JSON format into stream \c outStream (one result per line).
+	void writeJSON(ostream& outStream, const vector<Result>& inResults)
+	{
+		outStream << "{\n  \"cpu_level\": \"" << CPUFeatures::getLevelName(CPUFeatures::getLevel()) << "\",\n";
+		outStream << "  \"results\": [\n";
+		outStream.precision(6);
+		for(unsigned int i = 0; i < inResults.size(); ++i) {
+			const Result& lResult = inResults[i];
+			outStream << "    {\"name\": \"" << lResult.mName << "\", \"size\": " << lResult.mSize 
+			<< ", \"mean_ns\": " << lResult.mMean << ", \"stddev_ns\": " << lResult.mStdDev 
+			<< ", \"gflops\": " << lResult.mGFlops << ", \"gbps\": " << lResult.mGBytes 
+			<< ", \"ns_per_element\": " << lResult.mPerElement << ", \"samples\": " << lResult.mSamples 
+			<< ", \"repetitions\": " << lResult.mRepetitions << "}" << (i+1 < inResults.size() ? "," : "") << "\n";
+		}
+		outStream << "  ]\n}\n";
+	}
+	
+	//! Return the number following key \c inKey in JSON line \c inLine.
+	double readNumber(const string& inLine, const string& inKey)
+	{
+		const string::size_type lPos = inLine.find("\"" + inKey + "\":");
+		if(lPos == string::npos) return 0;
+		return atof(inLine.c_str() + lPos + inKey.size() + 3);
+	}
+	
+	//! Read the results of JSON file \c inFileName (as written by writeJSON) into map \c outResults indexed by name and size.
+	bool readJSON(const string& inFileName, map<pair<string, unsigned int>, Result>& outResults)
+	{
+		ifstream lFile(inFileName.c_str());
+		if(!lFile) {
+			cerr << "error: cannot open file " << inFileName << endl;
+			return false;
+		}
+		string lLine;
+		while(getline(lFile, lLine)) {
+			const string::size_type lPos = lLine.find("\"name\": \"");
+			if(lPos == string::npos) continue;
+			Result lResult;
+			lResult.mName = lLine.substr(lPos+9, lLine.find('"', lPos+9)-lPos-9);
+			lResult.mSize = (unsigned int) readNumber(lLine, "size");
+			lResult.mMean = readNumber(lLine, "mean_ns");
+			lResult.mStdDev = readNumber(lLine, "stddev_ns");
+			outResults[make_pair(lResult.mName, lResult.mSize)] = lResult;
+		}
+		return true;
+	}
+	
+	//! Print the relative change of the mean times between files \c inBase and \c inNew.
+	int compare(const string& inBase, const string& inNew, double inThreshold)
+	{
+		map<pair<string, unsigned int>, Result> lBase, lNew;
+		if(!readJSON(inBase, lBase) || !readJSON(inNew, lNew)) return 1;
+		cout << left << setw(16) << "benchmark" << right << setw(6) << "size" << setw(14) << "base (ns)" 
+		<< setw(14) << "new (ns)" << setw(10) << "change" << "  verdict" << endl;
+		for(map<pair<string, unsigned int>, Result>::const_iterator i = lNew.begin(); i != lNew.end(); ++i) {
+			map<pair<string, unsigned int>, Result>::const_iterator lMatch = lBase.find(i->first);
+			if(lMatch == lBase.end()) continue;
+			const Result& lOld = lMatch->second;
+			const Result& lNow = i->second;
+			const double lChange = 100. * (lNow.mMean - lOld.mMean) / lOld.mMean;
+			// a change is significant if it exceeds the threshold and twice the combined deviation
+			const double lNoise = 2*sqrt(lOld.mStdDev*lOld.mStdDev + lNow.mStdDev*lNow.mStdDev);
+			const char* lVerdict = "~";
+			if(fabs(lChange) > inThreshold && fabs(lNow.mMean - lOld.mMean) > lNoise) lVerdict = (lChange < 0 ? "faster" : "slower");
+			cout << left << setw(16) << i->first.first << right << setw(6) << i->first.second 
+			<< fixed << setprecision(1) << setw(14) << lOld.mMean << setw(14) << lNow.mMean 
+			<< showpos << setw(9) << lChange << "%" << noshowpos << "  " << lVerdict << endl;
+		}
+		return 0;
+	}
+	
+	//! Parse comma separated list of sizes \c inList.
+	vector<unsigned int> parseSizes(const string& inList)
+	{
+		vector<unsigned int> lSizes;
+		istringstream lStream(inList);
+		string lSize;
+		while(getline(lStream, lSize, ',')) if(!lSize.empty()) lSizes.push_back(atoi(lSize.c_str()));
+		return lSizes;
+	}
+	
+	void printUsage(const char* inProgram)
+	{
+		cerr << "usage: " << inProgram << " [--sizes 4,16,...] [--max-size N] [--samples N] [--min-time S] [--filter NAME] [--json FILE]" << endl;
+		cerr << "       " << inProgram << " --compare BASE.json NEW.json [--threshold PERCENT]" << endl;
+	}
+	
+}
+
+int main(int argc, char** argv)
+{
+	Options lOptions;
+	for(int i = 1; i < argc; ++i) {
+		const string lArg = argv[i];
+		const bool lHasValue = (i+1 < argc);
+		if(lArg == "--sizes" && lHasValue) lOptions.mSizes = parseSizes(argv[++i]);
+		else if(lArg == "--max-size" && lHasValue) lOptions.mMaxSize = atoi(argv[++i]);
+		else if(lArg == "--samples" && lHasValue) lOptions.mSamples = max(1, atoi(argv[++i]));
+		else if(lArg == "--min-time" && lHasValue) lOptions.mMinTime = atof(argv[++i]);
+		else if(lArg == "--filter" && lHasValue) lOptions.mFilter = argv[++i];
+		else if(lArg == "--json" && lHasValue) lOptions.mJSON = argv[++i];
+		else if(lArg == "--threshold" && lHasValue) lOptions.mThreshold = atof(argv[++i]);
+		else if(lArg == "--compare" && i+2 < argc) {
+			lOptions.mCompare.push_back(argv[++i]);
+			lOptions.mCompare.push_back(argv[++i]);
+		} else {
+			printUsage(argv[0]);
+			return 1;
+		}
+	}
+	if(!lOptions.mCompare.empty()) return compare(lOptions.mCompare[0], lOptions.mCompare[1], lOptions.mThreshold);
+	
+	vector<Benchmark*> lBenchmarks;
+	lBenchmarks.push_back(new MultiplyBenchmark);
+	lBenchmarks.push_back(new InvertBenchmark);
+	lBenchmarks.push_back(new EigensBenchmark);
+	lBenchmarks.push_back(new TransposeBenchmark);
+	lBenchmarks.push_back(new ReductionBenchmark("sumColumns", &Matrix::sumColumns, 1));
+	lBenchmarks.push_back(new ReductionBenchmark("sum2Columns", &Matrix::sum2Columns, 2));
+	lBenchmarks.push_back(new ReductionBenchmark("sumRows", &Matrix::sumRows, 1));
+	lBenchmarks.push_back(new ReductionBenchmark("maxColumns", &Matrix::maxColumns, 1));
+	lBenchmarks.push_back(new SerializeBenchmark);
+	lBenchmarks.push_back(new ParseBenchmark);
+	lBenchmarks.push_back(new QRandBenchmark(false));
+	lBenchmarks.push_back(new QRandBenchmark(true));
+	
+	// JSON on the standard output replaces the table
+	ostream& lTable = (lOptions.mJSON == "-") ? cerr : cout;
+	lTable << "# cpu level: " << CPUFeatures::getLevelName(CPUFeatures::getLevel()) << endl;
+	lTable << left << setw(16) << "benchmark" << right << setw(6) << "size" << setw(14) << "mean (ns)" 
+	<< setw(9) << "cv" << setw(10) << "GFLOP/s" << setw(10) << "GB/s" << setw(12) << "ns/elem" << endl;
+	vector<Result> lResults;
+	for(unsigned int b = 0; b < lBenchmarks.size(); ++b) {
+		Benchmark& lBenchmark = *lBenchmarks[b];
+		if(!lOptions.mFilter.empty() && lBenchmark.getName().find(lOptions.mFilter) == string::npos) continue;
+		const unsigned int lMaxSize = lOptions.mMaxSize > 0 ? lOptions.mMaxSize : lBenchmark.getMaxSize();
+		for(unsigned int s = 0; s < lOptions.mSizes.size(); ++s) {
+			if(lOptions.mSizes[s] == 0 || lOptions.mSizes[s] > lMaxSize) continue;
+			const Result lResult = measure(lBenchmark, lOptions.mSizes[s], lOptions);
+			lTable << left << setw(16) << lResult.mName << right << setw(6) << lResult.mSize 
+			<< fixed << setprecision(1) << setw(14) << lResult.mMean 
+			<< setw(8) << 100*lResult.mStdDev/lResult.mMean << "%" << setprecision(3) << setw(10) << lResult.mGFlops 
+			<< setw(10) << lResult.mGBytes << setw(12) << lResult.mPerElement << endl;
+			lResults.push_back(lResult);
+		}
+	}
+	for(unsigned int b = 0; b < lBenchmarks.size(); ++b) delete lBenchmarks[b];
+	
+	if(lOptions.mJSON == "-") writeJSON(cout, lResults);
+	else if(!lOptions.mJSON.empty()) {
+		ofstream lFile(lOptions.mJSON.c_str());
+		writeJSON(lFile, lResults);
+		if(!lFile) {
+			cerr << "error: cannot write file " << lOptions.mJSON << endl;
+			return 1;
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,180 @@
+/*
+ *  Portable Agile C++ Classes (PACC)
+ *  Copyright (C) 2001-2003 by Marc Parizeau
+ *  http://manitou.gel.ulaval.ca/~parizeau/PACC
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *  Contact:
+ *  Laboratoire de Vision et Systemes Numeriques
+ *  Departement de genie electrique et de genie informatique
+ *  Universite Laval, Quebec, Canada, G1K 7P4
+ *  http://vision.gel.ulaval.ca
+ *
+ */
+
+/*!
+ * \file bench/ParallelStress.cpp
+ * \brief Stress test of the data-parallel algorithms of the thread pool.
+ * \author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+ *
+ * Usage:
+ * \verbatim
+ pacc-stress-parallel [SLAVES]
+ \endverbatim
+ * For each scheduling mode of ThreadPool, and for pools of 1 and SLAVES slaves (default 4), 
+ * the program checks that parallelFor calls its function exactly once per index, also for 
+ * nested loops and for loops run from tasks of the same pool, and that it rethrows the 
+ * exception of a failed iteration. It checks that parallelReduce gives a bitwise identical 
+ * floating point sum in every pool, and that parallelSort gives the same result as 
+ * std::stable_sort, also for elements that can only be moved. The program returns a non-zero status if any check fails.
+ */
+
+#include "PACC/Threading.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+using namespace std;
+using namespace PACC;
+
+namespace {
+	
+	//! Return the next value of xorshift generator \c ioSeed.
+	unsigned int next(unsigned int& ioSeed)
+	{
+		ioSeed ^= ioSeed << 13;
+		ioSeed ^= ioSeed >> 17;
+		ioSeed ^= ioSeed << 5;
+		return ioSeed;
+	}
+	
+	//! Element without default constructor, which can only be moved.
+	class Keyed {
+	 public:
+		Keyed(int inKey, int inIndex) : mKey(inKey), mIndex(inIndex) {}
+		Keyed(Keyed&& inKeyed) = default;
+		Keyed& operator=(Keyed&& inKeyed) = default;
+		//! Return whether this element is ordered before element \c inKeyed.
+		bool operator<(const Keyed& inKeyed) const {return mKey < inKeyed.mKey;}
+		int mKey; //!< Sort key.
+		int mIndex; //!< Original position.
+	};
+	
+	//! Return whether the first members of pairs \c inFirst and \c inSecond are ordered.
+	bool isFirstLess(const pair<int, int>& inFirst, const pair<int, int>& inSecond)
+	{
+		return inFirst.first < inSecond.first;
+	}
+	
+	//! Run the checks in pool \c ioPool, compare the sum of \c inValues with \c ioSum (set it if \c ioFirst), and return the number of failed checks.
+	unsigned int stress(Threading::ThreadPool& ioPool, const vector<double>& inValues, double& ioSum, bool& ioFirst)
+	{
+		unsigned int lErrors = 0;
+		// each index once
+		vector<atomic<unsigned int> > lHits(100003);
+		for(unsigned int i = 0; i < lHits.size(); ++i) lHits[i] = 0;
+		Threading::parallelFor(ioPool, 0u, (unsigned int) lHits.size(), [&](unsigned int inIndex) {++lHits[inIndex];});
+		for(unsigned int i = 0; i < lHits.size(); ++i) if(lHits[i] != 1) ++lErrors;
+		// nested loops
+		atomic<long> lTotal(0);
+		Threading::parallelFor(ioPool, 0, 50, 1, [&](int) {
+			Threading::parallelFor(ioPool, 0, 1000, 7, [&](int inIndex) {lTotal += inIndex;});
+		});
+		if(lTotal != 50L*999*1000/2) ++lErrors;
+		// loops run from tasks of the same pool
+		vector<Threading::Future<long> > lFutures;
+		for(unsigned int i = 0; i < 8; ++i) {
+			lFutures.push_back(ioPool.submit([&ioPool](void) {
+				return Threading::parallelReduce(ioPool, 0, 10000, 0L, [](int inBegin, int inEnd) {
+					long lSum = 0;
+					for(int j = inBegin; j < inEnd; ++j) lSum += j;
+					return lSum;
+				}, [](long inFirst, long inSecond) {return inFirst + inSecond;});
+			}));
+		}
+		for(unsigned int i = 0; i < lFutures.size(); ++i) if(lFutures[i].get() != 49995000L) ++lErrors;
+		// exception of an iteration
+		try {
+			Threading::parallelFor(ioPool, 0, 100000, [](int inIndex) {if(inIndex == 777) throw runtime_error("iteration 777");});
+			++lErrors;
+		}
+		catch(runtime_error&) {}
+		// deterministic floating point sum
+		const double lSum = Threading::parallelReduce(ioPool, size_t(0), inValues.size(), 0., [&inValues](size_t inBegin, size_t inEnd) {
+			double lPartial = 0;
+			for(size_t j = inBegin; j < inEnd; ++j) lPartial += inValues[j];
+			return lPartial;
+		}, [](double inFirst, double inSecond) {return inFirst + inSecond;});
+		if(ioFirst) {
+			ioSum = lSum;
+			ioFirst = false;
+		}
+		else if(memcmp(&lSum, &ioSum, sizeof(double)) != 0) ++lErrors;
+		// stable sort
+		unsigned int lSeed = 88675123u;
+		vector<pair<int, int> > lPairs(300007);
+		for(unsigned int i = 0; i < lPairs.size(); ++i) lPairs[i] = make_pair(int(next(lSeed) % 1000), int(i));
+		vector<pair<int, int> > lExpected(lPairs);
+		stable_sort(lExpected.begin(), lExpected.end(), isFirstLess);
+		Threading::parallelSort(ioPool, lPairs.begin(), lPairs.end(), isFirstLess);
+		if(lPairs != lExpected) ++lErrors;
+		vector<Keyed> lKeyed;
+		for(unsigned int i = 0; i < lPairs.size(); ++i) lKeyed.push_back(Keyed(int(next(lSeed) % 1000), int(i)));
+		Threading::parallelSort(ioPool, lKeyed.begin(), lKeyed.end());
+		for(unsigned int i = 1; i < lKeyed.size(); ++i) {
+			if(lKeyed[i].mKey < lKeyed[i-1].mKey || (lKeyed[i].mKey == lKeyed[i-1].mKey && lKeyed[i].mIndex < lKeyed[i-1].mIndex)) ++lErrors;
+		}
+		vector<int> lEmpty;
+		Threading::parallelSort(ioPool, lEmpty.begin(), lEmpty.end(), less<int>());
+		return lErrors;
+	}
+	
+}
+
+int main(int argc, char** argv)
+{
+	const unsigned int lSlaves = (argc > 1) ? atoi(argv[1]) : 4;
+	if(lSlaves == 0) {
+		cerr << "usage: " << argv[0] << " [SLAVES]" << endl;
+		return 1;
+	}
+	// values of very different magnitudes, whose sum depends on the order of the additions
+	unsigned int lSeed = 2463534242u;
+	vector<double> lValues(1000000);
+	for(unsigned int i = 0; i < lValues.size(); ++i) {
+		lValues[i] = (double(next(lSeed)) - 2147483648.) * (1 << (next(lSeed) % 24));
+	}
+	const char* lNames[] = {"global queue", "work stealing", "lock-free queue"};
+	const unsigned int lSizes[] = {1, lSlaves};
+	unsigned int lErrors = 0;
+	double lSum = 0;
+	bool lFirst = true;
+	for(unsigned int i = 0; i < 2; ++i) {
+		for(unsigned int lMode = 0; lMode < 3; ++lMode) {
+			Threading::ThreadPool lPool(lSizes[i], (Threading::ThreadPool::Mode) lMode);
+			const unsigned int lPoolErrors = stress(lPool, lValues, lSum, lFirst);
+			cout << lNames[lMode] << ", " << lSizes[i] << " slaves: " << lPoolErrors << " errors" << endl;
+			lErrors += lPoolErrors;
+		}
+	}
+	cout << (lErrors == 0 ? "PASSED" : "FAILED") << endl;
+	return lErrors == 0 ? 0 : 1;
+}
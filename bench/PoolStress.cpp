@@ -0,0 +1,122 @@
+/*
+ *  Portable Agile C++ Classes (PACC)
+ *  Copyright (C) 2001-2003 by Marc Parizeau
+ *  http://manitou.gel.ulaval.ca/~parizeau/PACC
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *  Contact:
+ *  Laboratoire de Vision et Systemes Numeriques
+ *  Departement de genie electrique et de genie informatique
+ *  Universite Laval, Quebec, Canada, G1K 7P4
+ *  http://vision.gel.ulaval.ca
+ *
+ */
+
+/*!
+ * \file bench/PoolStress.cpp
+ * \brief Stress test of the scheduling modes of the thread pool with nested tasks.
+ * \author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+ *
+ * Usage:
+ * \verbatim
+ pacc-stress-pool [SLAVES] [ROUNDS]
+ \endverbatim
+ * For each scheduling mode of ThreadPool, a pool of SLAVES slaves (default 4) runs ROUNDS 
+ * rounds (default 10) of a tree of tasks: each root task pushes its children from within 
+ * its slave, alternately one by one and in a batch, and so do the children. The capacity of 
+ * the lock-free queue is kept small, so that its overflow queue is also exercised. The 
+ * program waits for every task, and checks that each task ran exactly once. It returns a 
+ * non-zero status if any check fails.
+ */
+
+#include "PACC/Threading.hpp"
+#include "PACC/Util/Timer.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+using namespace PACC;
+
+namespace {
+	
+	//! Task of the tree, that pushes its children when it runs.
+	class Node : public Threading::LightTask {
+	 public:
+		Node(void) : mRuns(0), mPool(0), mBatch(false) {}
+		
+		atomic<unsigned int> mRuns; //!< Number of times the task ran.
+		vector<Threading::LightTask*> mChildren; //!< Children of the task.
+		Threading::ThreadPool* mPool; //!< Thread pool of the task.
+		bool mBatch; //!< Children are pushed in a single batch.
+		
+		void main(void) {
+			++mRuns;
+			if(mChildren.empty()) return;
+			if(mBatch) mPool->pushBatch(&mChildren[0], mChildren.size());
+			else for(unsigned int i = 0; i < mChildren.size(); ++i) mPool->push(*mChildren[i]);
+		}
+	};
+	
+	//! Run \c inRounds rounds of the tree in a pool of \c inSlaves slaves using mode \c inMode, and return the number of failed checks.
+	unsigned int stress(const char* inName, Threading::ThreadPool::Mode inMode, unsigned int inSlaves, unsigned int inRounds)
+	{
+		const unsigned int lRoots = 32, lFanOut = 16, lLeaves = 64;
+		vector<Node> lNodes(lRoots + lRoots*lFanOut + lRoots*lFanOut*lLeaves);
+		Threading::ThreadPool lPool(inSlaves, inMode, 64);
+		// build the tree: the roots come first, then the middle nodes, and then the leaves
+		unsigned int lNext = lRoots;
+		for(unsigned int i = 0; i < lRoots + lRoots*lFanOut; ++i) {
+			const unsigned int lChildren = (i < lRoots ? lFanOut : lLeaves);
+			for(unsigned int j = 0; j < lChildren; ++j) lNodes[i].mChildren.push_back(&lNodes[lNext++]);
+			lNodes[i].mBatch = (i % 2 == 1);
+		}
+		for(unsigned int i = 0; i < lNodes.size(); ++i) lNodes[i].mPool = &lPool;
+		unsigned int lErrors = 0;
+		Timer lTimer;
+		for(unsigned int lRound = 0; lRound < inRounds; ++lRound) {
+			for(unsigned int i = 0; i < lNodes.size(); ++i) lNodes[i].mRuns = 0;
+			for(unsigned int i = 0; i < lRoots; ++i) lPool.push(lNodes[i]);
+			// a parent has pushed its children when it is completed
+			for(unsigned int i = 0; i < lNodes.size(); ++i) lNodes[i].wait();
+			for(unsigned int i = 0; i < lNodes.size(); ++i) {
+				if(lNodes[i].mRuns != 1) ++lErrors;
+			}
+		}
+		const double lTime = lTimer.getValue();
+		cout << inName << ": " << inRounds*lNodes.size() << " tasks in " << lTime << " s, " << lErrors << " errors" << endl;
+		return lErrors;
+	}
+	
+}
+
+int main(int argc, char** argv)
+{
+	const unsigned int lSlaves = (argc > 1) ? atoi(argv[1]) : 4;
+	const unsigned int lRounds = (argc > 2) ? atoi(argv[2]) : 10;
+	if(lSlaves == 0) {
+		cerr << "usage: " << argv[0] << " [SLAVES] [ROUNDS]" << endl;
+		return 1;
+	}
+	unsigned int lErrors = 0;
+	lErrors += stress("global queue", Threading::ThreadPool::eGlobalQueue, lSlaves, lRounds);
+	lErrors += stress("work stealing", Threading::ThreadPool::eWorkStealing, lSlaves, lRounds);
+	lErrors += stress("lock-free queue", Threading::ThreadPool::eLockFreeQueue, lSlaves, lRounds);
+	cout << (lErrors == 0 ? "PASSED" : "FAILED") << endl;
+	return lErrors == 0 ? 0 : 1;
+}
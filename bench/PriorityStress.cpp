@@ -0,0 +1,190 @@
+/*
+ *  Portable Agile C++ Classes (PACC)
+ *  Copyright (C) 2001-2003 by Marc Parizeau
+ *  http://manitou.gel.ulaval.ca/~parizeau/PACC
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *  Contact:
+ *  Laboratoire de Vision et Systemes Numeriques
+ *  Departement de genie electrique et de genie informatique
+ *  Universite Laval, Quebec, Canada, G1K 7P4
+ *  http://vision.gel.ulaval.ca
+ *
+ */
+/*!
+ * \file bench/PriorityStress.cpp
+ * \brief Stress test of the priority levels, deadlines and aging of the thread pool.
+ * \author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+ *
+ * Usage:
+ * \verbatim
+ pacc-stress-priority [TASKS] [ROUNDS]
+ \endverbatim
+ * For each scheduling mode of ThreadPool, the single slave of a pool is held by a first task 
+ * while TASKS tasks (default 600) of all priority levels, with and without deadlines, are 
+ * pushed in ROUNDS rounds (default 20). ThreadPool::getDepth must count the waiting tasks of 
+ * each level, and the slave must then start them by level, in earliest deadline first order 
+ * within a level, and the tasks without deadline in FIFO order. A background task must 
+ * overtake waiting normal tasks once it has waited for the aging delay, or once its deadline 
+ * has passed (immediately with the global queue, and within the 64 tasks after which the 
+ * slaves of the other modes look for aged tasks). The program returns a non-zero status if 
+ * any check fails.
+ */
+
+#include "PACC/Threading.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+using namespace PACC;
+
+namespace {
+	
+	//! Task that holds its slave until it is released.
+	class Gate : public Threading::LightTask {
+	 public:
+		Gate(void) : mOpen(false) {}
+		
+		atomic<bool> mOpen; //!< Task may complete.
+		
+		void main(void) {
+			while(!mOpen) Threading::Thread::sleep(0.0002);
+		}
+	};
+	
+	//! Task that records its rank among the tasks started by the slave.
+	class Step : public Threading::LightTask {
+	 public:
+		Step(void) : mCounter(0), mRank(0), mLevel(Threading::ThreadPool::eNormal), mDeadline(0), mIndex(0) {}
+		
+		atomic<unsigned int>* mCounter; //!< Number of started tasks.
+		unsigned int mRank; //!< Rank of the task when it started.
+		Threading::ThreadPool::Priority mLevel; //!< Priority level of the task.
+		double mDeadline; //!< Deadline of the task (none if null).
+		unsigned int mIndex; //!< Index of the task in push order.
+		
+		void main(void) {mRank = (*mCounter)++;}
+		
+		//! Return whether this task should start before task \c inStep.
+		bool operator<(const Step& inStep) const {
+			if(mLevel != inStep.mLevel) return mLevel < inStep.mLevel;
+			if((mDeadline > 0) != (inStep.mDeadline > 0)) return mDeadline > 0;
+			if(mDeadline > 0 && mDeadline != inStep.mDeadline) return mDeadline < inStep.mDeadline;
+			return mIndex < inStep.mIndex;
+		}
+	};
+	
+	//! Hold the slave of \c ioPool with \c ioGate, and wait until the gate runs.
+	void hold(Threading::ThreadPool& ioPool, Gate& ioGate)
+	{
+		ioGate.mOpen = false;
+		ioPool.push(ioGate);
+		while(!ioGate.isRunning()) Threading::Thread::sleep(0.0002);
+	}
+	
+	//! Push \c inCount normal tasks behind background task \c ioLate, which must overtake them after \c inWait seconds; return the number of failed checks.
+	unsigned int checkAging(Threading::ThreadPool& ioPool, Threading::ThreadPool::Mode inMode, double inDeadline, double inWait, unsigned int inCount)
+	{
+		atomic<unsigned int> lCounter(0);
+		Gate lGate;
+		hold(ioPool, lGate);
+		Step lLate;
+		lLate.mCounter = &lCounter;
+		ioPool.push(lLate, Threading::ThreadPool::eBackground, inDeadline);
+		vector<Step> lSteps(inCount);
+		for(unsigned int i = 0; i < inCount; ++i) {
+			lSteps[i].mCounter = &lCounter;
+			ioPool.push(lSteps[i]);
+		}
+		Threading::Thread::sleep(inWait);
+		lGate.mOpen = true;
+		lLate.wait();
+		for(unsigned int i = 0; i < inCount; ++i) lSteps[i].wait();
+		const unsigned int lLimit = inMode == Threading::ThreadPool::eGlobalQueue ? 0 : 64;
+		return lLate.mRank > lLimit ? 1 : 0;
+	}
+	
+	//! Run \c inRounds rounds of \c inTasks prioritized tasks in a pool using mode \c inMode, and return the number of failed checks.
+	unsigned int stress(const char* inName, Threading::ThreadPool::Mode inMode, unsigned int inTasks, unsigned int inRounds)
+	{
+		unsigned int lErrors = 0;
+		Threading::ThreadPool lPool(1, inMode, 256);
+		unsigned long long lSeed = 88172645463325252ULL;
+		for(unsigned int lRound = 0; lRound < inRounds; ++lRound) {
+			// background tasks do not age during a round
+			lPool.setAging(10);
+			atomic<unsigned int> lCounter(0);
+			Gate lGate;
+			hold(lPool, lGate);
+			vector<Step> lSteps(inTasks);
+			unsigned int lDepth[3] = {0, 0, 0};
+			for(unsigned int i = 0; i < inTasks; ++i) {
+				lSeed ^= lSeed << 13; lSeed ^= lSeed >> 7; lSeed ^= lSeed << 17;
+				Step& lStep = lSteps[i];
+				lStep.mCounter = &lCounter;
+				lStep.mIndex = i;
+				lStep.mLevel = (Threading::ThreadPool::Priority) (lSeed % 3);
+				// one task out of two has a deadline, far enough not to pass during the round; deadlines are 
+				// relative to the push, so that they must differ by much more than the duration of the pushes
+				lStep.mDeadline = (lSeed >> 8) % 2 ? 5 + ((lSeed >> 16) % 50)*0.1 : 0;
+				++lDepth[lStep.mLevel];
+				lPool.push(lStep, lStep.mLevel, lStep.mDeadline);
+			}
+			for(unsigned int i = 0; i < 3; ++i) {
+				if(lPool.getDepth((Threading::ThreadPool::Priority) i) != lDepth[i]) ++lErrors;
+			}
+			lGate.mOpen = true;
+			for(unsigned int i = 0; i < inTasks; ++i) lSteps[i].wait();
+			// equal relative deadlines start in FIFO order
+			vector<Step*> lExpected;
+			for(unsigned int i = 0; i < inTasks; ++i) lExpected.push_back(&lSteps[i]);
+			stable_sort(lExpected.begin(), lExpected.end(), [](const Step* inA, const Step* inB) {return *inA < *inB;});
+			for(unsigned int i = 0; i < inTasks; ++i) {
+				if(lExpected[i]->mRank != i) ++lErrors;
+			}
+			for(unsigned int i = 0; i < 3; ++i) {
+				if(lPool.getDepth((Threading::ThreadPool::Priority) i) != 0) ++lErrors;
+			}
+		}
+		// aging, and background deadlines that have passed
+		lPool.setAging(0.02);
+		lErrors += checkAging(lPool, inMode, 0, 0.05, 200);
+		lPool.setAging(10);
+		lErrors += checkAging(lPool, inMode, 0.02, 0.05, 200);
+		// without aging, the background task waits for all normal tasks
+		unsigned int lStarved = checkAging(lPool, inMode, 0, 0.05, 200);
+		if(lStarved != 1) ++lErrors;
+		cout << inName << ": " << inRounds*inTasks << " tasks, " << lErrors << " errors" << endl;
+		return lErrors;
+	}
+	
+}
+
+int main(int argc, char** argv)
+{
+	const unsigned int lTasks = (argc > 1) ? atoi(argv[1]) : 600;
+	const unsigned int lRounds = (argc > 2) ? atoi(argv[2]) : 20;
+	unsigned int lErrors = 0;
+	lErrors += stress("global queue", Threading::ThreadPool::eGlobalQueue, lTasks, lRounds);
+	lErrors += stress("work stealing", Threading::ThreadPool::eWorkStealing, lTasks, lRounds);
+	lErrors += stress("lock-free queue", Threading::ThreadPool::eLockFreeQueue, lTasks, lRounds);
+	cout << (lErrors == 0 ? "PASSED" : "FAILED") << endl;
+	return lErrors == 0 ? 0 : 1;
+}
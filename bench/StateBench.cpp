@@ -0,0 +1,108 @@
+/*
+ *  Portable Agile C++ Classes (PACC)
+ *  Copyright (C) 2001-2003 by Marc Parizeau
+ *  http://manitou.gel.ulaval.ca/~parizeau/PACC
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *  Contact:
+ *  Laboratoire de Vision et Systemes Numeriques
+ *  Departement de genie electrique et de genie informatique
+ *  Universite Laval, Quebec, Canada, G1K 7P4
+ *  http://vision.gel.ulaval.ca
+ *
+ */
+
+/*!
+ * \file bench/StateBench.cpp
+ * \brief Benchmark of the text and binary state snapshots of the random number generators.
+ * \author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+ */
+
+#include "PACC/Util/Randomizer.hpp"
+#include "PACC/Util/Timer.hpp"
+#include "PACC/Math/QRandSequencer.hpp"
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace PACC;
+
+namespace {
+	
+	//! Timing of a text and binary save/load round trip.
+	struct Timing {
+		double mText;   //!< Mean time of a text round trip (seconds).
+		double mBinary; //!< Mean time of a binary round trip (seconds).
+		unsigned int mTextSize;   //!< Size of the text state (bytes).
+		unsigned int mBinarySize; //!< Size of the binary state (bytes).
+	};
+	
+	//! Time \c inRepeats text and binary state round trips of generator \c ioGenerator.
+	template <class T>
+	Timing measure(T& ioGenerator, unsigned int inRepeats)
+	{
+		Timing lTiming;
+		std::string lText = ioGenerator.getState();
+		lTiming.mTextSize = lText.size();
+		Timer lTimer;
+		for(unsigned int i=0; i<inRepeats; ++i) {
+			lText = ioGenerator.getState();
+			ioGenerator.setState(lText);
+		}
+		lTiming.mText = lTimer.getValue() / inRepeats;
+		
+		std::vector<unsigned char> lBuffer(ioGenerator.getBinaryStateSize());
+		lTiming.mBinarySize = lBuffer.size();
+		lTimer.reset();
+		for(unsigned int i=0; i<inRepeats; ++i) {
+			ioGenerator.saveState(&lBuffer[0]);
+			ioGenerator.loadState(&lBuffer[0]);
+		}
+		lTiming.mBinary = lTimer.getValue() / inRepeats;
+		
+		// check that both formats restore the same state
+		if(ioGenerator.getState() != lText) {
+			cerr << "error: binary state round trip does not match text state!" << endl;
+			exit(1);
+		}
+		return lTiming;
+	}
+	
+	//! Print timing \c inTiming of generator named \c inName.
+	void print(const char* inName, const Timing& inTiming)
+	{
+		cout << inName << ":" << endl;
+		cout << "  text:   " << inTiming.mText*1e6 << " us (" << inTiming.mTextSize << " bytes)" << endl;
+		cout << "  binary: " << inTiming.mBinary*1e6 << " us (" << inTiming.mBinarySize << " bytes)" << endl;
+		cout << "  speedup: " << inTiming.mText/inTiming.mBinary << "x" << endl;
+	}
+	
+}
+
+int main(int argc, char** argv)
+{
+	const unsigned int lRepeats = (argc > 1) ? atoi(argv[1]) : 1000;
+	
+	Randomizer lRandomizer(12345);
+	print("Randomizer", measure(lRandomizer, lRepeats));
+	
+	QRandSequencer lSequencer(100, lRandomizer);
+	print("QRandSequencer (dimensionality 100)", measure(lSequencer, lRepeats));
+	return 0;
+}
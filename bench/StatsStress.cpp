@@ -0,0 +1,354 @@
+/*
+ *  Portable Agile C++ Classes (PACC)
+ *  Copyright (C) 2001-2003 by Marc Parizeau
+ *  http://manitou.gel.ulaval.ca/~parizeau/PACC
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *  Contact:
+ *  Laboratoire de Vision et Systemes Numeriques
+ *  Departement de genie electrique et de genie informatique
+ *  Universite Laval, Quebec, Canada, G1K 7P4
+ *  http://vision.gel.ulaval.ca
+ *
+ */
+
+/*!
+ * \file bench/StatsStress.cpp
+ * \brief Stress test of the statistics and latency histograms of the thread pool.
+ * \author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+ *
+ * Usage:
+ * \verbatim
+ pacc-stress-stats [TASKS] [VALUES]
+ \endverbatim
+ * A Histogram is first filled with VALUES (default 200000) known values spread over the 64 
+ * bits range: its count, sum and maximum must be exact, its buckets must partition the 
+ * values, its percentiles must never underestimate the exact ones nor exceed them by more 
+ * than the 12.5% width of a bucket, and the merge of two halves must equal the whole. Then, 
+ * for each scheduling mode of ThreadPool, TASKS short tasks (default 20000) are pushed one by 
+ * one and in batches, with a few sleeping tasks and a few tasks held behind busy slaves, 
+ * while snapshots are taken concurrently. Once the pool is drained, ThreadPool::getStats 
+ * must count every task, both in total and over the slaves, in the queue latency and run 
+ * time histograms, whose percentiles must reflect the sleeps and the held tasks; no task may 
+ * remain queued, and tasks run with ThreadPool::setTiming disabled must be counted without 
+ * being timed. The text and JSON dumps must hold the counters, and the JSON dump must be well 
+ * formed. The program returns a non-zero status if any check fails.
+ */
+
+#include "PACC/Threading.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace PACC;
+
+namespace {
+	
+	//! Task that counts its runs, and sleeps for a given duration.
+	class Probe : public Threading::LightTask {
+	 public:
+		Probe(void) : mSleep(0) {}
+		
+		static atomic<unsigned int> smRuns; //!< Number of runs of all probes.
+		double mSleep; //!< Duration of a run (seconds).
+		
+		void main(void) {
+			if(mSleep > 0) Threading::Thread::sleep(mSleep);
+			++smRuns;
+		}
+	};
+	
+	atomic<unsigned int> Probe::smRuns(0);
+	
+	//! Task that holds its slave until it is released.
+	class Gate : public Threading::LightTask {
+	 public:
+		Gate(void) : mStarted(false), mOpen(false) {}
+		
+		atomic<bool> mStarted; //!< Task has started.
+		atomic<bool> mOpen; //!< Task may complete.
+		
+		void main(void) {
+			mStarted = true;
+			while(!mOpen) Threading::Thread::sleep(0.0002);
+		}
+	};
+	
+	//! Parser that checks that a string is a single well formed JSON value.
+	class JSONChecker {
+	 public:
+		JSONChecker(const string& inText) : mText(inText), mPos(0) {}
+		
+		//! Return whether the whole text is a single JSON value.
+		bool check(void) {
+			if(!parseValue()) return false;
+			skipSpaces();
+			return mPos == mText.size();
+		}
+		
+	 protected:
+		const string& mText; //!< Text to check.
+		size_t mPos; //!< Current position in text.
+		
+		//! Skip white spaces, and return whether the text continues.
+		bool skipSpaces(void) {
+			while(mPos < mText.size() && isspace((unsigned char) mText[mPos])) ++mPos;
+			return mPos < mText.size();
+		}
+		
+		//! Parse the separated elements of an array or object, up to character \c inEnd.
+		bool parseElements(char inEnd, bool inObject) {
+			++mPos;
+			if(!skipSpaces()) return false;
+			if(mText[mPos] == inEnd) {++mPos; return true;}
+			while(true) {
+				if(inObject) {
+					if(!skipSpaces() || mText[mPos] != '"' || !parseString() || !skipSpaces() || mText[mPos++] != ':') return false;
+				}
+				if(!parseValue() || !skipSpaces()) return false;
+				const char lNext = mText[mPos++];
+				if(lNext == inEnd) return true;
+				if(lNext != ',') return false;
+			}
+		}
+		
+		//! Parse a number (no nan nor inf).
+		bool parseNumber(void) {
+			const char* lStart = mText.c_str()+mPos;
+			if(*lStart != '-' && !isdigit((unsigned char) *lStart)) return false;
+			char* lEnd = 0;
+			strtod(lStart, &lEnd);
+			if(lEnd == lStart) return false;
+			mPos += lEnd-lStart;
+			return true;
+		}
+		
+		//! Parse a string without escapes.
+		bool parseString(void) {
+			const size_t lEnd = mText.find('"', mPos+1);
+			if(lEnd == string::npos || mText.find('\\', mPos+1) < lEnd) return false;
+			mPos = lEnd+1;
+			return true;
+		}
+		
+		//! Parse any value.
+		bool parseValue(void) {
+			if(!skipSpaces()) return false;
+			switch(mText[mPos]) {
+				case '{': return parseElements('}', true);
+				case '[': return parseElements(']', false);
+				case '"': return parseString();
+				case 't': return parseWord("true");
+				case 'f': return parseWord("false");
+				case 'n': return parseWord("null");
+				default: return parseNumber();
+			}
+		}
+		
+		//! Parse literal \c inWord.
+		bool parseWord(const char* inWord) {
+			const string lWord(inWord);
+			if(mText.compare(mPos, lWord.size(), lWord) != 0) return false;
+			mPos += lWord.size();
+			return true;
+		}
+	};
+	
+	//! Return whether the percentiles of histogram \c inHistogram never decrease, and end with its maximum.
+	bool isMonotonic(const Threading::Histogram& inHistogram)
+	{
+		unsigned long long lPrevious = 0;
+		for(unsigned int i = 0; i <= 1000; ++i) {
+			const unsigned long long lValue = inHistogram.getPercentile(i*0.001);
+			if(lValue < lPrevious) return false;
+			lPrevious = lValue;
+		}
+		return lPrevious == inHistogram.getMax();
+	}
+	
+	//! Check a histogram of \c inValues known values, and return the number of failed checks.
+	unsigned int stressHistogram(unsigned int inValues)
+	{
+		unsigned int lErrors = 0;
+		// every bucket must hold its own bounds
+		for(unsigned int i = 0; i < Threading::Histogram::eBuckets; ++i) {
+			const unsigned long long lLower = Threading::Histogram::getLowerBound(i);
+			if(Threading::Histogram::getBucket(lLower) != i) ++lErrors;
+			if(i+1 < Threading::Histogram::eBuckets && Threading::Histogram::getBucket(Threading::Histogram::getLowerBound(i+1)-1) != i) ++lErrors;
+		}
+		if(Threading::Histogram::getBucket(~0ULL) != Threading::Histogram::eBuckets-1) ++lErrors;
+		// values of all magnitudes, in a pseudo-random order
+		vector<unsigned long long> lValues(inValues);
+		unsigned long long lSeed = 88172645463325252ULL, lSum = 0, lMax = 0;
+		for(unsigned int i = 0; i < inValues; ++i) {
+			lSeed ^= lSeed << 13;
+			lSeed ^= lSeed >> 7;
+			lSeed ^= lSeed << 17;
+			lValues[i] = lSeed >> (lSeed % 64);
+			lSum += lValues[i];
+			if(lValues[i] > lMax) lMax = lValues[i];
+		}
+		Threading::Histogram lWhole, lFirst, lSecond;
+		for(unsigned int i = 0; i < inValues; ++i) {
+			lWhole.add(lValues[i]);
+			(i % 2 ? lSecond : lFirst).add(lValues[i]);
+		}
+		unsigned long long lBuckets = 0;
+		for(unsigned int i = 0; i < Threading::Histogram::eBuckets; ++i) lBuckets += lWhole.getCount(i);
+		if(lWhole.getCount() != inValues || lBuckets != inValues || lWhole.getSum() != lSum || lWhole.getMax() != lMax) ++lErrors;
+		if(!isMonotonic(lWhole)) ++lErrors;
+		// percentiles against the exact ones
+		vector<unsigned long long> lSorted(lValues);
+		sort(lSorted.begin(), lSorted.end());
+		const double lFractions[] = {0.001, 0.1, 0.5, 0.9, 0.99, 0.999, 1};
+		for(unsigned int i = 0; i < sizeof(lFractions)/sizeof(double); ++i) {
+			const unsigned long long lExact = lSorted[(size_t) ceil(lFractions[i]*inValues)-1];
+			const unsigned long long lValue = lWhole.getPercentile(lFractions[i]);
+			if(lValue < lExact || (lValue-lExact) > lExact/8 + 1) ++lErrors;
+		}
+		// merge, copy and reset
+		lFirst.merge(lSecond);
+		Threading::Histogram lCopy(lFirst);
+		for(unsigned int i = 0; i < Threading::Histogram::eBuckets; ++i) {
+			if(lFirst.getCount(i) != lWhole.getCount(i) || lCopy.getCount(i) != lWhole.getCount(i)) ++lErrors;
+		}
+		if(lCopy.getCount() != lWhole.getCount() || lCopy.getSum() != lWhole.getSum() || lCopy.getMax() != lWhole.getMax()) ++lErrors;
+		lCopy.reset();
+		if(lCopy.getCount() != 0 || lCopy.getSum() != 0 || lCopy.getMax() != 0 || lCopy.getPercentile(0.5) != 0 || lCopy.getMean() != 0) ++lErrors;
+		cout << "histogram: " << inValues << " values, " << lErrors << " errors" << endl;
+		return lErrors;
+	}
+	
+	//! Wait until the tasks of pool \c inPool are all completed, and return its statistics.
+	Threading::ThreadPool::Stats drain(const Threading::ThreadPool& inPool)
+	{
+		Threading::ThreadPool::Stats lStats = inPool.getStats();
+		for(unsigned int i = 0; lStats.mQueued != 0 && i < 100000; ++i) {
+			Threading::Thread::sleep(0.0001);
+			lStats = inPool.getStats();
+		}
+		return lStats;
+	}
+	
+	//! Return the number of occurrences of string \c inPattern in string \c inText.
+	unsigned int countOccurrences(const string& inText, const string& inPattern)
+	{
+		unsigned int lCount = 0;
+		for(size_t lPos = inText.find(inPattern); lPos != string::npos; lPos = inText.find(inPattern, lPos+1)) ++lCount;
+		return lCount;
+	}
+	
+	//! Run the checks of the statistics of a pool using mode \c inMode, and return the number of failed checks.
+	unsigned int stress(const char* inName, Threading::ThreadPool::Mode inMode, unsigned int inTasks)
+	{
+		const unsigned int lSlaves = 3, lSleeperCount = 20, lHeldCount = 30;
+		const double lSleep = 0.02, lHold = 0.05;
+		unsigned int lErrors = 0;
+		Threading::ThreadPool lPool(lSlaves, inMode);
+		Probe::smRuns = 0;
+		Threading::ThreadPool::Stats lStats = lPool.getStats();
+		if(lStats.mCompleted != 0 || lStats.mQueued != 0 || lStats.mLatency.getCount() != 0 || lStats.mRunTime.getCount() != 0) ++lErrors;
+		if(lStats.mMaxSlaves != lSlaves || lStats.mSlaves.size() != lSlaves) ++lErrors;
+		// short tasks, half of them in batches, and sleeping tasks, while snapshots are taken
+		vector<Probe> lShort(inTasks), lSleepers(lSleeperCount);
+		vector<Threading::LightTask*> lBatch;
+		unsigned long long lLast = 0;
+		for(unsigned int i = 0; i < inTasks; ++i) {
+			if(i % 2 == 0) lPool.push(lShort[i]);
+			else lBatch.push_back(&lShort[i]);
+			if(lBatch.size() == 16 || i+1 == inTasks) {
+				lPool.pushBatch(&lBatch[0], lBatch.size());
+				lBatch.clear();
+			}
+			if(i % (inTasks/lSleeperCount) == 0 && i/(inTasks/lSleeperCount) < lSleeperCount) {
+				Probe& lSleeper = lSleepers[i/(inTasks/lSleeperCount)];
+				lSleeper.mSleep = lSleep;
+				lPool.push(lSleeper);
+			}
+			if(i % 256 == 0) {
+				// snapshots never go back, nor count tasks that were not pushed
+				lStats = lPool.getStats();
+				if(lStats.mCompleted < lLast || lStats.mCompleted > i+1+lSleeperCount) ++lErrors;
+				lLast = lStats.mCompleted;
+			}
+		}
+		// tasks held behind busy slaves
+		vector<Gate> lGates(lSlaves);
+		for(unsigned int i = 0; i < lSlaves; ++i) lPool.push(lGates[i]);
+		for(unsigned int i = 0; i < lSlaves; ++i) {
+			while(!lGates[i].mStarted) Threading::Thread::sleep(0.0002);
+		}
+		vector<Probe> lHeld(lHeldCount);
+		for(unsigned int i = 0; i < lHeld.size(); ++i) lPool.push(lHeld[i]);
+		Threading::Thread::sleep(lHold);
+		for(unsigned int i = 0; i < lSlaves; ++i) lGates[i].mOpen = true;
+		lStats = drain(lPool);
+		const unsigned int lTotal = inTasks + lSleeperCount + lSlaves + lHeld.size();
+		// counters
+		unsigned long long lCompleted = 0;
+		for(unsigned int i = 0; i < lStats.mSlaves.size(); ++i) lCompleted += lStats.mSlaves[i].mCompleted;
+		if(lStats.mCompleted != lTotal || lCompleted != lTotal || Probe::smRuns != inTasks + lSleeperCount + lHeld.size()) ++lErrors;
+		if(lStats.mQueued != 0 || lStats.mDepth[0] != 0 || lStats.mDepth[1] != 0 || lStats.mDepth[2] != 0 || lStats.mRunning != lSlaves) ++lErrors;
+		if(lStats.mBusy > lStats.mAlive + 1e-6 || lStats.getUtilization() < 0 || lStats.getUtilization() > 1 + 1e-6) ++lErrors;
+		// histograms: every task is timed, the sleepers run for at least their sleep, and the held tasks wait for at least the hold
+		if(lStats.mLatency.getCount() != lTotal || lStats.mRunTime.getCount() != lTotal) ++lErrors;
+		if(!isMonotonic(lStats.mLatency) || !isMonotonic(lStats.mRunTime)) ++lErrors;
+		if(lStats.mRunTime.getSum() < (unsigned long long) (lSleeperCount*lSleep*1e9) + (unsigned long long) (lSlaves*lHold*1e9)) ++lErrors;
+		if(lStats.mRunTime.getPercentile((lTotal-lSleeperCount-lSlaves+0.5)/lTotal) < lSleep*1e9) ++lErrors;
+		if(lStats.mRunTime.getPercentile(0.5) >= lSleep*1e9) ++lErrors;
+		if(lStats.mLatency.getPercentile((lTotal-lHeld.size()+0.5)/lTotal) < lHold*1e9) ++lErrors;
+		// tasks run without timing are counted, but not timed
+		lPool.setTiming(false);
+		vector<Probe> lUntimed(1000);
+		for(unsigned int i = 0; i < lUntimed.size(); ++i) lPool.push(lUntimed[i]);
+		Threading::ThreadPool::Stats lUntimedStats = drain(lPool);
+		lPool.setTiming(true);
+		if(lUntimedStats.mCompleted != lTotal + lUntimed.size() || lUntimedStats.mLatency.getCount() != lTotal || lUntimedStats.mRunTime.getCount() != lTotal) ++lErrors;
+		// dumps
+		ostringstream lText, lJSON;
+		lUntimedStats.write(lText);
+		lUntimedStats.writeJSON(lJSON);
+		ostringstream lCompletedText, lCompletedJSON;
+		lCompletedText << "tasks: " << lUntimedStats.mCompleted << " completed";
+		lCompletedJSON << "\"completed\": " << lUntimedStats.mCompleted << ",";
+		if(lText.str().find(lCompletedText.str()) == string::npos || countOccurrences(lText.str(), "  slave ") != lSlaves) ++lErrors;
+		if(!JSONChecker(lJSON.str()).check() || lJSON.str().find(lCompletedJSON.str()) == string::npos || countOccurrences(lJSON.str(), "{\"running\": ") != lSlaves) ++lErrors;
+		cout << inName << ": " << lUntimedStats.mCompleted << " tasks, " << lErrors << " errors" << endl;
+		if(lErrors != 0) cout << lText.str() << lJSON.str() << endl;
+		return lErrors;
+	}
+	
+}
+
+int main(int argc, char** argv)
+{
+	const unsigned int lTasks = (argc > 1) ? atoi(argv[1]) : 20000;
+	const unsigned int lValues = (argc > 2) ? atoi(argv[2]) : 200000;
+	unsigned int lErrors = stressHistogram(lValues);
+	lErrors += stress("global queue", Threading::ThreadPool::eGlobalQueue, lTasks);
+	lErrors += stress("work stealing", Threading::ThreadPool::eWorkStealing, lTasks);
+	lErrors += stress("lock-free queue", Threading::ThreadPool::eLockFreeQueue, lTasks);
+	cout << (lErrors == 0 ? "PASSED" : "FAILED") << endl;
+	return lErrors == 0 ? 0 : 1;
+}
@@ -0,0 +1,205 @@
+/*
+ *  Portable Agile C++ Classes (PACC)
+ *  Copyright (C) 2001-2003 by Marc Parizeau
+ *  http://manitou.gel.ulaval.ca/~parizeau/PACC
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *  Contact:
+ *  Laboratoire de Vision et Systemes Numeriques
+ *  Departement de genie electrique et de genie informatique
+ *  Universite Laval, Quebec, Canada, G1K 7P4
+ *  http://vision.gel.ulaval.ca
+ *
+ */
+/*!
+ * \file bench/TaskStress.cpp
+ * \brief Stress test of the completion of lightweight tasks and of the condition protocol of tasks.
+ * \author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+ *
+ * Usage:
+ * \verbatim
+ pacc-stress-task [WAITERS] [ROUNDS]
+ \endverbatim
+ * For each scheduling mode of ThreadPool, ROUNDS rounds (default 200) push a batch of 
+ * lightweight tasks and a batch of tasks of class Task, while WAITERS threads (default 3) 
+ * are already waiting for them, each in a different order: the waiters use LightTask::wait 
+ * for the lightweight tasks, and the condition protocol of class Task (lock, wait on the 
+ * embedded condition until the task is completed, unlock) for the others. A task must have 
+ * run to its end when a wait returns, and must not be pending anymore. The program then 
+ * waits on the embedded condition of tasks until they start, and deletes tasks of both kinds 
+ * as soon as a wait returns. It returns a non-zero status if any check fails, and hangs if a 
+ * wake up is lost.
+ */
+
+#include "PACC/Threading.hpp"
+#include "PACC/Util/Timer.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+using namespace PACC;
+
+namespace {
+	
+	//! Lightweight task that flags the end of its run.
+	class Probe : public Threading::LightTask {
+	 public:
+		Probe(void) : mDone(false) {}
+		
+		atomic<bool> mDone; //!< Task has run to its end.
+		
+		void main(void) {mDone = true;}
+	};
+	
+	//! %Task that flags the end of its run, after \c mSleep seconds.
+	class Job : public Threading::Task {
+	 public:
+		Job(void) : mDone(false), mSleep(0) {}
+		
+		atomic<bool> mDone; //!< Task has run to its end.
+		double mSleep; //!< Duration of a run (seconds).
+		
+		void main(void) {
+			if(mSleep > 0) Threading::Thread::sleep(mSleep);
+			mDone = true;
+		}
+	};
+	
+	//! Thread that waits for all tasks of a round, starting at task \c mOffset.
+	class Waiter : public Threading::Thread {
+	 public:
+		Waiter(vector<Probe>& inProbes, vector<Job>& inJobs, unsigned int inOffset) : mProbes(inProbes), mJobs(inJobs), mOffset(inOffset), mErrors(0) {}
+		
+		vector<Probe>& mProbes; //!< Lightweight tasks of the round.
+		vector<Job>& mJobs; //!< Tasks of the round.
+		unsigned int mOffset; //!< First task to wait for.
+		unsigned int mErrors; //!< Number of failed checks.
+		
+		void main(void) {
+			for(unsigned int i = 0; i < mProbes.size(); ++i) {
+				Probe& lProbe = mProbes[(i+mOffset) % mProbes.size()];
+				lProbe.wait();
+				if(!lProbe.mDone || !lProbe.isCompleted()) ++mErrors;
+			}
+			for(unsigned int i = 0; i < mJobs.size(); ++i) {
+				Job& lJob = mJobs[(i+mOffset) % mJobs.size()];
+				lJob.lock();
+				while(!lJob.isCompleted()) lJob.wait(false);
+				if(!lJob.mDone) ++mErrors;
+				lJob.unlock();
+			}
+		}
+	};
+	
+	//! Run \c inRounds rounds with \c inWaiters waiting threads in a pool using mode \c inMode, and return the number of failed checks.
+	unsigned int stress(const char* inName, Threading::ThreadPool::Mode inMode, unsigned int inWaiters, unsigned int inRounds)
+	{
+		const unsigned int lCount = 64;
+		vector<Probe> lProbes(lCount);
+		vector<Job> lJobs(lCount);
+		vector<Threading::LightTask*> lProbeBatch;
+		vector<Threading::Task*> lJobBatch;
+		for(unsigned int i = 0; i < lCount; ++i) {
+			lProbeBatch.push_back(&lProbes[i]);
+			lJobBatch.push_back(&lJobs[i]);
+		}
+		unsigned int lErrors = 0;
+		Timer lTimer;
+		{
+			Threading::ThreadPool lPool(4, inMode, 256);
+			for(unsigned int lRound = 0; lRound < inRounds; ++lRound) {
+				// the tasks are marked as queued before the waiters start, so that they do not see the previous round
+				for(unsigned int i = 0; i < lCount; ++i) {
+					lProbes[i].mDone = false;
+					lJobs[i].mDone = false;
+					lProbes[i].reset();
+					lJobs[i].reset();
+				}
+				vector<Waiter*> lWaiters;
+				for(unsigned int i = 0; i < inWaiters; ++i) {
+					lWaiters.push_back(new Waiter(lProbes, lJobs, i*lCount/inWaiters));
+					lWaiters.back()->run();
+				}
+				// the waiters are mostly asleep when the tasks complete
+				Threading::Thread::sleep(0.0005);
+				lPool.pushBatch(&lProbeBatch[0], lCount);
+				lPool.pushBatch(&lJobBatch[0], lCount);
+				for(unsigned int i = 0; i < lWaiters.size(); ++i) {
+					lWaiters[i]->wait();
+					lErrors += lWaiters[i]->mErrors;
+					delete lWaiters[i];
+				}
+				for(unsigned int i = 0; i < lCount; ++i) {
+					if(lProbes[i].isPending() || lJobs[i].isPending() || !lProbes[i].isCompleted() || !lJobs[i].isCompleted()) ++lErrors;
+				}
+			}
+			// wait on the embedded condition for tasks to start
+			for(unsigned int i = 0; i < lCount; ++i) {
+				lJobs[i].mDone = false;
+				lJobs[i].mSleep = 0.0002;
+			}
+			lPool.pushBatch(&lJobBatch[0], lCount);
+			for(unsigned int i = 0; i < lCount; ++i) {
+				lJobs[i].lock();
+				while(!lJobs[i].isRunning() && !lJobs[i].isCompleted()) lJobs[i].Condition::wait();
+				lJobs[i].unlock();
+				lJobs[i].wait();
+				if(!lJobs[i].mDone) ++lErrors;
+			}
+			// tasks deleted as soon as their wait returns
+			for(unsigned int i = 0; i < inRounds*lCount; ++i) {
+				Probe* lProbe = new Probe;
+				Job* lJob = new Job;
+				lPool.push(*lProbe);
+				lPool.push(*lJob);
+				lProbe->wait();
+				if(!lProbe->mDone) ++lErrors;
+				delete lProbe;
+				if(i % 2 == 0) lJob->wait();
+				else {
+					lJob->lock();
+					while(!lJob->isCompleted()) lJob->wait(false);
+					lJob->unlock();
+				}
+				if(!lJob->mDone) ++lErrors;
+				delete lJob;
+			}
+		}
+		const double lTime = lTimer.getValue();
+		cout << inName << ": " << inRounds*lCount*4 << " tasks in " << lTime << " s, " << lErrors << " errors" << endl;
+		return lErrors;
+	}
+	
+}
+
+int main(int argc, char** argv)
+{
+	const unsigned int lWaiters = (argc > 1) ? atoi(argv[1]) : 3;
+	const unsigned int lRounds = (argc > 2) ? atoi(argv[2]) : 200;
+	if(lWaiters == 0) {
+		cerr << "usage: " << argv[0] << " [WAITERS] [ROUNDS]" << endl;
+		return 1;
+	}
+	unsigned int lErrors = 0;
+	lErrors += stress("global queue", Threading::ThreadPool::eGlobalQueue, lWaiters, lRounds);
+	lErrors += stress("work stealing", Threading::ThreadPool::eWorkStealing, lWaiters, lRounds);
+	lErrors += stress("lock-free queue", Threading::ThreadPool::eLockFreeQueue, lWaiters, lRounds);
+	cout << (lErrors == 0 ? "PASSED" : "FAILED") << endl;
+	return lErrors == 0 ? 0 : 1;
+}
@@ -0,0 +1,247 @@
+/*
+ *  Portable Agile C++ Classes (PACC)
+ *  Copyright (C) 2001-2003 by Marc Parizeau
+ *  http://manitou.gel.ulaval.ca/~parizeau/PACC
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *  Contact:
+ *  Laboratoire de Vision et Systemes Numeriques
+ *  Departement de genie electrique et de genie informatique
+ *  Universite Laval, Quebec, Canada, G1K 7P4
+ *  http://vision.gel.ulaval.ca
+ *
+ */
+
+/*!
+ * \file bench/TimerStress.cpp
+ * \brief Stress test of the timer wheel and of the timers of the thread pool.
+ * \author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+ *
+ * Usage:
+ * \verbatim
+ pacc-stress-timers [OPERATIONS]
+ \endverbatim
+ * A TimerWheel is first driven by a simulated clock through OPERATIONS (default 200000) random 
+ * additions, removals and advances, with delays from a millisecond to more than a day, so 
+ * that timers cascade through all the levels that they reach. It is checked against a brute 
+ * force list of timers: no timer may expire early, nor remain after its tick has passed, and 
+ * a periodic timer must skip its missed occurrences. Then, for each scheduling mode of 
+ * ThreadPool, delayed and periodic tasks must never start early, a cancelled timer must 
+ * never run, a periodic task that is not pending after its timer is cancelled must never run 
+ * again, a slow periodic task must never run concurrently with itself, and the pending 
+ * timers of a deleted pool must be cancelled. The program returns a non-zero status if any 
+ * check fails.
+ */
+
+#include "PACC/Threading.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <set>
+#include <vector>
+
+using namespace std;
+using namespace PACC;
+
+namespace {
+	
+	//! Return the current time (seconds of the steady clock).
+	double getTime(void)
+	{
+		return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+	}
+	
+	//! Return the next value of xorshift generator \c ioSeed.
+	unsigned long long next(unsigned long long& ioSeed)
+	{
+		ioSeed ^= ioSeed << 13;
+		ioSeed ^= ioSeed >> 7;
+		ioSeed ^= ioSeed << 17;
+		return ioSeed;
+	}
+	
+	//! Task that records its start time, counts its runs, and the largest number of its concurrent runs.
+	class Probe : public Threading::LightTask {
+	 public:
+		Probe(void) : mStart(0), mRuns(0), mActive(0), mMaxActive(0), mSleep(0) {}
+		
+		double mStart; //!< Start time of the last run (seconds of the steady clock).
+		atomic<unsigned int> mRuns; //!< Number of runs.
+		atomic<unsigned int> mActive; //!< Number of current runs.
+		atomic<unsigned int> mMaxActive; //!< Largest number of concurrent runs.
+		double mSleep; //!< Duration of a run (seconds).
+		
+		void main(void) {
+			mStart = getTime();
+			const unsigned int lActive = ++mActive;
+			if(lActive > mMaxActive) mMaxActive = lActive;
+			if(mSleep > 0) Threading::Thread::sleep(mSleep);
+			--mActive;
+			++mRuns;
+		}
+	};
+	
+	//! Drive a timer wheel through \c inOperations random operations, and return the number of failed checks.
+	unsigned int stressWheel(unsigned int inOperations)
+	{
+		const double lResolution = 0.001;
+		Threading::TimerWheel lWheel(lResolution);
+		vector<Probe> lTasks(20000);
+		map<Threading::TimerWheel::Timer, unsigned int> lTimers; // task of each live timer
+		map<Threading::LightTask*, double> lDue; // expiration time of each waiting task
+		unsigned long long lSeed = 88172645463325252ULL;
+		double lNow = getTime();
+		unsigned int lErrors = 0, lExpired = 0;
+		for(unsigned int i = 0; i < inOperations; ++i) {
+			const unsigned int lOperation = next(lSeed) % 10;
+			if(lOperation < 4) {
+				const unsigned int lTask = next(lSeed) % lTasks.size();
+				if(lDue.count(&lTasks[lTask]) != 0) continue;
+				// mostly short delays, and some delays of up to a day (up to the fifth level)
+				const double lDelay = (next(lSeed) % 4 == 0) ? (next(lSeed) % 100000000) * 1e-3 : (next(lSeed) % 5000) * 1e-3 * (next(lSeed) % 2 ? 1 : 1e-3);
+				lTimers[lWheel.add(lTasks[lTask], lNow+lDelay)] = lTask;
+				lDue[&lTasks[lTask]] = lNow+lDelay;
+			} else if(lOperation < 5 && !lTimers.empty()) {
+				map<Threading::TimerWheel::Timer, unsigned int>::iterator lTimer = lTimers.lower_bound(next(lSeed) % (lTimers.rbegin()->first+1));
+				if(lTimer == lTimers.end()) lTimer = lTimers.begin();
+				if(!lWheel.remove(lTimer->first) || lWheel.remove(lTimer->first)) ++lErrors;
+				lDue.erase(&lTasks[lTimer->second]);
+				lTimers.erase(lTimer);
+			} else {
+				lNow += (next(lSeed) % 3 == 0) ? (next(lSeed) % 100000) * 1e-3 : (next(lSeed) % 50) * 1e-3;
+				vector<Threading::LightTask*> lOut;
+				lWheel.advance(lNow, lOut);
+				set<Threading::LightTask*> lReturned(lOut.begin(), lOut.end());
+				for(unsigned int j = 0; j < lOut.size(); ++j) {
+					// never early, and in order of expiration (within a tick)
+					map<Threading::LightTask*, double>::iterator lTime = lDue.find(lOut[j]);
+					if(lTime == lDue.end() || lTime->second > lNow) ++lErrors;
+					else if(j > 0 && lDue.count(lOut[j-1]) != 0 && lDue[lOut[j-1]] > lTime->second + lResolution) ++lErrors;
+				}
+				for(map<Threading::TimerWheel::Timer, unsigned int>::iterator lTimer = lTimers.begin(); lTimer != lTimers.end();) {
+					Threading::LightTask* lTask = &lTasks[lTimer->second];
+					if(lReturned.count(lTask) != 0) {
+						lDue.erase(lTask);
+						lTimers.erase(lTimer++);
+						++lExpired;
+						continue;
+					}
+					// a timer whose tick has passed must have expired
+					if(lDue[lTask] <= lNow - lResolution) ++lErrors;
+					++lTimer;
+				}
+			}
+			if(lWheel.getSize() != lTimers.size()) ++lErrors;
+		}
+		// periodic timer of 10 ticks, advanced tick by tick for one second, and then late
+		Threading::TimerWheel lPeriodic(lResolution);
+		Probe lTask;
+		const double lStart = getTime();
+		lPeriodic.add(lTask, lStart+0.010, 0.010);
+		unsigned int lCount = 0;
+		for(unsigned int i = 1; i <= 1000; ++i) {
+			vector<Threading::LightTask*> lOut;
+			lPeriodic.advance(lStart+i*lResolution, lOut);
+			lCount += lOut.size();
+		}
+		vector<Threading::LightTask*> lOut;
+		lPeriodic.advance(lStart+10, lOut);
+		// 99 or 100 occurrences, depending on the rounding of the start time, and a single one for the missed occurrences
+		lCount += lOut.size();
+		if(lCount < 100 || lCount > 101 || lPeriodic.getSize() != 1) ++lErrors;
+		cout << "timer wheel: " << lExpired << " timers expired, " << lErrors << " errors" << endl;
+		return lErrors;
+	}
+	
+	//! Run the checks of the timers of a pool using mode \c inMode, and return the number of failed checks.
+	unsigned int stressPool(const char* inName, Threading::ThreadPool::Mode inMode)
+	{
+		unsigned int lErrors = 0;
+		Probe lCancelled, lOrphan;
+		{
+			Threading::ThreadPool lPool(2, inMode);
+			// delayed tasks, one of them cancelled
+			Probe lFirst, lSecond;
+			double lTime = getTime();
+			lPool.schedule(lFirst, 0.05);
+			lPool.schedule(lSecond, 0.02);
+			Threading::ThreadPool::Timer lTimer = lPool.schedule(lCancelled, 0.03);
+			if(!lPool.cancel(lTimer) || lPool.cancel(lTimer)) ++lErrors;
+			lFirst.wait();
+			lSecond.wait();
+			if(lFirst.mStart < lTime+0.05 || lSecond.mStart < lTime+0.02) ++lErrors;
+			// periodic task, cancelled after about 20 occurrences
+			Probe lPeriodic;
+			lTimer = lPool.scheduleAtFixedRate(lPeriodic, 0.01, 0.01);
+			Threading::Thread::sleep(0.205);
+			lPool.cancel(lTimer);
+			lPeriodic.wait();
+			const unsigned int lRuns = lPeriodic.mRuns;
+			Threading::Thread::sleep(0.05);
+			if(lRuns == 0 || lRuns > 21 || lPeriodic.mRuns != lRuns) ++lErrors;
+			// slow periodic task, which must skip its occurrences while it runs
+			Probe lSlow;
+			lSlow.mSleep = 0.025;
+			lTimer = lPool.scheduleAtFixedRate(lSlow, 0, 0.01);
+			Threading::Thread::sleep(0.2);
+			lPool.cancel(lTimer);
+			lSlow.wait();
+			if(lSlow.mRuns == 0 || lSlow.mRuns > 9 || lSlow.mMaxActive != 1) ++lErrors;
+			// a periodic task that is not pending after the cancellation of its timer must never run again
+			Probe lRacing;
+			for(unsigned int i = 0; i < 200; ++i) {
+				lTimer = lPool.scheduleAtFixedRate(lRacing, 0, 0.001);
+				Threading::Thread::sleep(0.001*(i % 4));
+				if(!lPool.cancel(lTimer)) ++lErrors;
+				if(lRacing.isPending()) {
+					lRacing.wait();
+					continue;
+				}
+				const unsigned int lRacingRuns = lRacing.mRuns;
+				Threading::Thread::sleep(0.002);
+				if(lRacing.mRuns != lRacingRuns || lRacing.isPending()) ++lErrors;
+			}
+			// many delayed tasks
+			vector<Probe> lMany(20000);
+			lTime = getTime();
+			for(unsigned int i = 0; i < lMany.size(); ++i) lPool.schedule(lMany[i], 0.001*(i % 200));
+			for(unsigned int i = 0; i < lMany.size(); ++i) {
+				lMany[i].wait();
+				if(lMany[i].mRuns != 1 || lMany[i].mStart < lTime+0.001*(i % 200)) ++lErrors;
+			}
+			// the pool is deleted before this timer expires
+			lPool.schedule(lOrphan, 10);
+		}
+		if(lCancelled.mRuns != 0 || lCancelled.isPending() || lOrphan.mRuns != 0 || lOrphan.isPending()) ++lErrors;
+		cout << inName << ": " << lErrors << " errors" << endl;
+		return lErrors;
+	}
+	
+}
+
+int main(int argc, char** argv)
+{
+	const unsigned int lOperations = (argc > 1) ? atoi(argv[1]) : 200000;
+	unsigned int lErrors = stressWheel(lOperations);
+	lErrors += stressPool("global queue", Threading::ThreadPool::eGlobalQueue);
+	lErrors += stressPool("work stealing", Threading::ThreadPool::eWorkStealing);
+	lErrors += stressPool("lock-free queue", Threading::ThreadPool::eLockFreeQueue);
+	cout << (lErrors == 0 ? "PASSED" : "FAILED") << endl;
+	return lErrors == 0 ? 0 : 1;
+}
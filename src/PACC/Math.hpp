@@ -39,3 +39,5 @@
 #include "PACC/Math/Matrix.hpp"
 #include "PACC/Math/Vector.hpp"
 #include "PACC/Math/QRandSequencer.hpp"
+#include "PACC/Math/NormalTransform.hpp"
+#include "PACC/Math/PCA.hpp"
@@ -37,6 +37,9 @@
 #include "PACC/Math/Matrix.hpp"
 #include "PACC/Math/Vector.hpp"
 #include "PACC/Util/StringFunc.hpp"
+#include "PACC/Util/CPUFeatures.hpp"
+#include "PACC/Util/Parallel.hpp"
+#include <algorithm>
 #include <stdexcept>
 #include <iomanip>
 #include <cmath>
@@ -45,6 +48,163 @@
 using namespace std;
 using namespace PACC;
 
+namespace {
+	
+	//! Number of inner dimension elements in a block of the matrix product.
+	const unsigned int cBlockInner = 128;
+	//! Number of columns in a block of the matrix product.
+	const unsigned int cBlockCols = 256;
+	
+	/*!
+	 \brief Compute the product of the \c inRows x \c inInner row-major matrix \c inLeft with the \c inInner x \c inCols row-major matrix \c inRight into \c outProduct.
+	 
+	 The product is computed by blocks of the right matrix that fit in cache, four rows 
+	 of the left matrix at a time, so that the innermost loop is a contiguous 
+	 multiply-add over the columns that the compiler can vectorize.
+	 */
+	PACC_FORCE_INLINE void multiplyKernel(double* __restrict outProduct, const double* __restrict inLeft, const double* __restrict inRight, unsigned int inRows, unsigned int inInner, unsigned int inCols)
+	{
+		for(unsigned int i = 0; i < inRows*inCols; ++i) outProduct[i] = 0;
+		for(unsigned int kk = 0; kk < inInner; kk += cBlockInner) {
+			const unsigned int lInnerEnd = min(kk+cBlockInner, inInner);
+			for(unsigned int jj = 0; jj < inCols; jj += cBlockCols) {
+				const unsigned int lColsEnd = min(jj+cBlockCols, inCols);
+				unsigned int i = 0;
+				for(; i+4 <= inRows; i += 4) {
+					double* __restrict lC0 = outProduct + i*inCols;
+					double* __restrict lC1 = lC0 + inCols;
+					double* __restrict lC2 = lC1 + inCols;
+					double* __restrict lC3 = lC2 + inCols;
+					const double* lA = inLeft + i*inInner;
+					for(unsigned int k = kk; k < lInnerEnd; ++k) {
+						const double lA0 = lA[k], lA1 = lA[inInner+k], lA2 = lA[2*inInner+k], lA3 = lA[3*inInner+k];
+						const double* __restrict lB = inRight + k*inCols;
+						for(unsigned int j = jj; j < lColsEnd; ++j) {
+							const double lBj = lB[j];
+							lC0[j] += lA0 * lBj;
+							lC1[j] += lA1 * lBj;
+							lC2[j] += lA2 * lBj;
+							lC3[j] += lA3 * lBj;
+						}
+					}
+				}
+				for(; i < inRows; ++i) {
+					double* __restrict lC = outProduct + i*inCols;
+					for(unsigned int k = kk; k < lInnerEnd; ++k) {
+						const double lA = inLeft[i*inInner+k];
+						const double* __restrict lB = inRight + k*inCols;
+						for(unsigned int j = jj; j < lColsEnd; ++j) lC[j] += lA * lB[j];
+					}
+				}
+			}
+		}
+	}
+	
+
+	//! Signature of the matrix product kernels.
+	typedef void (*MultiplyFunction)(double*, const double*, const double*, unsigned int, unsigned int, unsigned int);
+	
+	// clones of the kernel for each instruction set
+	void multiplyGeneric(double* outProduct, const double* inLeft, const double* inRight, unsigned int inRows, unsigned int inInner, unsigned int inCols)
+	{
+		multiplyKernel(outProduct, inLeft, inRight, inRows, inInner, inCols);
+	}
+	
+#ifdef PACC_CPU_DISPATCH_X86
+	PACC_TARGET_AVX2 void multiplyAVX2(double* outProduct, const double* inLeft, const double* inRight, unsigned int inRows, unsigned int inInner, unsigned int inCols)
+	{
+		multiplyKernel(outProduct, inLeft, inRight, inRows, inInner, inCols);
+	}
+	
+	PACC_TARGET_AVX512 void multiplyAVX512(double* outProduct, const double* inLeft, const double* inRight, unsigned int inRows, unsigned int inInner, unsigned int inCols)
+	{
+		multiplyKernel(outProduct, inLeft, inRight, inRows, inInner, inCols);
+	}
+#endif
+	
+	/*!
+	 \brief Compute the matrix product with the kernel selected for the processor (see multiplyKernel).
+	 
+	 Large products are split into chunks of rows (multiples of four) that are computed in parallel.
+	 */
+	void multiplyBlocked(double* outProduct, const double* inLeft, const double* inRight, unsigned int inRows, unsigned int inInner, unsigned int inCols)
+	{
+#ifdef PACC_CPU_DISPATCH_X86
+		static const MultiplyFunction lMultiply = CPUFeatures::select<MultiplyFunction>(multiplyGeneric, 0, multiplyAVX2, multiplyAVX512);
+#else
+		static const MultiplyFunction lMultiply = multiplyGeneric;
+#endif
+		const unsigned long lWork = (unsigned long) inRows * inInner * inCols;
+		const int lChunks = Parallel::getChunkCount(lWork);
+		PACC_PARALLEL_FOR(lWork)
+		for(int c = 0; c < lChunks; ++c) {
+			const unsigned int lBegin = Parallel::getChunkBegin(inRows, c, lChunks) & ~3u;
+			const unsigned int lEnd = (c+1 == lChunks ? inRows : Parallel::getChunkBegin(inRows, c+1, lChunks) & ~3u);
+			if(lBegin < lEnd) lMultiply(outProduct+lBegin*inCols, inLeft+lBegin*inInner, inRight, lEnd-lBegin, inInner, inCols);
+		}
+	}
+	
+	//! Column reductions.
+	enum Reduction {eSum, eSumAbs, eSum2};
+	
+	//! Accumulate into \c outSums the first \c inCols columns of the \c inRows rows (transformed according to \c inReduction) of row-major matrix \c inData with row stride \c inStride.
+	PACC_FORCE_INLINE void reduceColumnsKernel(double* __restrict outSums, const double* __restrict inData, unsigned int inRows, unsigned int inCols, unsigned int inStride, Reduction inReduction)
+	{
+		for(unsigned int i = 0; i < inRows; ++i) {
+			const double* __restrict lRow = inData + i*inStride;
+			switch(inReduction) {
+				case eSum: for(unsigned int j = 0; j < inCols; ++j) outSums[j] += lRow[j]; break;
+				case eSumAbs: for(unsigned int j = 0; j < inCols; ++j) outSums[j] += fabs(lRow[j]); break;
+				case eSum2: for(unsigned int j = 0; j < inCols; ++j) outSums[j] += lRow[j] * lRow[j]; break;
+			}
+		}
+	}
+	
+	//! Signature of the column reduction kernels.
+	typedef void (*ReduceFunction)(double*, const double*, unsigned int, unsigned int, unsigned int, Reduction);
+	
+	// clones of the kernel for each instruction set
+	void reduceColumnsGeneric(double* outSums, const double* inData, unsigned int inRows, unsigned int inCols, unsigned int inStride, Reduction inReduction)
+	{
+		reduceColumnsKernel(outSums, inData, inRows, inCols, inStride, inReduction);
+	}
+	
+#ifdef PACC_CPU_DISPATCH_X86
+	PACC_TARGET_AVX2 void reduceColumnsAVX2(double* outSums, const double* inData, unsigned int inRows, unsigned int inCols, unsigned int inStride, Reduction inReduction)
+	{
+		reduceColumnsKernel(outSums, inData, inRows, inCols, inStride, inReduction);
+	}
+	
+	PACC_TARGET_AVX512 void reduceColumnsAVX512(double* outSums, const double* inData, unsigned int inRows, unsigned int inCols, unsigned int inStride, Reduction inReduction)
+	{
+		reduceColumnsKernel(outSums, inData, inRows, inCols, inStride, inReduction);
+	}
+#endif
+	
+	/*!
+	 \brief Compute a column reduction with the kernel selected for the processor (see reduceColumnsKernel).
+	 
+	 Large reductions are split into chunks of columns that are reduced in parallel.
+	 */
+	void reduceColumns(double* outSums, const double* inData, unsigned int inRows, unsigned int inCols, Reduction inReduction)
+	{
+#ifdef PACC_CPU_DISPATCH_X86
+		static const ReduceFunction lReduce = CPUFeatures::select<ReduceFunction>(reduceColumnsGeneric, 0, reduceColumnsAVX2, reduceColumnsAVX512);
+#else
+		static const ReduceFunction lReduce = reduceColumnsGeneric;
+#endif
+		const unsigned long lWork = (unsigned long) inRows * inCols;
+		const int lChunks = Parallel::getChunkCount(lWork);
+		PACC_PARALLEL_FOR(lWork)
+		for(int c = 0; c < lChunks; ++c) {
+			const unsigned int lBegin = Parallel::getChunkBegin(inCols, c, lChunks);
+			const unsigned int lEnd = Parallel::getChunkBegin(inCols, c+1, lChunks);
+			if(lBegin < lEnd) lReduce(outSums+lBegin, inData+lBegin, inRows, lEnd-lBegin, inCols, inReduction);
+		}
+	}
+
+}
+
 /*! 
 This method also returns a reference to the result.
 */
@@ -52,7 +212,9 @@ Matrix& Matrix::add(Matrix& outMatrix, double inScalar) const
 {
 	PACC_AssertM(mRows > 0 && mCols > 0, "Matrix::add() invalid of empty matrix!");
 	outMatrix.setRowsCols(mRows, mCols);	
-	for(unsigned int i = 0; i < size(); ++i) outMatrix[i] = (*this)[i] + inScalar;
+	const int lSize = size();
+	PACC_PARALLEL_FOR(lSize)
+	for(int i = 0; i < lSize; ++i) outMatrix[i] = (*this)[i] + inScalar;
 	return outMatrix;
 }
 
@@ -64,7 +226,9 @@ Matrix& Matrix::add(Matrix& outMatrix, const Matrix& inMatrix) const
 	PACC_AssertM(mRows > 0 && mCols > 0, "Matrix::add() invalid or empty matrix!");
 	PACC_AssertM(mRows == inMatrix.mRows && mCols == inMatrix.mCols, "Matrix::add() matrix mismatch!");	
 	outMatrix.setRowsCols(mRows, mCols);	
-	for(unsigned int i = 0; i < size(); ++i) outMatrix[i] = (*this)[i] + inMatrix[i];
+	const int lSize = size();
+	PACC_PARALLEL_FOR(lSize)
+	for(int i = 0; i < lSize; ++i) outMatrix[i] = (*this)[i] + inMatrix[i];
 	return outMatrix;
 }
 
@@ -367,7 +531,9 @@ This method also returns a reference to the result.
 Matrix& Matrix::maxRows(Matrix& outMatrix) const
 {
 	extractColumn(outMatrix, 0);
-	for(unsigned int i = 0; i < getRows(); ++i) {
+	const int lRows = mRows;
+	PACC_PARALLEL_FOR((unsigned long) mRows*mCols)
+	for(int i = 0; i < lRows; ++i) {
 		for(unsigned int j = 1; j < getCols(); ++j) {
 			if(outMatrix(i, 0) < (*this)(i,j)) outMatrix(i, 0) = (*this)(i,j);
 		}
@@ -395,7 +561,9 @@ This method also returns a reference to the result.
 Matrix& Matrix::minRows(Matrix& outMatrix) const
 {
 	extractColumn(outMatrix, 0);
-	for(unsigned int i = 0; i < getRows(); ++i) {
+	const int lRows = mRows;
+	PACC_PARALLEL_FOR((unsigned long) mRows*mCols)
+	for(int i = 0; i < lRows; ++i) {
 		for(unsigned int j = 1; j < getCols(); ++j) {
 			if(outMatrix(i, 0) > (*this)(i,j)) outMatrix(i, 0) = (*this)(i,j);
 		}
@@ -410,7 +578,9 @@ Matrix& Matrix::multiply(Matrix& outMatrix, double inScalar) const
 {
 	PACC_AssertM(mRows > 0 && mCols > 0, "Matrix::multiply() invalid or empty matrix!");
 	outMatrix.setRowsCols(mRows, mCols);
-	for(unsigned int i = 0; i < size(); ++i) outMatrix[i] = (*this)[i] * inScalar;
+	const int lSize = size();
+	PACC_PARALLEL_FOR(lSize)
+	for(int i = 0; i < lSize; ++i) outMatrix[i] = (*this)[i] * inScalar;
 	return outMatrix;
 }
 
@@ -423,50 +593,13 @@ Matrix& Matrix::multiply(Matrix& outMatrix, const Matrix& inMatrix) const
 	if(&outMatrix != this && &outMatrix != &inMatrix) {
 		// output matrix is neither left or right matrix (no self assigment)
 		outMatrix.setRowsCols(mRows, inMatrix.mCols);
-		for(unsigned int i = 0; i < outMatrix.mRows; ++i) {
-			for(unsigned int j = 0; j < outMatrix.mCols; ++j) {
-				outMatrix(i,j) = 0;
-				for(unsigned int k = 0; k < mCols; ++k) {
-					outMatrix(i,j) += (*this)(i,k) * inMatrix(k,j);
-				}
-			}
-		}
-	} else if(&outMatrix == this && &outMatrix != &inMatrix) {
-		// use temporary matrix to self assign with left matrix
-		Matrix lMatrix(*this);
-		outMatrix.setRowsCols(mRows, inMatrix.mCols);
-		for(unsigned int i = 0; i < outMatrix.mRows; ++i) {
-			for(unsigned int j = 0; j < outMatrix.mCols; ++j) {
-				outMatrix(i,j) = 0;
-				for(unsigned int k = 0; k < mCols; ++k) {
-					outMatrix(i,j) += lMatrix(i,k) * inMatrix(k,j);
-				}
-			}
-		}
-	} else if(&outMatrix != this && &outMatrix == &inMatrix) {
-		// use temporary matrix to self assign with right matrix
-		Matrix lMatrix(inMatrix);
-		outMatrix.setRowsCols(mRows, inMatrix.mCols);
-		for(unsigned int i = 0; i < outMatrix.mRows; ++i) {
-			for(unsigned int j = 0; j < outMatrix.mCols; ++j) {
-				outMatrix(i,j) = 0;
-				for(unsigned int k = 0; k < mCols; ++k) {
-					outMatrix(i,j) += (*this)(i,k) * lMatrix(k,j);
-				}
-			}
-		}
+		multiplyBlocked(outMatrix.data(), data(), inMatrix.data(), mRows, mCols, inMatrix.mCols);
 	} else {
-		// use temporary matrix to self assign with both left and right matrices
-		Matrix lMatrix(*this);
+		// use temporary matrix to self assign with left and/or right matrices
+		Matrix lMatrix(mRows, inMatrix.mCols);
+		multiplyBlocked(lMatrix.data(), data(), inMatrix.data(), mRows, mCols, inMatrix.mCols);
 		outMatrix.setRowsCols(mRows, inMatrix.mCols);
-		for(unsigned int i = 0; i < outMatrix.mRows; ++i) {
-			for(unsigned int j = 0; j < outMatrix.mCols; ++j) {
-				outMatrix(i,j) = 0;
-				for(unsigned int k = 0; k < mCols; ++k) {
-					outMatrix(i,j) += lMatrix(i,k) * lMatrix(k,j);
-				}
-			}
-		}
+		outMatrix.vector<double>::swap(lMatrix);
 	}
 	return outMatrix;
 }
@@ -616,14 +749,26 @@ This method enumerates matrix elements matrix elements in row order, with row
  */
 string Matrix::serialize(void) const
 {
-	ostringstream lContent;
-	lContent.precision(mPrec);
-	for(unsigned int i = 0; i < size(); ++i) {
-		if(i != 0 && i % mCols == 0) lContent << ";";
-		else if(i != 0) lContent << ",";
-		lContent << (*this)[i];
+	// large matrices are formatted by chunks in parallel, then concatenated
+	const unsigned int lSize = size();
+	const int lChunks = Parallel::getChunkCount(lSize);
+	vector<string> lContents(lChunks);
+	PACC_PARALLEL_FOR(lSize)
+	for(int c = 0; c < lChunks; ++c) {
+		ostringstream lContent;
+		lContent.precision(mPrec);
+		const unsigned int lEnd = Parallel::getChunkBegin(lSize, c+1, lChunks);
+		for(unsigned int i = Parallel::getChunkBegin(lSize, c, lChunks); i < lEnd; ++i) {
+			if(i != 0 && i % mCols == 0) lContent << ";";
+			else if(i != 0) lContent << ",";
+			lContent << (*this)[i];
+		}
+		lContents[c] = lContent.str();
 	}
-	return lContent.str();
+	if(lChunks == 1) return lContents[0];
+	string lResult;
+	for(int c = 0; c < lChunks; ++c) lResult += lContents[c];
+	return lResult;
 }
 
 /*!
@@ -645,7 +790,9 @@ Matrix& Matrix::subtract(Matrix& outMatrix, double inScalar) const
 {
 	PACC_AssertM(mRows > 0 && mCols > 0, "Matrix::subtract() invalid or empty matrix!");
 	outMatrix.setRowsCols(mRows, mCols);
-	for(unsigned int i = 0; i < size(); ++i) outMatrix[i] = (*this)[i] - inScalar;
+	const int lSize = size();
+	PACC_PARALLEL_FOR(lSize)
+	for(int i = 0; i < lSize; ++i) outMatrix[i] = (*this)[i] - inScalar;
 	return outMatrix;
 }
 
@@ -657,7 +804,9 @@ Matrix& Matrix::subtract(Matrix& outMatrix, const Matrix& inMatrix) const
 	PACC_AssertM(mRows > 0 && mCols > 0, "Matrix::subtract() invalid or empty matrix!");
 	PACC_AssertM(mRows == inMatrix.mRows && mCols == inMatrix.mCols, "Matrix::subtract() matrix mismatch!");
 	outMatrix.setRowsCols(mRows, mCols);
-	for(unsigned int i = 0; i < size(); ++i) outMatrix[i] = (*this)[i] - inMatrix[i];
+	const int lSize = size();
+	PACC_PARALLEL_FOR(lSize)
+	for(int i = 0; i < lSize; ++i) outMatrix[i] = (*this)[i] - inMatrix[i];
 	return outMatrix;
 }
 
@@ -667,11 +816,7 @@ This method also returns a reference to the result.
 Matrix& Matrix::sumAbsColumns(Matrix& outMatrix) const
 {
 	outMatrix = Matrix(1, getCols(), 0);
-	for(unsigned int i = 0; i < getRows(); ++i) {
-		for(unsigned int j = 0; j < getCols(); ++j) {
-			outMatrix(0, j) += fabs((*this)(i,j));
-		}
-	}
+	if(mCols > 0) reduceColumns(outMatrix.data(), data(), mRows, mCols, eSumAbs);
 	return outMatrix;
 }
 
@@ -681,7 +826,9 @@ This method also returns a reference to the result.
 Matrix& Matrix::sumAbsRows(Matrix& outMatrix) const
 {
 	outMatrix = Matrix(getRows(), 1, 0);
-	for(unsigned int i = 0; i < getRows(); ++i) {
+	const int lRows = mRows;
+	PACC_PARALLEL_FOR((unsigned long) mRows*mCols)
+	for(int i = 0; i < lRows; ++i) {
 		for(unsigned int j = 0; j < getCols(); ++j) {
 			outMatrix(i, 0) += fabs((*this)(i,j));
 		}
@@ -695,11 +842,7 @@ This method also returns a reference to the result.
 Matrix& Matrix::sumColumns(Matrix& outMatrix) const
 {
 	outMatrix = Matrix(1, getCols(), 0);
-	for(unsigned int i = 0; i < getRows(); ++i) {
-		for(unsigned int j = 0; j < getCols(); ++j) {
-			outMatrix(0, j) += (*this)(i,j);
-		}
-	}
+	if(mCols > 0) reduceColumns(outMatrix.data(), data(), mRows, mCols, eSum);
 	return outMatrix;
 }
 
@@ -709,11 +852,7 @@ This method also returns a reference to the result.
 Matrix& Matrix::sum2Columns(Matrix& outMatrix) const
 {
 	outMatrix = Matrix(1, getCols(), 0);
-	for(unsigned int i = 0; i < getRows(); ++i) {
-		for(unsigned int j = 0; j < getCols(); ++j) {
-			outMatrix(0, j) += (*this)(i,j) * (*this)(i,j);
-		}
-	}
+	if(mCols > 0) reduceColumns(outMatrix.data(), data(), mRows, mCols, eSum2);
 	return outMatrix;
 }
 
@@ -723,7 +862,9 @@ This method also returns a reference to the result.
 Matrix& Matrix::sumRows(Matrix& outMatrix) const
 {
 	outMatrix = Matrix(getRows(), 1, 0);
-	for(unsigned int i = 0; i < getRows(); ++i) {
+	const int lRows = mRows;
+	PACC_PARALLEL_FOR((unsigned long) mRows*mCols)
+	for(int i = 0; i < lRows; ++i) {
 		for(unsigned int j = 0; j < getCols(); ++j) {
 			outMatrix(i, 0) += (*this)(i,j);
 		}
@@ -737,7 +878,9 @@ This method also returns a reference to the result.
 Matrix& Matrix::sum2Rows(Matrix& outMatrix) const
 {
 	outMatrix = Matrix(getRows(), 1, 0);
-	for(unsigned int i = 0; i < getRows(); ++i) {
+	const int lRows = mRows;
+	PACC_PARALLEL_FOR((unsigned long) mRows*mCols)
+	for(int i = 0; i < lRows; ++i) {
 		for(unsigned int j = 0; j < getCols(); ++j) {
 			outMatrix(i, 0) += (*this)(i,j) * (*this)(i,j);
 		}
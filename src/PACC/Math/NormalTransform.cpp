@@ -0,0 +1,260 @@
+/*
+ *  Portable Agile C++ Classes (PACC)
+ *  Copyright (C) 2001-2003 by Marc Parizeau
+ *  http://manitou.gel.ulaval.ca/~parizeau/PACC
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *  Contact:
+ *  Laboratoire de Vision et Systemes Numeriques
+ *  Departement de genie electrique et de genie informatique
+ *  Universite Laval, Quebec, Canada, G1K 7P4
+ *  http://vision.gel.ulaval.ca
+ *
+ */
+
+/*!
+ * \file   PACC/Math/NormalTransform.cpp
+ * \brief  Method definitions for class NormalTransform.
+ * \author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+ */
+
+#include "PACC/Math/NormalTransform.hpp"
+#include "PACC/Math/Vector.hpp"
+#include "PACC/Util/Assert.hpp"
+#include "PACC/Util/CPUFeatures.hpp"
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+using namespace std;
+using namespace PACC;
+
+namespace {
+	
+	//! Number of values processed per block by the inverse cumulative distribution.
+	const unsigned int cBlockSize = 64;
+	
+	/*! \brief Return the natural logarithm of positive (normal) number \c inX.
+	
+	The argument is split into a mantissa m in [sqrt(1/2),sqrt(2)[ and a binary exponent e. 
+	The logarithm of the mantissa is then computed as 2*atanh(s), with s=(m-1)/(m+1), using 
+	its Taylor series (|s| < 0.1716 so that 12 terms are enough for double precision).
+	*/
+	PACC_FORCE_INLINE double computeLog(double inX)
+	{
+		const unsigned long long cSqrtHalfBits = 0x3fe6a09e667f3bcdULL;
+		unsigned long long lBits;
+		memcpy(&lBits, &inX, sizeof(lBits));
+		const long long lExponent = (long long)(lBits - cSqrtHalfBits) >> 52;
+		lBits -= (unsigned long long)lExponent << 52;
+		double lMantissa;
+		memcpy(&lMantissa, &lBits, sizeof(lMantissa));
+		const double lS = (lMantissa - 1.) / (lMantissa + 1.);
+		const double lZ = lS * lS;
+		const double lR = lZ*(1./3+lZ*(1./5+lZ*(1./7+lZ*(1./9+lZ*(1./11+lZ*(1./13+lZ*(1./15
+		                  +lZ*(1./17+lZ*(1./19+lZ*(1./21+lZ*(1./23)))))))))));
+		// ln(2) is split in a high part (exact when multiplied by the exponent) and a low part
+		const double lE = (double) (int) lExponent;
+		return lE*6.93147180369123816490e-01 + (lE*1.90821492927058770002e-10 + 2.*lS + 2.*lS*lR);
+	}
+	
+	/*! \brief Compute the sine and cosine of angle 2*pi*\c inTurn, for \c inTurn in [0,1[.
+	
+	The angle is reduced to [-pi/4,pi/4] by removing the nearest multiple of pi/2 (this reduction 
+	is exact for a fraction of turn), and the sine and cosine are evaluated with the minimax 
+	polynomials of the Cephes library.
+	*/
+	PACC_FORCE_INLINE void computeSinCos(double inTurn, double& outSin, double& outCos)
+	{
+		const double lY = 4. * inTurn;
+		const int lQuadrant = (int) (lY + 0.5);
+		const double lX = (lY - lQuadrant) * 1.57079632679489661923;
+		const double lZ = lX * lX;
+		const double lSin = lX + lX*lZ*(-1.66666666666666307295e-1+lZ*(8.33333333332211858878e-3
+		                    +lZ*(-1.98412698295895385996e-4+lZ*(2.75573136213857245213e-6
+		                    +lZ*(-2.50507477628578072866e-8+lZ*1.58962301576546568060e-10)))));
+		const double lCos = 1. - 0.5*lZ + lZ*lZ*(4.16666666666665929218e-2+lZ*(-1.38888888888730564116e-3
+		                    +lZ*(2.48015872888517045348e-5+lZ*(-2.75573141792967388112e-7
+		                    +lZ*(2.08757008419747316778e-9+lZ*-1.13585365213876817300e-11)))));
+		// rotate result according to quadrant
+		const double lS = (lQuadrant & 1) ? lCos : lSin;
+		const double lC = (lQuadrant & 1) ? lSin : lCos;
+		outSin = (lQuadrant & 2) ? -lS : lS;
+		outCos = ((lQuadrant+1) & 2) ? -lC : lC;
+	}
+	
+	//! Return the inverse normal cumulative distribution for \c inQ=p-0.5 in the central region |q| <= 0.425.
+	PACC_FORCE_INLINE double computeCentralInverseCDF(double inQ)
+	{
+		const double lR = 0.180625 - inQ*inQ;
+		return inQ * (((((((2.5090809287301226727e+3*lR + 3.3430575583588128105e+4)*lR
+		  + 6.7265770927008700853e+4)*lR + 4.5921953931549871457e+4)*lR + 1.3731693765509461125e+4)*lR
+		  + 1.9715909503065514427e+3)*lR + 1.3314166789178437745e+2)*lR + 3.3871328727963666080e+0)
+		/ (((((((5.2264952788528545610e+3*lR + 2.8729085735721942674e+4)*lR + 3.9307895800092710610e+4)*lR
+		  + 2.1213794301586595867e+4)*lR + 5.3941960214247511077e+3)*lR + 6.8718700749205790830e+2)*lR
+		  + 4.2313330701600911252e+1)*lR + 1.0);
+	}
+	
+	//! Return the inverse normal cumulative distribution for probability \c inP in the tail regions |p-0.5| > 0.425.
+	inline double computeTailInverseCDF(double inP)
+	{
+		const double lQ = inP - 0.5;
+		double lR = (lQ < 0 ? inP : 1.-inP);
+		if(lR <= 0) return (lQ < 0 ? -numeric_limits<double>::infinity() : numeric_limits<double>::infinity());
+		lR = sqrt(-computeLog(lR));
+		double lValue;
+		if(lR <= 5) {
+			lR -= 1.6;
+			lValue = (((((((7.74545014278341407640e-4*lR + 2.27238449892691845833e-2)*lR
+			  + 2.41780725177450611770e-1)*lR + 1.27045825245236838258e+0)*lR + 3.64784832476320460504e+0)*lR
+			  + 5.76949722146069140550e+0)*lR + 4.63033784615654529590e+0)*lR + 1.42343711074968357734e+0)
+			/ (((((((1.05075007164441684324e-9*lR + 5.47593808499534494600e-4)*lR + 1.51986665636164571966e-2)*lR
+			  + 1.48103976427480074590e-1)*lR + 6.89767334985100004550e-1)*lR + 1.67638483018380384940e+0)*lR
+			  + 2.05319162663775882187e+0)*lR + 1.0);
+		} else {
+			lR -= 5.;
+			lValue = (((((((2.01033439929228813265e-7*lR + 2.71155556874348757815e-5)*lR
+			  + 1.24266094738807843860e-3)*lR + 2.65321895265761230930e-2)*lR + 2.96560571828504891230e-1)*lR
+			  + 1.78482653991729133580e+0)*lR + 5.46378491116411436990e+0)*lR + 6.65790464350110377720e+0)
+			/ (((((((2.04426310338993978564e-15*lR + 1.42151175831644588870e-7)*lR + 1.84631831751005468180e-5)*lR
+			  + 7.86869131145613259100e-4)*lR + 1.48753612908506148525e-2)*lR + 1.36929880922735805310e-1)*lR
+			  + 5.99832206555887937690e-1)*lR + 1.0);
+		}
+		return (lQ < 0 ? -lValue : lValue);
+	}
+	
+	//! Transform the pairs of uniform deviates of buffer \c ioValues of size \c inSize into normal deviates (see NormalTransform::applyBoxMuller).
+	PACC_FORCE_INLINE void transformBoxMuller(double* ioValues, unsigned int inSize)
+	{
+		double lSquares[cBlockSize];
+		const unsigned int lPairs = inSize / 2;
+		for(unsigned int lStart = 0; lStart < lPairs; lStart += cBlockSize) {
+			const unsigned int lCount = (lPairs-lStart < cBlockSize ? lPairs-lStart : cBlockSize);
+			double* lValues = ioValues + 2*lStart;
+			// polynomial kernels first (vectorizable), then square roots
+			for(unsigned int i = 0; i < lCount; ++i) {
+				lSquares[i] = -2. * computeLog(1. - lValues[2*i]);
+				computeSinCos(lValues[2*i+1], lValues[2*i+1], lValues[2*i]);
+			}
+			for(unsigned int i = 0; i < lCount; ++i) {
+				const double lRadius = sqrt(lSquares[i]);
+				lValues[2*i] *= lRadius;
+				lValues[2*i+1] *= lRadius;
+			}
+		}
+	}
+	
+	//! Transform the uniform deviates of buffer \c ioValues of size \c inSize into normal deviates (see NormalTransform::applyInverseCDF).
+	PACC_FORCE_INLINE void transformInverseCDF(double* ioValues, unsigned int inSize)
+	{
+		double lProbabilities[cBlockSize];
+		for(unsigned int lStart = 0; lStart < inSize; lStart += cBlockSize) {
+			const unsigned int lCount = (inSize-lStart < cBlockSize ? inSize-lStart : cBlockSize);
+			double* lValues = ioValues + lStart;
+			unsigned int lTails = 0;
+			for(unsigned int i = 0; i < lCount; ++i) {
+				lProbabilities[i] = lValues[i];
+				lTails += (fabs(lValues[i] - 0.5) > 0.425);
+			}
+			for(unsigned int i = 0; i < lCount; ++i) {
+				lValues[i] = computeCentralInverseCDF(lProbabilities[i] - 0.5);
+			}
+			if(lTails > 0) {
+				for(unsigned int i = 0; i < lCount; ++i) {
+					if(fabs(lProbabilities[i] - 0.5) > 0.425) lValues[i] = computeTailInverseCDF(lProbabilities[i]);
+				}
+			}
+		}
+	}
+	
+	//! Signature of the transform kernels.
+	typedef void (*TransformFunction)(double*, unsigned int);
+	
+	// clones of the kernels for each instruction set
+	void transformBoxMullerGeneric(double* ioValues, unsigned int inSize) {transformBoxMuller(ioValues, inSize);}
+	void transformInverseCDFGeneric(double* ioValues, unsigned int inSize) {transformInverseCDF(ioValues, inSize);}
+#ifdef PACC_CPU_DISPATCH_X86
+	PACC_TARGET_AVX2 void transformBoxMullerAVX2(double* ioValues, unsigned int inSize) {transformBoxMuller(ioValues, inSize);}
+	PACC_TARGET_AVX2 void transformInverseCDFAVX2(double* ioValues, unsigned int inSize) {transformInverseCDF(ioValues, inSize);}
+	PACC_TARGET_AVX512 void transformBoxMullerAVX512(double* ioValues, unsigned int inSize) {transformBoxMuller(ioValues, inSize);}
+	PACC_TARGET_AVX512 void transformInverseCDFAVX512(double* ioValues, unsigned int inSize) {transformInverseCDF(ioValues, inSize);}
+#endif
+	
+} // end of anonymous namespace
+
+/*!
+Each consecutive pair (u1,u2) of uniform deviates is replaced by the pair of normal deviates
+\verbatim
+ (sqrt(-2*log(1-u1))*cos(2*pi*u2), sqrt(-2*log(1-u1))*sin(2*pi*u2))
+\endverbatim
+If \c inSize is odd, the last deviate is transformed using the inverse normal cumulative 
+distribution (see NormalTransform::applyInverseCDF).
+*/
+void NormalTransform::applyBoxMuller(double* ioValues, unsigned int inSize)
+{
+#ifdef PACC_CPU_DISPATCH_X86
+	static const TransformFunction lTransform = CPUFeatures::select<TransformFunction>(transformBoxMullerGeneric, 0, transformBoxMullerAVX2, transformBoxMullerAVX512);
+#else
+	static const TransformFunction lTransform = transformBoxMullerGeneric;
+#endif
+	lTransform(ioValues, inSize);
+	if(inSize % 2 != 0) ioValues[inSize-1] = computeInverseCDF(ioValues[inSize-1]);
+}
+
+/*!
+See NormalTransform::applyBoxMuller(double*, unsigned int) for details.
+*/
+void NormalTransform::applyBoxMuller(Vector& ioVector)
+{
+	if(ioVector.size() > 0) applyBoxMuller(&ioVector[0], ioVector.size());
+}
+
+/*!
+The values are processed by blocks: the central region (|p-0.5| <= 0.425), which covers 85% 
+of the deviates, is first evaluated for the whole block without any branching, and the 
+remaining tail values are then corrected one by one. The relative accuracy is about 1e-16.
+
+A null probability gives -infinity, and a unit probability gives +infinity.
+*/
+void NormalTransform::applyInverseCDF(double* ioValues, unsigned int inSize)
+{
+#ifdef PACC_CPU_DISPATCH_X86
+	static const TransformFunction lTransform = CPUFeatures::select<TransformFunction>(transformInverseCDFGeneric, 0, transformInverseCDFAVX2, transformInverseCDFAVX512);
+#else
+	static const TransformFunction lTransform = transformInverseCDFGeneric;
+#endif
+	lTransform(ioValues, inSize);
+}
+
+/*!
+See NormalTransform::applyInverseCDF(double*, unsigned int) for details.
+*/
+void NormalTransform::applyInverseCDF(Vector& ioVector)
+{
+	if(ioVector.size() > 0) applyInverseCDF(&ioVector[0], ioVector.size());
+}
+
+/*!
+This method implements algorithm AS241 (PPND16) of M.J. Wichura, with a relative accuracy 
+of about 1e-16. A null probability gives -infinity, and a unit probability gives +infinity.
+*/
+double NormalTransform::computeInverseCDF(double inProbability)
+{
+	PACC_AssertM(inProbability >= 0 && inProbability <= 1, "NormalTransform::computeInverseCDF() invalid probability!");
+	const double lQ = inProbability - 0.5;
+	if(fabs(lQ) <= 0.425) return computeCentralInverseCDF(lQ);
+	else return computeTailInverseCDF(inProbability);
+}
@@ -0,0 +1,81 @@
+/*
+ *  Portable Agile C++ Classes (PACC)
+ *  Copyright (C) 2001-2003 by Marc Parizeau
+ *  http://manitou.gel.ulaval.ca/~parizeau/PACC
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *  Contact:
+ *  Laboratoire de Vision et Systemes Numeriques
+ *  Departement de genie electrique et de genie informatique
+ *  Universite Laval, Quebec, Canada, G1K 7P4
+ *  http://vision.gel.ulaval.ca
+ *
+ */
+
+/*!
+ * \file   PACC/Math/NormalTransform.hpp
+ * \brief  Class definition for the bulk uniform to normal deviate transforms.
+ * \author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+ */
+
+#ifndef PACC_NormalTransform_hpp
+#define PACC_NormalTransform_hpp
+
+namespace PACC {
+	
+	// Forward declarations
+	class Vector;
+	
+	/*! \brief Bulk transforms of uniform deviates into normal deviates.
+		\author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+		\ingroup Math
+		
+		This class groups static methods that transform, in place, a buffer of uniformly distributed 
+		deviates into standard normal deviates N(0,1). Two transforms are available:
+		- NormalTransform::applyBoxMuller maps pairs of uniform deviates onto pairs of normal deviates 
+		(both the cosine and sine values are kept);
+		- NormalTransform::applyInverseCDF maps each uniform deviate onto a single normal deviate using 
+		the inverse of the normal cumulative distribution (algorithm AS241 of M.J. Wichura, 
+		Applied Statistics, Vol. 37, 1988, pp. 477-484). Because each output only depends on 
+		its own input, this transform preserves the structure of low-discrepancy sequences.
+		.
+		Both transforms process whole buffers using branch-free polynomial approximations of the 
+		logarithm, sine and cosine functions (relative error below 1e-15), instead of calling the 
+		scalar functions of the standard library for each value. This allows the compiler to 
+		vectorize the inner loops.
+	*/
+	class NormalTransform {
+	 public:
+		//! Transform the \c inSize uniform deviates in [0,1[ of buffer \c ioValues into normal deviates using the Box-Muller method.
+		static void applyBoxMuller(double* ioValues, unsigned int inSize);
+		
+		//! Transform the uniform deviates in [0,1[ of vector \c ioVector into normal deviates using the Box-Muller method.
+		static void applyBoxMuller(Vector& ioVector);
+		
+		//! Transform the \c inSize uniform deviates in ]0,1[ of buffer \c ioValues into normal deviates using the inverse normal cumulative distribution.
+		static void applyInverseCDF(double* ioValues, unsigned int inSize);
+		
+		//! Transform the uniform deviates in ]0,1[ of vector \c ioVector into normal deviates using the inverse normal cumulative distribution.
+		static void applyInverseCDF(Vector& ioVector);
+		
+		//! Return the inverse of the standard normal cumulative distribution for probability \c inProbability.
+		static double computeInverseCDF(double inProbability);
+		
+	};
+	
+} // end of PACC namespace
+
+#endif // PACC_NormalTransform_hpp
@@ -0,0 +1,485 @@
+/*
+ *  Portable Agile C++ Classes (PACC)
+ *  Copyright (C) 2001-2003 by Marc Parizeau
+ *  http://manitou.gel.ulaval.ca/~parizeau/PACC
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *  Contact:
+ *  Laboratoire de Vision et Systemes Numeriques
+ *  Departement de genie electrique et de genie informatique
+ *  Universite Laval, Quebec, Canada, G1K 7P4
+ *  http://vision.gel.ulaval.ca
+ *
+ */
+
+/*!
+ * \file   PACC/Math/PCA.cpp
+ * \brief  Method definitions for class PCA.
+ * \author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+ */
+
+#include "PACC/Math/PCA.hpp"
+#include "PACC/Util/Assert.hpp"
+#include "PACC/Util/StringFunc.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+using namespace std;
+using namespace PACC;
+
+namespace {
+	
+	//! Largest dimensionality for which the full decomposition is always used by PCA::eAuto.
+	const unsigned int cFullLimit = 128;
+	//! Number of extra vectors of the randomized range finder.
+	const unsigned int cOversampling = 10;
+	//! Number of applications of the covariance operator by the randomized range finder.
+	const unsigned int cPowerIterations = 3;
+	//! Minimum number of extra Lanczos steps beyond the number of components.
+	const unsigned int cLanczosExtra = 20;
+	
+	//! Return the dot product of the \c inSize elements of \c inX and \c inY.
+	inline double computeDot(const double* inX, const double* inY, unsigned int inSize)
+	{
+		double lSum = 0;
+		for(unsigned int i = 0; i < inSize; ++i) lSum += inX[i]*inY[i];
+		return lSum;
+	}
+	
+	//! Add \c inScale times the \c inSize elements of \c inX to those of \c ioY.
+	inline void addScaled(double* ioY, const double* inX, double inScale, unsigned int inSize)
+	{
+		for(unsigned int i = 0; i < inSize; ++i) ioY[i] += inScale*inX[i];
+	}
+	
+	/*! \brief Symmetric covariance operator.
+	
+	The operator is either an explicit covariance matrix, or a centered data matrix X for 
+	which the covariance matrix X'X/(n-1) is never formed.
+	*/
+	class CovarianceOperator {
+	 public:
+		//! Construct the operator of covariance matrix \c inCovariance.
+		explicit CovarianceOperator(const Matrix& inCovariance) : mCovariance(&inCovariance), mData(0), mScale(1) {}
+		
+		//! Construct the operator of the centered observations of matrix \c inData, scaled by \c inScale.
+		CovarianceOperator(const Matrix& inData, double inScale) : mCovariance(0), mData(&inData), mScale(inScale) {}
+		
+		//! Return through matrix \c outProducts the rows of matrix \c inVectors multiplied by the covariance matrix.
+		void apply(Matrix& outProducts, const Matrix& inVectors) const {
+			if(mCovariance) inVectors.multiply(outProducts, *mCovariance);
+			else {
+				Matrix lProjections;
+				mData->multiply(lProjections, inVectors.transpose());
+				lProjections.transpose().multiply(outProducts, *mData);
+				outProducts *= mScale;
+			}
+		}
+		
+	 protected:
+		const Matrix* mCovariance; //!< Explicit covariance matrix.
+		const Matrix* mData;       //!< Centered observations.
+		double mScale;             //!< Scale of the implicit covariance matrix.
+	};
+	
+	/*! \brief Orthonormalize rows \c inFirst to \c inLast (exclusive) of matrix \c ioVectors against all previous rows.
+	
+	Uses the modified Gram-Schmidt method with two passes. Rows that vanish (linearly dependent 
+	vectors) are replaced by random vectors drawn from \c ioRand.
+	*/
+	void orthonormalizeRows(Matrix& ioVectors, unsigned int inFirst, unsigned int inLast, Randomizer& ioRand)
+	{
+		const unsigned int lSize = ioVectors.cols();
+		for(unsigned int i = inFirst; i < inLast; ++i) {
+			double* lRow = &ioVectors(i,0);
+			for(unsigned int lTries = 0; ; ++lTries) {
+				const double lNorm = sqrt(computeDot(lRow, lRow, lSize));
+				for(unsigned int lPass = 0; lPass < 2; ++lPass) {
+					for(unsigned int j = 0; j < i; ++j) {
+						const double* lPrevious = &ioVectors(j,0);
+						addScaled(lRow, lPrevious, -computeDot(lRow, lPrevious, lSize), lSize);
+					}
+				}
+				const double lResidual = sqrt(computeDot(lRow, lRow, lSize));
+				if(lResidual > 1e-10*lNorm && lResidual > numeric_limits<double>::min()) {
+					for(unsigned int j = 0; j < lSize; ++j) lRow[j] /= lResidual;
+					break;
+				}
+				PACC_AssertM(lTries < 10 && i < lSize, "orthonormalizeRows() cannot find independent vectors!");
+				ioRand.fillGaussian(lRow, lSize);
+			}
+		}
+	}
+	
+	//! Return through \c outValues and \c outVectors the \c inComponents leading eigenvalues and eigenvectors (columns) of operator \c inOperator, computed by the Lanczos method.
+	void computeLanczos(Vector& outValues, Matrix& outVectors, const CovarianceOperator& inOperator, unsigned int inDimensionality, unsigned int inComponents, Randomizer& ioRand)
+	{
+		const unsigned int lSteps = min(inDimensionality, max(2*inComponents, inComponents+cLanczosExtra));
+		Matrix lBasis(lSteps, inDimensionality);
+		Matrix lTridiagonal(lSteps, lSteps);
+		Matrix lVector(1, inDimensionality), lProduct;
+		ioRand.fillGaussian(&lBasis(0,0), inDimensionality);
+		orthonormalizeRows(lBasis, 0, 1, ioRand);
+		for(unsigned int j = 0; j < lSteps; ++j) {
+			const double* lQ = &lBasis(j,0);
+			copy(lQ, lQ+inDimensionality, &lVector(0,0));
+			inOperator.apply(lProduct, lVector);
+			double* lW = &lProduct(0,0);
+			lTridiagonal(j,j) = computeDot(lW, lQ, inDimensionality);
+			if(j+1 == lSteps) break;
+			// full reorthogonalization (also removes the alpha and beta terms of the recurrence)
+			const double lNorm = sqrt(computeDot(lW, lW, inDimensionality));
+			copy(lW, lW+inDimensionality, &lBasis(j+1,0));
+			double* lNext = &lBasis(j+1,0);
+			for(unsigned int lPass = 0; lPass < 2; ++lPass) {
+				for(unsigned int i = 0; i <= j; ++i) {
+					const double* lPrevious = &lBasis(i,0);
+					addScaled(lNext, lPrevious, -computeDot(lNext, lPrevious, inDimensionality), inDimensionality);
+				}
+			}
+			const double lBeta = sqrt(computeDot(lNext, lNext, inDimensionality));
+			if(lBeta > 1e-10*lNorm && lBeta > numeric_limits<double>::min()) {
+				for(unsigned int i = 0; i < inDimensionality; ++i) lNext[i] /= lBeta;
+				lTridiagonal(j,j+1) = lTridiagonal(j+1,j) = lBeta;
+			} else {
+				// invariant subspace found; restart with a random vector
+				ioRand.fillGaussian(lNext, inDimensionality);
+				orthonormalizeRows(lBasis, j+1, j+2, ioRand);
+			}
+		}
+		Matrix lRitz;
+		lTridiagonal.computeEigens(outValues, lRitz);
+		outValues.resize(inComponents);
+		lRitz.resize(lSteps, inComponents);
+		lBasis.transpose().multiply(outVectors, lRitz);
+	}
+	
+	//! Return through \c outValues and \c outVectors the \c inComponents leading eigenvalues and eigenvectors (columns) of operator \c inOperator, computed by a randomized range finder.
+	void computeRandomized(Vector& outValues, Matrix& outVectors, const CovarianceOperator& inOperator, unsigned int inDimensionality, unsigned int inComponents, Randomizer& ioRand)
+	{
+		const unsigned int lSize = min(inDimensionality, inComponents+cOversampling);
+		Matrix lBasis(lSize, inDimensionality), lProducts;
+		ioRand.fillGaussian(lBasis);
+		for(unsigned int i = 0; i < cPowerIterations; ++i) {
+			inOperator.apply(lProducts, lBasis);
+			lBasis = lProducts;
+			orthonormalizeRows(lBasis, 0, lSize, ioRand);
+		}
+		// Rayleigh-Ritz projection onto the basis
+		inOperator.apply(lProducts, lBasis);
+		Matrix lProjected;
+		lBasis.multiply(lProjected, lProducts.transpose());
+		for(unsigned int i = 0; i < lSize; ++i) {
+			for(unsigned int j = 0; j < i; ++j) lProjected(i,j) = lProjected(j,i) = (lProjected(i,j)+lProjected(j,i))/2;
+		}
+		Matrix lRitz;
+		lProjected.computeEigens(outValues, lRitz);
+		outValues.resize(inComponents);
+		lRitz.resize(lSize, inComponents);
+		lBasis.transpose().multiply(outVectors, lRitz);
+	}
+	
+	//! Change the sign of each column of matrix \c ioVectors so that its largest element (in absolute value) is positive.
+	void normalizeSigns(Matrix& ioVectors)
+	{
+		for(unsigned int j = 0; j < ioVectors.cols(); ++j) {
+			unsigned int lMaxArg = 0;
+			for(unsigned int i = 1; i < ioVectors.rows(); ++i) {
+				if(fabs(ioVectors(i,j)) > fabs(ioVectors(lMaxArg,j))) lMaxArg = i;
+			}
+			if(ioVectors.rows() > 0 && ioVectors(lMaxArg,j) < 0) {
+				for(unsigned int i = 0; i < ioVectors.rows(); ++i) ioVectors(i,j) = -ioVectors(i,j);
+			}
+		}
+	}
+	
+	//! Subtract vector \c inMean from each row of matrix \c ioData.
+	void subtractRows(Matrix& ioData, const Vector& inMean)
+	{
+		const unsigned int lSize = ioData.cols();
+		for(unsigned int i = 0; i < ioData.rows(); ++i) {
+			double* lRow = &ioData(i,0);
+			for(unsigned int j = 0; j < lSize; ++j) lRow[j] -= inMean[j];
+		}
+	}
+	
+}
+
+/*!
+The observations of a first call are subtracted from all subsequent observations before 
+their outer products are accumulated (using the blocked matrix product). All batches must 
+have the same number of columns.
+*/
+void PCA::Accumulator::add(const Matrix& inData)
+{
+	if(inData.rows() == 0) return;
+	const unsigned int lDim = inData.cols();
+	if(mCount == 0) {
+		mShift = Vector(lDim);
+		for(unsigned int j = 0; j < lDim; ++j) mShift[j] = inData(0,j);
+		mSums = Vector(lDim);
+		mProducts = Matrix(lDim, lDim);
+	}
+	PACC_AssertM(lDim == mShift.size(), "PCA::Accumulator::add() dimensionality mismatch!");
+	Matrix lShifted(inData);
+	subtractRows(lShifted, mShift);
+	for(unsigned int i = 0; i < lShifted.rows(); ++i) {
+		const double* lRow = &lShifted(i,0);
+		for(unsigned int j = 0; j < lDim; ++j) mSums[j] += lRow[j];
+	}
+	Matrix lProducts;
+	lShifted.transpose().multiply(lProducts, lShifted);
+	mProducts += lProducts;
+	mCount += inData.rows();
+}
+
+/*!
+This method also returns a reference to the result. At least two observations are required.
+*/
+Matrix& PCA::Accumulator::getCovariance(Matrix& outCovariance) const
+{
+	PACC_AssertM(mCount > 1, "PCA::Accumulator::getCovariance() at least two observations are required!");
+	const unsigned int lDim = mShift.size();
+	outCovariance = mProducts;
+	for(unsigned int i = 0; i < lDim; ++i) {
+		for(unsigned int j = 0; j < lDim; ++j) {
+			outCovariance(i,j) = (mProducts(i,j) - mSums[i]*mSums[j]/mCount) / (mCount-1);
+		}
+	}
+	return outCovariance;
+}
+
+/*!
+This method also returns a reference to the result. At least one observation is required.
+*/
+Vector& PCA::Accumulator::getMean(Vector& outMean) const
+{
+	PACC_AssertM(mCount > 0, "PCA::Accumulator::getMean() no observation!");
+	const unsigned int lDim = mShift.size();
+	outMean = Vector(lDim);
+	for(unsigned int j = 0; j < lDim; ++j) outMean[j] = mShift[j] + mSums[j]/mCount;
+	return outMean;
+}
+
+void PCA::Accumulator::reset(void)
+{
+	mCount = 0;
+	mShift = Vector();
+	mSums = Vector();
+	mProducts = Matrix();
+}
+
+/*!
+The rows of matrix \c inData are the observations (at least two are required). When \c inComponents 
+is 0 or exceeds the dimensionality, all components are computed. Argument \c inMethod selects the 
+decomposition method (see PCA::Method), and \c ioRand is the random number generator used by 
+the Lanczos and randomized methods. With the full decomposition, the covariance matrix is 
+accumulated using a PCA::Accumulator; otherwise, the operator of the centered data is used directly.
+*/
+void PCA::fit(const Matrix& inData, unsigned int inComponents, Method inMethod, Randomizer& ioRand)
+{
+	PACC_AssertM(inData.rows() > 1, "PCA::fit() at least two observations are required!");
+	const unsigned int lDim = inData.cols();
+	const unsigned int lComponents = (inComponents == 0 || inComponents > lDim) ? lDim : inComponents;
+	const Method lMethod = selectMethod(inMethod, lComponents, lDim, inData.rows());
+	if(lMethod == eFull) {
+		Accumulator lAccumulator;
+		lAccumulator.add(inData);
+		fit(lAccumulator, lComponents, eFull, ioRand);
+		return;
+	}
+	
+	// center data
+	Matrix lSums;
+	inData.sumColumns(lSums);
+	mMean = Vector(lDim);
+	for(unsigned int j = 0; j < lDim; ++j) mMean[j] = lSums(0,j) / inData.rows();
+	Matrix lCentered(inData);
+	subtractRows(lCentered, mMean);
+	const double lScale = 1. / (inData.rows()-1);
+	mTotalVariance = 0;
+	for(unsigned int i = 0; i < lCentered.rows(); ++i) {
+		const double* lRow = &lCentered(i,0);
+		mTotalVariance += computeDot(lRow, lRow, lDim);
+	}
+	mTotalVariance *= lScale;
+	
+	CovarianceOperator lOperator(lCentered, lScale);
+	if(lMethod == eLanczos) computeLanczos(mEigenvalues, mComponents, lOperator, lDim, lComponents, ioRand);
+	else computeRandomized(mEigenvalues, mComponents, lOperator, lDim, lComponents, ioRand);
+	normalizeSigns(mComponents);
+	mMethod = lMethod;
+}
+
+/*!
+The accumulator must contain at least two observations. See PCA::fit(const Matrix&, unsigned int, Method, Randomizer&) 
+for the description of the other arguments. The Lanczos and randomized methods are applied to the 
+accumulated covariance matrix.
+*/
+void PCA::fit(const Accumulator& inAccumulator, unsigned int inComponents, Method inMethod, Randomizer& ioRand)
+{
+	PACC_AssertM(inAccumulator.getCount() > 1, "PCA::fit() at least two observations are required!");
+	const unsigned int lDim = inAccumulator.getDimensionality();
+	const unsigned int lComponents = (inComponents == 0 || inComponents > lDim) ? lDim : inComponents;
+	const Method lMethod = selectMethod(inMethod, lComponents, lDim, inAccumulator.getCount());
+	Matrix lCovariance;
+	inAccumulator.getCovariance(lCovariance);
+	inAccumulator.getMean(mMean);
+	mTotalVariance = 0;
+	for(unsigned int j = 0; j < lDim; ++j) mTotalVariance += lCovariance(j,j);
+	
+	if(lMethod == eFull) {
+		lCovariance.computeEigens(mEigenvalues, mComponents);
+		mEigenvalues.resize(lComponents);
+		mComponents.resize(lDim, lComponents);
+	} else {
+		CovarianceOperator lOperator(lCovariance);
+		if(lMethod == eLanczos) computeLanczos(mEigenvalues, mComponents, lOperator, lDim, lComponents, ioRand);
+		else computeRandomized(mEigenvalues, mComponents, lOperator, lDim, lComponents, ioRand);
+	}
+	normalizeSigns(mComponents);
+	mMethod = lMethod;
+}
+
+double PCA::getExplainedVariance(void) const
+{
+	if(mTotalVariance <= 0) return 0;
+	double lSum = 0;
+	for(unsigned int i = 0; i < mEigenvalues.size(); ++i) lSum += mEigenvalues[i];
+	return lSum / mTotalVariance;
+}
+
+/*!
+The rows of matrix \c inProjections must have as many columns as there are principal components. 
+If whitening is enabled, the projections are first scaled back to the variance of their component. 
+This method also returns a reference to the result.
+*/
+Matrix& PCA::inverseTransform(Matrix& outData, const Matrix& inProjections) const
+{
+	PACC_AssertM(mComponents.cols() > 0, "PCA::inverseTransform() principal components are not fitted!");
+	PACC_AssertM(inProjections.cols() == mComponents.cols(), "PCA::inverseTransform() number of components mismatch!");
+	Matrix lProjections(inProjections);
+	if(mWhitening) {
+		for(unsigned int j = 0; j < mEigenvalues.size(); ++j) {
+			const double lScale = mEigenvalues[j] > 0 ? sqrt(mEigenvalues[j]) : 0;
+			for(unsigned int i = 0; i < lProjections.rows(); ++i) lProjections(i,j) *= lScale;
+		}
+	}
+	lProjections.multiply(outData, mComponents.transpose());
+	for(unsigned int i = 0; i < outData.rows(); ++i) {
+		double* lRow = &outData(i,0);
+		for(unsigned int j = 0; j < outData.cols(); ++j) lRow[j] += mMean[j];
+	}
+	return outData;
+}
+
+/*!
+The method is forced to PCA::eFull when all components are requested. Otherwise, with PCA::eAuto, 
+the full decomposition is chosen for small dimensionalities or when at least half of the 
+components are requested, the randomized method when the number of components (plus 
+oversampling) is at most a fourth of the rank bound min(\c inCount, \c inDimensionality), 
+and the Lanczos method otherwise.
+*/
+PCA::Method PCA::selectMethod(Method inMethod, unsigned int inComponents, unsigned int inDimensionality, unsigned long inCount)
+{
+	if(inComponents >= inDimensionality) return eFull;
+	if(inMethod != eAuto) return inMethod;
+	if(inDimensionality <= cFullLimit || 2*inComponents >= inDimensionality) return eFull;
+	const unsigned long lRank = (inCount == 0 || inCount > inDimensionality) ? inDimensionality : inCount;
+	if(4*(inComponents+cOversampling) <= lRank) return eRandomized;
+	return eLanczos;
+}
+
+/*!
+The node must contain a "Mean" vector, an "Eigenvalues" vector and a "Components" matrix, 
+as written by PCA::write. Any format error throws a \c runtime_error exception.
+*/
+string PCA::read(const XML::ConstIterator& inNode)
+{
+	if(!inNode) throw runtime_error("PCA::read() nothing to read!");
+	if(inNode->getType() != XML::eData) throw runtime_error("PCA::read() node type must be XML::eData!");
+	bool lMean = false, lEigenvalues = false, lComponents = false;
+	for(XML::ConstIterator lChild = inNode->getFirstChild(); lChild; ++lChild) {
+		if(lChild->getType() != XML::eData) continue;
+		if(lChild->getValue() == "Mean") {
+			mMean.read(lChild);
+			lMean = true;
+		} else if(lChild->getValue() == "Eigenvalues") {
+			mEigenvalues.read(lChild);
+			lEigenvalues = true;
+		} else if(lChild->getValue() == "Components") {
+			mComponents.read(lChild);
+			lComponents = true;
+		}
+	}
+	if(!lMean || !lEigenvalues || !lComponents) 
+		throw runtime_error("PCA::read() missing Mean, Eigenvalues or Components markup!");
+	if(mComponents.rows() != mMean.size() || mComponents.cols() != mEigenvalues.size())
+		throw runtime_error("PCA::read() inconsistent dimensions of Mean, Eigenvalues and Components!");
+	mWhitening = inNode->isDefined("whitening") && inNode->getAttribute("whitening") == "1";
+	mTotalVariance = inNode->isDefined("variance") ? String::convertToFloat(inNode->getAttribute("variance")) : 0;
+	mMethod = eAuto;
+	if(inNode->isDefined("name")) mName = inNode->getAttribute("name");
+	return mName;
+}
+
+/*!
+Projections are computed by centering the rows of matrix \c inData, and multiplying them 
+with the principal components (blocked matrix product). If whitening is enabled, each 
+projection is then divided by the standard deviation of its component (components with null 
+variance are set to 0). This method also returns a reference to the result.
+*/
+Matrix& PCA::transform(Matrix& outProjections, const Matrix& inData) const
+{
+	PACC_AssertM(mComponents.cols() > 0, "PCA::transform() principal components are not fitted!");
+	PACC_AssertM(inData.cols() == mMean.size(), "PCA::transform() dimensionality mismatch!");
+	Matrix lCentered(inData);
+	subtractRows(lCentered, mMean);
+	lCentered.multiply(outProjections, mComponents);
+	if(mWhitening) {
+		for(unsigned int j = 0; j < mEigenvalues.size(); ++j) {
+			const double lScale = mEigenvalues[j] > 0 ? 1./sqrt(mEigenvalues[j]) : 0;
+			for(unsigned int i = 0; i < outProjections.rows(); ++i) outProjections(i,j) *= lScale;
+		}
+	}
+	return outProjections;
+}
+
+void PCA::write(XML::Streamer& outStream, const string& inTag) const
+{
+	outStream.openTag(inTag);
+	if(mName != "") outStream.insertAttribute("name", mName);
+	outStream.insertAttribute("whitening", mWhitening ? "1" : "0");
+	ostringstream lVariance;
+	lVariance.precision(17);
+	lVariance << mTotalVariance;
+	outStream.insertAttribute("variance", lVariance.str());
+	mMean.write(outStream, "Mean");
+	mEigenvalues.write(outStream, "Eigenvalues");
+	mComponents.write(outStream, "Components");
+	outStream.closeTag();
+}
+
+XML::Document& PACC::operator>>(XML::Document& inDocument, PCA& outPCA)
+{
+	XML::Iterator lNode = inDocument.getFirstDataTag();
+	outPCA.read(lNode);
+	inDocument.erase(lNode);
+	return inDocument;
+}
@@ -0,0 +1,199 @@
+/*
+ *  Portable Agile C++ Classes (PACC)
+ *  Copyright (C) 2001-2003 by Marc Parizeau
+ *  http://manitou.gel.ulaval.ca/~parizeau/PACC
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *  Contact:
+ *  Laboratoire de Vision et Systemes Numeriques
+ *  Departement de genie electrique et de genie informatique
+ *  Universite Laval, Quebec, Canada, G1K 7P4
+ *  http://vision.gel.ulaval.ca
+ *
+ */
+
+/*!
+ * \file   PACC/Math/PCA.hpp
+ * \brief  Class definition for the principal component analysis.
+ * \author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+ */
+
+#ifndef PACC_PCA_hpp
+#define PACC_PCA_hpp
+
+#include "PACC/Math/Matrix.hpp"
+#include "PACC/Math/Vector.hpp"
+#include "PACC/Util/Randomizer.hpp"
+#include "PACC/XML/Document.hpp"
+#include "PACC/XML/Streamer.hpp"
+
+namespace PACC {
+	
+	using namespace std;
+	
+	/*! \brief Principal component analysis and whitening.
+		\author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+		\ingroup Math
+		
+		This class computes the principal components of a set of observations, that is the 
+		eigenvectors of their covariance matrix with the largest eigenvalues. The observations 
+		are given either as the rows of a data matrix (PCA::fit), or through a PCA::Accumulator 
+		that builds the covariance matrix incrementally from batches of observations that do 
+		not need to be in memory at the same time.
+		
+		Three decomposition methods are available:
+		- PCA::eFull computes all eigenvectors of the covariance matrix (Matrix::computeEigens);
+		- PCA::eLanczos computes the leading eigenvectors with the Lanczos method (with full 
+		reorthogonalization);
+		- PCA::eRandomized computes the leading eigenvectors using a randomized range finder 
+		with power iterations, followed by a Rayleigh-Ritz projection.
+		.
+		With PCA::eAuto (the default), the full decomposition is used for small dimensionalities 
+		or when many components are requested, the randomized method when the number of 
+		components is small relative to the shape of the data, and the Lanczos method otherwise. 
+		The Lanczos and randomized methods never form the covariance matrix when fitting a data 
+		matrix.
+		
+		Once fitted, PCA::transform projects observations onto the principal components (and 
+		optionally whitens them, so that each component has unit variance), while 
+		PCA::inverseTransform maps projections back into the observation space. Both methods 
+		use the blocked matrix product of Matrix::multiply. A fitted model can read and write 
+		itself in %XML.
+		
+		\attention Observations are always the rows of the data matrices.
+	*/
+	class PCA {
+	 public:
+		//! Decomposition methods.
+		enum Method {
+			eAuto,       //!< Choose method according to the shape of the problem.
+			eFull,       //!< Full eigendecomposition of the covariance matrix.
+			eLanczos,    //!< Lanczos iterations for the leading eigenvectors.
+			eRandomized  //!< Randomized range finder for the leading eigenvectors.
+		};
+		
+		/*! \brief Streaming accumulator of the mean and covariance of observations.
+		
+			Observations are accumulated relative to the first observation, which avoids 
+			most of the cancellation errors of the naive sum of squares formula.
+		*/
+		class Accumulator {
+		 public:
+			//! Construct an empty accumulator.
+			Accumulator(void) : mCount(0) {}
+			
+			//! Add the observations of the rows of matrix \c inData.
+			void add(const Matrix& inData);
+			
+			//! Return the number of accumulated observations.
+			unsigned long getCount(void) const {return mCount;}
+			
+			//! Return the dimensionality of the accumulated observations.
+			unsigned int getDimensionality(void) const {return mShift.size();}
+			
+			//! Return the unbiased covariance matrix of the accumulated observations through matrix \c outCovariance.
+			Matrix& getCovariance(Matrix& outCovariance) const;
+			
+			//! Return the mean of the accumulated observations through vector \c outMean.
+			Vector& getMean(Vector& outMean) const;
+			
+			//! Discard all accumulated observations.
+			void reset(void);
+			
+		 protected:
+			unsigned long mCount; //!< Number of accumulated observations.
+			Vector mShift;        //!< Observation subtracted before accumulation.
+			Vector mSums;         //!< Sum of the shifted observations.
+			Matrix mProducts;     //!< Sum of the outer products of the shifted observations.
+		};
+		
+		//! Construct an empty (unfitted) principal component analysis with name \c inName.
+		PCA(const string& inName="") : mTotalVariance(0), mWhitening(false), mMethod(eAuto), mName(inName) {}
+		
+		//! Fit the \c inComponents leading principal components (0 for all) of the rows of matrix \c inData.
+		void fit(const Matrix& inData, unsigned int inComponents=0, Method inMethod=eAuto, Randomizer& ioRand=PACC::rand);
+		
+		//! Fit the \c inComponents leading principal components (0 for all) of the observations of accumulator \c inAccumulator.
+		void fit(const Accumulator& inAccumulator, unsigned int inComponents=0, Method inMethod=eAuto, Randomizer& ioRand=PACC::rand);
+		
+		//! Return the number of principal components.
+		unsigned int getComponentCount(void) const {return mComponents.cols();}
+		
+		//! Return the principal components (one per column, by decreasing variance).
+		const Matrix& getComponents(void) const {return mComponents;}
+		
+		//! Return the dimensionality of the observations.
+		unsigned int getDimensionality(void) const {return mMean.size();}
+		
+		//! Return the variance of each principal component (eigenvalues of the covariance matrix).
+		const Vector& getEigenvalues(void) const {return mEigenvalues;}
+		
+		//! Return the fraction of the total variance that is explained by the principal components.
+		double getExplainedVariance(void) const;
+		
+		//! Return the mean of the observations.
+		const Vector& getMean(void) const {return mMean;}
+		
+		//! Return the decomposition method used by the last fit.
+		Method getMethod(void) const {return mMethod;}
+		
+		//! Return the name of this principal component analysis.
+		const string& getName(void) const {return mName;}
+		
+		//! Return the total variance of the observations (trace of the covariance matrix).
+		double getTotalVariance(void) const {return mTotalVariance;}
+		
+		//! Return whether projections are whitened.
+		bool isWhitening(void) const {return mWhitening;}
+		
+		//! Map the projections of the rows of matrix \c inProjections back into the observation space, and return them through matrix \c outData.
+		Matrix& inverseTransform(Matrix& outData, const Matrix& inProjections) const;
+		
+		//! Read this principal component analysis from parse tree node \c inNode.
+		string read(const XML::ConstIterator& inNode);
+		
+		//! Set the name of this principal component analysis.
+		void setName(const string& inName) {mName = inName;}
+		
+		//! Enable or disable the whitening of projections.
+		void setWhitening(bool inWhitening) {mWhitening = inWhitening;}
+		
+		//! Project the rows of matrix \c inData onto the principal components, and return the projections through matrix \c outProjections.
+		Matrix& transform(Matrix& outProjections, const Matrix& inData) const;
+		
+		//! Write this principal component analysis into streamer \c outStream using tag name \c inTag.
+		void write(XML::Streamer& outStream, const string& inTag="PCA") const;
+		
+	 protected:
+		Vector mMean;          //!< Mean of the observations.
+		Vector mEigenvalues;   //!< Variance of each principal component.
+		Matrix mComponents;    //!< Principal components (one per column).
+		double mTotalVariance; //!< Total variance of the observations.
+		bool mWhitening;       //!< Whether projections are whitened.
+		Method mMethod;        //!< Decomposition method of the last fit.
+		string mName;          //!< Name of the principal component analysis.
+		
+		//! Return the method to use for \c inComponents components of \c inDimensionality dimensional observations, with \c inCount observations (0 if unknown).
+		static Method selectMethod(Method inMethod, unsigned int inComponents, unsigned int inDimensionality, unsigned long inCount);
+		
+	};
+	
+	//! Extract principal component analysis \c outPCA from %XML document \c inDocument.
+	XML::Document& operator>>(XML::Document& inDocument, PCA& outPCA);
+	
+}
+
+#endif // PACC_PCA_hpp
@@ -36,15 +36,22 @@
  */
 
 #include "PACC/Util/Assert.hpp"
+#include "PACC/Util/ByteOrder.hpp"
 #include "PACC/Math/QRandSequencer.hpp"
+#include "PACC/Math/NormalTransform.hpp"
 
 #include <cmath>
 #include <sstream>
+#include <stdexcept>
 
-#ifndef M_PI
-//! Value of PI
-#define M_PI 3.14159265358979323846
-#endif
+namespace {
+	//! Identifier of the binary state of a QRandSequencer ("PQRS" in little-endian order).
+	const unsigned long cStateMagic = 0x53525150UL;
+	//! Version of the binary state of a QRandSequencer.
+	const unsigned long cStateVersion = 1;
+	//! Size in bytes of the header of the binary state.
+	const unsigned int cStateHeaderSize = 20;
+}
 
 using namespace PACC;
 
@@ -55,7 +62,8 @@ using namespace PACC;
  */
 QRandSequencer::QRandSequencer(unsigned int inDimensionality, PACC::Randomizer& inRand) :
   mDimensionality(inDimensionality),
-  mCount(0)
+  mCount(0),
+  mGaussianMethod(eBoxMuller)
 {
 	if(inDimensionality != 0) reset(mDimensionality, inRand);
 }
@@ -128,18 +136,44 @@ void QRandSequencer::getGaussianVector(PACC::Vector& outVector)
 	generateSequence(lValues, lMaxValues);
 	PACC_AssertM((lValues.size()%2)==0 && (lMaxValues.size()%2)==0, "getGaussianVector() internal error");
 	outVector.resize(lValues.size());
-	// Box-Muller method to get gaussian distributions.
-	for(unsigned int i = 0; i < lValues.size(); i+=2) {
-		const double lX1   = double(lValues[i]) / double(lMaxValues[i]);
-		const double lX2   = double(lValues[i+1]) / double(lMaxValues[i+1]);
-		const double lR    = std::sqrt(-2.0 * std::log(1.0 - lX1));
-		const double lPhi  = 2.0 * M_PI * lX2;
-		outVector[i]   = lR * std::cos(lPhi);
-		outVector[i+1] = lR * std::sin(lPhi);
+	// the inverse normal distribution maps 0 onto -infinity: use the middle of the first cell instead
+	const double lZero = (mGaussianMethod == eInverseCDF ? 0.5 : 0.);
+	for(unsigned int i = 0; i < lValues.size(); ++i) {
+		outVector[i] = (lValues[i] == 0 ? lZero : double(lValues[i])) / double(lMaxValues[i]);
 	}
+	if(outVector.size() > 0) transformToGaussian(&outVector[0], outVector.size());
 	outVector.resize(mDimensionality);
 }
 
+/*!
+ *  \brief Generate \c inCount point vectors of Gaussian distribution N(0,I).
+ *  \param outMatrix Generated vector points, one point per row.
+ *  \param inCount Number of points to generate.
+ 
+ This method is equivalent to \c inCount calls to QRandSequencer::getGaussianVector(PACC::Vector&), 
+ but the gaussian transform is applied once to the whole set of points.
+ */
+void QRandSequencer::getGaussianVectors(PACC::Matrix& outMatrix, unsigned int inCount)
+{
+	const unsigned int lDim = mBases.size();
+	std::vector<unsigned long> lValues, lMaxValues;
+	std::vector<double> lBuffer(inCount*lDim);
+	// the inverse normal distribution maps 0 onto -infinity: use the middle of the first cell instead
+	const double lZero = (mGaussianMethod == eInverseCDF ? 0.5 : 0.);
+	for(unsigned int i = 0; i < inCount; ++i) {
+		generateSequence(lValues, lMaxValues);
+		PACC_AssertM(lValues.size() == lDim, "getGaussianVectors() internal error");
+		for(unsigned int j = 0; j < lDim; ++j) {
+			lBuffer[i*lDim+j] = (lValues[j] == 0 ? lZero : double(lValues[j])) / double(lMaxValues[j]);
+		}
+	}
+	if(lBuffer.size() > 0) transformToGaussian(&lBuffer[0], lBuffer.size());
+	outMatrix.resize(inCount, mDimensionality);
+	for(unsigned int i = 0; i < inCount; ++i) {
+		for(unsigned int j = 0; j < mDimensionality; ++j) outMatrix(i,j) = lBuffer[i*lDim+j];
+	}
+}
+
 /*!
  *  \brief Generate a point vector of gaussian distribution \c N(inCenter,inStdDev*I).
  *  \param outVector Generated vector point.
@@ -159,7 +193,7 @@ void QRandSequencer::getGaussianVector(PACC::Vector& outVector, const PACC::Vect
 	// generate N(0,I) vector
 	getGaussianVector(outVector);
 	// apply scales
-	for(unsigned int i = 0; i < outVector.size(); ++i) outVector *= inStDev[i];
+	for(unsigned int i = 0; i < outVector.size(); ++i) outVector[i] *= inStDev[i];
 	// apply translation
 	outVector += inCenter;
 }
@@ -193,6 +227,17 @@ void QRandSequencer::getGaussianVector(PACC::Vector& outVector, const PACC::Vect
 	outVector = inCenter + inSqRootCovar*outVector;
 }
 
+/*!
+ *  \brief Transform uniform values in ]0,1[ into gaussian values N(0,1), using the current gaussian method.
+ *  \param ioValues Values to transform.
+ *  \param inSize Number of values to transform (must be even).
+ */
+void QRandSequencer::transformToGaussian(double* ioValues, unsigned int inSize) const
+{
+	if(mGaussianMethod == eInverseCDF) NormalTransform::applyInverseCDF(ioValues, inSize);
+	else NormalTransform::applyBoxMuller(ioValues, inSize);
+}
+
 /*!
  *  \brief Get a new integer low-discrepancy sequence.
  *  \param outSequence Generated integer sequence.
@@ -358,7 +403,7 @@ void QRandSequencer::reset(unsigned int inDimensionality, PACC::Randomizer& inRa
 	const unsigned int lDim = inDimensionality + (inDimensionality % 2);
 	mBases.resize(lDim);
 	for(unsigned int i=0; i < lDim; ++i) mBases[i] = l1000FirstPrimes[i];
-	std::random_shuffle(mBases.begin(), mBases.end(), inRand);
+	inRand.shuffle(mBases.begin(), mBases.end());
 	// Reset counters to 0.
 	mCounters.resize(lDim);
 	for(unsigned int i=0; i<lDim; ++i) mCounters[i].clear();
@@ -367,7 +412,7 @@ void QRandSequencer::reset(unsigned int inDimensionality, PACC::Randomizer& inRa
 	for(unsigned int i=0; i<lDim; ++i) {
 		mPermutations[i].resize(mBases[i]);
 		for(unsigned int j=0; j < mPermutations[i].size(); ++j) mPermutations[i][j] = j;
-		std::random_shuffle(mPermutations[i].begin()+1, mPermutations[i].end(), inRand);
+		inRand.shuffle(mPermutations[i].begin()+1, mPermutations[i].end());
 	}
 	// Set dimensionality and counter values.
 	mDimensionality = inDimensionality;
@@ -407,10 +452,16 @@ void QRandSequencer::setState(const std::string& inState)
 	}
 	mCount = 0;
 	lISS >> mCount;
-	
-	// Set counters values.
-	mCounters.resize(lDim);
-	for(unsigned int i=0; i<lDim; ++i) {
+	resetCounters();
+}
+
+/*!
+ *  \brief Set the counters in prime bases to the current count.
+ */
+void QRandSequencer::resetCounters(void)
+{
+	mCounters.resize(mBases.size());
+	for(unsigned int i=0; i<mBases.size(); ++i) {
 		mCounters[i].clear();
 		unsigned int lCounterI = mCount;
 		while(lCounterI > 0) {
@@ -420,3 +471,114 @@ void QRandSequencer::setState(const std::string& inState)
 		}
 	}
 }
+
+/*!
+ *  \brief Return the size in bytes of the binary state of the quasi-random numbers generator.
+ */
+unsigned int QRandSequencer::getBinaryStateSize(void) const
+{
+	unsigned int lSize = cStateHeaderSize;
+	for(unsigned int i=0; i<mBases.size(); ++i) lSize += 2*mBases[i];
+	return lSize;
+}
+
+/*!
+ *  \brief Save the binary state of the quasi-random numbers generator into buffer \c outBuffer.
+ *  \return Number of bytes written.
+ 
+ The binary state starts with the identifier and version of the format, its size in bytes, 
+ the dimensionality and the count of generated numbers (as 32 bits integers). Then, for each 
+ prime basis, the basis and its permutation follow (as 16 bits integers). All integers are 
+ stored in little-endian order. Buffer \c outBuffer must hold at least 
+ QRandSequencer::getBinaryStateSize bytes.
+ */
+unsigned int QRandSequencer::saveState(void* outBuffer) const
+{
+	unsigned char* lBuffer = (unsigned char*) outBuffer;
+	const unsigned int lSize = getBinaryStateSize();
+	writeLittleEndian32(lBuffer, cStateMagic);
+	writeLittleEndian32(lBuffer+4, cStateVersion);
+	writeLittleEndian32(lBuffer+8, lSize);
+	writeLittleEndian32(lBuffer+12, mBases.empty() ? 0 : mDimensionality);
+	writeLittleEndian32(lBuffer+16, mCount);
+	lBuffer += cStateHeaderSize;
+	for(unsigned int i=0; i<mBases.size(); ++i) {
+		writeLittleEndian16(lBuffer, mBases[i]);
+		for(unsigned int j=1; j<mBases[i]; ++j) writeLittleEndian16(lBuffer+2*j, mPermutations[i][j]);
+		lBuffer += 2*mBases[i];
+	}
+	return lSize;
+}
+
+/*!
+ *  \brief Write the binary state of the quasi-random numbers generator into stream \c outStream.
+ */
+void QRandSequencer::saveState(std::ostream& outStream) const
+{
+	std::vector<unsigned char> lBuffer(getBinaryStateSize());
+	outStream.write((const char*) &lBuffer[0], saveState(&lBuffer[0]));
+}
+
+/*!
+ *  \brief Load the binary state of the quasi-random numbers generator from buffer \c inBuffer.
+ *  \return Number of bytes read.
+ *  \throw std::runtime_error if the buffer does not contain a valid binary state; the generator 
+ *  is then left unchanged.
+ */
+unsigned int QRandSequencer::loadState(const void* inBuffer)
+{
+	const unsigned char* lBuffer = (const unsigned char*) inBuffer;
+	if(readLittleEndian32(lBuffer) != cStateMagic || readLittleEndian32(lBuffer+4) != cStateVersion) {
+		throw std::runtime_error("QRandSequencer::loadState() invalid binary state!");
+	}
+	const unsigned int lSize = readLittleEndian32(lBuffer+8);
+	const unsigned int lDimensionality = readLittleEndian32(lBuffer+12);
+	const unsigned int lDim = lDimensionality + (lDimensionality % 2);
+	if(lSize < cStateHeaderSize || lDimensionality > 1000) throw std::runtime_error("QRandSequencer::loadState() invalid binary state!");
+	// parse and validate the whole state before changing the generator
+	std::vector<unsigned int> lBases(lDim);
+	std::vector< std::vector<unsigned int> > lPermutations(lDim);
+	unsigned int lOffset = cStateHeaderSize;
+	for(unsigned int i=0; i<lDim; ++i) {
+		if(lOffset+2 > lSize) throw std::runtime_error("QRandSequencer::loadState() invalid binary state!");
+		lBases[i] = readLittleEndian16(lBuffer+lOffset);
+		if(lBases[i] < 2 || lOffset+2*lBases[i] > lSize) throw std::runtime_error("QRandSequencer::loadState() invalid binary state!");
+		lPermutations[i].resize(lBases[i]);
+		lPermutations[i][0] = 0;
+		for(unsigned int j=1; j<lBases[i]; ++j) {
+			lPermutations[i][j] = readLittleEndian16(lBuffer+lOffset+2*j);
+			if(lPermutations[i][j] >= lBases[i]) throw std::runtime_error("QRandSequencer::loadState() invalid binary state!");
+		}
+		lOffset += 2*lBases[i];
+	}
+	mBases.swap(lBases);
+	mPermutations.swap(lPermutations);
+	mDimensionality = lDimensionality;
+	mCount = readLittleEndian32(lBuffer+16);
+	resetCounters();
+	return lSize;
+}
+
+/*!
+ *  \brief Read the binary state of the quasi-random numbers generator from stream \c inStream.
+ *  \throw std::runtime_error if the stream does not contain a valid binary state.
+ */
+void QRandSequencer::loadState(std::istream& inStream)
+{
+	std::vector<unsigned char> lBuffer(cStateHeaderSize);
+	if(inStream.read((char*) &lBuffer[0], cStateHeaderSize)) {
+		if(readLittleEndian32(&lBuffer[0]) != cStateMagic || readLittleEndian32(&lBuffer[4]) != cStateVersion) {
+			throw std::runtime_error("QRandSequencer::loadState() invalid binary state!");
+		}
+		// at most 1000 bases, each smaller than 7920
+		const unsigned int lSize = readLittleEndian32(&lBuffer[8]);
+		if(lSize >= cStateHeaderSize && lSize <= cStateHeaderSize+2000*7920) {
+			lBuffer.resize(lSize);
+			if(lSize == cStateHeaderSize || inStream.read((char*) &lBuffer[cStateHeaderSize], lSize-cStateHeaderSize)) {
+				loadState(&lBuffer[0]);
+				return;
+			}
+		}
+	}
+	throw std::runtime_error("QRandSequencer::loadState() unable to read binary state!");
+}
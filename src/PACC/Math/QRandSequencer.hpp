@@ -37,6 +37,7 @@
 #ifndef PACC_QRandSequencer_hpp
 #define PACC_QRandSequencer_hpp
 
+#include <iostream>
 #include <vector>
 
 #include "PACC/Util/Randomizer.hpp"
@@ -55,10 +56,20 @@ namespace PACC {
  *
  *  Generate low-discrepancy sequences of numbers (quasirandom numbers) using the
  *  scrambled Halton algorithm.
+ *
+ *  The state of the generator can be saved and restored either as a text string 
+ *  (QRandSequencer::getState and QRandSequencer::setState), or in a compact binary format 
+ *  (QRandSequencer::saveState and QRandSequencer::loadState) which is much faster.
  */
 	class QRandSequencer {
 
 	 public:
+		//! Methods for transforming the uniform low-discrepancy sequences into gaussian ones.
+		enum GaussianMethod {
+			eBoxMuller,  //!< Box-Muller transform of pairs of components (default).
+			eInverseCDF  //!< Inverse normal cumulative distribution of each component.
+		};
+		
 		explicit QRandSequencer(unsigned int inDimensionality=0, PACC::Randomizer& inRand=PACC::rand);
 
 		//! Delete this sequence generator.
@@ -69,6 +80,7 @@ namespace PACC {
 		void getGaussianVector(PACC::Vector& outVector);
 		void getGaussianVector(PACC::Vector& outVector, const PACC::Vector& inCenter, const PACC::Vector& inStDev);
 		void getGaussianVector(PACC::Vector& outVector, const PACC::Vector& inCenter, const PACC::Matrix& inSqRootCovar);
+		void getGaussianVectors(PACC::Matrix& outMatrix, unsigned int inCount);
 
 		void getIntegerSequence(std::vector<long>& outSequence, long inMinValue, long inMaxValue);
 		void getIntegerSequence(std::vector<long>& outSequence, const std::vector<long>& inMinValues, const std::vector<long>& inMaxValues);
@@ -78,10 +90,22 @@ namespace PACC {
 
 		std::string getState(void) const;
 		void setState(const std::string& inState);
+		
+		unsigned int getBinaryStateSize(void) const;
+		unsigned int saveState(void* outBuffer) const;
+		void saveState(std::ostream& outStream) const;
+		unsigned int loadState(const void* inBuffer);
+		void loadState(std::istream& inStream);
 
 		//! \brief Return dimensionality of low-discrepancy sequences.
 		inline unsigned int getDimensionality(void) const {return mDimensionality;}
 		
+		//! \brief Return method used to generate gaussian vectors.
+		inline GaussianMethod getGaussianMethod(void) const {return mGaussianMethod;}
+		
+		//! \brief Set method used to generate gaussian vectors to \c inMethod.
+		inline void setGaussianMethod(GaussianMethod inMethod) {mGaussianMethod = inMethod;}
+		
 		void reset(unsigned int inDimensionality, PACC::Randomizer& inRand=PACC::rand);
 		
 	 protected:
@@ -90,8 +114,11 @@ namespace PACC {
 		std::vector< std::vector<unsigned int> > mPermutations;   //!< Number permutations in given bases.
 		unsigned int mDimensionality; //!< Dimensionality of the numbers.
 		unsigned int mCount;          //!< Count generated numbers.
+		GaussianMethod mGaussianMethod; //!< Method used to generate gaussian vectors.
 
 		void generateSequence(std::vector<unsigned long>& outValues, std::vector<unsigned long>& outMaxValues);
+		void resetCounters(void);
+		void transformToGaussian(double* ioValues, unsigned int inSize) const;
 	};
 }
 
@@ -35,11 +35,90 @@
 
 #include "PACC/Math/Vector.hpp"
 #include "PACC/Util/StringFunc.hpp"
+#include "PACC/Util/Parallel.hpp"
+#include <functional>
 #include <stdexcept>
 
 using namespace std;
 using namespace PACC;
 
+namespace {
+	
+	//! Return the index of the first element of \c inData in range [\c inBegin, \c inEnd) that is minimal according to \c inCompare.
+	template <class Compare>
+	unsigned int findFirst(const double* inData, unsigned int inBegin, unsigned int inEnd, Compare inCompare)
+	{
+		unsigned int lArg = inBegin;
+		for(unsigned int i = inBegin+1; i < inEnd; ++i) {
+			if(inCompare(inData[i], inData[lArg])) lArg = i;
+		}
+		return lArg;
+	}
+	
+	/*!
+	 \brief Return the index of the first element of \c inData that is minimal according to \c inCompare.
+	 
+	 Large arrays are split into chunks that are searched in parallel; the partial results are 
+	 then combined in chunk order, so that ties are always resolved in favor of the lowest index 
+	 (the parallel mode of the standard library does not guarantee it for std::min_element).
+	 */
+	template <class Compare>
+	unsigned int findExtremum(const double* inData, unsigned int inSize, Compare inCompare)
+	{
+		if(inSize == 0) return 0;
+		const int lChunks = Parallel::getChunkCount(inSize);
+		vector<unsigned int> lArgs(lChunks);
+		PACC_PARALLEL_FOR(inSize)
+		for(int c = 0; c < lChunks; ++c) {
+			const unsigned int lBegin = Parallel::getChunkBegin(inSize, c, lChunks);
+			const unsigned int lEnd = Parallel::getChunkBegin(inSize, c+1, lChunks);
+			lArgs[c] = (lBegin < lEnd ? findFirst(inData, lBegin, lEnd, inCompare) : inSize);
+		}
+		// combine chunk results in order, skipping empty chunks
+		unsigned int lArg = inSize;
+		for(int c = 0; c < lChunks; ++c) {
+			if(lArgs[c] == inSize) continue;
+			if(lArg == inSize || inCompare(inData[lArgs[c]], inData[lArg])) lArg = lArgs[c];
+		}
+		return lArg;
+	}
+	
+}
+
+/*!
+ Ties are resolved in favor of the lowest index.
+ */
+int Vector::getArgMax(void) const
+{
+	PACC_AssertM(mCols == 1, "Vector::getArgMax() invalid number of columns!");
+	return findExtremum(data(), mRows, greater<double>());
+}
+
+/*!
+ Ties are resolved in favor of the lowest index.
+ */
+int Vector::getArgMin(void) const
+{
+	PACC_AssertM(mCols == 1, "Vector::getArgMin() invalid number of columns!");
+	return findExtremum(data(), mRows, less<double>());
+}
+
+/*!
+ */
+double Vector::getMax(void) const
+{
+	PACC_AssertM(mCols == 1, "Vector::getMax() invalid number of columns!");
+	return (*this)[findExtremum(data(), mRows, greater<double>())];
+}
+
+/*!
+ */
+double Vector::getMin(void) const
+{
+	PACC_AssertM(mCols == 1, "Vector::getMin() invalid number of columns!");
+	return (*this)[findExtremum(data(), mRows, less<double>())];
+}
+
 /*!
  This method will try to interpret the input node as a matrix (see Matrix::read).
  For example, the following defines a vector of size 4:
@@ -105,15 +184,8 @@ void Vector::write(XML::Streamer& outStream, const string& inTag) const
 	outStream.openTag(inTag, false);
 	if(mName != "") outStream.insertAttribute("name", mName);
 	outStream.insertAttribute("size", mRows);
-	if(size() > 0) {
-		ostringstream lContent;
-		lContent.precision(mPrec);
-		for(unsigned int i = 0; i < mRows; ++i) {
-			if(i != 0) lContent << ";";
-			lContent << (*this)[i];
-		}
-		outStream.insertStringContent(lContent.str());
-	}
+	// a column matrix serializes its elements separated by semi-columns
+	if(size() > 0) outStream.insertStringContent(serialize());
 	outStream.closeTag();
 }
 
@@ -212,28 +212,16 @@ namespace PACC {
 		}
 		
 		//! Return index of max element.
-		inline int getArgMax(void) const {
-			PACC_AssertM(mCols == 1, "Vector::getArgMax() invalid number of columns!");
-			return distance(begin(), max_element(begin(), end()));
-		}
+		int getArgMax(void) const;
 		
 		//! Return max element.
-		inline double getMax(void) const {
-			PACC_AssertM(mCols == 1, "Vector::getMax() invalid number of columns!");
-			return *max_element(begin(), end());
-		}
+		double getMax(void) const;
 		
 		//! Return index of min element.
-		inline int getArgMin(void) const {
-			PACC_AssertM(mCols == 1, "Vector::getArgMin() invalid number of columns!");
-			return distance(begin(), min_element(begin(), end()));
-		}
+		int getArgMin(void) const;
 		
 		//! Return min element.
-		inline double getMin(void) const {
-			PACC_AssertM(mCols == 1, "Vector::getMin() invalid number of columns!");
-			return *min_element(begin(), end());
-		}
+		double getMin(void) const;
 		
 		//! Return size of this vector.
 		inline unsigned int size(void) const {
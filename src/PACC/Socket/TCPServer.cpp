@@ -70,16 +70,11 @@ void Socket::ServerThread::main(void)
 
 /*! Return whether the server thread should terminated its current connection early.
 
-This method will respond true whenever the running thread has received a cancellation request. Such a request results from a call to method TCPServer::halt. 
-
-\attention This method should never be called with the thread mutex LOCKED BY THE CALLER. Otherwise, it will deadlock!
+This method will respond true whenever the running thread has received a cancellation request. Such a request results from a call to method TCPServer::halt. The cancellation flag is atomic, so that this method does not lock the thread mutex.
 */
 bool Socket::ServerThread::shouldTerminate(void) const
 {
-	lock();
-	bool lResult = mCancel;
-	unlock();
-	return lResult;
+	return mCancel.load();
 }
 
 /*!
@@ -160,15 +155,18 @@ void Socket::TCPServer::setDefaultOptions()
 /*!
 Upon return, this method has added \c inThreads new threads to the server's thread pool. These new threads start accepting incomming connections immediately, and until some thread calls method TCPServer::halt. Incomming connections are processed through calls to virtual function TCPServer::main which needs to be overloaded in a sub-class. Halt requests will be honored at least every \c inMaxHaltDelay seconds (default=1), or after a connection terminates.
 
-This method can be called any number of times to increase the size of the thread pool. 
+This method can be called any number of times to increase the size of the thread pool. The new threads are placed on the CPUs of the host according to policy \c inPlacement (see Threading::Topology::getPlacement), for instance on the node of the network interface; by default, they may run on any CPU. When the pool already has threads, the placement is computed for the whole pool, and the new threads take its last places, so that successive calls spread the threads as a single call would.
 
 \attention if the server was constructed using the default constructor, methods TCPServer::bind and TCPServer::listen must be called prior to calling this method. Otherwise, no incomming connection will ever be accepted, nor any error raised. Any error during the initialization of the new threads raises a Socket::Exception.
 */
-void Socket::TCPServer::run(unsigned int inThreads, double inMaxHaltDelay)
+void Socket::TCPServer::run(unsigned int inThreads, double inMaxHaltDelay, Threading::Topology::Placement inPlacement)
 {
+	// the new threads take the places that follow those of the existing threads
+	const unsigned int lFirst = mThreadPool.size();
+	const vector<vector<unsigned int> > lPlacement = Threading::Topology::getDefault().getPlacement(inPlacement, lFirst+inThreads);
 	// allocate new threads
 	for(unsigned int i = 0; i < inThreads; ++i) {
-		ServerThread* lThread = new ServerThread(this, inMaxHaltDelay);
+		ServerThread* lThread = new ServerThread(this, inMaxHaltDelay, lPlacement[lFirst+i]);
 		mThreadPool.push_back(lThread);
 	}
 }
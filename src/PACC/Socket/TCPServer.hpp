@@ -38,6 +38,7 @@
 
 #include "PACC/Socket/TCP.hpp"
 #include "PACC/Threading/Thread.hpp"
+#include "PACC/Threading/Topology.hpp"
 #include <vector>
 
 namespace PACC { 
@@ -56,8 +57,8 @@ namespace PACC {
 		*/
 		class ServerThread : public Threading::Thread {
 		 public:
-			//! Construct thread and link to server \c inServer.
-			ServerThread(Socket::TCPServer* inServer, double inMaxHaltDelay) : mServer(inServer), mMaxHaltDelay(inMaxHaltDelay) {run();}
+			//! Construct thread and link to server \c inServer; the thread runs on CPUs \c inAffinity (any CPU if empty).
+			ServerThread(Socket::TCPServer* inServer, double inMaxHaltDelay, const vector<unsigned int>& inAffinity=vector<unsigned int>()) : mServer(inServer), mMaxHaltDelay(inMaxHaltDelay) {setAffinity(inAffinity); run();}
 			//! delete thread.
 			~ServerThread(void) {wait();}
 			
@@ -109,7 +110,7 @@ namespace PACC {
 			void open(void) {Port::open();}
 			
 			//! Start accepting incomming connections.
-			void run(unsigned int inThreads, double inMaxHaltDelay=1);
+			void run(unsigned int inThreads, double inMaxHaltDelay=1, Threading::Topology::Placement inPlacement=Threading::Topology::eFloating);
 			
 			//! Wait for server termination.
 			void wait(void);
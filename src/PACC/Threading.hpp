@@ -43,9 +43,26 @@
  * \brief Framework for multithreaded programming. 
  */
 
+#include "PACC/Threading/AdaptiveMutex.hpp"
+#include "PACC/Threading/Algorithm.hpp"
 #include "PACC/Threading/Condition.hpp"
+#include "PACC/Threading/CoTask.hpp"
+#include "PACC/Threading/EventCount.hpp"
+#include "PACC/Threading/Future.hpp"
+#include "PACC/Threading/Histogram.hpp"
+#include "PACC/Threading/LightTask.hpp"
 #include "PACC/Threading/Mutex.hpp"
+#include "PACC/Threading/Reactor.hpp"
+#include "PACC/Threading/RWMutex.hpp"
 #include "PACC/Threading/Semaphore.hpp"
+#include "PACC/Threading/SeqLock.hpp"
+#include "PACC/Threading/SpinMutex.hpp"
+#include "PACC/Threading/TaskDeque.hpp"
+#include "PACC/Threading/TaskGraph.hpp"
+#include "PACC/Threading/TaskGroup.hpp"
+#include "PACC/Threading/TaskRing.hpp"
 #include "PACC/Threading/Thread.hpp"
 #include "PACC/Threading/ThreadPool.hpp"
+#include "PACC/Threading/TimerWheel.hpp"
 #include "PACC/Threading/TLS.hpp"
+#include "PACC/Threading/Topology.hpp"
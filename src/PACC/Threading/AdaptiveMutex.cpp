@@ -0,0 +1,58 @@
+/*
+ *  Portable Agile C++ Classes (PACC)
+ *  Copyright (C) 2001-2003 by Marc Parizeau
+ *  http://manitou.gel.ulaval.ca/~parizeau/PACC
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *  Contact:
+ *  Laboratoire de Vision et Systemes Numeriques
+ *  Departement de genie electrique et de genie informatique
+ *  Universite Laval, Quebec, Canada, G1K 7P4
+ *  http://vision.gel.ulaval.ca
+ *
+ */
+
+/*!
+ * \file PACC/Threading/AdaptiveMutex.cpp
+ * \brief Class methods for the adaptive mutex.
+ * \author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+ */
+
+#include "PACC/Threading/AdaptiveMutex.hpp"
+#include "PACC/Threading/SpinMutex.hpp"
+
+using namespace std;
+using namespace PACC;
+
+/*! \brief Acquire the mutex after a failed attempt of AdaptiveMutex::lock.
+
+The calling thread first spins while the mutex is locked, and tries to lock it whenever it appears unlocked. It then marks the mutex as contended, and sleeps on the event count until the mutex is unlocked; a thread that acquires the mutex after sleeping leaves it contended, because other threads may still be sleeping.
+*/
+void Threading::AdaptiveMutex::wait(void) const
+{
+	for(unsigned int i = 0; i < mSpins; ++i) {
+		unsigned int lState = mState.load(memory_order_relaxed);
+		if(lState == eUnlocked && mState.compare_exchange_weak(lState, eLocked, memory_order_acquire, memory_order_relaxed)) return;
+		if(lState == eContended) break;
+		SpinMutex::pause();
+	}
+	while(mState.exchange(eContended, memory_order_acquire) != eUnlocked) {
+		// the state must be checked again after preparing to wait (see AdaptiveMutex::unlock)
+		EventCount::Key lKey = mEvents.prepareWait();
+		if(mState.load(memory_order_seq_cst) != eContended) mEvents.cancelWait();
+		else mEvents.wait(lKey);
+	}
+}
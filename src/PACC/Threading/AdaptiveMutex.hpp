@@ -0,0 +1,107 @@
+/*
+ *  Portable Agile C++ Classes (PACC)
+ *  Copyright (C) 2001-2003 by Marc Parizeau
+ *  http://manitou.gel.ulaval.ca/~parizeau/PACC
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *  Contact:
+ *  Laboratoire de Vision et Systemes Numeriques
+ *  Departement de genie electrique et de genie informatique
+ *  Universite Laval, Quebec, Canada, G1K 7P4
+ *  http://vision.gel.ulaval.ca
+ *
+ */
+
+/*!
+ * \file PACC/Threading/AdaptiveMutex.hpp
+ * \brief Class definition for the adaptive mutex.
+ * \author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+ */
+
+#ifndef PACC_Threading_AdaptiveMutex_hpp_
+#define PACC_Threading_AdaptiveMutex_hpp_
+
+#include "PACC/Threading/EventCount.hpp"
+#include <atomic>
+
+namespace PACC {
+	
+	using namespace std;
+	
+	namespace Threading {
+		
+		/*! \brief Mutex that spins briefly before sleeping.
+		\author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+		\ingroup Threading
+		
+		This class implements a mutex with the same AdaptiveMutex::lock, AdaptiveMutex::tryLock, and AdaptiveMutex::unlock methods as class Mutex, but without any native structure. An uncontended lock or unlock is a single atomic operation. A thread that finds the mutex locked first spins for a number of iterations given to the constructor, since short critical sections are usually released before a sleep would even start, and then sleeps on an event count (see EventCount) until the mutex is unlocked. Unlocking only wakes up a thread when one may be sleeping.
+		
+		Unlike Mutex, it cannot be used with a Condition. It is not recursive.
+		*/
+		class AdaptiveMutex {
+			public:
+			//! Construct unlocked mutex that spins \c inSpins times before sleeping.
+			explicit AdaptiveMutex(unsigned int inSpins=100) : mState(eUnlocked), mSpins(inSpins) {}
+			
+			//! Return the number of spins before sleeping.
+			unsigned int getSpins(void) const {return mSpins;}
+			
+			//! Lock the mutex.
+			void lock(void) const {
+				unsigned int lState = eUnlocked;
+				if(!mState.compare_exchange_strong(lState, eLocked, memory_order_acquire, memory_order_relaxed)) wait();
+			}
+			
+			//! Set the number of spins before sleeping to \c inSpins.
+			void setSpins(unsigned int inSpins) {mSpins = inSpins;}
+			
+			//! Try to lock the mutex without blocking; return true if successful.
+			bool tryLock(void) const {
+				unsigned int lState = eUnlocked;
+				return mState.compare_exchange_strong(lState, eLocked, memory_order_acquire, memory_order_relaxed);
+			}
+			
+			//! Unlock the mutex, and wake up a sleeping thread if any.
+			void unlock(void) const {
+				if(mState.exchange(eUnlocked, memory_order_release) == eContended) mEvents.notify();
+			}
+			
+			protected:
+			//! States of the mutex.
+			enum State {
+				eUnlocked=0, //!< Mutex is unlocked.
+				eLocked=1, //!< Mutex is locked, and no thread sleeps.
+				eContended=2 //!< Mutex is locked, and threads may be sleeping.
+			};
+			
+			mutable atomic<unsigned int> mState; //!< State of mutex (see AdaptiveMutex::State).
+			mutable EventCount mEvents; //!< Event count of sleeping threads.
+			unsigned int mSpins; //!< Number of spins before sleeping.
+			
+			void wait(void) const;
+			
+			private:
+			//! restrict (disable) copy constructor.
+			AdaptiveMutex(const AdaptiveMutex&);
+			//! restrict (disable) assignment operator.
+			void operator=(const AdaptiveMutex&);
+		};
+		
+	} // end of Threading namespace
+	
+} // end of PACC namespace
+
+#endif // PACC_Threading_AdaptiveMutex_hpp_
@@ -0,0 +1,86 @@
+/*
+ *  Portable Agile C++ Classes (PACC)
+ *  Copyright (C) 2001-2003 by Marc Parizeau
+ *  http://manitou.gel.ulaval.ca/~parizeau/PACC
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *  Contact:
+ *  Laboratoire de Vision et Systemes Numeriques
+ *  Departement de genie electrique et de genie informatique
+ *  Universite Laval, Quebec, Canada, G1K 7P4
+ *  http://vision.gel.ulaval.ca
+ *
+ */
+
+/*!
+ * \file PACC/Threading/Algorithm.cpp
+ * \brief Class methods for the data-parallel algorithms of thread pools.
+ * \author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+ */
+
+#include "PACC/Threading/Algorithm.hpp"
+
+using namespace std;
+using namespace PACC;
+
+//! Construct dispenser of \c inSize iterations, in chunks of at least \c inGrain iterations, for \c inParticipants participants.
+Threading::ParallelRange::ParallelRange(size_t inSize, size_t inGrain, unsigned int inParticipants) :
+	mSize(inSize), mGrain(inGrain == 0 ? 1 : inGrain), mParticipants(inParticipants == 0 ? 1 : inParticipants), mNext(0), mCompleted(0)
+{}
+
+//! Account for \c inCount completed iterations, and wake up the waiting thread after the last one.
+void Threading::ParallelRange::done(size_t inCount)
+{
+	lock();
+	mCompleted += inCount;
+	if(mCompleted == mSize) broadcast();
+	unlock();
+}
+
+//! Keep exception \c inException if it is the first one, and skip the iterations that were not handed out.
+void Threading::ParallelRange::fail(exception_ptr inException)
+{
+	lock();
+	if(!mException) mException = inException;
+	unlock();
+	size_t lNext = mNext.exchange(mSize);
+	if(lNext < mSize) done(mSize-lNext);
+}
+
+/*! \brief Hand out the next chunk [\c outBegin, \c outEnd); return false if no iteration is left.
+
+The size of the chunk is half the remaining iterations divided by the number of participants, but no less than the grain.
+*/
+bool Threading::ParallelRange::next(size_t& outBegin, size_t& outEnd)
+{
+	size_t lNext = mNext.load(memory_order_relaxed);
+	do {
+		if(lNext >= mSize) return false;
+		size_t lChunk = max(mGrain, (mSize-lNext)/(2*mParticipants));
+		outEnd = min(mSize, lNext+lChunk);
+	} while(!mNext.compare_exchange_weak(lNext, outEnd, memory_order_relaxed));
+	outBegin = lNext;
+	return true;
+}
+
+//! Wait for all iterations to complete, and rethrow the first exception thrown by a participant, if any.
+void Threading::ParallelRange::wait(void)
+{
+	lock();
+	while(mCompleted < mSize) Condition::wait();
+	unlock();
+	if(mException) rethrow_exception(mException);
+}
@@ -0,0 +1,257 @@
+/*
+ *  Portable Agile C++ Classes (PACC)
+ *  Copyright (C) 2001-2003 by Marc Parizeau
+ *  http://manitou.gel.ulaval.ca/~parizeau/PACC
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *  Contact:
+ *  Laboratoire de Vision et Systemes Numeriques
+ *  Departement de genie electrique et de genie informatique
+ *  Universite Laval, Quebec, Canada, G1K 7P4
+ *  http://vision.gel.ulaval.ca
+ *
+ */
+
+/*!
+ * \file PACC/Threading/Algorithm.hpp
+ * \brief Definition of the data-parallel algorithms of thread pools.
+ * \author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+ */
+
+#ifndef PACC_Threading_Algorithm_hpp_
+#define PACC_Threading_Algorithm_hpp_
+
+#include "PACC/Threading/Condition.hpp"
+#include "PACC/Threading/LightTask.hpp"
+#include "PACC/Threading/ThreadPool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+namespace PACC {
+	
+	using namespace std;
+	
+	namespace Threading {
+		
+		/*! \brief Dispenser of the chunks of a data-parallel loop.
+		\author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+		\ingroup Threading
+		
+		This class hands out the iterations of a loop of \c inSize iterations to its participants (see Threading::parallelFor), in chunks of decreasing size: each chunk is a fraction of the remaining iterations, but no less than the grain. Large chunks are thus handed out first, and small ones balance the load at the end. 
+		
+		The first exception thrown by a participant is kept, and stops the distribution of chunks. Method ParallelRange::wait waits for all chunks that were handed out to complete; as participants that start late find no chunk left, it never waits for a task that is still queued.
+		*/
+		class ParallelRange : public Condition {
+			public:
+			ParallelRange(size_t inSize, size_t inGrain, unsigned int inParticipants);
+			
+			void done(size_t inCount);
+			void fail(exception_ptr inException);
+			bool next(size_t& outBegin, size_t& outEnd);
+			void wait(void);
+			
+			protected:
+			size_t mSize; //!< Number of iterations.
+			size_t mGrain; //!< Minimum number of iterations of a chunk.
+			unsigned int mParticipants; //!< Number of participants.
+			atomic<size_t> mNext; //!< First iteration that was not handed out.
+			size_t mCompleted; //!< Number of completed (or skipped) iterations.
+			exception_ptr mException; //!< First exception thrown by a participant.
+		};
+		
+		//! Run the chunks of loop \c ioRange, calling \c inFunction(inBegin+i) for each iteration \c i.
+		template <class Index, class Function>
+		void runParallelRange(ParallelRange& ioRange, Index inBegin, Function& inFunction)
+		{
+			size_t lBegin, lEnd;
+			while(ioRange.next(lBegin, lEnd)) {
+				try {
+					for(size_t i = lBegin; i < lEnd; ++i) inFunction(inBegin + Index(i));
+				}
+				catch(...) {ioRange.fail(current_exception());}
+				ioRange.done(lEnd-lBegin);
+			}
+		}
+		
+		/*! \brief %Task that participates in a data-parallel loop.
+		\author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+		\ingroup Threading
+		
+		This task is allocated by Threading::parallelFor, and is deleted by its slave thread after completion. It refers to the function of the calling thread, which can only return after all chunks are completed.
+		*/
+		template <class Index, class Function>
+		class ParallelForTask : public LightTask {
+			public:
+			//! Construct participant of loop \c inRange, for function \c inFunction of indices starting at \c inBegin.
+			ParallelForTask(const shared_ptr<ParallelRange>& inRange, Index inBegin, Function* inFunction) : mRange(inRange), mBegin(inBegin), mFunction(inFunction) {mAutoDelete = true;}
+			
+			//! Run chunks until none is left.
+			void main(void) {runParallelRange(*mRange, mBegin, *mFunction);}
+			
+			protected:
+			shared_ptr<ParallelRange> mRange; //!< Loop.
+			Index mBegin; //!< First index of loop.
+			Function* mFunction; //!< Function of the calling thread.
+		};
+		
+		/*! \brief Call \c inFunction(i) for each index \c i in [\c inBegin, \c inEnd), using thread pool \c ioPool.
+		
+		The iterations are handed out in chunks of decreasing size, to the calling thread and to up to one task per running slave of the pool (see ParallelRange). Argument \c inGrain is the minimum number of iterations of a chunk; a null grain (default) selects a grain of about 1/32 of the iterations of each participant. Ranges that are not larger than the grain run in the calling thread.
+		
+		As the calling thread runs chunks itself, and only waits for the chunks that were started by other participants, this function may be called from a task that runs in the same pool (nested loops). In work-stealing mode, the tasks pushed by a slave go to its own deque, where idle slaves steal them. If the function throws an exception, the remaining chunks are skipped, and the first exception is rethrown.
+		*/
+		template <class Index, class Function>
+		void parallelFor(ThreadPool& ioPool, Index inBegin, Index inEnd, size_t inGrain, Function inFunction)
+		{
+			if(!(inBegin < inEnd)) return;
+			const size_t lSize = size_t(inEnd - inBegin);
+			const unsigned int lParticipants = ioPool.getSlaves()+1;
+			if(inGrain == 0) inGrain = max<size_t>(1, lSize/(32*lParticipants));
+			if(lSize <= inGrain || ioPool.empty()) {
+				for(size_t i = 0; i < lSize; ++i) inFunction(inBegin + Index(i));
+				return;
+			}
+			shared_ptr<ParallelRange> lRange(new ParallelRange(lSize, inGrain, lParticipants));
+			const size_t lHelpers = min<size_t>(ioPool.getSlaves(), (lSize+inGrain-1)/inGrain - 1);
+			for(size_t i = 0; i < lHelpers; ++i) ioPool.push(*new ParallelForTask<Index, Function>(lRange, inBegin, &inFunction));
+			runParallelRange(*lRange, inBegin, inFunction);
+			lRange->wait();
+		}
+		
+		//! Call \c inFunction(i) for each index \c i in [\c inBegin, \c inEnd), using thread pool \c ioPool and an automatic grain.
+		template <class Index, class Function>
+		void parallelFor(ThreadPool& ioPool, Index inBegin, Index inEnd, Function inFunction)
+		{
+			parallelFor(ioPool, inBegin, inEnd, 0, inFunction);
+		}
+		
+		/*! \brief Reduce range [\c inBegin, \c inEnd) using thread pool \c ioPool, and return the result.
+		
+		The range is cut into fixed blocks of \c inGrain indices, and \c inFunction(b, e) returns the partial result of block [b, e). The partial results are then combined pairwise with \c inCombine(a, b), in a fixed binary tree: block 0 with block 1, block 2 with block 3, and so on, and then the results of these combinations in the same way. An empty range returns \c inIdentity. 
+		
+		As the blocks and the tree only depend on the grain, the result is deterministic, even for non associative operations like floating point additions, whatever the number of slaves and the order in which blocks are computed. A null grain (default) selects a grain that only depends on the size of the range (at most 256 blocks).
+		*/
+		template <class Index, class T, class Function, class Combine>
+		T parallelReduce(ThreadPool& ioPool, Index inBegin, Index inEnd, size_t inGrain, const T& inIdentity, Function inFunction, Combine inCombine)
+		{
+			if(!(inBegin < inEnd)) return inIdentity;
+			const size_t lSize = size_t(inEnd - inBegin);
+			if(inGrain == 0) inGrain = (lSize+255)/256;
+			const size_t lBlocks = (lSize+inGrain-1)/inGrain;
+			vector<T> lPartials(lBlocks, inIdentity);
+			parallelFor(ioPool, size_t(0), lBlocks, 1, [&](size_t inBlock) {
+				const size_t lBegin = inBlock*inGrain;
+				lPartials[inBlock] = inFunction(inBegin + Index(lBegin), inBegin + Index(min(lBegin+inGrain, lSize)));
+			});
+			for(size_t lStep = 1; lStep < lBlocks; lStep *= 2) {
+				parallelFor(ioPool, size_t(0), (lBlocks-lStep+2*lStep-1)/(2*lStep), [&](size_t inPair) {
+					const size_t lFirst = inPair*2*lStep;
+					lPartials[lFirst] = inCombine(lPartials[lFirst], lPartials[lFirst+lStep]);
+				});
+			}
+			return lPartials[0];
+		}
+		
+		//! Reduce range [\c inBegin, \c inEnd) using thread pool \c ioPool and an automatic grain (see the other overload).
+		template <class Index, class T, class Function, class Combine>
+		T parallelReduce(ThreadPool& ioPool, Index inBegin, Index inEnd, const T& inIdentity, Function inFunction, Combine inCombine)
+		{
+			return parallelReduce(ioPool, inBegin, inEnd, 0, inIdentity, inFunction, inCombine);
+		}
+		
+		/*! \brief Sort range [\c inBegin, \c inEnd) with comparison \c inCompare in the calling thread (stable).
+		
+		In the parallel mode of the standard library (_GLIBCXX_PARALLEL), the sort is explicitly sequential: the blocks of Threading::parallelSort are already sorted in parallel by the thread pool, and the parallel sort of the standard library needs copyable elements.
+		*/
+		template <class Iterator, class Compare>
+		void sequentialSort(Iterator inBegin, Iterator inEnd, Compare inCompare)
+		{
+#ifdef _GLIBCXX_PARALLEL
+			std::stable_sort(inBegin, inEnd, inCompare, __gnu_parallel::sequential_tag());
+#else
+			std::stable_sort(inBegin, inEnd, inCompare);
+#endif
+		}
+		
+		/*! \brief Merge sorted ranges [\c inFirst, \c inMiddle) and [\c inMiddle, \c inLast) into \c outResult by moving their elements, and return the end of the merged range.
+		
+		The merge is stable: equal elements of the first range come first. Unlike std::merge on move iterators, this function does not depend on the parallel mode of the standard library (_GLIBCXX_PARALLEL).
+		*/
+		template <class InIterator, class OutIterator, class Compare>
+		OutIterator moveMerge(InIterator inFirst, InIterator inMiddle, InIterator inLast, OutIterator outResult, Compare inCompare)
+		{
+			InIterator lSecond = inMiddle;
+			while(inFirst != inMiddle && lSecond != inLast) {
+				if(inCompare(*lSecond, *inFirst)) *outResult++ = std::move(*lSecond++);
+				else *outResult++ = std::move(*inFirst++);
+			}
+			for(; inFirst != inMiddle; ++inFirst) *outResult++ = std::move(*inFirst);
+			for(; lSecond != inLast; ++lSecond) *outResult++ = std::move(*lSecond);
+			return outResult;
+		}
+		
+		/*! \brief Sort range [\c inBegin, \c inEnd) with comparison \c inCompare, using thread pool \c ioPool.
+		
+		The range is cut into blocks that are sorted in parallel, and the sorted blocks are then merged pairwise, in parallel rounds that alternate between the range and a buffer. The sort is stable. Ranges of less than 8192 elements are sorted in the calling thread. As for std::stable_sort, the elements only need to be move constructible and move assignable: the buffer is move constructed from the sorted blocks.
+		*/
+		template <class Iterator, class Compare>
+		void parallelSort(ThreadPool& ioPool, Iterator inBegin, Iterator inEnd, Compare inCompare)
+		{
+			typedef typename iterator_traits<Iterator>::value_type Value;
+			const size_t lSize = inEnd - inBegin;
+			const size_t lMinBlock = 4096;
+			if(lSize < 2*lMinBlock || ioPool.empty()) {
+				sequentialSort(inBegin, inEnd, inCompare);
+				return;
+			}
+			const size_t lBlocks = min<size_t>(4*(ioPool.getSlaves()+1), lSize/lMinBlock);
+			const size_t lWidth = (lSize+lBlocks-1)/lBlocks;
+			parallelFor(ioPool, size_t(0), lBlocks, 1, [&](size_t inBlock) {
+				sequentialSort(inBegin + min(inBlock*lWidth, lSize), inBegin + min((inBlock+1)*lWidth, lSize), inCompare);
+			});
+			// the sorted blocks are moved into the buffer, so that the first merge round goes back to the range
+			vector<Value> lBuffer(make_move_iterator(inBegin), make_move_iterator(inEnd));
+			bool lInBuffer = true;
+			for(size_t lRun = lWidth; lRun < lSize; lRun *= 2) {
+				// merge pairs of sorted runs from the source into the destination
+				parallelFor(ioPool, size_t(0), (lSize+2*lRun-1)/(2*lRun), 1, [&](size_t inPair) {
+					const size_t lLow = inPair*2*lRun, lMiddle = min(lLow+lRun, lSize), lHigh = min(lLow+2*lRun, lSize);
+					if(lInBuffer) moveMerge(lBuffer.begin()+lLow, lBuffer.begin()+lMiddle, lBuffer.begin()+lHigh, inBegin+lLow, inCompare);
+					else moveMerge(inBegin+lLow, inBegin+lMiddle, inBegin+lHigh, lBuffer.begin()+lLow, inCompare);
+				});
+				lInBuffer = !lInBuffer;
+			}
+			if(lInBuffer) parallelFor(ioPool, size_t(0), lSize, [&](size_t i) {inBegin[i] = std::move(lBuffer[i]);});
+		}
+		
+		//! Sort range [\c inBegin, \c inEnd) in increasing order, using thread pool \c ioPool (see the other overload).
+		template <class Iterator>
+		void parallelSort(ThreadPool& ioPool, Iterator inBegin, Iterator inEnd)
+		{
+			parallelSort(ioPool, inBegin, inEnd, less<typename iterator_traits<Iterator>::value_type>());
+		}
+		
+	} // end of Threading namespace
+	
+} // end of PACC namespace
+
+#endif // PACC_Threading_Algorithm_hpp_
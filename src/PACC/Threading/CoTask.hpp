@@ -0,0 +1,434 @@
+/*
+ *  Portable Agile C++ Classes (PACC)
+ *  Copyright (C) 2001-2003 by Marc Parizeau
+ *  http://manitou.gel.ulaval.ca/~parizeau/PACC
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *  Contact:
+ *  Laboratoire de Vision et Systemes Numeriques
+ *  Departement de genie electrique et de genie informatique
+ *  Universite Laval, Quebec, Canada, G1K 7P4
+ *  http://vision.gel.ulaval.ca
+ *
+ */
+
+/*!
+ * \file PACC/Threading/CoTask.hpp
+ * \brief Class definition for the coroutine task.
+ * \author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+ */
+
+#ifndef PACC_Threading_CoTask_hpp_
+#define PACC_Threading_CoTask_hpp_
+
+#include "PACC/Threading/Future.hpp"
+#include "PACC/Threading/LightTask.hpp"
+#include "PACC/Threading/ThreadPool.hpp"
+#include "PACC/Util/Assert.hpp"
+
+// Coroutines are only available to C++20 compilers (the library itself does not need them)
+#if defined(__cpp_impl_coroutine) && defined(__has_include)
+#if __has_include(<coroutine>)
+#define PACC_THREADS_COROUTINES
+#endif
+#endif
+
+#ifdef PACC_THREADS_COROUTINES
+#include <coroutine>
+#include <exception>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace PACC {
+	
+	using namespace std;
+	
+	namespace Threading {
+		
+		template <class T> class CoTask;
+		
+		/*! \brief %Task that resumes a suspended coroutine.
+		\author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+		\ingroup Threading
+		
+		This task is allocated by the awaiters of coroutines, is pushed onto a thread pool when the awaited event happens, and is deleted by its slave thread after completion.
+		*/
+		class ResumeTask : public LightTask {
+			public:
+			//! Construct task that resumes coroutine \c inHandle.
+			explicit ResumeTask(coroutine_handle<> inHandle) : mHandle(inHandle) {mAutoDelete = true;}
+			
+			//! Resume coroutine until its next suspension.
+			void main(void) {mHandle.resume();}
+			
+			protected:
+			coroutine_handle<> mHandle; //!< Coroutine to resume.
+		};
+		
+		/*! \brief Promise of a coroutine task, without its result.
+		\author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+		\ingroup Threading
+		
+		A coroutine task is lazy: it is suspended at creation, and starts when it is awaited or started on a thread pool (see CoTask). At completion, it transfers control to the coroutine that awaits it, without going through the thread pool.
+		*/
+		class CoPromiseBase {
+			public:
+			//! Awaiter of the final suspension: resume the awaiting coroutine, if any.
+			struct FinalAwaiter {
+				//! Always suspend, so that the awaiting coroutine can read the result before destroying this one.
+				bool await_ready(void) const noexcept {return false;}
+				//! Transfer control to the awaiting coroutine.
+				template <class Promise>
+				coroutine_handle<> await_suspend(coroutine_handle<Promise> inHandle) noexcept {
+					coroutine_handle<> lContinuation = inHandle.promise().mContinuation;
+					return lContinuation ? lContinuation : noop_coroutine();
+				}
+				//! Never called, as the coroutine is never resumed after its final suspension.
+				void await_resume(void) const noexcept {}
+			};
+			
+			//! Suspend coroutine at completion (see CoPromiseBase::FinalAwaiter).
+			FinalAwaiter final_suspend(void) const noexcept {return FinalAwaiter();}
+			//! Suspend coroutine at creation.
+			suspend_always initial_suspend(void) const noexcept {return suspend_always();}
+			//! Store the exception that escapes the coroutine body.
+			void unhandled_exception(void) {mException = current_exception();}
+			
+			coroutine_handle<> mContinuation; //!< Coroutine that awaits this one.
+			exception_ptr mException; //!< Exception thrown by the coroutine body.
+		};
+		
+		/*! \brief Promise of a coroutine task of type \c T.
+		\author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+		\ingroup Threading
+		
+		The result is constructed in place by \c co_return, so that type \c T does not need a default constructor.
+		*/
+		template <class T>
+		class CoPromise : public CoPromiseBase {
+			public:
+			//! Construct promise without result.
+			CoPromise(void) : mHasValue(false) {}
+			//! Delete promise and its result.
+			~CoPromise(void) {if(mHasValue) getPointer()->~T();}
+			
+			CoTask<T> get_return_object(void);
+			
+			//! Move the result out of this promise; rethrow the exception of the coroutine, if any.
+			T getValue(void) {
+				if(mException) rethrow_exception(mException);
+				return std::move(*getPointer());
+			}
+			
+			//! Store result \c inValue of \c co_return.
+			template <class U>
+			void return_value(U&& inValue) {
+				new(mStorage) T(std::forward<U>(inValue));
+				mHasValue = true;
+			}
+			
+			protected:
+			alignas(T) unsigned char mStorage[sizeof(T)]; //!< Storage of the result.
+			bool mHasValue; //!< Result has been constructed.
+			
+			//! Return pointer to the result.
+			T* getPointer(void) {return reinterpret_cast<T*>(mStorage);}
+		};
+		
+		//! Promise of a coroutine task without result.
+		template <>
+		class CoPromise<void> : public CoPromiseBase {
+			public:
+			CoTask<void> get_return_object(void);
+			
+			//! Rethrow the exception of the coroutine, if any.
+			void getValue(void) {if(mException) rethrow_exception(mException);}
+			
+			//! Complete \c co_return without value.
+			void return_void(void) {}
+		};
+		
+		/*! \brief Coroutine started on a thread pool, that deletes itself at completion.
+		\ingroup Threading
+		
+		This type is internal to CoTask::start.
+		*/
+		struct CoDetached {
+			//! Promise of a detached coroutine.
+			struct promise_type {
+				//! Return the detached coroutine.
+				CoDetached get_return_object(void) {return CoDetached(coroutine_handle<promise_type>::from_promise(*this));}
+				//! Suspend coroutine at creation, until it is pushed onto its thread pool.
+				suspend_always initial_suspend(void) const noexcept {return suspend_always();}
+				//! Delete coroutine at completion.
+				suspend_never final_suspend(void) const noexcept {return suspend_never();}
+				//! Complete coroutine without value.
+				void return_void(void) {}
+				//! Never called, as CoTask::start catches all exceptions.
+				void unhandled_exception(void) {terminate();}
+			};
+			
+			//! Construct detached coroutine \c inHandle.
+			explicit CoDetached(coroutine_handle<promise_type> inHandle) : mHandle(inHandle) {}
+			
+			coroutine_handle<promise_type> mHandle; //!< Suspended coroutine.
+		};
+		
+		/*! \brief Coroutine task for thread pool execution.
+		\author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+		\ingroup Threading
+		
+		A coroutine task is the result of a coroutine: a function that uses \c co_await or \c co_return. Unlike a Task, a coroutine does not block its slave thread while it waits: it is suspended at each \c co_await that is not ready, and is resumed later by a slave thread of the pool, so that a small pool can serve thousands of concurrent coroutines. The following expressions can be awaited:
+		- another coroutine task, which then runs in the same slave thread, and returns its result (or rethrows its exception);
+		- a Future, whose result is returned when available (the coroutine is resumed by the thread pool of the future);
+		- the readiness of a descriptor, or a delay, using a Reactor (see Reactor::readable, Reactor::writable and Reactor::delay);
+		- the completion of an existing task, run by a thread pool (see function runTask);
+		- a thread pool itself, on which the coroutine continues (see function resumeOn).
+		
+		A coroutine task is lazy: it starts when it is awaited, or when method CoTask::start pushes it onto a thread pool, which returns a Future of its result. Coroutine tasks are movable but not copyable handles; a task that was neither awaited nor started is destroyed with its handle. Coroutines require a C++20 compiler; with an older compiler, this header defines nothing, and macro \c PACC_THREADS_COROUTINES is undefined.
+		
+		Here is a simple usage example, where each conversation waits for its socket without blocking a slave thread:
+		\code
+CoTask<void> converse(Reactor& ioReactor, Socket::Cafe& ioCafe) {
+	string lMessage;
+	for(;;) {
+		co_await ioReactor.readable(ioCafe.getDescriptor());
+		if(!ioCafe.receiveMessage(lMessage)) break;
+		ioCafe.sendMessage(co_await answer(lMessage));
+	}
+}
+...
+ThreadPool lPool(4);
+Reactor lReactor(lPool);
+vector<Future<void> > lConversations;
+for(unsigned int i = 0; i < lCafes.size(); ++i) lConversations.push_back(converse(lReactor, *lCafes[i]).start(lPool));
+		\endcode
+		*/
+		template <class T=void>
+		class CoTask {
+			public:
+			typedef CoPromise<T> promise_type; //!< Promise type of the coroutine.
+			
+			/*! \brief Awaiter of a coroutine task.
+			
+			The awaiting coroutine is suspended, and the awaited task runs immediately in the same thread; the awaiting coroutine is resumed when the task completes.
+			*/
+			class Awaiter {
+				public:
+				//! Construct awaiter of coroutine \c inHandle.
+				explicit Awaiter(coroutine_handle<promise_type> inHandle) : mHandle(inHandle) {}
+				//! Return whether the task is already completed.
+				bool await_ready(void) const noexcept {return mHandle.done();}
+				//! Run the task, which resumes coroutine \c inHandle at completion.
+				coroutine_handle<> await_suspend(coroutine_handle<> inHandle) noexcept {
+					mHandle.promise().mContinuation = inHandle;
+					return mHandle;
+				}
+				//! Return the result of the task, or rethrow its exception.
+				T await_resume(void) {return mHandle.promise().getValue();}
+				
+				protected:
+				coroutine_handle<promise_type> mHandle; //!< Awaited coroutine.
+			};
+			
+			//! Construct invalid task (see CoTask::isValid).
+			CoTask(void) {}
+			//! Construct task of coroutine \c inHandle.
+			explicit CoTask(coroutine_handle<promise_type> inHandle) : mHandle(inHandle) {}
+			//! Move task \c ioTask, which becomes invalid.
+			CoTask(CoTask&& ioTask) noexcept : mHandle(ioTask.mHandle) {ioTask.mHandle = nullptr;}
+			//! Destroy coroutine.
+			~CoTask(void) {if(mHandle) mHandle.destroy();}
+			
+			//! Move task \c ioTask, which becomes invalid.
+			CoTask& operator=(CoTask&& ioTask) noexcept {
+				if(this != &ioTask) {
+					if(mHandle) mHandle.destroy();
+					mHandle = ioTask.mHandle;
+					ioTask.mHandle = nullptr;
+				}
+				return *this;
+			}
+			
+			//! Return awaiter of this task.
+			Awaiter operator co_await(void) {
+				PACC_AssertM(mHandle, "CoTask::operator co_await() invalid task!");
+				return Awaiter(mHandle);
+			}
+			
+			//! Return whether this task is completed.
+			bool isCompleted(void) const {return mHandle && mHandle.done();}
+			
+			//! Return whether this task refers to a coroutine.
+			bool isValid(void) const {return (bool) mHandle;}
+			
+			/*! \brief Start this task on thread pool \c inPool, and return a future of its result.
+			
+			The task is pushed onto \c inPool, and becomes invalid: its coroutine is deleted at completion, after its result (or exception) is stored into the returned future.
+			*/
+			Future<T> start(ThreadPool& inPool) {
+				PACC_AssertM(mHandle, "CoTask::start() invalid task!");
+				shared_ptr<FutureValue<T> > lState(new FutureValue<T>(&inPool));
+				CoDetached lDriver = drive(std::move(*this), lState);
+				inPool.push(*new ResumeTask(lDriver.mHandle));
+				return Future<T>(lState);
+			}
+			
+			protected:
+			coroutine_handle<promise_type> mHandle; //!< Coroutine of task.
+			
+			//! Await task \c inTask, store its result (or exception) into \c ioState, and complete it.
+			static CoDetached drive(CoTask inTask, shared_ptr<FutureValue<T> > ioState) {
+				try {
+					if constexpr (is_void<T>::value) co_await inTask;
+					else ioState->storeValue(co_await inTask);
+				}
+				catch(...) {ioState->storeException(current_exception());}
+				ioState->complete();
+			}
+			
+			private:
+			//! restrict (disable) copy constructor.
+			CoTask(const CoTask&);
+			//! restrict (disable) assignment operator.
+			void operator=(const CoTask&);
+		};
+		
+		//! Return task of this coroutine.
+		template <class T>
+		CoTask<T> CoPromise<T>::get_return_object(void)
+		{
+			return CoTask<T>(coroutine_handle<CoPromise<T> >::from_promise(*this));
+		}
+		
+		//! Return task of this coroutine.
+		inline CoTask<void> CoPromise<void>::get_return_object(void)
+		{
+			return CoTask<void>(coroutine_handle<CoPromise<void> >::from_promise(*this));
+		}
+		
+		/*! \brief Awaiter of a future.
+		\author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+		\ingroup Threading
+		
+		The awaiting coroutine is resumed by the thread pool of the future, as a continuation (see Future::then), when the result becomes available.
+		*/
+		template <class T>
+		class FutureAwaiter {
+			public:
+			//! Construct awaiter of future \c inFuture.
+			explicit FutureAwaiter(const Future<T>& inFuture) : mState(inFuture.mState) {
+				PACC_AssertM(mState, "FutureAwaiter() invalid future!");
+			}
+			//! Return whether the result (or exception) is available.
+			bool await_ready(void) const {return mState->isReady();}
+			//! Resume coroutine \c inHandle when the result becomes available.
+			void await_suspend(coroutine_handle<> inHandle) {mState->addContinuation(*mState->getPool(), new ResumeTask(inHandle));}
+			//! Return the result, or rethrow the exception of the task.
+			typename FutureValue<T>::Reference await_resume(void) const {return mState->getValue();}
+			
+			protected:
+			shared_ptr<FutureValue<T> > mState; //!< Shared state of the future.
+		};
+		
+		//! Return awaiter of future \c inFuture.
+		template <class T>
+		FutureAwaiter<T> operator co_await(const Future<T>& inFuture) {return FutureAwaiter<T>(inFuture);}
+		
+		/*! \brief Awaiter of a thread pool.
+		\ingroup Threading
+		
+		The awaiting coroutine is pushed onto the thread pool, where it continues (see function resumeOn).
+		*/
+		class PoolAwaiter {
+			public:
+			//! Construct awaiter of thread pool \c inPool.
+			explicit PoolAwaiter(ThreadPool& inPool) : mPool(inPool) {}
+			//! Always suspend.
+			bool await_ready(void) const noexcept {return false;}
+			//! Push coroutine \c inHandle onto the thread pool.
+			void await_suspend(coroutine_handle<> inHandle) {mPool.push(*new ResumeTask(inHandle));}
+			//! Continue on a slave thread of the pool.
+			void await_resume(void) const noexcept {}
+			
+			protected:
+			ThreadPool& mPool; //!< Thread pool on which to continue.
+		};
+		
+		//! Return awaiter that continues the awaiting coroutine on a slave thread of pool \c inPool (for instance, to yield to the other tasks).
+		inline PoolAwaiter resumeOn(ThreadPool& inPool) {return PoolAwaiter(inPool);}
+		
+		/*! \brief Awaiter of an existing task.
+		\author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+		\ingroup Threading
+		
+		This adapter runs an existing task (for instance, a subclass of Task) on a thread pool, and resumes the awaiting coroutine in the same slave thread when the task completes (see function runTask). The task is not queued itself: an internal task of the pool calls its main procedure, and marks it as running and completed, so that LightTask::wait and LightTask::isCompleted behave as if the task was pushed onto the pool. An exception thrown by the main procedure of the task is rethrown into the awaiting coroutine. The task must not be pending when it is awaited.
+		*/
+		class TaskAwaiter {
+			public:
+			//! Construct awaiter of task \c inTask, to run on thread pool \c inPool.
+			TaskAwaiter(ThreadPool& inPool, LightTask& inTask) : mPool(inPool), mTask(inTask) {}
+			//! Always suspend.
+			bool await_ready(void) const noexcept {return false;}
+			//! Push the task onto the thread pool, and resume coroutine \c inHandle at its completion.
+			void await_suspend(coroutine_handle<> inHandle) {
+				PACC_AssertM(!mTask.isPending(), "TaskAwaiter::await_suspend() task is pending!");
+				mHandle = inHandle;
+				mTask.reset();
+				mPool.push(*new Adapter(*this));
+			}
+			//! Rethrow the exception of the task, if any.
+			void await_resume(void) const {if(mException) rethrow_exception(mException);}
+			
+			protected:
+			//! Internal task of the pool that runs the awaited task.
+			class Adapter : public LightTask {
+				public:
+				//! Construct task that runs the task of awaiter \c inAwaiter.
+				explicit Adapter(TaskAwaiter& inAwaiter) : mAwaiter(inAwaiter) {mAutoDelete = true;}
+				//! Run the awaited task, and resume the awaiting coroutine.
+				void main(void) {mAwaiter.execute();}
+				protected:
+				TaskAwaiter& mAwaiter; //!< Awaiter of the task.
+			};
+			
+			ThreadPool& mPool; //!< Thread pool of the task.
+			LightTask& mTask; //!< Awaited task.
+			coroutine_handle<> mHandle; //!< Awaiting coroutine.
+			exception_ptr mException; //!< Exception thrown by the task.
+			
+			//! Run the task, and resume the awaiting coroutine (the awaiter lives in the coroutine frame, until it is resumed).
+			void execute(void) {
+				mTask.start();
+				try {mTask.main();}
+				catch(...) {mException = current_exception();}
+				mTask.complete();
+				mHandle.resume();
+			}
+		};
+		
+		//! Return awaiter that runs task \c ioTask on thread pool \c inPool (see TaskAwaiter).
+		inline TaskAwaiter runTask(ThreadPool& inPool, LightTask& ioTask) {return TaskAwaiter(inPool, ioTask);}
+		
+	} // end of Threading namespace
+	
+} // end of PACC namespace
+
+#endif // PACC_THREADS_COROUTINES
+
+#endif // PACC_Threading_CoTask_hpp_
@@ -54,19 +54,24 @@ typedef struct {
 #else
 #include <pthread.h>
 #include <sys/errno.h>
-#include <sys/time.h>
+#include <time.h>
 #include <math.h>
+// Timed waits use the monotonic clock, except under MacOS X, which waits for a relative time instead
+#ifndef __APPLE__
+#define PACC_THREADS_MONOTONIC
+#endif
 #endif
 
 using namespace PACC;
 
-/*! \brief Allocate native structure and create condition. 
+/*! \brief Create condition in its embedded native structure. 
 
-Any error raises a Threading::Exception.
+Under Unix, the condition measures its time outs with the monotonic clock, so that they are not affected by changes of the time of day. Any error raises a Threading::Exception.
 */
 Threading::Condition::Condition(void)
 {
-	pthread_cond_t* lCondition = new pthread_cond_t;
+	static_assert(sizeof(pthread_cond_t) <= sizeof(mCondition) && alignof(pthread_cond_t) <= 16, "Condition::mCondition is too small for the native condition");
+	pthread_cond_t* lCondition = reinterpret_cast<pthread_cond_t*>(mCondition);
 #ifdef PACC_THREADS_WIN32
 	lCondition->mWaiters = 0;
 	lCondition->mBroadcast = false;
@@ -75,16 +80,22 @@ Threading::Condition::Condition(void)
 	lCondition->mDone = ::CreateEvent(0, false, false, 0);
 	if(lCondition->mSemaphore == 0 || lCondition->mDone == 0)
 #else
-		if(::pthread_cond_init(lCondition, 0) != 0)
+	pthread_condattr_t lAttributes;
+	bool lError = ::pthread_condattr_init(&lAttributes) != 0;
+#ifdef PACC_THREADS_MONOTONIC
+	lError = lError || ::pthread_condattr_setclock(&lAttributes, CLOCK_MONOTONIC) != 0;
 #endif
-			throw Exception(eOtherError, "Threading::Condition() can't create!");
-	mCondition = lCondition;
+	lError = lError || ::pthread_cond_init(lCondition, &lAttributes) != 0;
+	::pthread_condattr_destroy(&lAttributes);
+	if(lError)
+#endif
+		throw Exception(eOtherError, "Threading::Condition() can't create!");
 }
 
-//! Destroy condition and free allocated native structure.
+//! Destroy condition.
 Threading::Condition::~Condition(void)
 {
-	pthread_cond_t* lCondition = (pthread_cond_t*) mCondition;
+	pthread_cond_t* lCondition = reinterpret_cast<pthread_cond_t*>(mCondition);
 #ifdef PACC_THREADS_WIN32
 	::DeleteCriticalSection(&lCondition->mLock);
 	while(::CloseHandle(lCondition->mSemaphore) == 0) broadcast();
@@ -92,8 +103,6 @@ Threading::Condition::~Condition(void)
 #else
 	while(::pthread_cond_destroy(lCondition) == EBUSY) broadcast();
 #endif
-	delete lCondition;
-	mCondition = 0;
 }
 
 /*! \brief Broadcast a wake up signal to all waiting threads.
@@ -112,7 +121,7 @@ Any error raises a Threading::Exception.
 */
 void Threading::Condition::broadcast(void) const
 {
-	pthread_cond_t* lCondition = (pthread_cond_t*) mCondition;
+	pthread_cond_t* lCondition = reinterpret_cast<pthread_cond_t*>(mCondition);
 #ifdef PACC_THREADS_WIN32
 	EnterCriticalSection(&lCondition->mLock);
 	if(lCondition->mWaiters > 0) {
@@ -155,7 +164,7 @@ Any error raises a Threading::Exception.
 */
 void Threading::Condition::signal(void) const
 {
-	pthread_cond_t* lCondition = (pthread_cond_t*) mCondition;
+	pthread_cond_t* lCondition = reinterpret_cast<pthread_cond_t*>(mCondition);
 #ifdef PACC_THREADS_WIN32
 	EnterCriticalSection(&lCondition->mLock);
 	int lWaiters = lCondition->mWaiters;
@@ -174,7 +183,7 @@ void Threading::Condition::signal(void) const
 /*! \brief Wait up to \c inMaxTime seconds for the condition to be signaled (or broadcasted). 
 \return True if condition was signaled (or broadcasted), false if timed out.
 
-This method assumes that the embedded mutex has already been locked by the calling thread (using method Condition::lock), and will also return with the mutex locked. A negative or null time out (default) means that the method should wait indefinitely.
+This method assumes that the embedded mutex has already been locked by the calling thread (using method Condition::lock), and will also return with the mutex locked. A negative or null time out (default) means that the method should wait indefinitely. Under Unix, the time out is measured with the monotonic clock, and is thus not affected by changes of the time of day.
 
 Here is an example of typical usage:
 \code
@@ -196,14 +205,14 @@ Any error raises a Threading::Exception.
 bool Threading::Condition::wait(double inMaxTime) const
 {
 	bool lReturn;
-	pthread_cond_t* lCondition = (pthread_cond_t*) mCondition;
+	pthread_cond_t* lCondition = reinterpret_cast<pthread_cond_t*>(mCondition);
 #ifdef PACC_THREADS_WIN32
 	EnterCriticalSection(&lCondition->mLock);
 	// increment number of waiters
 	lCondition->mWaiters += 1;
 	LeaveCriticalSection(&lCondition->mLock);
 	// wait for the semaphore after atomically unlocking the mutex
-	HANDLE* lMutex = (HANDLE*) mMutex;
+	HANDLE* lMutex = reinterpret_cast<HANDLE*>(mMutex);
 	DWORD lRes = ::SignalObjectAndWait(*lMutex, lCondition->mSemaphore, (inMaxTime <= 0 ? INFINITE : (DWORD)(inMaxTime*1000)), false);
 	if((lReturn = (lRes != WAIT_TIMEOUT)) && lRes != WAIT_OBJECT_0) {
 		unlock();
@@ -229,14 +238,18 @@ bool Threading::Condition::wait(double inMaxTime) const
 #else
 	int lRes;
 	// pthread_cond_wait atomically unlocks the mutex, waits on the condition, and locks the mutex again
-	if(inMaxTime <= 0) lRes = ::pthread_cond_wait(lCondition, (pthread_mutex_t*)mMutex);
+	if(inMaxTime <= 0) lRes = ::pthread_cond_wait(lCondition, reinterpret_cast<pthread_mutex_t*>(mMutex));
 	else {
-		// get time of day and add specified time out
-		struct timeval lVal;
-		::gettimeofday(&lVal, 0);
 		struct timespec lSpec;
-		lSpec.tv_sec = lVal.tv_sec + (long) inMaxTime;
-		lSpec.tv_nsec = lVal.tv_usec*1000 + (long) ((inMaxTime - floor(inMaxTime)) * 1000000000);
+#ifdef PACC_THREADS_MONOTONIC
+		// get monotonic time and add specified time out
+		::clock_gettime(CLOCK_MONOTONIC, &lSpec);
+#else
+		lSpec.tv_sec = 0;
+		lSpec.tv_nsec = 0;
+#endif
+		lSpec.tv_sec += (time_t) inMaxTime;
+		lSpec.tv_nsec += (long) ((inMaxTime - floor(inMaxTime)) * 1000000000);
 		// check that the number of nanoseconds is less than 1 sec
 		if(lSpec.tv_nsec >= 1000000000)
 		{
@@ -245,7 +258,11 @@ bool Threading::Condition::wait(double inMaxTime) const
 			lSpec.tv_sec += 1;
 		}
 		// pthread_cond_timedwait atomically unlocks the mutex, waits on the condition, and locks the mutex again
-		lRes = ::pthread_cond_timedwait(lCondition, (pthread_mutex_t*)mMutex, &lSpec);
+#ifdef PACC_THREADS_MONOTONIC
+		lRes = ::pthread_cond_timedwait(lCondition, reinterpret_cast<pthread_mutex_t*>(mMutex), &lSpec);
+#else
+		lRes = ::pthread_cond_timedwait_relative_np(lCondition, reinterpret_cast<pthread_mutex_t*>(mMutex), &lSpec);
+#endif
 	}
 	if((lReturn = (lRes != ETIMEDOUT)) && lRes != 0)
 	{
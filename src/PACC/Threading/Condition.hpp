@@ -60,7 +60,8 @@ namespace PACC {
 			bool wait(double inMaxTime=0) const;
 			
 			protected:
-			void* mCondition; //!< Opaque structure of native condition
+			//! Opaque storage of native condition (large enough for a pthread_cond_t, or the Windows emulation of Condition.cpp).
+			alignas(16) mutable unsigned char mCondition[96];
 			
 			private:
 			//! restrict (disable) copy constructor.
@@ -0,0 +1,134 @@
+/*
+ *  Portable Agile C++ Classes (PACC)
+ *  Copyright (C) 2001-2003 by Marc Parizeau
+ *  http://manitou.gel.ulaval.ca/~parizeau/PACC
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *  Contact:
+ *  Laboratoire de Vision et Systemes Numeriques
+ *  Departement de genie electrique et de genie informatique
+ *  Universite Laval, Quebec, Canada, G1K 7P4
+ *  http://vision.gel.ulaval.ca
+ *
+ */
+
+/*!
+ * \file PACC/Threading/EventCount.cpp
+ * \brief Class methods for the event count.
+ * \author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+ */
+
+#include "PACC/Threading/EventCount.hpp"
+#include <algorithm>
+#include <chrono>
+
+#ifdef PACC_THREADS_FUTEX
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+using namespace PACC;
+
+/*!
+Sleep until a notification changes the epoch from key \c inKey (see EventCount::prepareWait), or for at most \c inMaxTime seconds if positive. Returns immediately if a notification was made since the call to prepareWait. Returns false if the wait timed out without notification.
+*/
+bool Threading::EventCount::wait(Key inKey, double inMaxTime)
+{
+	const chrono::steady_clock::time_point lEnd = chrono::steady_clock::now() + chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(max(inMaxTime, 0.)));
+	// the sleepers are counted before checking the epoch, and the epoch is changed before checking the sleepers (see EventCount::wake)
+	mSleepers.fetch_add(1, memory_order_seq_cst);
+#ifdef PACC_THREADS_FUTEX
+	while(mEpoch.load(memory_order_seq_cst) == inKey) {
+		struct timespec lSpec, *lTimeout = 0;
+		if(inMaxTime > 0) {
+			const double lLeft = chrono::duration<double>(lEnd - chrono::steady_clock::now()).count();
+			if(lLeft <= 0) break;
+			lSpec.tv_sec = (time_t) lLeft;
+			lSpec.tv_nsec = (long) ((lLeft - lSpec.tv_sec) * 1000000000);
+			lTimeout = &lSpec;
+		}
+		// a wake up that leaves the epoch unchanged was meant for another sleeper, so give it back before sleeping again
+		if(::syscall(SYS_futex, (unsigned int*) &mEpoch, FUTEX_WAIT_PRIVATE, inKey, lTimeout, 0, 0) == 0 && mEpoch.load(memory_order_seq_cst) == inKey) release(1);
+	}
+#else
+	mCondition.lock();
+	while(mEpoch.load(memory_order_seq_cst) == inKey) {
+		if(inMaxTime <= 0) mCondition.wait();
+		else {
+			const double lLeft = chrono::duration<double>(lEnd - chrono::steady_clock::now()).count();
+			if(lLeft <= 0) break;
+			mCondition.wait(lLeft);
+		}
+	}
+	mCondition.unlock();
+#endif
+	// remove this sleeper, and one of the awakened sleepers if notified (no thread was awakened since the epoch of a timed out wait)
+	const bool lNotified = mEpoch.load(memory_order_seq_cst) != inKey;
+	unsigned long long lSleepers = mSleepers.load(memory_order_relaxed);
+	unsigned long long lNew;
+	do {
+		lNew = lSleepers - 1;
+		if(lNotified && (lNew >> 32) > 0) lNew -= 1ull << 32;
+	} while(!mSleepers.compare_exchange_weak(lSleepers, lNew, memory_order_seq_cst, memory_order_relaxed));
+	mWaiters.fetch_sub(1, memory_order_seq_cst);
+	return lNotified;
+}
+
+/*!
+Give back \c inWakes wake ups that did not reach a thread which will see a new epoch, so that the next notification makes its system call again.
+*/
+void Threading::EventCount::release(unsigned long long inWakes)
+{
+	unsigned long long lSleepers = mSleepers.load(memory_order_relaxed);
+	unsigned long long lNew;
+	do {
+		const unsigned long long lAwakened = lSleepers >> 32;
+		if(lAwakened == 0) return;
+		lNew = ((lAwakened - min(inWakes, lAwakened)) << 32) | (lSleepers & 0xFFFFFFFFull);
+	} while(!mSleepers.compare_exchange_weak(lSleepers, lNew, memory_order_seq_cst, memory_order_relaxed));
+}
+
+/*!
+Start a new epoch, so that no waiting thread goes to sleep, and wake up to \c inCount sleeping threads (all of them for UINT_MAX). 
+
+Under Linux, the system call is skipped if all sleeping threads were already awakened. The wake ups that find no sleeping thread are given back, as the counted thread may have prepared its wait after the new epoch, and then go to sleep.
+*/
+void Threading::EventCount::wake(unsigned int inCount)
+{
+	mEpoch.fetch_add(1, memory_order_seq_cst);
+#ifdef PACC_THREADS_FUTEX
+	unsigned long long lSleepers = mSleepers.load(memory_order_seq_cst);
+	unsigned long long lNew, lWakes;
+	do {
+		const unsigned long long lCount = lSleepers & 0xFFFFFFFFull, lAwakened = lSleepers >> 32;
+		if(lAwakened >= lCount) return;
+		lWakes = min<unsigned long long>(inCount, lCount-lAwakened);
+		lNew = ((lAwakened+lWakes) << 32) | lCount;
+	} while(!mSleepers.compare_exchange_weak(lSleepers, lNew, memory_order_seq_cst, memory_order_seq_cst));
+	long lWoken = ::syscall(SYS_futex, (unsigned int*) &mEpoch, FUTEX_WAKE_PRIVATE, inCount == UINT_MAX ? INT_MAX : int(lWakes), 0, 0, 0);
+	if(lWoken < 0) lWoken = 0;
+	if((unsigned long long) lWoken < lWakes) release(lWakes-lWoken);
+#else
+	if((mSleepers.load(memory_order_seq_cst) & 0xFFFFFFFFull) == 0) return;
+	mCondition.lock();
+	if(inCount > 1) mCondition.broadcast();
+	else mCondition.signal();
+	mCondition.unlock();
+#endif
+}
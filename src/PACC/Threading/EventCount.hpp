@@ -0,0 +1,133 @@
+/*
+ *  Portable Agile C++ Classes (PACC)
+ *  Copyright (C) 2001-2003 by Marc Parizeau
+ *  http://manitou.gel.ulaval.ca/~parizeau/PACC
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *  Contact:
+ *  Laboratoire de Vision et Systemes Numeriques
+ *  Departement de genie electrique et de genie informatique
+ *  Universite Laval, Quebec, Canada, G1K 7P4
+ *  http://vision.gel.ulaval.ca
+ *
+ */
+
+/*!
+ * \file PACC/Threading/EventCount.hpp
+ * \brief Class definition for the event count.
+ * \author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+ */
+
+#ifndef PACC_Threading_EventCount_hpp_
+#define PACC_Threading_EventCount_hpp_
+
+#include <atomic>
+#include <climits>
+
+// Waiting threads park on a futex under Linux, and on a condition elsewhere
+#if defined(__linux__)
+#define PACC_THREADS_FUTEX
+#else
+#include "PACC/Threading/Condition.hpp"
+#endif
+
+namespace PACC {
+	
+	using namespace std;
+	
+	namespace Threading {
+		
+		/*! \brief %Event count for lock-free waiting.
+		\author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+		\ingroup Threading
+		
+		An event count lets threads sleep until a lock-free condition becomes true, without a mutex around the condition. A waiting thread first calls EventCount::prepareWait, then checks its condition again, and either calls EventCount::cancelWait if the condition is now true, or EventCount::wait with the key returned by prepareWait otherwise. A notifying thread first makes its condition true, and then calls EventCount::notify or EventCount::notifyAll. A notification that happens after prepareWait is never lost, and a notification without any waiting thread costs a single atomic load. A notification with waiting threads starts a new epoch, which prevents them from sleeping, but the futex system call (or the condition under other systems than Linux) is only used when a thread may actually be sleeping, and has not already been awakened by another notification.
+		
+		Here is an example of typical usage:
+		\code
+while(!lQueue.tryPop(lItem)) {
+	EventCount::Key lKey = lEvents.prepareWait();
+	if(!lQueue.isEmpty()) lEvents.cancelWait();
+	else lEvents.wait(lKey);
+}
+...
+lQueue.push(lItem);
+lEvents.notify();
+		\endcode
+		*/
+		class EventCount {
+		 public:
+			//! Key of a wait.
+			typedef unsigned int Key;
+			
+			//! Construct an event count without waiters.
+			EventCount(void) : mEpoch(0), mWaiters(0), mSleepers(0) {}
+			
+			//! Cancel a wait that was prepared by EventCount::prepareWait.
+			void cancelWait(void) {mWaiters.fetch_sub(1, memory_order_seq_cst);}
+			
+			//! Return the number of threads that are waiting or preparing to wait.
+			unsigned int getWaiters(void) const {return mWaiters.load(memory_order_seq_cst);}
+			
+			//! Wake up one waiting thread (the fence orders the change of condition before the check for waiters).
+			void notify(void) {
+				atomic_thread_fence(memory_order_seq_cst);
+				if(mWaiters.load(memory_order_relaxed) > 0) wake(1);
+			}
+			
+			//! Wake up to \c inCount waiting threads.
+			void notify(unsigned int inCount) {
+				atomic_thread_fence(memory_order_seq_cst);
+				if(inCount > 0 && mWaiters.load(memory_order_relaxed) > 0) wake(inCount);
+			}
+			
+			//! Wake up all waiting threads.
+			void notifyAll(void) {
+				atomic_thread_fence(memory_order_seq_cst);
+				if(mWaiters.load(memory_order_relaxed) > 0) wake(UINT_MAX);
+			}
+			
+			//! Prepare to wait; the condition must be checked again before calling EventCount::wait with the returned key.
+			Key prepareWait(void) {
+				mWaiters.fetch_add(1, memory_order_seq_cst);
+				return mEpoch.load(memory_order_seq_cst);
+			}
+			
+			bool wait(Key inKey, double inMaxTime=0);
+			
+		 protected:
+			atomic<unsigned int> mEpoch; //!< Number of notifications.
+			atomic<unsigned int> mWaiters; //!< Number of waiting threads.
+			atomic<unsigned long long> mSleepers; //!< Number of threads that may be sleeping (low 32 bits), and number of those that were already awakened (high 32 bits, futex only).
+#ifndef PACC_THREADS_FUTEX
+			Condition mCondition; //!< Condition of sleeping threads.
+#endif
+			
+			void release(unsigned long long inWakes);
+			void wake(unsigned int inCount);
+			
+		 private:
+			//! restrict (disable) copy constructor.
+			EventCount(const EventCount&);
+			//! restrict (disable) assignment operator.
+			void operator=(const EventCount&);
+		};
+		
+	} // end of Threading namespace
+	
+} // end of PACC namespace
+
+#endif // PACC_Threading_EventCount_hpp_
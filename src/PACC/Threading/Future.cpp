@@ -0,0 +1,120 @@
+/*
+ *  Portable Agile C++ Classes (PACC)
+ *  Copyright (C) 2001-2003 by Marc Parizeau
+ *  http://manitou.gel.ulaval.ca/~parizeau/PACC
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *  Contact:
+ *  Laboratoire de Vision et Systemes Numeriques
+ *  Departement de genie electrique et de genie informatique
+ *  Universite Laval, Quebec, Canada, G1K 7P4
+ *  http://vision.gel.ulaval.ca
+ *
+ */
+
+/*!
+ * \file PACC/Threading/Future.cpp
+ * \brief Class methods for the futures of thread pool tasks.
+ * \author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+ */
+
+#include "PACC/Threading/Future.hpp"
+#include "PACC/Threading/ThreadPool.hpp"
+#include <chrono>
+
+using namespace std;
+using namespace PACC;
+
+/*! \brief Push continuation task \c inTask onto thread pool \c inPool when the result becomes available.
+
+If the result is already available, the task is pushed immediately.
+*/
+void Threading::FutureState::addContinuation(ThreadPool& inPool, LightTask* inTask)
+{
+	lock();
+	if(!mReady) {
+		mContinuations.push_back(make_pair(&inPool, inTask));
+		unlock();
+		return;
+	}
+	unlock();
+	inPool.push(*inTask);
+}
+
+/*! \brief Mark the result as available, wake up the waiting threads, and push the continuation tasks.
+
+The continuation tasks are pushed after unlocking the embedded mutex, as their thread pool may run them (and add other continuations) immediately.
+*/
+void Threading::FutureState::complete(void)
+{
+	vector<pair<ThreadPool*, LightTask*> > lContinuations;
+	lock();
+	mReady = true;
+	lContinuations.swap(mContinuations);
+	broadcast();
+	unlock();
+	for(unsigned int i = 0; i < lContinuations.size(); ++i) lContinuations[i].first->push(*lContinuations[i].second);
+}
+
+//! Return whether the result (or exception) is available.
+bool Threading::FutureState::isReady(void) const
+{
+	lock();
+	bool lReady = mReady;
+	unlock();
+	return lReady;
+}
+
+//! Rethrow the exception of the task, if any. The result must be available.
+void Threading::FutureState::rethrow(void) const
+{
+	if(mException) rethrow_exception(mException);
+}
+
+//! Set exception \c inException as the result, and wake up the waiting threads.
+void Threading::FutureState::setException(exception_ptr inException)
+{
+	mException = inException;
+	complete();
+}
+
+//! Wait for the result (or exception) to become available.
+void Threading::FutureState::wait(void) const
+{
+	lock();
+	while(!mReady) Condition::wait();
+	unlock();
+}
+
+/*! \brief Wait up to \c inMaxTime seconds for the result (or exception) to become available.
+\return True if the result is available, false if timed out.
+
+A negative or null time out returns immediately.
+*/
+bool Threading::FutureState::waitFor(double inMaxTime) const
+{
+	typedef chrono::steady_clock Clock;
+	const Clock::time_point lDeadline = Clock::now() + chrono::duration_cast<Clock::duration>(chrono::duration<double>(inMaxTime));
+	lock();
+	while(!mReady) {
+		double lLeft = chrono::duration<double>(lDeadline - Clock::now()).count();
+		// a null time out would wait indefinitely (see Condition::wait)
+		if(lLeft <= 0 || !Condition::wait(lLeft)) break;
+	}
+	bool lReady = mReady;
+	unlock();
+	return lReady;
+}
@@ -0,0 +1,320 @@
+/*
+ *  Portable Agile C++ Classes (PACC)
+ *  Copyright (C) 2001-2003 by Marc Parizeau
+ *  http://manitou.gel.ulaval.ca/~parizeau/PACC
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *  Contact:
+ *  Laboratoire de Vision et Systemes Numeriques
+ *  Departement de genie electrique et de genie informatique
+ *  Universite Laval, Quebec, Canada, G1K 7P4
+ *  http://vision.gel.ulaval.ca
+ *
+ */
+
+/*!
+ * \file PACC/Threading/Future.hpp
+ * \brief Class definition for the futures of thread pool tasks.
+ * \author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+ */
+
+#ifndef PACC_Threading_Future_hpp_
+#define PACC_Threading_Future_hpp_
+
+#include "PACC/Threading/Condition.hpp"
+#include "PACC/Threading/LightTask.hpp"
+#include "PACC/Util/Assert.hpp"
+#include <exception>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace PACC {
+	
+	using namespace std;
+	
+	namespace Threading {
+		
+		class ThreadPool;
+		template <class T> class FutureAwaiter;
+		
+		/*! \brief Shared state of a future.
+		\author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+		\ingroup Threading
+		
+		This class holds the part of the state of a Future that does not depend on the type of its result: the ready flag, the exception thrown by the task (if any), and the continuation tasks that must be pushed onto their thread pool when the result becomes available (see Future::then). The result itself is held by derived class FutureValue.
+		*/
+		class FutureState : public Condition {
+			public:
+			//! Construct state of a result computed by thread pool \c inPool.
+			FutureState(ThreadPool* inPool) : mPool(inPool), mReady(false) {}
+			
+			void addContinuation(ThreadPool& inPool, LightTask* inTask);
+			void complete(void);
+			//! Return the thread pool that computes the result.
+			ThreadPool* getPool(void) const {return mPool;}
+			bool isReady(void) const;
+			void setException(exception_ptr inException);
+			//! Store exception \c inException, without waking up the waiting threads (see FutureState::complete).
+			void storeException(exception_ptr inException) {mException = inException;}
+			void wait(void) const;
+			bool waitFor(double inMaxTime) const;
+			
+			protected:
+			ThreadPool* mPool; //!< Thread pool that computes the result.
+			bool mReady; //!< Result (or exception) is available.
+			exception_ptr mException; //!< Exception thrown while computing the result.
+			vector<pair<ThreadPool*, LightTask*> > mContinuations; //!< Continuation tasks to push when the result becomes available.
+			
+			void rethrow(void) const;
+		};
+		
+		/*! \brief Shared state of a future of type \c T.
+		\author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+		\ingroup Threading
+		
+		The result is constructed in place when it becomes available, so that type \c T does not need a default constructor.
+		*/
+		template <class T>
+		class FutureValue : public FutureState {
+			public:
+			typedef const T& Reference; //!< Type returned by FutureValue::getValue.
+			
+			//! Construct state of a result computed by thread pool \c inPool.
+			FutureValue(ThreadPool* inPool) : FutureState(inPool), mHasValue(false) {}
+			//! Delete state and its result.
+			~FutureValue(void) {if(mHasValue) getPointer()->~T();}
+			
+			//! Wait for the result and return it; rethrow the exception of the task, if any.
+			const T& getValue(void) const {wait(); rethrow(); return *getPointer();}
+			//! Set the result to \c inValue, and wake up the waiting threads.
+			template <class U>
+			void setValue(U&& inValue) {
+				storeValue(std::forward<U>(inValue));
+				complete();
+			}
+			//! Store result \c inValue, without waking up the waiting threads (see FutureState::complete).
+			template <class U>
+			void storeValue(U&& inValue) {
+				new(mStorage) T(std::forward<U>(inValue));
+				mHasValue = true;
+			}
+			
+			protected:
+			alignas(T) unsigned char mStorage[sizeof(T)]; //!< Storage of the result.
+			bool mHasValue; //!< Result has been constructed.
+			
+			//! Return pointer to the result.
+			const T* getPointer(void) const {return reinterpret_cast<const T*>(mStorage);}
+			//! Return pointer to the result.
+			T* getPointer(void) {return reinterpret_cast<T*>(mStorage);}
+		};
+		
+		//! Shared state of a future without result.
+		template <>
+		class FutureValue<void> : public FutureState {
+			public:
+			typedef void Reference; //!< Type returned by FutureValue::getValue.
+			
+			//! Construct state of a task run by thread pool \c inPool.
+			FutureValue(ThreadPool* inPool) : FutureState(inPool) {}
+			
+			//! Wait for task completion; rethrow the exception of the task, if any.
+			void getValue(void) const {wait(); rethrow();}
+			//! Wake up the threads that wait for task completion.
+			void setValue(void) {complete();}
+			//! Do nothing, as there is no result to store (see FutureState::complete).
+			void storeValue(void) {}
+		};
+		
+		/*! \brief Invocation of a function whose result of type \c R is stored in a future.
+		\ingroup Threading
+		
+		The result is only stored: the caller completes the future (see FutureState::complete), so that an exception thrown by the completion is not mistaken for an exception of the function.
+		*/
+		template <class R>
+		struct FutureInvoker {
+			//! Store result of \c inFunction() into \c ioState.
+			template <class Function>
+			static void call(FutureValue<R>& ioState, Function& inFunction) {ioState.storeValue(inFunction());}
+			//! Store result of \c inFunction(value of inAntecedent) into \c ioState.
+			template <class Function, class T>
+			static void call(FutureValue<R>& ioState, Function& inFunction, const FutureValue<T>& inAntecedent) {ioState.storeValue(inFunction(inAntecedent.getValue()));}
+			//! Store result of \c inFunction() into \c ioState, after completion of \c inAntecedent.
+			template <class Function>
+			static void call(FutureValue<R>& ioState, Function& inFunction, const FutureValue<void>& inAntecedent) {inAntecedent.getValue(); ioState.storeValue(inFunction());}
+		};
+		
+		//! Invocation of a function without result.
+		template <>
+		struct FutureInvoker<void> {
+			//! Call \c inFunction().
+			template <class Function>
+			static void call(FutureValue<void>&, Function& inFunction) {inFunction();}
+			//! Call \c inFunction(value of inAntecedent).
+			template <class Function, class T>
+			static void call(FutureValue<void>&, Function& inFunction, const FutureValue<T>& inAntecedent) {inFunction(inAntecedent.getValue());}
+			//! Call \c inFunction() after completion of \c inAntecedent.
+			template <class Function>
+			static void call(FutureValue<void>&, Function& inFunction, const FutureValue<void>& inAntecedent) {inAntecedent.getValue(); inFunction();}
+		};
+		
+		//! Type of the result of continuation \c Function for a future of type \c T (a returned reference is stored as a copy).
+		template <class T, class Function>
+		struct FutureContinuation {
+			typedef typename decay<decltype(declval<Function&>()(declval<const T&>()))>::type Result; //!< Result type.
+		};
+		
+		//! Type of the result of continuation \c Function for a future without result.
+		template <class Function>
+		struct FutureContinuation<void, Function> {
+			typedef typename decay<decltype(declval<Function&>()())>::type Result; //!< Result type.
+		};
+		
+		/*! \brief %Task that stores the result of a function into a future.
+		\author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+		\ingroup Threading
+		
+		This task is allocated by ThreadPool::submit, and is deleted by its slave thread after completion. An exception thrown by the function is stored into the future.
+		*/
+		template <class R, class Function>
+		class FunctionTask : public LightTask {
+			public:
+			//! Construct task that stores the result of \c inFunction into \c inState.
+			FunctionTask(const shared_ptr<FutureValue<R> >& inState, const Function& inFunction) : mState(inState), mFunction(inFunction) {mAutoDelete = true;}
+			
+			//! Call function and store its result (or exception), then complete the future.
+			void main(void) {
+				try {FutureInvoker<R>::call(*mState, mFunction);}
+				catch(...) {mState->storeException(current_exception());}
+				mState->complete();
+			}
+			
+			protected:
+			shared_ptr<FutureValue<R> > mState; //!< Future of the result.
+			Function mFunction; //!< Function to call.
+		};
+		
+		/*! \brief %Task that continues a future with a function of its result.
+		\author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+		\ingroup Threading
+		
+		This task is allocated by Future::then, is pushed onto its thread pool when the antecedent future becomes ready, and is deleted by its slave thread after completion. If the antecedent holds an exception, the function is not called, and the exception is propagated to the future of this task.
+		*/
+		template <class T, class R, class Function>
+		class ContinuationTask : public LightTask {
+			public:
+			//! Construct task that stores the result of \c inFunction applied to the result of \c inAntecedent into \c inState.
+			ContinuationTask(const shared_ptr<FutureValue<R> >& inState, const shared_ptr<FutureValue<T> >& inAntecedent, const Function& inFunction) : mState(inState), mAntecedent(inAntecedent), mFunction(inFunction) {mAutoDelete = true;}
+			
+			//! Call function on the antecedent result, and store its result (or exception), then complete the future.
+			void main(void) {
+				try {FutureInvoker<R>::call(*mState, mFunction, *mAntecedent);}
+				catch(...) {mState->storeException(current_exception());}
+				mState->complete();
+			}
+			
+			protected:
+			shared_ptr<FutureValue<R> > mState; //!< Future of the result.
+			shared_ptr<FutureValue<T> > mAntecedent; //!< Future of the antecedent result.
+			Function mFunction; //!< Function to call.
+		};
+		
+		/*! \brief %Future result of a thread pool task.
+		\author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+		\ingroup Threading
+		
+		A future is returned by ThreadPool::submit, which runs a function (or any callable object) in the thread pool. Method Future::get waits for the result of the function and returns it, or rethrows the exception that was thrown by the function. Method Future::waitFor waits with a time out.
+		
+		Method Future::then schedules a continuation: a function that is pushed onto the thread pool when the result becomes available, and that receives this result as argument (or no argument for a future of type \c void). A continuation never blocks a slave thread while it waits. Futures are copyable handles to a shared state; the state lives as long as a future or a pending task refers to it.
+		
+		Here is a simple usage example:
+		\code
+ThreadPool lPool(4);
+Future<double> lSum = lPool.submit([&]() {return computeSum(lData);});
+Future<void> lPrint = lSum.then([](double inSum) {cout << inSum << endl;});
+...
+lPrint.get();
+		\endcode
+		*/
+		template <class T>
+		class Future {
+			public:
+			//! Construct invalid future (see Future::isValid).
+			Future(void) {}
+			//! Construct future of shared state \c inState.
+			explicit Future(const shared_ptr<FutureValue<T> >& inState) : mState(inState) {}
+			
+			//! Wait for the result and return it; rethrow the exception of the task, if any.
+			typename FutureValue<T>::Reference get(void) const {
+				PACC_AssertM(mState, "Future::get() invalid future!");
+				return mState->getValue();
+			}
+			
+			//! Return whether the result (or exception) is available.
+			bool isReady(void) const {
+				PACC_AssertM(mState, "Future::isReady() invalid future!");
+				return mState->isReady();
+			}
+			
+			//! Return whether this future refers to a shared state.
+			bool isValid(void) const {return mState.get() != 0;}
+			
+			//! Continue this future with function \c inFunction, using the thread pool of this future.
+			template <class Function>
+			Future<typename FutureContinuation<T, Function>::Result> then(Function inFunction) const {
+				PACC_AssertM(mState, "Future::then() invalid future!");
+				return then(*mState->getPool(), inFunction);
+			}
+			
+			/*! \brief Continue this future with function \c inFunction, using thread pool \c inPool.
+			
+			The continuation is pushed onto \c inPool when the result of this future becomes available (immediately if it is already available). It receives the result as argument, or no argument for a future of type \c void. If this future holds an exception, the continuation is not called and the returned future holds the same exception.
+			*/
+			template <class Function>
+			Future<typename FutureContinuation<T, Function>::Result> then(ThreadPool& inPool, Function inFunction) const {
+				typedef typename FutureContinuation<T, Function>::Result Result;
+				PACC_AssertM(mState, "Future::then() invalid future!");
+				shared_ptr<FutureValue<Result> > lState(new FutureValue<Result>(&inPool));
+				mState->addContinuation(inPool, new ContinuationTask<T, Result, Function>(lState, mState, inFunction));
+				return Future<Result>(lState);
+			}
+			
+			//! Wait for the result (or exception) to become available.
+			void wait(void) const {
+				PACC_AssertM(mState, "Future::wait() invalid future!");
+				mState->wait();
+			}
+			
+			//! Wait up to \c inMaxTime seconds for the result (or exception); return whether it is available.
+			bool waitFor(double inMaxTime) const {
+				PACC_AssertM(mState, "Future::waitFor() invalid future!");
+				return mState->waitFor(inMaxTime);
+			}
+			
+			protected:
+			shared_ptr<FutureValue<T> > mState; //!< Shared state.
+			
+			friend class FutureAwaiter<T>;
+		};
+		
+	} // end of Threading namespace
+	
+} // end of PACC namespace
+
+#endif // PACC_Threading_Future_hpp_
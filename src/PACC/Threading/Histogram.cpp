@@ -0,0 +1,91 @@
+/*
+ *  Portable Agile C++ Classes (PACC)
+ *  Copyright (C) 2001-2003 by Marc Parizeau
+ *  http://manitou.gel.ulaval.ca/~parizeau/PACC
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *  Contact:
+ *  Laboratoire de Vision et Systemes Numeriques
+ *  Departement de genie electrique et de genie informatique
+ *  Universite Laval, Quebec, Canada, G1K 7P4
+ *  http://vision.gel.ulaval.ca
+ *
+ */
+
+/*!
+ * \file PACC/Threading/Histogram.cpp
+ * \brief Class methods for the log-linear histogram.
+ * \author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+ */
+
+#include "PACC/Threading/Histogram.hpp"
+#include <cmath>
+
+using namespace std;
+using namespace PACC;
+
+//! Copy the counters of histogram \c inHistogram.
+Threading::Histogram& Threading::Histogram::operator=(const Histogram& inHistogram)
+{
+	for(unsigned int i = 0; i < eBuckets; ++i) mBuckets[i].store(inHistogram.getCount(i), memory_order_relaxed);
+	mCount.store(inHistogram.getCount(), memory_order_relaxed);
+	mSum.store(inHistogram.getSum(), memory_order_relaxed);
+	mMax.store(inHistogram.getMax(), memory_order_relaxed);
+	return *this;
+}
+
+//! Return the smallest value of bucket \c inBucket.
+unsigned long long Threading::Histogram::getLowerBound(unsigned int inBucket)
+{
+	if(inBucket < eSubBuckets) return inBucket;
+	const unsigned int lExponent = inBucket/eSubBuckets + 2;
+	return (unsigned long long) (eSubBuckets + inBucket%eSubBuckets) << (lExponent-3);
+}
+
+/*! \brief Return the percentile \c inFraction (between 0 and 1) of the values, e.g. 0.99 for the 99th percentile.
+
+The returned value is the upper bound of the bucket that holds the percentile, or the largest value if it is smaller, so that it never underestimates the percentile by more than the width of a bucket. An empty histogram returns 0.
+*/
+unsigned long long Threading::Histogram::getPercentile(double inFraction) const
+{
+	const unsigned long long lCount = getCount();
+	if(lCount == 0) return 0;
+	const unsigned long long lRank = max(1ull, (unsigned long long) ceil(inFraction*lCount));
+	unsigned long long lSum = 0;
+	for(unsigned int i = 0; i < eBuckets; ++i) {
+		lSum += getCount(i);
+		if(lSum >= lRank) return i+1 < eBuckets ? min(getLowerBound(i+1)-1, getMax()) : getMax();
+	}
+	return getMax();
+}
+
+//! Add the values of histogram \c inHistogram to this histogram.
+void Threading::Histogram::merge(const Histogram& inHistogram)
+{
+	for(unsigned int i = 0; i < eBuckets; ++i) increase(mBuckets[i], inHistogram.getCount(i));
+	increase(mCount, inHistogram.getCount());
+	increase(mSum, inHistogram.getSum());
+	if(inHistogram.getMax() > getMax()) mMax.store(inHistogram.getMax(), memory_order_relaxed);
+}
+
+//! Remove all values.
+void Threading::Histogram::reset(void)
+{
+	for(unsigned int i = 0; i < eBuckets; ++i) mBuckets[i].store(0, memory_order_relaxed);
+	mCount.store(0, memory_order_relaxed);
+	mSum.store(0, memory_order_relaxed);
+	mMax.store(0, memory_order_relaxed);
+}
@@ -0,0 +1,125 @@
+/*
+ *  Portable Agile C++ Classes (PACC)
+ *  Copyright (C) 2001-2003 by Marc Parizeau
+ *  http://manitou.gel.ulaval.ca/~parizeau/PACC
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *  Contact:
+ *  Laboratoire de Vision et Systemes Numeriques
+ *  Departement de genie electrique et de genie informatique
+ *  Universite Laval, Quebec, Canada, G1K 7P4
+ *  http://vision.gel.ulaval.ca
+ *
+ */
+
+/*!
+ * \file PACC/Threading/Histogram.hpp
+ * \brief Class definition for the log-linear histogram.
+ * \author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+ */
+
+#ifndef PACC_Threading_Histogram_hpp_
+#define PACC_Threading_Histogram_hpp_
+
+#include <atomic>
+
+namespace PACC {
+	
+	using namespace std;
+	
+	namespace Threading {
+		
+		/*! \brief Log-linear histogram of non negative integers, for latency statistics.
+		\author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+		\ingroup Threading
+		
+		Values below 8 have their own bucket, and each power of two interval [2<sup>e</sup>, 2<sup>e+1</sup>) above is split into 8 buckets of equal width, so that the relative error of a percentile is at most 12.5% over the whole 64 bits range. The histogram also keeps the exact number, sum and maximum of its values.
+		
+		A histogram is meant to be written by a single thread (Histogram::add does not use atomic read-modify-write operations), and read at any time by other threads: its counters are atomic, so that a copy made while values are added is a consistent snapshot of each counter, though not of the histogram as a whole. Histograms of several threads are combined with Histogram::merge.
+		*/
+		class Histogram {
+		 public:
+			enum {
+				eSubBuckets = 8, //!< Number of buckets per power of two.
+				eBuckets = 496 //!< Total number of buckets.
+			};
+			
+			//! Construct an empty histogram.
+			Histogram(void) {reset();}
+			//! Construct a copy of histogram \c inHistogram.
+			Histogram(const Histogram& inHistogram) {*this = inHistogram;}
+			
+			Histogram& operator=(const Histogram& inHistogram);
+			
+			//! Add value \c inValue (from the single writing thread).
+			void add(unsigned long long inValue) {
+				increase(mBuckets[getBucket(inValue)], 1);
+				increase(mCount, 1);
+				increase(mSum, inValue);
+				if(inValue > mMax.load(memory_order_relaxed)) mMax.store(inValue, memory_order_relaxed);
+			}
+			
+			//! Return the bucket of value \c inValue.
+			static unsigned int getBucket(unsigned long long inValue) {
+				if(inValue < eSubBuckets) return (unsigned int) inValue;
+				const unsigned int lExponent = getExponent(inValue);
+				return eSubBuckets*(lExponent-2) + (unsigned int) ((inValue >> (lExponent-3)) & (eSubBuckets-1));
+			}
+			
+			//! Return the number of values.
+			unsigned long long getCount(void) const {return mCount.load(memory_order_relaxed);}
+			//! Return the number of values in bucket \c inBucket.
+			unsigned long long getCount(unsigned int inBucket) const {return mBuckets[inBucket].load(memory_order_relaxed);}
+			static unsigned long long getLowerBound(unsigned int inBucket);
+			//! Return the largest value (0 if empty).
+			unsigned long long getMax(void) const {return mMax.load(memory_order_relaxed);}
+			//! Return the mean of the values (0 if empty).
+			double getMean(void) const {return getCount() > 0 ? double(getSum())/getCount() : 0;}
+			unsigned long long getPercentile(double inFraction) const;
+			//! Return the sum of the values.
+			unsigned long long getSum(void) const {return mSum.load(memory_order_relaxed);}
+			
+			void merge(const Histogram& inHistogram);
+			void reset(void);
+			
+		 protected:
+			atomic<unsigned long long> mBuckets[eBuckets]; //!< Number of values of each bucket.
+			atomic<unsigned long long> mCount; //!< Number of values.
+			atomic<unsigned long long> mSum; //!< Sum of values.
+			atomic<unsigned long long> mMax; //!< Largest value.
+			
+			//! Return the position of the most significant bit of non null value \c inValue.
+			static unsigned int getExponent(unsigned long long inValue) {
+#if defined(__GNUC__)
+				return 63 - __builtin_clzll(inValue);
+#else
+				unsigned int lExponent = 0;
+				while(inValue >>= 1) ++lExponent;
+				return lExponent;
+#endif
+			}
+			
+			//! Add \c inValue to counter \c ioCounter, which is only written by the calling thread.
+			static void increase(atomic<unsigned long long>& ioCounter, unsigned long long inValue) {
+				ioCounter.store(ioCounter.load(memory_order_relaxed)+inValue, memory_order_relaxed);
+			}
+		};
+		
+	} // end of Threading namespace
+	
+} // end of PACC namespace
+
+#endif // PACC_Threading_Histogram_hpp_
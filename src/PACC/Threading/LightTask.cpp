@@ -0,0 +1,117 @@
+/*
+ *  Portable Agile C++ Classes (PACC)
+ *  Copyright (C) 2001-2003 by Marc Parizeau
+ *  http://manitou.gel.ulaval.ca/~parizeau/PACC
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *  Contact:
+ *  Laboratoire de Vision et Systemes Numeriques
+ *  Departement de genie electrique et de genie informatique
+ *  Universite Laval, Quebec, Canada, G1K 7P4
+ *  http://vision.gel.ulaval.ca
+ *
+ */
+
+/*!
+ * \file PACC/Threading/LightTask.cpp
+ * \brief Class methods for the lightweight task of the portable thread pool.
+ * \author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+ */
+
+#include "PACC/Threading/LightTask.hpp"
+#include "PACC/Threading/EventCount.hpp"
+
+#ifdef PACC_THREADS_FUTEX
+#include <climits>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+using namespace PACC;
+
+#ifndef PACC_THREADS_FUTEX
+namespace {
+	
+	//! Return the condition on which threads wait for the completion of any lightweight task.
+	Threading::Condition& getCompletion(void)
+	{
+		static Threading::Condition lCompletion;
+		return lCompletion;
+	}
+	
+}
+#endif
+
+/*! \brief Mark task as completed (called by its slave thread), and wake up the threads that wait for it.
+
+This method is virtual so that derived classes can also notify their own waiting threads (see Task::complete).
+
+The task may be deleted by another thread as soon as its state is changed, so that the futex system call may be made on a deleted task; this only causes a spurious wake up of another futex.
+*/
+void Threading::LightTask::complete(void)
+{
+	if((mState.exchange(eCompleted, memory_order_acq_rel) & eWaiting) == 0) return;
+#ifdef PACC_THREADS_FUTEX
+	::syscall(SYS_futex, (unsigned int*) &mState, FUTEX_WAKE_PRIVATE, INT_MAX, 0, 0, 0);
+#else
+	getCompletion().lock();
+	getCompletion().broadcast();
+	getCompletion().unlock();
+#endif
+}
+
+//! Reset task state to queued (not running and not completed), keeping track of the waiting threads.
+void Threading::LightTask::reset(void)
+{
+	unsigned int lState = mState.load(memory_order_relaxed);
+	while(!mState.compare_exchange_weak(lState, (lState & eWaiting) | eQueued, memory_order_release, memory_order_relaxed));
+}
+
+//! Mark task as running (called by its slave thread).
+void Threading::LightTask::start(void)
+{
+	unsigned int lState = mState.load(memory_order_relaxed);
+	while(!mState.compare_exchange_weak(lState, (lState & eWaiting) | eRunning, memory_order_relaxed, memory_order_relaxed));
+}
+
+/*! \brief Wait for task to complete.
+
+The calling thread sleeps only if the task is not already completed; it then flags the task state, so that LightTask::complete knows that a system call is needed.
+*/
+void Threading::LightTask::wait(void) const
+{
+	unsigned int lState = mState.load(memory_order_acquire);
+	if(lState & eCompleted) return;
+#ifdef PACC_THREADS_FUTEX
+	while((lState & eCompleted) == 0) {
+		if((lState & eWaiting) == 0 && !mState.compare_exchange_weak(lState, lState | eWaiting, memory_order_acquire, memory_order_acquire)) continue;
+		::syscall(SYS_futex, (unsigned int*) &mState, FUTEX_WAIT_PRIVATE, lState | eWaiting, 0, 0, 0);
+		lState = mState.load(memory_order_acquire);
+	}
+#else
+	getCompletion().lock();
+	// the task may have completed before the lock was taken, without waking anybody
+	lState = mState.load(memory_order_acquire);
+	while((lState & eCompleted) == 0) {
+		if((lState & eWaiting) == 0 && !mState.compare_exchange_weak(lState, lState | eWaiting, memory_order_acquire, memory_order_acquire)) continue;
+		getCompletion().wait();
+		lState = mState.load(memory_order_acquire);
+	}
+	getCompletion().unlock();
+#endif
+}
@@ -0,0 +1,114 @@
+/*
+ *  Portable Agile C++ Classes (PACC)
+ *  Copyright (C) 2001-2003 by Marc Parizeau
+ *  http://manitou.gel.ulaval.ca/~parizeau/PACC
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *  Contact:
+ *  Laboratoire de Vision et Systemes Numeriques
+ *  Departement de genie electrique et de genie informatique
+ *  Universite Laval, Quebec, Canada, G1K 7P4
+ *  http://vision.gel.ulaval.ca
+ *
+ */
+
+/*!
+ * \file PACC/Threading/LightTask.hpp
+ * \brief Class definition for the lightweight task of the portable thread pool.
+ * \author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+ */
+
+#ifndef PACC_Threading_LightTask_hpp_
+#define PACC_Threading_LightTask_hpp_
+
+#include <atomic>
+
+namespace PACC {
+	
+	using namespace std;
+	
+	namespace Threading {
+		
+		class TaskGroup;
+		
+		/*! \brief Lightweight task for thread pool execution.
+		\author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+		\ingroup Threading
+		
+		This abstract class is the base of all tasks that can be executed by a ThreadPool. Its whole state is a single atomic word, so that it allocates nothing, and a slave thread starts and completes it without any lock. The completion makes a system call only if a thread is actually waiting for the task (futex under Linux, and a condition shared by all tasks elsewhere). 
+		
+		Unlike Task, it does not embed a mutex and a condition, and should be preferred for short tasks that are created in large numbers. A lightweight task that was never pushed onto a thread pool can be deleted at any time.
+		*/
+		class LightTask {
+			public:
+			//! Construct default task: initialize to not queued, not running and not completed.
+			LightTask(void) : mState(0), mAutoDelete(false), mGroup(0), mPushTime(0) {}
+			//! Delete task: wait for task completion if the task was pushed onto a thread pool.
+			virtual ~LightTask(void) {if(isPending()) wait();}
+			
+			//! Check whether task is completed.
+			bool isCompleted(void) const {return (mState.load(memory_order_acquire) & eCompleted) != 0;}
+			
+			//! Check whether task was pushed onto a thread pool and is not completed yet.
+			bool isPending(void) const {return (mState.load(memory_order_acquire) & (eQueued | eRunning)) != 0;}
+			
+			//! Check whether task is running.
+			bool isRunning(void) const {return (mState.load(memory_order_acquire) & eRunning) != 0;}
+			
+			/*! \brief Implements main procedure of task.
+			
+			This virtual method must be overloaded in a derived class in order to implement the main procedure of this task.
+			*/
+			virtual void main(void) = 0;
+			
+			void reset(void);
+			void wait(void) const;
+			
+			protected:
+			//! Bits of the task state.
+			enum State {
+				eQueued=1, //!< Task was pushed and has not started.
+				eRunning=2, //!< Task is running.
+				eCompleted=4, //!< Task is completed.
+				eWaiting=8 //!< A thread may be sleeping until the task is completed.
+			};
+			
+			mutable atomic<unsigned int> mState; //!< State bits of task (see LightTask::State).
+			bool mAutoDelete; //!< task is deleted by its slave thread after completion (internal tasks of futures)
+			TaskGroup* mGroup; //!< group of task (see TaskGroup::push)
+			unsigned long long mPushTime; //!< push time of task (nanoseconds of the steady clock), for the statistics of its thread pool
+			
+			virtual void complete(void);
+			virtual void start(void);
+			
+			friend class SlaveThread;
+			friend class TaskAwaiter;
+			friend class TaskGraph;
+			friend class TaskGroup;
+			friend class ThreadPool;
+			
+			private:
+			//! restrict (disable) copy constructor.
+			LightTask(const LightTask&);
+			//! restrict (disable) assignment operator.
+			void operator=(const LightTask&);
+		};
+		
+	} // end of Threading namespace 
+	
+} // end of PACC namespace
+
+#endif // PACC_Threading_LightTask_hpp_
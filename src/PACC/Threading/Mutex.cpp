@@ -46,26 +46,26 @@ typedef HANDLE pthread_mutex_t;
 
 using namespace PACC;
 
-/*! \brief Allocate native structure and create mutex. 
+/*! \brief Create mutex in its embedded native structure. 
 
 Any error raised a Threading:Exception.
 */
 Threading::Mutex::Mutex(void)
 {
-	pthread_mutex_t* lMutex = new pthread_mutex_t;
+	static_assert(sizeof(pthread_mutex_t) <= sizeof(mMutex) && alignof(pthread_mutex_t) <= 16, "Mutex::mMutex is too small for the native mutex");
+	pthread_mutex_t* lMutex = reinterpret_cast<pthread_mutex_t*>(mMutex);
 #ifdef PACC_THREADS_WIN32
 	if((*lMutex = ::CreateMutex(0, 0, 0)) == 0)
 #else
 		if(::pthread_mutex_init(lMutex, 0))
 #endif
 			throw Exception(eOtherError, "Mutex::Mutex() can't create!");
-	mMutex = lMutex;
 }
 
-//! Destroy mutex and free allocated native structure.
+//! Destroy mutex.
 Threading::Mutex::~Mutex(void)
 {
-	pthread_mutex_t* lMutex = (pthread_mutex_t*) mMutex;
+	pthread_mutex_t* lMutex = reinterpret_cast<pthread_mutex_t*>(mMutex);
 #ifdef PACC_THREADS_WIN32
 	while(::CloseHandle(*lMutex) == 0)
 #else
@@ -76,8 +76,6 @@ Threading::Mutex::~Mutex(void)
 			lock();
 			unlock();
 		}
-			delete lMutex;
-	mMutex = 0;
 }
 
 /*! \brief Lock the mutex.
@@ -86,7 +84,7 @@ A thread should never lock a mutex twice consecutively (without calling method M
 */
 void Threading::Mutex::lock(void) const
 {
-	pthread_mutex_t* lMutex = (pthread_mutex_t*) mMutex;
+	pthread_mutex_t* lMutex = reinterpret_cast<pthread_mutex_t*>(mMutex);
 #ifdef PACC_THREADS_WIN32
 	if(::WaitForSingleObject(*lMutex, INFINITE) != WAIT_OBJECT_0)
 #else
@@ -103,7 +101,7 @@ Any error will raise a Threading::Exception.
 */
 bool Threading::Mutex::tryLock(void) const
 {
-	pthread_mutex_t* lMutex = (pthread_mutex_t*) mMutex;
+	pthread_mutex_t* lMutex = reinterpret_cast<pthread_mutex_t*>(mMutex);
 #ifdef PACC_THREADS_WIN32
 	int lValue = ::WaitForSingleObject(*lMutex, 0);
 	if(lValue == WAIT_TIMEOUT) return false;
@@ -124,7 +122,7 @@ A thread should never unlock a mutex twice consecutively (without calling method
 */
 void Threading::Mutex::unlock(void) const
 {
-	pthread_mutex_t* lMutex = (pthread_mutex_t*) mMutex;
+	pthread_mutex_t* lMutex = reinterpret_cast<pthread_mutex_t*>(mMutex);
 #ifdef PACC_THREADS_WIN32
 	if(::ReleaseMutex(*lMutex) == 0)
 #else
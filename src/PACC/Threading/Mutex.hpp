@@ -60,7 +60,8 @@ namespace PACC {
 			void unlock(void) const;
 			
 			protected:
-			void* mMutex; //!< Opaque structure of native mutex
+			//! Opaque storage of native mutex (large enough for a pthread_mutex_t, or a Windows handle).
+			alignas(16) mutable unsigned char mMutex[64];
 			
 			private:
 			//! restrict (disable) copy constructor.
@@ -0,0 +1,177 @@
+/*
+ *  Portable Agile C++ Classes (PACC)
+ *  Copyright (C) 2001-2003 by Marc Parizeau
+ *  http://manitou.gel.ulaval.ca/~parizeau/PACC
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *  Contact:
+ *  Laboratoire de Vision et Systemes Numeriques
+ *  Departement de genie electrique et de genie informatique
+ *  Universite Laval, Quebec, Canada, G1K 7P4
+ *  http://vision.gel.ulaval.ca
+ *
+ */
+
+/*!
+ * \file PACC/Threading/RWMutex.cpp
+ * \brief Class methods for the reader-writer mutex.
+ * \author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+ */
+
+#include "PACC/Threading/RWMutex.hpp"
+#include <chrono>
+
+using namespace std;
+using namespace PACC;
+
+namespace {
+	
+	typedef chrono::steady_clock Clock;
+	
+	//! Wait on condition \c inCondition until time \c inDeadline (indefinitely if \c inTimed is false); return false if the deadline has passed.
+	bool waitUntil(const Threading::Condition& inCondition, bool inTimed, const Clock::time_point& inDeadline)
+	{
+		if(!inTimed) return inCondition.wait();
+		double lLeft = chrono::duration<double>(inDeadline - Clock::now()).count();
+		// a null time out would wait indefinitely (see Condition::wait)
+		return lLeft > 0 && inCondition.wait(lLeft);
+	}
+	
+}
+
+/*! \brief Wait up to \c inMaxTime seconds (indefinitely if negative or null) until no writer holds or waits for the mutex, and then acquire it for reading.
+\return True if the mutex was acquired, false if timed out.
+*/
+bool Threading::RWMutex::acquireRead(double inMaxTime)
+{
+	const bool lTimed = inMaxTime > 0;
+	const Clock::time_point lDeadline = Clock::now() + chrono::duration_cast<Clock::duration>(chrono::duration<double>(lTimed ? inMaxTime : 0));
+	lock();
+	// the writer flag is only set with the embedded mutex locked
+	while(mState.load() & eWriter) {
+		if(!waitUntil(*this, lTimed, lDeadline)) break;
+	}
+	const bool lAcquired = (mState.load() & eWriter) == 0;
+	if(lAcquired) mState.fetch_add(1, memory_order_acquire);
+	unlock();
+	return lAcquired;
+}
+
+/*! \brief Wait up to \c inMaxTime seconds (indefinitely if negative or null) for the other writers and then for the readers to leave, and acquire the mutex for writing.
+\return True if the mutex was acquired, false if timed out.
+
+Once this writer is next, the writer flag keeps new readers out while the current readers leave. If the wait times out, the flag is cleared again unless other writers are waiting.
+*/
+bool Threading::RWMutex::acquireWrite(double inMaxTime)
+{
+	const bool lTimed = inMaxTime > 0;
+	const Clock::time_point lDeadline = Clock::now() + chrono::duration_cast<Clock::duration>(chrono::duration<double>(lTimed ? inMaxTime : 0));
+	lock();
+	++mWritersWaiting;
+	while(mWriting) {
+		if(!waitUntil(*this, lTimed, lDeadline)) break;
+	}
+	--mWritersWaiting;
+	bool lAcquired = !mWriting;
+	if(lAcquired) {
+		mWriting = true;
+		mState.fetch_or(eWriter);
+		while(mState.load() & eReaders) {
+			if(!waitUntil(*this, lTimed, lDeadline)) break;
+		}
+		lAcquired = (mState.load(memory_order_acquire) & eReaders) == 0;
+		if(!lAcquired) {
+			mWriting = false;
+			if(mWritersWaiting == 0) mState.fetch_and(~(unsigned int) eWriter);
+			broadcast();
+		}
+	}
+	unlock();
+	return lAcquired;
+}
+
+//! Lock the mutex for reading; wait while a writer holds or waits for it.
+void Threading::RWMutex::lockRead(void)
+{
+	if(!tryLockRead()) acquireRead(0);
+}
+
+/*! \brief Lock the mutex for reading, waiting up to \c inMaxTime seconds (indefinitely if negative or null).
+\return True if the mutex was locked, false if timed out.
+*/
+bool Threading::RWMutex::lockRead(double inMaxTime)
+{
+	return tryLockRead() || acquireRead(inMaxTime);
+}
+
+//! Lock the mutex for writing; wait for the other writers and for all readers to leave.
+void Threading::RWMutex::lockWrite(void)
+{
+	acquireWrite(0);
+}
+
+/*! \brief Lock the mutex for writing, waiting up to \c inMaxTime seconds (indefinitely if negative or null).
+\return True if the mutex was locked, false if timed out.
+*/
+bool Threading::RWMutex::lockWrite(double inMaxTime)
+{
+	return acquireWrite(inMaxTime);
+}
+
+/*! \brief Try to lock the mutex for reading without blocking.
+\return True if successful, false if a writer holds or waits for the mutex.
+*/
+bool Threading::RWMutex::tryLockRead(void)
+{
+	unsigned int lState = mState.load(memory_order_relaxed);
+	while((lState & eWriter) == 0) {
+		if(mState.compare_exchange_weak(lState, lState+1, memory_order_acquire, memory_order_relaxed)) return true;
+	}
+	return false;
+}
+
+/*! \brief Try to lock the mutex for writing without waiting for readers or writers.
+\return True if successful, false if the mutex is held, or if a writer waits for it.
+*/
+bool Threading::RWMutex::tryLockWrite(void)
+{
+	lock();
+	unsigned int lState = 0;
+	const bool lAcquired = !mWriting && mState.compare_exchange_strong(lState, eWriter, memory_order_acquire, memory_order_relaxed);
+	if(lAcquired) mWriting = true;
+	unlock();
+	return lAcquired;
+}
+
+//! Unlock the mutex held for reading; the last reader wakes up a waiting writer.
+void Threading::RWMutex::unlockRead(void)
+{
+	if(mState.fetch_sub(1, memory_order_release) == (eWriter | 1)) {
+		lock();
+		broadcast();
+		unlock();
+	}
+}
+
+//! Unlock the mutex held for writing; it is handed over to the next waiting writer if any, and to the waiting readers otherwise.
+void Threading::RWMutex::unlockWrite(void)
+{
+	lock();
+	mWriting = false;
+	if(mWritersWaiting == 0) mState.fetch_and(~(unsigned int) eWriter, memory_order_release);
+	broadcast();
+	unlock();
+}
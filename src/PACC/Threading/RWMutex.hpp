@@ -0,0 +1,147 @@
+/*
+ *  Portable Agile C++ Classes (PACC)
+ *  Copyright (C) 2001-2003 by Marc Parizeau
+ *  http://manitou.gel.ulaval.ca/~parizeau/PACC
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *  Contact:
+ *  Laboratoire de Vision et Systemes Numeriques
+ *  Departement de genie electrique et de genie informatique
+ *  Universite Laval, Quebec, Canada, G1K 7P4
+ *  http://vision.gel.ulaval.ca
+ *
+ */
+
+/*!
+ * \file PACC/Threading/RWMutex.hpp
+ * \brief Class definition for the reader-writer mutex.
+ * \author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+ */
+
+#ifndef PACC_Threading_RWMutex_hpp_
+#define PACC_Threading_RWMutex_hpp_
+
+#include "PACC/Threading/Condition.hpp"
+#include <atomic>
+
+namespace PACC {
+	
+	using namespace std;
+	
+	namespace Threading {
+		
+		/*! \brief Writer-preferring reader-writer mutex.
+		\author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+		\ingroup Threading
+		
+		This class lets any number of readers hold the mutex together (see RWMutex::lockRead), or a single writer (see RWMutex::lockWrite). It protects read-mostly data, such as lookup tables and configuration trees, that a plain Mutex would serialize. As long as no writer holds or waits for the mutex, a reader locks and unlocks it with a single atomic operation on the state word, without touching the embedded condition. 
+		
+		Writers have priority: a reader cannot acquire the mutex while a writer waits for it, and a writer that unlocks the mutex hands it over to the next waiting writer, so that writers are never starved by a continuous flow of readers. The timed variants return false if the mutex could not be acquired within the given time. The mutex is not recursive, and a reader cannot be upgraded to a writer.
+		\code
+RWMutex lMutex;
+...
+{
+	ReadGuard lGuard(lMutex);
+	// read the shared data
+}
+...
+{
+	WriteGuard lGuard(lMutex);
+	// modify the shared data
+}
+		\endcode
+		*/
+		class RWMutex : protected Condition {
+			public:
+			//! Construct unlocked mutex.
+			RWMutex(void) : mState(0), mWriting(false), mWritersWaiting(0) {}
+			
+			//! Return the number of readers that hold the mutex.
+			unsigned int getReaders(void) const {return mState.load() & eReaders;}
+			//! Return whether a writer holds or waits for the mutex.
+			bool hasWriter(void) const {return (mState.load() & eWriter) != 0;}
+			
+			void lockRead(void);
+			bool lockRead(double inMaxTime);
+			void lockWrite(void);
+			bool lockWrite(double inMaxTime);
+			bool tryLockRead(void);
+			bool tryLockWrite(void);
+			void unlockRead(void);
+			void unlockWrite(void);
+			
+			protected:
+			//! Bits of the state word.
+			enum State {
+				eReaders=0x7fffffff, //!< Number of readers that hold the mutex.
+				eWriter=0x80000000 //!< A writer holds or waits for the mutex.
+			};
+			
+			atomic<unsigned int> mState; //!< State word (see RWMutex::State).
+			bool mWriting; //!< A writer holds the mutex, or waits for its readers to leave (protected by the embedded mutex).
+			unsigned int mWritersWaiting; //!< Number of writers that wait for another writer (protected by the embedded mutex).
+			
+			bool acquireRead(double inMaxTime);
+			bool acquireWrite(double inMaxTime);
+		};
+		
+		/*! \brief Scoped read lock of a RWMutex.
+		\author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+		\ingroup Threading
+		*/
+		class ReadGuard {
+			public:
+			//! Lock mutex \c ioMutex for reading.
+			explicit ReadGuard(RWMutex& ioMutex) : mMutex(ioMutex) {mMutex.lockRead();}
+			//! Unlock mutex.
+			~ReadGuard(void) {mMutex.unlockRead();}
+			
+			protected:
+			RWMutex& mMutex; //!< Guarded mutex.
+			
+			private:
+			//! restrict (disable) copy constructor.
+			ReadGuard(const ReadGuard&);
+			//! restrict (disable) assignment operator.
+			void operator=(const ReadGuard&);
+		};
+		
+		/*! \brief Scoped write lock of a RWMutex.
+		\author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+		\ingroup Threading
+		*/
+		class WriteGuard {
+			public:
+			//! Lock mutex \c ioMutex for writing.
+			explicit WriteGuard(RWMutex& ioMutex) : mMutex(ioMutex) {mMutex.lockWrite();}
+			//! Unlock mutex.
+			~WriteGuard(void) {mMutex.unlockWrite();}
+			
+			protected:
+			RWMutex& mMutex; //!< Guarded mutex.
+			
+			private:
+			//! restrict (disable) copy constructor.
+			WriteGuard(const WriteGuard&);
+			//! restrict (disable) assignment operator.
+			void operator=(const WriteGuard&);
+		};
+		
+	} // end of Threading namespace
+	
+} // end of PACC namespace
+
+#endif // PACC_Threading_RWMutex_hpp_
@@ -0,0 +1,325 @@
+/*
+ *  Portable Agile C++ Classes (PACC)
+ *  Copyright (C) 2001-2003 by Marc Parizeau
+ *  http://manitou.gel.ulaval.ca/~parizeau/PACC
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *  Contact:
+ *  Laboratoire de Vision et Systemes Numeriques
+ *  Departement de genie electrique et de genie informatique
+ *  Universite Laval, Quebec, Canada, G1K 7P4
+ *  http://vision.gel.ulaval.ca
+ *
+ */
+
+/*!
+ * \file PACC/Threading/Reactor.cpp
+ * \brief Class methods for the I/O reactor.
+ * \author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+ */
+
+#include "PACC/Threading/Reactor.hpp"
+#include "PACC/Util/Assert.hpp"
+#include "PACC/config.hpp"
+#include <chrono>
+#include <climits>
+#include <cmath>
+
+// The reactor waits with epoll under Linux, and with poll elsewhere
+#if defined(__linux__)
+#define PACC_THREADS_EPOLL
+#include <cerrno>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#define ErrNo errno // descriptor of last error
+#elif defined(PACC_THREADS_WIN32)
+#define _WIN32_WINNT 0x0600 // for WSAPoll
+#include <winsock2.h>
+#include <windows.h>
+#define ErrNo WSAGetLastError() // descriptor of last error
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#define ErrNo errno // descriptor of last error
+#endif
+
+using namespace std;
+using namespace PACC;
+
+namespace {
+	
+	//! Return the current time (in seconds of the steady clock).
+	double getTime(void)
+	{
+		return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+	}
+	
+}
+
+/*! \brief Construct reactor for thread pool \c inPool, and run its thread.
+
+Any error raises a Threading::Exception.
+*/
+Threading::Reactor::Reactor(ThreadPool& inPool) : mPool(inPool), mPoll(-1)
+{
+	mWake[0] = mWake[1] = -1;
+#if defined(PACC_THREADS_EPOLL)
+	mPoll = ::epoll_create1(EPOLL_CLOEXEC);
+	mWake[0] = mWake[1] = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	epoll_event lEvent;
+	lEvent.events = EPOLLIN;
+	lEvent.data.fd = mWake[0];
+	if(mPoll < 0 || mWake[0] < 0 || ::epoll_ctl(mPoll, EPOLL_CTL_ADD, mWake[0], &lEvent) != 0) {
+		const int lError = ErrNo;
+		if(mPoll >= 0) ::close(mPoll);
+		if(mWake[0] >= 0) ::close(mWake[0]);
+		throw Exception(lError, "Reactor::Reactor() can't create epoll set!");
+	}
+#elif !defined(PACC_THREADS_WIN32)
+	if(::pipe(mWake) != 0) throw Exception(ErrNo, "Reactor::Reactor() can't create pipe!");
+	for(int i = 0; i < 2; ++i) {
+		::fcntl(mWake[i], F_SETFL, ::fcntl(mWake[i], F_GETFL) | O_NONBLOCK);
+		::fcntl(mWake[i], F_SETFD, FD_CLOEXEC);
+	}
+#endif
+	run();
+}
+
+/*! \brief Stop the reactor thread, and push the tasks that still wait onto the thread pool.
+
+The waiting tasks are pushed so that no waiting coroutine is lost; they run as if their event had happened.
+*/
+Threading::Reactor::~Reactor(void)
+{
+	cancel();
+	mMutex.lock();
+	wake();
+	mMutex.unlock();
+	Thread::wait();
+	vector<LightTask*> lTasks;
+	for(map<int, Watch>::iterator lWatch = mWatches.begin(); lWatch != mWatches.end(); ++lWatch) {
+		for(int i = 0; i < 2; ++i) if(lWatch->second.mTasks[i]) lTasks.push_back(lWatch->second.mTasks[i]);
+	}
+	mWatches.clear();
+	mTimers.clear(&lTasks);
+	if(!lTasks.empty()) mPool.pushBatch(&lTasks[0], lTasks.size());
+#ifndef PACC_THREADS_WIN32
+	if(mPoll >= 0) ::close(mPoll);
+	if(mWake[0] >= 0) ::close(mWake[0]);
+	if(mWake[1] >= 0 && mWake[1] != mWake[0]) ::close(mWake[1]);
+#endif
+}
+
+/*! \brief Arm descriptor \c inDescriptor for the events of the tasks of watch \c ioWatch; return false on error.
+
+Under Linux, the descriptor is added to the epoll set (or modified) as a one-shot descriptor, so that it is disarmed by its first event. Elsewhere, the reactor thread is awakened, so that it polls the descriptor at its next wait. The mutex of the reactor must be locked.
+*/
+bool Threading::Reactor::arm(int inDescriptor, Watch& ioWatch)
+{
+#ifdef PACC_THREADS_EPOLL
+	epoll_event lEvent;
+	lEvent.events = EPOLLONESHOT;
+	if(ioWatch.mTasks[eReadable]) lEvent.events |= EPOLLIN | EPOLLRDHUP;
+	if(ioWatch.mTasks[eWritable]) lEvent.events |= EPOLLOUT;
+	lEvent.data.fd = inDescriptor;
+	if(ioWatch.mAdded && ::epoll_ctl(mPoll, EPOLL_CTL_MOD, inDescriptor, &lEvent) == 0) return true;
+	// a closed descriptor is removed from the epoll set, and its number may have been reused
+	if(ioWatch.mAdded && errno != ENOENT) return false;
+	if(::epoll_ctl(mPoll, EPOLL_CTL_ADD, inDescriptor, &lEvent) != 0) return false;
+	ioWatch.mAdded = true;
+#else
+	wake();
+#endif
+	return true;
+}
+
+/*! \brief Wait for the watched descriptors and the timers, and push the ready tasks onto the thread pool, until the reactor is deleted.
+
+The ready tasks of each wait are pushed as a single batch (see ThreadPool::pushBatch), after unlocking the mutex of the reactor.
+*/
+void Threading::Reactor::main(void)
+{
+	vector<LightTask*> lReady;
+	// collect the tasks of a watch whose events happened
+	auto lCollect = [&lReady](Watch& ioWatch, bool inReadable, bool inWritable) {
+		if(inReadable && ioWatch.mTasks[eReadable]) {lReady.push_back(ioWatch.mTasks[eReadable]); ioWatch.mTasks[eReadable] = 0;}
+		if(inWritable && ioWatch.mTasks[eWritable]) {lReady.push_back(ioWatch.mTasks[eWritable]); ioWatch.mTasks[eWritable] = 0;}
+	};
+#ifdef PACC_THREADS_EPOLL
+	epoll_event lEvents[64];
+#else
+	vector<pollfd> lDescriptors;
+#endif
+	while(!mCancel) {
+		// wait until the timer wheel must be advanced
+		int lTimeout = -1;
+		mMutex.lock();
+		if(mTimers.getSize() > 0) {
+			const double lDelay = mTimers.getNextTime() - getTime();
+			lTimeout = lDelay <= 0 ? 0 : (lDelay >= INT_MAX/1000 ? INT_MAX : (int) ceil(lDelay*1000));
+		}
+#ifndef PACC_THREADS_EPOLL
+		lDescriptors.clear();
+		pollfd lDescriptor;
+		lDescriptor.revents = 0;
+		if(mWake[0] >= 0) {
+			lDescriptor.fd = mWake[0];
+			lDescriptor.events = POLLIN;
+			lDescriptors.push_back(lDescriptor);
+		}
+		for(map<int, Watch>::iterator lWatch = mWatches.begin(); lWatch != mWatches.end(); ++lWatch) {
+			lDescriptor.fd = lWatch->first;
+			lDescriptor.events = 0;
+			if(lWatch->second.mTasks[eReadable]) lDescriptor.events |= POLLIN;
+			if(lWatch->second.mTasks[eWritable]) lDescriptor.events |= POLLOUT;
+			if(lDescriptor.events != 0) lDescriptors.push_back(lDescriptor);
+		}
+#ifdef PACC_THREADS_WIN32
+		// without wake up descriptor, the changes are seen after a short wait
+		if(lTimeout < 0 || lTimeout > 10) lTimeout = 10;
+#endif
+#endif
+		mMutex.unlock();
+#if defined(PACC_THREADS_EPOLL)
+		const int lCount = ::epoll_wait(mPoll, lEvents, 64, lTimeout);
+#elif defined(PACC_THREADS_WIN32)
+		int lCount = 0;
+		if(lDescriptors.empty()) ::Sleep(lTimeout);
+		else lCount = ::WSAPoll(&lDescriptors[0], lDescriptors.size(), lTimeout);
+#else
+		const int lCount = ::poll(lDescriptors.empty() ? 0 : &lDescriptors[0], lDescriptors.size(), lTimeout);
+#endif
+		mMutex.lock();
+#ifdef PACC_THREADS_EPOLL
+		for(int i = 0; i < lCount; ++i) {
+			const int lDescriptor = lEvents[i].data.fd;
+			if(lDescriptor == mWake[0]) {
+				unsigned long long lValue;
+				ssize_t lResult = ::read(mWake[0], &lValue, sizeof(lValue));
+				(void) lResult;
+				continue;
+			}
+			map<int, Watch>::iterator lWatch = mWatches.find(lDescriptor);
+			if(lWatch == mWatches.end()) continue;
+			const unsigned int lEvent = lEvents[i].events;
+			lCollect(lWatch->second, (lEvent & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) != 0, (lEvent & (EPOLLOUT | EPOLLHUP | EPOLLERR)) != 0);
+			// the one-shot descriptor must be armed again for its remaining task, which is ready if it can't
+			if((lWatch->second.mTasks[eReadable] || lWatch->second.mTasks[eWritable]) && !arm(lDescriptor, lWatch->second)) lCollect(lWatch->second, true, true);
+		}
+#else
+		for(unsigned int i = 0; lCount > 0 && i < lDescriptors.size(); ++i) {
+			if(lDescriptors[i].revents == 0) continue;
+			if(lDescriptors[i].fd == mWake[0]) {
+				char lBuffer[64];
+				while(::read(mWake[0], lBuffer, sizeof(lBuffer)) > 0);
+				continue;
+			}
+			map<int, Watch>::iterator lWatch = mWatches.find(lDescriptors[i].fd);
+			if(lWatch == mWatches.end()) continue;
+			const short lEvent = lDescriptors[i].revents;
+			lCollect(lWatch->second, (lEvent & (POLLIN | POLLHUP | POLLERR | POLLNVAL)) != 0, (lEvent & (POLLOUT | POLLHUP | POLLERR | POLLNVAL)) != 0);
+		}
+#endif
+		mTimers.advance(getTime(), lReady);
+		mMutex.unlock();
+		if(!lReady.empty()) {
+			mPool.pushBatch(&lReady[0], lReady.size());
+			lReady.clear();
+		}
+	}
+}
+
+/*! \brief Push task \c inTask onto the thread pool after \c inDelay seconds.
+
+The delay is measured with the steady clock, and has the resolution of the timer wheel of the reactor (one millisecond, see TimerWheel).
+*/
+void Threading::Reactor::schedule(LightTask& inTask, double inDelay)
+{
+	mMutex.lock();
+	const double lNext = mTimers.getNextTime();
+	mTimers.add(inTask, getTime()+inDelay);
+	// the reactor thread must shorten its wait if this timer expires first
+	if(lNext < 0 || mTimers.getNextTime() < lNext) wake();
+	mMutex.unlock();
+}
+
+/*! \brief Stop watching descriptor \c inDescriptor, and push the tasks that still wait for it onto the thread pool.
+
+This method must be called before the descriptor is closed.
+*/
+void Threading::Reactor::unwatch(int inDescriptor)
+{
+	vector<LightTask*> lTasks;
+	mMutex.lock();
+	map<int, Watch>::iterator lWatch = mWatches.find(inDescriptor);
+	if(lWatch == mWatches.end()) {
+		mMutex.unlock();
+		return;
+	}
+	for(int i = 0; i < 2; ++i) if(lWatch->second.mTasks[i]) lTasks.push_back(lWatch->second.mTasks[i]);
+#ifdef PACC_THREADS_EPOLL
+	if(lWatch->second.mAdded) ::epoll_ctl(mPoll, EPOLL_CTL_DEL, inDescriptor, 0);
+#else
+	wake();
+#endif
+	mWatches.erase(lWatch);
+	mMutex.unlock();
+	if(!lTasks.empty()) mPool.pushBatch(&lTasks[0], lTasks.size());
+}
+
+/*! \brief Push task \c inTask onto the thread pool when descriptor \c inDescriptor is ready for event \c inEvent.
+
+An error or a hang up of the descriptor makes it ready for both events. At most one task may wait for each event of a descriptor. Any error raises a Threading::Exception.
+*/
+void Threading::Reactor::watch(int inDescriptor, Event inEvent, LightTask& inTask)
+{
+	PACC_AssertM(inDescriptor >= 0, "Reactor::watch() invalid descriptor!");
+	mMutex.lock();
+	Watch& lWatch = mWatches[inDescriptor];
+	if(lWatch.mTasks[inEvent] != 0) {
+		mMutex.unlock();
+		throw Exception(eOtherError, "Reactor::watch() descriptor is already watched for this event!");
+	}
+	lWatch.mTasks[inEvent] = &inTask;
+	if(!arm(inDescriptor, lWatch)) {
+		const int lError = ErrNo;
+		lWatch.mTasks[inEvent] = 0;
+		if(!lWatch.mAdded && lWatch.mTasks[eReadable] == 0 && lWatch.mTasks[eWritable] == 0) mWatches.erase(inDescriptor);
+		mMutex.unlock();
+		throw Exception(lError, "Reactor::watch() can't watch descriptor!");
+	}
+	mMutex.unlock();
+}
+
+/*! \brief Wake up the reactor thread, so that it takes the changes of timers and watches into account.
+
+The mutex of the reactor must be locked. Under Windows, the reactor thread wakes up periodically instead.
+*/
+void Threading::Reactor::wake(void)
+{
+#if defined(PACC_THREADS_EPOLL)
+	const unsigned long long lValue = 1;
+	ssize_t lResult = ::write(mWake[1], &lValue, sizeof(lValue));
+	(void) lResult;
+#elif !defined(PACC_THREADS_WIN32)
+	const char lValue = 0;
+	ssize_t lResult = ::write(mWake[1], &lValue, 1);
+	(void) lResult;
+#endif
+}
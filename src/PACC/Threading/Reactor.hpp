@@ -0,0 +1,148 @@
+/*
+ *  Portable Agile C++ Classes (PACC)
+ *  Copyright (C) 2001-2003 by Marc Parizeau
+ *  http://manitou.gel.ulaval.ca/~parizeau/PACC
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *  Contact:
+ *  Laboratoire de Vision et Systemes Numeriques
+ *  Departement de genie electrique et de genie informatique
+ *  Universite Laval, Quebec, Canada, G1K 7P4
+ *  http://vision.gel.ulaval.ca
+ *
+ */
+
+/*!
+ * \file PACC/Threading/Reactor.hpp
+ * \brief Class definition for the I/O reactor.
+ * \author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+ */
+
+#ifndef PACC_Threading_Reactor_hpp_
+#define PACC_Threading_Reactor_hpp_
+
+#include "PACC/Threading/CoTask.hpp"
+#include "PACC/Threading/LightTask.hpp"
+#include "PACC/Threading/Mutex.hpp"
+#include "PACC/Threading/Thread.hpp"
+#include "PACC/Threading/ThreadPool.hpp"
+#include "PACC/Threading/TimerWheel.hpp"
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace PACC {
+	
+	using namespace std;
+	
+	namespace Threading {
+		
+		/*! \brief I/O reactor for thread pool tasks.
+		\author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+		\ingroup Threading
+		
+		A reactor runs a single thread that waits for the readiness of descriptors (for instance, the descriptor of a Socket::Port, see Socket::Port::getDescriptor) and for delays, and pushes the corresponding tasks onto its thread pool when they happen. Method Reactor::watch pushes a task when a descriptor becomes readable or writable, and method Reactor::schedule pushes a task after a delay (see TimerWheel). Each watch and each delay is used once: a task that needs to wait again must be watched or scheduled again. The reactor waits with epoll under Linux, and with poll elsewhere.
+		
+		With a C++20 compiler, methods Reactor::readable, Reactor::writable and Reactor::delay return awaiters for coroutine tasks (see CoTask), so that a small thread pool can serve thousands of connections: a coroutine that waits for its socket is suspended, and does not block any slave thread.
+		
+		A readiness may be spurious (for instance, when another task has already read the available data), so that non-blocking descriptors should be preferred. Method Reactor::unwatch must be called before a watched descriptor is closed; it pushes the tasks that still wait for the descriptor. The tasks that still wait when the reactor is deleted are pushed onto the thread pool, so that no waiting coroutine is lost; the pool must thus outlive the reactor.
+		*/
+		class Reactor : protected Thread {
+			public:
+			//! Event of a descriptor.
+			enum Event {
+				eReadable=0, //!< Descriptor can be read without blocking.
+				eWritable=1 //!< Descriptor can be written without blocking.
+			};
+			
+			explicit Reactor(ThreadPool& inPool);
+			~Reactor(void);
+			
+			//! Return the thread pool of ready tasks.
+			ThreadPool& getPool(void) const {return mPool;}
+			void schedule(LightTask& inTask, double inDelay);
+			void unwatch(int inDescriptor);
+			void watch(int inDescriptor, Event inEvent, LightTask& inTask);
+			
+#ifdef PACC_THREADS_COROUTINES
+			/*! \brief Awaiter of a descriptor event or a delay.
+			
+			The awaiting coroutine is suspended, and is resumed by a slave thread of the pool when the event happens (or the delay expires).
+			*/
+			class Awaiter {
+				public:
+				//! Construct awaiter of event \c inEvent of descriptor \c inDescriptor, or of delay \c inDelay if the descriptor is negative.
+				Awaiter(Reactor& ioReactor, int inDescriptor, Event inEvent, double inDelay) : mReactor(ioReactor), mDescriptor(inDescriptor), mEvent(inEvent), mDelay(inDelay) {}
+				//! Always suspend.
+				bool await_ready(void) const noexcept {return false;}
+				//! Resume coroutine \c inHandle when the event happens.
+				void await_suspend(coroutine_handle<> inHandle) {
+					unique_ptr<ResumeTask> lTask(new ResumeTask(inHandle));
+					if(mDescriptor < 0) mReactor.schedule(*lTask, mDelay);
+					else mReactor.watch(mDescriptor, mEvent, *lTask);
+					// the task may already be deleted by its slave thread
+					lTask.release();
+				}
+				//! Continue on a slave thread of the pool.
+				void await_resume(void) const noexcept {}
+				
+				protected:
+				Reactor& mReactor; //!< Reactor of the event.
+				int mDescriptor; //!< Watched descriptor (none if negative).
+				Event mEvent; //!< Event of the descriptor.
+				double mDelay; //!< Delay (in seconds).
+			};
+			
+			//! Return awaiter of a delay of \c inDelay seconds.
+			Awaiter delay(double inDelay) {return Awaiter(*this, -1, eReadable, inDelay);}
+			//! Return awaiter of the readability of descriptor \c inDescriptor.
+			Awaiter readable(int inDescriptor) {return Awaiter(*this, inDescriptor, eReadable, 0);}
+			//! Return awaiter of the writability of descriptor \c inDescriptor.
+			Awaiter writable(int inDescriptor) {return Awaiter(*this, inDescriptor, eWritable, 0);}
+#endif
+			
+			protected:
+			//! Tasks that wait for the events of a descriptor.
+			struct Watch {
+				//! Construct watch without task.
+				Watch(void) : mAdded(false) {mTasks[eReadable] = mTasks[eWritable] = 0;}
+				LightTask* mTasks[2]; //!< Task that waits for each event (null if none).
+				bool mAdded; //!< Descriptor was added to the epoll set.
+			};
+			
+			ThreadPool& mPool; //!< Thread pool of ready tasks.
+			Mutex mMutex; //!< Mutex of watches and timers.
+			map<int, Watch> mWatches; //!< Watches of descriptors.
+			TimerWheel mTimers; //!< Timers of delays.
+			int mPoll; //!< Epoll descriptor (Linux only).
+			int mWake[2]; //!< Descriptors that wake up the reactor thread (eventfd under Linux, pipe elsewhere).
+			
+			bool arm(int inDescriptor, Watch& ioWatch);
+			void main(void);
+			void wake(void);
+			
+			private:
+			//! restrict (disable) copy constructor.
+			Reactor(const Reactor&);
+			//! restrict (disable) assignment operator.
+			void operator=(const Reactor&);
+		};
+		
+	} // end of Threading namespace
+	
+} // end of PACC namespace
+
+#endif // PACC_Threading_Reactor_hpp_
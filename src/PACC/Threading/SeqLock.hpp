@@ -0,0 +1,138 @@
+/*
+ *  Portable Agile C++ Classes (PACC)
+ *  Copyright (C) 2001-2003 by Marc Parizeau
+ *  http://manitou.gel.ulaval.ca/~parizeau/PACC
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *  Contact:
+ *  Laboratoire de Vision et Systemes Numeriques
+ *  Departement de genie electrique et de genie informatique
+ *  Universite Laval, Quebec, Canada, G1K 7P4
+ *  http://vision.gel.ulaval.ca
+ *
+ */
+
+/*!
+ * \file PACC/Threading/SeqLock.hpp
+ * \brief Class definition for the sequence lock.
+ * \author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+ */
+
+#ifndef PACC_Threading_SeqLock_hpp_
+#define PACC_Threading_SeqLock_hpp_
+
+#include "PACC/Threading/SpinMutex.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+
+namespace PACC {
+	
+	using namespace std;
+	
+	namespace Threading {
+		
+		/*! \brief Sequence lock for snapshots of a small value.
+		\author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+		\ingroup Threading
+		
+		This class holds a value of a small trivially copyable type \c T (a few words, such as a structure of parameters or statistics), that many threads read and few threads write. Readers never write to shared memory: SeqLock::load copies the value, and retries if a writer changed it during the copy, as shown by the sequence number that each write increments before and after changing the value. Writers are serialized by a spin mutex, and never wait for readers; readers only spin while a write is in progress.
+		
+		The value is stored as an array of atomic words, which makes the concurrent copies well defined. Since a reader may retry, large values and frequent writes should use a RWMutex instead.
+		\code
+struct Parameters {double mRate; unsigned int mSize;};
+SeqLock<Parameters> lParameters;
+...
+Parameters lCurrent = lParameters.load();
+...
+lParameters.store(lNew);
+		\endcode
+		*/
+		template <class T>
+		class SeqLock {
+			static_assert(is_trivially_copyable<T>::value, "SeqLock<T> requires a trivially copyable type");
+			
+			public:
+			//! Construct sequence lock with value-initialized value.
+			SeqLock(void) : mSequence(0) {set(T());}
+			//! Construct sequence lock with value \c inValue.
+			explicit SeqLock(const T& inValue) : mSequence(0) {set(inValue);}
+			
+			//! Return the sequence number (even when no write is in progress, and incremented twice by each write).
+			unsigned int getSequence(void) const {return mSequence.load(memory_order_acquire);}
+			
+			//! Return a consistent copy of the value, spinning while a write is in progress.
+			T load(void) const {
+				T lValue;
+				while(!tryLoad(lValue)) SpinMutex::pause();
+				return lValue;
+			}
+			
+			//! Write value \c inValue.
+			void store(const T& inValue) {
+				mWriter.lock();
+				const unsigned int lSequence = mSequence.load(memory_order_relaxed);
+				mSequence.store(lSequence+1, memory_order_relaxed);
+				// the odd sequence must be visible before any word of the new value
+				atomic_thread_fence(memory_order_release);
+				set(inValue);
+				mSequence.store(lSequence+2, memory_order_release);
+				mWriter.unlock();
+			}
+			
+			/*! \brief Copy the value into \c outValue without retrying.
+			\return True if the copy is consistent, false if a write was in progress (\c outValue is then undefined).
+			*/
+			bool tryLoad(T& outValue) const {
+				const unsigned int lSequence = mSequence.load(memory_order_acquire);
+				if(lSequence & 1) return false;
+				size_t lWords[eWords];
+				for(size_t i = 0; i < eWords; ++i) lWords[i] = mWords[i].load(memory_order_relaxed);
+				// the words must be read before checking the sequence again
+				atomic_thread_fence(memory_order_acquire);
+				if(mSequence.load(memory_order_relaxed) != lSequence) return false;
+				memcpy(&outValue, lWords, sizeof(T));
+				return true;
+			}
+			
+			protected:
+			//! Number of words of the value.
+			enum {eWords = (sizeof(T)+sizeof(size_t)-1) / sizeof(size_t)};
+			
+			atomic<unsigned int> mSequence; //!< Sequence number (odd while a write is in progress).
+			atomic<size_t> mWords[eWords]; //!< Words of the value.
+			SpinMutex mWriter; //!< Mutex of writers.
+			
+			//! Copy value \c inValue into the words.
+			void set(const T& inValue) {
+				size_t lWords[eWords] = {};
+				memcpy(lWords, &inValue, sizeof(T));
+				for(size_t i = 0; i < eWords; ++i) mWords[i].store(lWords[i], memory_order_relaxed);
+			}
+			
+			private:
+			//! restrict (disable) copy constructor.
+			SeqLock(const SeqLock&);
+			//! restrict (disable) assignment operator.
+			void operator=(const SeqLock&);
+		};
+		
+	} // end of Threading namespace
+	
+} // end of PACC namespace
+
+#endif // PACC_Threading_SeqLock_hpp_
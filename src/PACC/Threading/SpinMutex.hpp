@@ -0,0 +1,101 @@
+/*
+ *  Portable Agile C++ Classes (PACC)
+ *  Copyright (C) 2001-2003 by Marc Parizeau
+ *  http://manitou.gel.ulaval.ca/~parizeau/PACC
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *  Contact:
+ *  Laboratoire de Vision et Systemes Numeriques
+ *  Departement de genie electrique et de genie informatique
+ *  Universite Laval, Quebec, Canada, G1K 7P4
+ *  http://vision.gel.ulaval.ca
+ *
+ */
+
+/*!
+ * \file PACC/Threading/SpinMutex.hpp
+ * \brief Class definition for the spin mutex.
+ * \author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+ */
+
+#ifndef PACC_Threading_SpinMutex_hpp_
+#define PACC_Threading_SpinMutex_hpp_
+
+#include <atomic>
+#include <thread>
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+#include <intrin.h>
+#endif
+
+namespace PACC {
+	
+	using namespace std;
+	
+	namespace Threading {
+		
+		/*! \brief Spin lock for very short critical sections.
+		\author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+		\ingroup Threading
+		
+		This class implements a test-and-test-and-set spin lock on a single atomic flag, with the same SpinMutex::lock, SpinMutex::tryLock, and SpinMutex::unlock methods as class Mutex. A waiting thread spins on a read of the flag with a processor pause instruction (see SpinMutex::pause), and yields its processor after a while, but never sleeps. It is neither recursive nor fair, and should only protect critical sections of a few instructions; use class AdaptiveMutex for critical sections of unknown length.
+		*/
+		class SpinMutex {
+			public:
+			//! Construct unlocked spin mutex.
+			SpinMutex(void) : mLocked(false) {}
+			
+			//! Lock the spin mutex, spinning until it is available.
+			void lock(void) const {
+				while(mLocked.exchange(true, memory_order_acquire)) {
+					for(unsigned int i = 1; mLocked.load(memory_order_relaxed); ++i) {
+						if(i % 1024 == 0) this_thread::yield();
+						else pause();
+					}
+				}
+			}
+			
+			//! Hint the processor that the calling thread is spinning (pause instruction of x86, yield instruction of ARM).
+			static void pause(void) {
+#if defined(__i386__) || defined(__x86_64__)
+				__builtin_ia32_pause();
+#elif defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+				_mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+				__asm__ __volatile__("yield");
+#endif
+			}
+			
+			//! Try to lock the spin mutex without spinning; return true if successful.
+			bool tryLock(void) const {return !mLocked.load(memory_order_relaxed) && !mLocked.exchange(true, memory_order_acquire);}
+			
+			//! Unlock the spin mutex.
+			void unlock(void) const {mLocked.store(false, memory_order_release);}
+			
+			protected:
+			mutable atomic<bool> mLocked; //!< Spin mutex is locked.
+			
+			private:
+			//! restrict (disable) copy constructor.
+			SpinMutex(const SpinMutex&);
+			//! restrict (disable) assignment operator.
+			void operator=(const SpinMutex&);
+		};
+		
+	} // end of Threading namespace
+	
+} // end of PACC namespace
+
+#endif // PACC_Threading_SpinMutex_hpp_
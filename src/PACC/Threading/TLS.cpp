@@ -51,14 +51,16 @@ typedef pthread_key_t TlsIndex;
 using namespace PACC;
 
 /*! 
+If a destructor is given, it is called with the non-null value of a thread when this thread 
+terminates. Destructors are only supported with POSIX threads; they are ignored under Windows.
 */
-Threading::TLS::TLS(void) : mIndex(0)
+Threading::TLS::TLS(void (*inDestructor)(void*)) : mIndex(0)
 {
 	TlsIndex* lIndex = new TlsIndex;
 #ifdef PACC_THREADS_WIN32
 	if((*lIndex = TlsAlloc()) == TLS_OUT_OF_INDEXES)
 #else
-	if(pthread_key_create(lIndex, NULL))
+	if(pthread_key_create(lIndex, inDestructor))
 #endif
 		throw Exception(eOtherError, "TLS::TLS() could not allocate local storage!");
 	mIndex = lIndex;
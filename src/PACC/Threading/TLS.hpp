@@ -50,8 +50,8 @@ namespace PACC {
 		*/
 		class TLS {
 		 public:
-			//! Construct local storage.
-			TLS(void);
+			//! Construct local storage, with optional destructor \c inDestructor for the objects of terminating threads.
+			explicit TLS(void (*inDestructor)(void*)=0);
 			
 			//! Delete local storage.
 			~TLS(void);
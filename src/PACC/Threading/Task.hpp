@@ -37,6 +37,7 @@
 #define PACC_Threading_Task_hpp_
 
 #include "PACC/Threading/Condition.hpp"
+#include "PACC/Threading/LightTask.hpp"
 
 namespace PACC {
 	
@@ -47,50 +48,30 @@ namespace PACC {
 		\ingroup Threading
 		
 		This abstract class encapsulates a primitive task that can be executed by a ThreadPool. It must be subclassed in order to implement virtual method Task::main which defines the task's function. Once pushed onto a thread pool using method ThreadPool::push, the task will start executing as soon as a thread becomes available. A task cannot be canceled after it has started to run.
+		
+		The state of the task is the atomic state of its LightTask base. Its slave thread also locks the embedded mutex and broadcasts the embedded condition when the task starts and when it completes, so that a thread can wait for the task using the following protocol: \c lock(), \c while(!isCompleted()) \c Condition::wait(), \c unlock().
 		*/
-		class Task : public Condition {
+		class Task : public LightTask, public Condition {
 			public: 
 			//! Construct default task: initialize to not running and not completed.
-			Task(void) : mRunning(false), mCompleted(false) {}
-			//! Delete task: wait for task completion.
-			virtual ~Task(void) {lock(); while(!mCompleted) wait(); unlock();}
-			
-			/*! \brief Check wheter task is completed.
-			
-			The embedded mutex should always be locked (using method Task::lock) prior to calling this method.
-			*/
-			bool isCompleted(void) const {return mCompleted;}
-			
-			/*! \brief Check wheter task is running.
-			
-			The embedded mutex should always be locked (using method Task::lock) prior to calling this method.
-			*/
-			bool isRunning(void) const {return mRunning;}
-			
-			/*! \brief Implements main procedure of task.
-			
-			This virtual method must be overloaded in a derived class in order to implement the main procedure of this task.
-			*/
-			virtual void main(void) = 0;
-			
-			//! Reset internal task state to default (not running and not completed).
-			void reset(void) {lock(); mRunning = mCompleted = false; unlock();}
+			Task(void) {}
+			//! Delete task: wait for task completion if the task was pushed onto a thread pool, and for its slave thread to release the embedded mutex.
+			virtual ~Task(void) {if(isPending()) LightTask::wait(); lock(); unlock();}
 			
 			/*! \brief Wait for task to complete.
 				
-				If argument \c inLock is true (default), this method locks the embedded mutex prior to waiting on the condition, and unlocks the mutex prior to return. Otherwise, it assumes that the mutex is already locked and does not modify its state. This method should never be called with argument \c inLock=false without first locking the mutex using method Task::lock.
+				If argument \c inLock is true (default), this method waits on the atomic state of the task, without locking the embedded mutex. Otherwise, it assumes that the mutex is already locked and waits on the embedded condition, without modifying the state of the mutex. This method should never be called with argument \c inLock=false without first locking the mutex using method Task::lock.
 			*/
 			void wait(bool inLock=true) const {
-				if(inLock) lock();
-				while(!mCompleted) Condition::wait();
-				if(inLock) unlock();
+				if(inLock) LightTask::wait();
+				else while(!isCompleted()) Condition::wait();
 			}
 			
 			protected:
-			bool mRunning; //!< is running flag
-			bool mCompleted; //!< is completed flag
-			
-			friend class SlaveThread;
+			//! Mark task as completed, and broadcast the embedded condition (called by its slave thread).
+			virtual void complete(void) {lock(); LightTask::complete(); broadcast(); unlock();}
+			//! Mark task as running, and broadcast the embedded condition (called by its slave thread).
+			virtual void start(void) {lock(); LightTask::start(); broadcast(); unlock();}
 		};
 		
 	} // end of Threading namespace 
@@ -0,0 +1,130 @@
+/*
+ *  Portable Agile C++ Classes (PACC)
+ *  Copyright (C) 2001-2003 by Marc Parizeau
+ *  http://manitou.gel.ulaval.ca/~parizeau/PACC
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *  Contact:
+ *  Laboratoire de Vision et Systemes Numeriques
+ *  Departement de genie electrique et de genie informatique
+ *  Universite Laval, Quebec, Canada, G1K 7P4
+ *  http://vision.gel.ulaval.ca
+ *
+ */
+
+/*!
+ * \file PACC/Threading/TaskDeque.cpp
+ * \brief Class methods for the work-stealing deque of tasks.
+ * \author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+ */
+
+#include "PACC/Threading/TaskDeque.hpp"
+
+using namespace std;
+using namespace PACC;
+
+/*! 
+The initial capacity \c inCapacity is rounded up to a power of 2.
+*/
+Threading::TaskDeque::TaskDeque(unsigned int inCapacity) : mTop(0), mBottom(0)
+{
+	long lCapacity = 2;
+	while(lCapacity < (long) inCapacity) lCapacity *= 2;
+	Array* lArray = new Array;
+	lArray->mMask = lCapacity-1;
+	lArray->mSlots = new atomic<LightTask*>[lCapacity];
+	mArrays.push_back(lArray);
+	mArray.store(lArray, memory_order_relaxed);
+}
+
+/*!
+The deque should no longer be accessed by any thread. The remaining tasks are not deleted.
+*/
+Threading::TaskDeque::~TaskDeque(void)
+{
+	for(unsigned int i = 0; i < mArrays.size(); ++i) {
+		delete[] mArrays[i]->mSlots;
+		delete mArrays[i];
+	}
+}
+
+/*!
+Return a new array of twice the capacity of array \c inArray, with a copy of the tasks from index \c inTop to \c inBottom. This method is only called by the owner thread.
+*/
+Threading::TaskDeque::Array* Threading::TaskDeque::grow(Array* inArray, long inTop, long inBottom)
+{
+	Array* lArray = new Array;
+	lArray->mMask = 2*inArray->mMask+1;
+	lArray->mSlots = new atomic<LightTask*>[lArray->mMask+1];
+	for(long i = inTop; i < inBottom; ++i) lArray->put(i, inArray->get(i));
+	mArrays.push_back(lArray);
+	mArray.store(lArray, memory_order_release);
+	return lArray;
+}
+
+/*!
+Return the bottom task of the deque, or a null pointer if the deque is empty (or if the last task was stolen concurrently). This method should only be called by the owner thread.
+*/
+Threading::LightTask* Threading::TaskDeque::pop(void)
+{
+	const long lBottom = mBottom.load(memory_order_relaxed) - 1;
+	Array* lArray = mArray.load(memory_order_relaxed);
+	mBottom.store(lBottom, memory_order_relaxed);
+	atomic_thread_fence(memory_order_seq_cst);
+	long lTop = mTop.load(memory_order_relaxed);
+	LightTask* lTask = 0;
+	if(lTop <= lBottom) {
+		lTask = lArray->get(lBottom);
+		if(lTop == lBottom) {
+			// last task, race against thieves
+			if(!mTop.compare_exchange_strong(lTop, lTop+1, memory_order_seq_cst, memory_order_relaxed)) lTask = 0;
+			mBottom.store(lBottom+1, memory_order_relaxed);
+		}
+	} else {
+		// deque was empty
+		mBottom.store(lBottom+1, memory_order_relaxed);
+	}
+	return lTask;
+}
+
+/*!
+This method should only be called by the owner thread.
+*/
+void Threading::TaskDeque::push(LightTask* inTask)
+{
+	const long lBottom = mBottom.load(memory_order_relaxed);
+	const long lTop = mTop.load(memory_order_acquire);
+	Array* lArray = mArray.load(memory_order_relaxed);
+	if(lBottom - lTop > lArray->mMask) lArray = grow(lArray, lTop, lBottom);
+	lArray->put(lBottom, inTask);
+	atomic_thread_fence(memory_order_release);
+	mBottom.store(lBottom+1, memory_order_relaxed);
+}
+
+/*!
+Return the top task of the deque, or a null pointer if the deque is empty or if another thread won the race for this task. This method can be called by any thread.
+*/
+Threading::LightTask* Threading::TaskDeque::steal(void)
+{
+	long lTop = mTop.load(memory_order_acquire);
+	atomic_thread_fence(memory_order_seq_cst);
+	const long lBottom = mBottom.load(memory_order_acquire);
+	if(lTop >= lBottom) return 0;
+	Array* lArray = mArray.load(memory_order_acquire);
+	LightTask* lTask = lArray->get(lTop);
+	if(!mTop.compare_exchange_strong(lTop, lTop+1, memory_order_seq_cst, memory_order_relaxed)) return 0;
+	return lTask;
+}
@@ -0,0 +1,103 @@
+/*
+ *  Portable Agile C++ Classes (PACC)
+ *  Copyright (C) 2001-2003 by Marc Parizeau
+ *  http://manitou.gel.ulaval.ca/~parizeau/PACC
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *  Contact:
+ *  Laboratoire de Vision et Systemes Numeriques
+ *  Departement de genie electrique et de genie informatique
+ *  Universite Laval, Quebec, Canada, G1K 7P4
+ *  http://vision.gel.ulaval.ca
+ *
+ */
+
+/*!
+ * \file PACC/Threading/TaskDeque.hpp
+ * \brief Class definition for the work-stealing deque of tasks.
+ * \author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+ */
+
+#ifndef PACC_Threading_TaskDeque_hpp_
+#define PACC_Threading_TaskDeque_hpp_
+
+#include <atomic>
+#include <vector>
+
+namespace PACC {
+	
+	using namespace std;
+	
+	namespace Threading {
+		
+		class LightTask;
+		
+		/*! \brief Work-stealing deque of tasks.
+		\author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+		\ingroup Threading
+		
+		This class implements the lock-free deque of Chase and Lev (with the memory orderings of L&ecirc; et al., PPoPP 2013). A single owner thread pushes and pops tasks at the bottom of the deque (LIFO order), while any other thread can steal tasks from its top (FIFO order). The circular array grows as needed; arrays that are replaced remain allocated until the deque is deleted, because a concurrent thief could still be reading them.
+		*/
+		class TaskDeque {
+		 public:
+			explicit TaskDeque(unsigned int inCapacity=256);
+			~TaskDeque(void);
+			
+			//! Return whether the deque is empty (may be called by any thread).
+			bool isEmpty(void) const {return mBottom.load() <= mTop.load();}
+			
+			LightTask* pop(void);
+			void push(LightTask* inTask);
+			
+			//! Return the number of tasks in the deque (may be called by any thread, but is only approximate if other threads modify the deque).
+			unsigned int size(void) const {
+				const long lSize = mBottom.load() - mTop.load();
+				return lSize > 0 ? (unsigned int) lSize : 0;
+			}
+			
+			LightTask* steal(void);
+			
+		 protected:
+			//! Circular array of tasks.
+			struct Array {
+				long mMask; //!< Capacity of array minus 1 (capacity is a power of 2).
+				atomic<LightTask*>* mSlots; //!< Task slots.
+				
+				//! Return task at index \c inIndex.
+				LightTask* get(long inIndex) const {return mSlots[inIndex & mMask].load(memory_order_relaxed);}
+				//! Put task \c inTask at index \c inIndex.
+				void put(long inIndex, LightTask* inTask) {mSlots[inIndex & mMask].store(inTask, memory_order_relaxed);}
+			};
+			
+			alignas(64) atomic<long> mTop; //!< Index of top task (modified by thieves and owner).
+			alignas(64) atomic<long> mBottom; //!< Index past the bottom task (modified by owner only).
+			atomic<Array*> mArray; //!< Current circular array.
+			vector<Array*> mArrays; //!< All allocated arrays (owner only).
+			
+			Array* grow(Array* inArray, long inTop, long inBottom);
+			
+		 private:
+			//! restrict (disable) copy constructor.
+			TaskDeque(const TaskDeque&);
+			//! restrict (disable) assignment operator.
+			void operator=(const TaskDeque&);
+		};
+		
+	} // end of Threading namespace
+	
+} // end of PACC namespace
+
+#endif // PACC_Threading_TaskDeque_hpp_
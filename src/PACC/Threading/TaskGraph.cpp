@@ -0,0 +1,221 @@
+/*
+ *  Portable Agile C++ Classes (PACC)
+ *  Copyright (C) 2001-2003 by Marc Parizeau
+ *  http://manitou.gel.ulaval.ca/~parizeau/PACC
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *  Contact:
+ *  Laboratoire de Vision et Systemes Numeriques
+ *  Departement de genie electrique et de genie informatique
+ *  Universite Laval, Quebec, Canada, G1K 7P4
+ *  http://vision.gel.ulaval.ca
+ *
+ */
+
+/*!
+ * \file PACC/Threading/TaskGraph.cpp
+ * \brief Class methods for the graph of dependent tasks.
+ * \author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+ */
+
+#include "PACC/Threading/TaskGraph.hpp"
+#include "PACC/Threading/Exception.hpp"
+#include "PACC/Threading/ThreadPool.hpp"
+#include "PACC/Util/Assert.hpp"
+#include <algorithm>
+
+using namespace std;
+using namespace PACC;
+
+//! Construct empty task graph.
+Threading::TaskGraph::TaskGraph(void) : mReported(0), mPool(0)
+{}
+
+//! Delete task graph: wait for completion of all tasks.
+Threading::TaskGraph::~TaskGraph(void)
+{
+	clear();
+}
+
+/*! \brief Add task \c inTask of cost \c inCost to the graph, and return its index.
+
+The cost is any positive measure of the duration of the task, which is used to compute the critical path priorities (see TaskGraph::run). The task is not owned by the graph. This method must not be called while the graph runs.
+*/
+unsigned int Threading::TaskGraph::add(LightTask& inTask, double inCost)
+{
+	Node lNode;
+	lNode.mTask = &inTask;
+	lNode.mCost = inCost;
+	lNode.mPriority = inCost;
+	lNode.mPredecessors = 0;
+	lNode.mRunner = new Runner(this);
+	mNodes.push_back(lNode);
+	return mNodes.size()-1;
+}
+
+/*! \brief Declare that task \c inTask depends on task \c inPredecessor.
+
+Task \c inTask will not start before task \c inPredecessor is completed. This method must not be called while the graph runs.
+*/
+void Threading::TaskGraph::addDependency(unsigned int inTask, unsigned int inPredecessor)
+{
+	PACC_AssertM(inTask < mNodes.size() && inPredecessor < mNodes.size(), "TaskGraph::addDependency() invalid task index!");
+	PACC_AssertM(inTask != inPredecessor, "TaskGraph::addDependency() a task cannot depend on itself!");
+	mNodes[inPredecessor].mSuccessors.push_back(inTask);
+	++mNodes[inTask].mPredecessors;
+}
+
+//! Wait for completion of all tasks, and remove them from the graph.
+void Threading::TaskGraph::clear(void)
+{
+	waitAll();
+	for(unsigned int i = 0; i < mNodes.size(); ++i) delete mNodes[i].mRunner;
+	mNodes.clear();
+	mPending.reset();
+	mReady.clear();
+	mCompleted.clear();
+	mReported = 0;
+	mPool = 0;
+}
+
+/*! \brief Compute the critical path priority of each node.
+
+Nodes are sorted in topological order, and the priority of a node is its cost plus the largest priority of its successors. Any cycle raises a Threading::Exception.
+*/
+void Threading::TaskGraph::computePriorities(void)
+{
+	vector<unsigned int> lOrder;
+	vector<unsigned int> lCounts(mNodes.size());
+	lOrder.reserve(mNodes.size());
+	for(unsigned int i = 0; i < mNodes.size(); ++i) {
+		lCounts[i] = mNodes[i].mPredecessors;
+		if(lCounts[i] == 0) lOrder.push_back(i);
+	}
+	for(unsigned int i = 0; i < lOrder.size(); ++i) {
+		const vector<unsigned int>& lSuccessors = mNodes[lOrder[i]].mSuccessors;
+		for(unsigned int j = 0; j < lSuccessors.size(); ++j) {
+			if(--lCounts[lSuccessors[j]] == 0) lOrder.push_back(lSuccessors[j]);
+		}
+	}
+	if(lOrder.size() != mNodes.size()) throw Exception(eOtherError, "TaskGraph::run() the graph contains a cycle!");
+	// successors come after their predecessors in topological order
+	for(unsigned int i = lOrder.size(); i-- > 0;) {
+		Node& lNode = mNodes[lOrder[i]];
+		double lMax = 0;
+		for(unsigned int j = 0; j < lNode.mSuccessors.size(); ++j) lMax = max(lMax, mNodes[lNode.mSuccessors[j]].mPriority);
+		lNode.mPriority = lNode.mCost + lMax;
+	}
+}
+
+//! Return whether ready node \c inFirst should run after ready node \c inSecond (heap order: lower priority first, then higher index).
+bool Threading::TaskGraph::isBefore(unsigned int inFirst, unsigned int inSecond) const
+{
+	if(mNodes[inFirst].mPriority != mNodes[inSecond].mPriority) return mNodes[inFirst].mPriority < mNodes[inSecond].mPriority;
+	return inFirst > inSecond;
+}
+
+//! Insert nodes \c inNodes into the heap of ready nodes, and push one runner for each of them onto the thread pool.
+void Threading::TaskGraph::pushReady(const vector<unsigned int>& inNodes)
+{
+	lock();
+	for(unsigned int i = 0; i < inNodes.size(); ++i) {
+		mReady.push_back(inNodes[i]);
+		push_heap(mReady.begin(), mReady.end(), [this](unsigned int inFirst, unsigned int inSecond) {return isBefore(inFirst, inSecond);});
+	}
+	unlock();
+	for(unsigned int i = 0; i < inNodes.size(); ++i) mPool->push(*mNodes[inNodes[i]].mRunner);
+}
+
+/*! \brief Run the graph on thread pool \c inPool.
+
+This method computes the critical path priorities, and pushes the tasks without predecessors onto the thread pool; it returns without waiting (see TaskGraph::waitAll and TaskGraph::waitAny). A graph can be run again after completion of all of its tasks. A cycle in the graph, or a graph that is already running, raises a Threading::Exception.
+*/
+void Threading::TaskGraph::run(ThreadPool& inPool)
+{
+	lock();
+	bool lRunning = mPool != 0 && mCompleted.size() < mNodes.size();
+	unlock();
+	if(lRunning) throw Exception(eRunning, "TaskGraph::run() graph is already running!");
+	// runners of the previous run may still be finishing after the completion of their last node
+	for(unsigned int i = 0; i < mNodes.size(); ++i) {
+		if(mNodes[i].mRunner->isPending()) mNodes[i].mRunner->wait();
+	}
+	computePriorities();
+	mPending.reset(new atomic<unsigned int>[mNodes.size()]);
+	vector<unsigned int> lRoots;
+	for(unsigned int i = 0; i < mNodes.size(); ++i) {
+		// the task may have been completed by a previous run, or pushed elsewhere before
+		mNodes[i].mTask->reset();
+		mNodes[i].mTask->mGroup = 0;
+		mNodes[i].mTask->mAutoDelete = false;
+		mPending[i] = mNodes[i].mPredecessors;
+		if(mNodes[i].mPredecessors == 0) lRoots.push_back(i);
+	}
+	mReady.clear();
+	mCompleted.clear();
+	mCompleted.reserve(mNodes.size());
+	mReported = 0;
+	mPool = &inPool;
+	pushReady(lRoots);
+}
+
+/*! \brief Run the ready node of highest priority (called by a runner).
+
+After completion of its task, the pending count of each successor is decremented, and the successors that have no more pending predecessors become ready.
+*/
+void Threading::TaskGraph::runNext(void)
+{
+	lock();
+	PACC_AssertM(!mReady.empty(), "TaskGraph::runNext() no ready task!");
+	pop_heap(mReady.begin(), mReady.end(), [this](unsigned int inFirst, unsigned int inSecond) {return isBefore(inFirst, inSecond);});
+	unsigned int lNode = mReady.back();
+	mReady.pop_back();
+	unlock();
+	SlaveThread::execute(mNodes[lNode].mTask);
+	// release successors
+	vector<unsigned int> lReady;
+	const vector<unsigned int>& lSuccessors = mNodes[lNode].mSuccessors;
+	for(unsigned int i = 0; i < lSuccessors.size(); ++i) {
+		if(--mPending[lSuccessors[i]] == 0) lReady.push_back(lSuccessors[i]);
+	}
+	if(!lReady.empty()) pushReady(lReady);
+	lock();
+	mCompleted.push_back(lNode);
+	broadcast();
+	unlock();
+}
+
+//! Wait for completion of all tasks of the current run (return immediately if the graph was never run).
+void Threading::TaskGraph::waitAll(void)
+{
+	lock();
+	while(mPool != 0 && mCompleted.size() < mNodes.size()) wait();
+	unlock();
+}
+
+/*! \brief Wait for the completion of a task of the current run, and return its index.
+
+Each call returns a different task, in order of completion; a task that was completed before the call is returned immediately. Calling this method more times than there are tasks in the graph is an error.
+*/
+unsigned int Threading::TaskGraph::waitAny(void)
+{
+	lock();
+	PACC_AssertM(mPool != 0 && mReported < mNodes.size(), "TaskGraph::waitAny() no more task to wait for!");
+	while(mCompleted.size() == mReported) wait();
+	unsigned int lNode = mCompleted[mReported++];
+	unlock();
+	return lNode;
+}
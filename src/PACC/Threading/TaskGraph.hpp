@@ -0,0 +1,129 @@
+/*
+ *  Portable Agile C++ Classes (PACC)
+ *  Copyright (C) 2001-2003 by Marc Parizeau
+ *  http://manitou.gel.ulaval.ca/~parizeau/PACC
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *  Contact:
+ *  Laboratoire de Vision et Systemes Numeriques
+ *  Departement de genie electrique et de genie informatique
+ *  Universite Laval, Quebec, Canada, G1K 7P4
+ *  http://vision.gel.ulaval.ca
+ *
+ */
+
+/*!
+ * \file PACC/Threading/TaskGraph.hpp
+ * \brief Class definition for the graph of dependent tasks.
+ * \author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+ */
+
+#ifndef PACC_Threading_TaskGraph_hpp_
+#define PACC_Threading_TaskGraph_hpp_
+
+#include "PACC/Threading/Condition.hpp"
+#include "PACC/Threading/Task.hpp"
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace PACC {
+	
+	using namespace std;
+	
+	namespace Threading {
+		
+		class ThreadPool;
+		
+		/*! \brief Directed acyclic graph of dependent tasks.
+		\author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+		\ingroup Threading
+		
+		This class schedules a set of tasks with dependencies onto a ThreadPool. Tasks are added with method TaskGraph::add, which returns their index in the graph, and dependencies are declared with method TaskGraph::addDependency. Method TaskGraph::run then pushes the tasks without predecessors onto the thread pool; each task becomes ready as soon as all of its predecessors are completed, which is tracked by an atomic count of pending predecessors. The calling thread never waits between wavefronts of tasks.
+		
+		Among the ready tasks, the one with the longest critical path runs first: the priority of a task is the largest total cost of any path from this task to a task without successors (its cost is given to TaskGraph::add). The thread pool may thus run tasks of a graph in any order, but a slave always takes the ready task with the highest priority.
+		
+		Method TaskGraph::waitAll waits for all tasks to complete, and method TaskGraph::waitAny waits for the next task to complete. The tasks themselves are not owned by the graph, and their Task::wait method may also be used. Here is a simple usage example:
+		\code
+TaskGraph lGraph;
+unsigned int lLoad = lGraph.add(lLoadTask);
+unsigned int lEvaluate = lGraph.add(lEvaluateTask, 10);
+unsigned int lReduce = lGraph.add(lReduceTask);
+lGraph.addDependency(lEvaluate, lLoad);
+lGraph.addDependency(lReduce, lEvaluate);
+lGraph.run(lPool);
+...
+lGraph.waitAll();
+		\endcode
+		*/
+		class TaskGraph : public Condition {
+			public:
+			TaskGraph(void);
+			~TaskGraph(void);
+			
+			unsigned int add(LightTask& inTask, double inCost=1);
+			void addDependency(unsigned int inTask, unsigned int inPredecessor);
+			void clear(void);
+			//! Return the priority of task \c inTask (length of its critical path, computed by TaskGraph::run).
+			double getPriority(unsigned int inTask) const {return mNodes[inTask].mPriority;}
+			//! Return the task of index \c inTask.
+			LightTask& getTask(unsigned int inTask) const {return *mNodes[inTask].mTask;}
+			void run(ThreadPool& inPool);
+			//! Return the number of tasks in graph.
+			unsigned int size(void) const {return mNodes.size();}
+			void waitAll(void);
+			unsigned int waitAny(void);
+			
+			protected:
+			//! Task pushed onto the thread pool for each ready task of the graph.
+			class Runner : public LightTask {
+				public:
+				//! Construct runner of graph \c inGraph.
+				Runner(TaskGraph* inGraph) : mGraph(inGraph) {}
+				//! Run the ready task of highest priority.
+				void main(void) {mGraph->runNext();}
+				protected:
+				TaskGraph* mGraph; //!< Parent graph.
+			};
+			
+			//! Node of the graph.
+			struct Node {
+				LightTask* mTask; //!< Task of node.
+				double mCost; //!< Cost of task.
+				double mPriority; //!< Total cost of the critical path from this node.
+				unsigned int mPredecessors; //!< Number of predecessors.
+				vector<unsigned int> mSuccessors; //!< Indices of successors.
+				Runner* mRunner; //!< Runner pushed when the node becomes ready.
+			};
+			
+			vector<Node> mNodes; //!< Nodes of graph.
+			unique_ptr<atomic<unsigned int>[]> mPending; //!< Number of pending predecessors of each node.
+			vector<unsigned int> mReady; //!< Heap of ready nodes, ordered by priority.
+			vector<unsigned int> mCompleted; //!< Completed nodes, in order of completion.
+			unsigned int mReported; //!< Number of completed nodes returned by TaskGraph::waitAny.
+			ThreadPool* mPool; //!< Thread pool of current run.
+			
+			void computePriorities(void);
+			bool isBefore(unsigned int inFirst, unsigned int inSecond) const;
+			void pushReady(const vector<unsigned int>& inNodes);
+			void runNext(void);
+		};
+		
+	} // end of Threading namespace
+	
+} // end of PACC namespace
+
+#endif // PACC_Threading_TaskGraph_hpp_
@@ -0,0 +1,88 @@
+/*
+ *  Portable Agile C++ Classes (PACC)
+ *  Copyright (C) 2001-2003 by Marc Parizeau
+ *  http://manitou.gel.ulaval.ca/~parizeau/PACC
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *  Contact:
+ *  Laboratoire de Vision et Systemes Numeriques
+ *  Departement de genie electrique et de genie informatique
+ *  Universite Laval, Quebec, Canada, G1K 7P4
+ *  http://vision.gel.ulaval.ca
+ *
+ */
+
+/*!
+ * \file PACC/Threading/TaskGroup.cpp
+ * \brief Class methods for the group of thread pool tasks.
+ * \author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+ */
+
+#include "PACC/Threading/TaskGroup.hpp"
+#include "PACC/Threading/ThreadPool.hpp"
+
+using namespace std;
+using namespace PACC;
+
+/*! \brief Account for a completed task of the group (called by its slave thread).
+
+The completion of the last pending task wakes up the waiting thread, if any. The flag is set under the lock, so that the group is not deleted before this method returns.
+*/
+void Threading::TaskGroup::done(void)
+{
+	if(mPending.fetch_sub(1) == 1) {
+		lock();
+		mDone = true;
+		broadcast();
+		unlock();
+	}
+}
+
+//! Push task \c inTask onto the thread pool, as a member of this group.
+void Threading::TaskGroup::push(LightTask& inTask)
+{
+	LightTask* lTask = &inTask;
+	push(&lTask, 1);
+}
+
+//! Push the \c inCount tasks of array \c inTasks onto the thread pool, as members of this group (see ThreadPool::pushBatch).
+void Threading::TaskGroup::push(LightTask** inTasks, unsigned int inCount)
+{
+	mPending += inCount;
+	mPool.enqueue(inTasks, inCount, this);
+}
+
+//! Push the \c inCount tasks of array \c inTasks onto the thread pool, as members of this group (see ThreadPool::pushBatch).
+void Threading::TaskGroup::push(Task** inTasks, unsigned int inCount)
+{
+	mPending += inCount;
+	mPool.enqueue(inTasks, inCount, this);
+}
+
+/*! \brief Wait for the completion of all pending tasks of the group.
+
+The extra count of the group is removed while waiting, so that either this method or the last pending task brings the count to zero. Only one thread may wait at a time.
+*/
+void Threading::TaskGroup::waitAll(void)
+{
+	if(mPending.fetch_sub(1) != 1) {
+		lock();
+		while(!mDone) Condition::wait();
+		mDone = false;
+		unlock();
+	}
+	mPending.fetch_add(1);
+}
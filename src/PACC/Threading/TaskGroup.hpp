@@ -0,0 +1,91 @@
+/*
+ *  Portable Agile C++ Classes (PACC)
+ *  Copyright (C) 2001-2003 by Marc Parizeau
+ *  http://manitou.gel.ulaval.ca/~parizeau/PACC
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *  Contact:
+ *  Laboratoire de Vision et Systemes Numeriques
+ *  Departement de genie electrique et de genie informatique
+ *  Universite Laval, Quebec, Canada, G1K 7P4
+ *  http://vision.gel.ulaval.ca
+ *
+ */
+
+/*!
+ * \file PACC/Threading/TaskGroup.hpp
+ * \brief Class definition for the group of thread pool tasks.
+ * \author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+ */
+
+#ifndef PACC_Threading_TaskGroup_hpp_
+#define PACC_Threading_TaskGroup_hpp_
+
+#include "PACC/Threading/Condition.hpp"
+#include "PACC/Threading/Task.hpp"
+#include <atomic>
+
+namespace PACC {
+	
+	using namespace std;
+	
+	namespace Threading {
+		
+		class ThreadPool;
+		
+		/*! \brief Group of thread pool tasks with a single completion wait.
+		\author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+		\ingroup Threading
+		
+		This class pushes tasks onto a thread pool (see TaskGroup::push), and counts the pending tasks of the group with a single atomic counter. Method TaskGroup::waitAll waits for all of them to complete; only the completion of the last pending task locks the group and wakes up the waiting thread, so that a group of thousands of tasks is waited for with a single wake up, instead of a wait on each task. Tasks of the group may push other tasks onto the same group.
+		
+		The group can be reused after TaskGroup::waitAll returns. Its destructor waits for all pending tasks.
+		\code
+TaskGroup lGroup(lPool);
+lGroup.push(&lTasks[0], lTasks.size());
+...
+lGroup.waitAll();
+		\endcode
+		*/
+		class TaskGroup : public Condition {
+			public:
+			//! Construct empty group of tasks for thread pool \c inPool.
+			TaskGroup(ThreadPool& inPool) : mPool(inPool), mPending(1), mDone(false) {}
+			//! Delete group: wait for all pending tasks.
+			~TaskGroup(void) {waitAll();}
+			
+			//! Return the number of pending tasks.
+			unsigned int getPending(void) const {return mPending.load()-1;}
+			void push(LightTask& inTask);
+			void push(LightTask** inTasks, unsigned int inCount);
+			void push(Task** inTasks, unsigned int inCount);
+			void waitAll(void);
+			
+			protected:
+			ThreadPool& mPool; //!< Thread pool of tasks.
+			atomic<unsigned int> mPending; //!< Number of pending tasks, plus one while no thread waits.
+			bool mDone; //!< Last pending task has completed while a thread waits.
+			
+			void done(void);
+			
+			friend class SlaveThread;
+		};
+		
+	} // end of Threading namespace
+	
+} // end of PACC namespace
+
+#endif // PACC_Threading_TaskGroup_hpp_
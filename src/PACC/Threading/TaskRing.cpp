@@ -0,0 +1,107 @@
+/*
+ *  Portable Agile C++ Classes (PACC)
+ *  Copyright (C) 2001-2003 by Marc Parizeau
+ *  http://manitou.gel.ulaval.ca/~parizeau/PACC
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *  Contact:
+ *  Laboratoire de Vision et Systemes Numeriques
+ *  Departement de genie electrique et de genie informatique
+ *  Universite Laval, Quebec, Canada, G1K 7P4
+ *  http://vision.gel.ulaval.ca
+ *
+ */
+
+/*!
+ * \file PACC/Threading/TaskRing.cpp
+ * \brief Class methods for the bounded lock-free queue of tasks.
+ * \author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+ */
+
+#include "PACC/Threading/TaskRing.hpp"
+
+using namespace std;
+using namespace PACC;
+
+/*! 
+The capacity \c inCapacity is rounded up to a power of 2.
+*/
+Threading::TaskRing::TaskRing(unsigned int inCapacity) : mHead(0), mTail(0)
+{
+	size_t lCapacity = 2;
+	while(lCapacity < inCapacity) lCapacity *= 2;
+	mMask = lCapacity-1;
+	mCells = new Cell[lCapacity];
+	for(size_t i = 0; i < lCapacity; ++i) {
+		mCells[i].mSequence.store(i, memory_order_relaxed);
+		mCells[i].mTask = 0;
+	}
+}
+
+/*!
+The queue should no longer be accessed by any thread. The remaining tasks are not deleted.
+*/
+Threading::TaskRing::~TaskRing(void)
+{
+	delete[] mCells;
+}
+
+/*!
+Return the task at the head of the queue, or a null pointer if the queue is empty. This method can be called by any thread.
+*/
+Threading::LightTask* Threading::TaskRing::pop(void)
+{
+	size_t lPosition = mHead.load(memory_order_relaxed);
+	Cell* lCell;
+	while(true) {
+		lCell = &mCells[lPosition & mMask];
+		const size_t lSequence = lCell->mSequence.load(memory_order_acquire);
+		const ptrdiff_t lDifference = (ptrdiff_t) lSequence - (ptrdiff_t) (lPosition+1);
+		if(lDifference == 0) {
+			// cell is full, try to claim it
+			if(mHead.compare_exchange_weak(lPosition, lPosition+1, memory_order_relaxed)) break;
+		} 
+		else if(lDifference < 0) return 0; // queue is empty
+		else lPosition = mHead.load(memory_order_relaxed);
+	}
+	LightTask* lTask = lCell->mTask;
+	// release cell for the push that will be made one lap later
+	lCell->mSequence.store(lPosition+mMask+1, memory_order_release);
+	return lTask;
+}
+
+/*!
+Return false if the queue is full. This method can be called by any thread.
+*/
+bool Threading::TaskRing::push(LightTask* inTask)
+{
+	size_t lPosition = mTail.load(memory_order_relaxed);
+	Cell* lCell;
+	while(true) {
+		lCell = &mCells[lPosition & mMask];
+		const size_t lSequence = lCell->mSequence.load(memory_order_acquire);
+		const ptrdiff_t lDifference = (ptrdiff_t) lSequence - (ptrdiff_t) lPosition;
+		if(lDifference == 0) {
+			// cell is empty, try to claim it
+			if(mTail.compare_exchange_weak(lPosition, lPosition+1, memory_order_relaxed)) break;
+		} 
+		else if(lDifference < 0) return false; // queue is full
+		else lPosition = mTail.load(memory_order_relaxed);
+	}
+	lCell->mTask = inTask;
+	lCell->mSequence.store(lPosition+1, memory_order_release);
+	return true;
+}
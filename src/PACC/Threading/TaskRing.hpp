@@ -0,0 +1,97 @@
+/*
+ *  Portable Agile C++ Classes (PACC)
+ *  Copyright (C) 2001-2003 by Marc Parizeau
+ *  http://manitou.gel.ulaval.ca/~parizeau/PACC
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *  Contact:
+ *  Laboratoire de Vision et Systemes Numeriques
+ *  Departement de genie electrique et de genie informatique
+ *  Universite Laval, Quebec, Canada, G1K 7P4
+ *  http://vision.gel.ulaval.ca
+ *
+ */
+
+/*!
+ * \file PACC/Threading/TaskRing.hpp
+ * \brief Class definition for the bounded lock-free queue of tasks.
+ * \author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+ */
+
+#ifndef PACC_Threading_TaskRing_hpp_
+#define PACC_Threading_TaskRing_hpp_
+
+#include <atomic>
+#include <cstddef>
+
+namespace PACC {
+	
+	using namespace std;
+	
+	namespace Threading {
+		
+		class LightTask;
+		
+		/*! \brief Bounded lock-free multi-producer multi-consumer queue of tasks.
+		\author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+		\ingroup Threading
+		
+		This class implements the bounded queue of Dmitry Vyukov: a circular array of cells that each hold a task and a sequence number. Producers and consumers claim a position with a single compare-and-swap on the tail or head index, and the sequence number of the cell tells them whether the cell is ready, so that neither end ever takes a lock. Tasks are popped in FIFO order. Method TaskRing::push fails when the queue is full.
+		*/
+		class TaskRing {
+		 public:
+			explicit TaskRing(unsigned int inCapacity=4096);
+			~TaskRing(void);
+			
+			//! Return the capacity of the queue.
+			unsigned int getCapacity(void) const {return (unsigned int) mMask+1;}
+			
+			//! Return whether the queue is empty (may be called by any thread).
+			bool isEmpty(void) const {return mHead.load() >= mTail.load();}
+			
+			//! Return the number of tasks in the queue (may be called by any thread, but is only approximate if other threads modify the queue).
+			unsigned int size(void) const {
+				const size_t lHead = mHead.load(), lTail = mTail.load();
+				return lTail > lHead ? (unsigned int) (lTail - lHead) : 0;
+			}
+			
+			LightTask* pop(void);
+			bool push(LightTask* inTask);
+			
+		 protected:
+			//! Cell of the circular array.
+			struct Cell {
+				atomic<size_t> mSequence; //!< Sequence number of cell.
+				LightTask* mTask; //!< Task of cell.
+			};
+			
+			Cell* mCells; //!< Circular array of cells.
+			size_t mMask; //!< Capacity of array minus 1 (capacity is a power of 2).
+			alignas(64) atomic<size_t> mHead; //!< Position of next pop.
+			alignas(64) atomic<size_t> mTail; //!< Position of next push.
+			
+		 private:
+			//! restrict (disable) copy constructor.
+			TaskRing(const TaskRing&);
+			//! restrict (disable) assignment operator.
+			void operator=(const TaskRing&);
+		};
+		
+	} // end of Threading namespace
+	
+} // end of PACC namespace
+
+#endif // PACC_Threading_TaskRing_hpp_
@@ -52,10 +52,43 @@ struct ThreadStruct {
 #include <sys/errno.h>
 #define ErrNo errno // descriptor of last error
 typedef pthread_t ThreadStruct;
+#if defined(__linux__) && defined(__GLIBC__)
+#include <sched.h>
+#define PACC_THREADS_AFFINITY
+#endif
 #endif
 
 using namespace PACC;
 
+namespace {
+	
+#if defined(PACC_THREADS_WIN32)
+	//! Return the affinity mask of CPUs \c inCPUs (the process mask if empty); CPUs beyond the width of the mask are ignored.
+	DWORD_PTR getMask(const std::vector<unsigned int>& inCPUs)
+	{
+		DWORD_PTR lMask = 0, lSystem;
+		if(inCPUs.empty()) ::GetProcessAffinityMask(::GetCurrentProcess(), &lMask, &lSystem);
+		for(unsigned int i = 0; i < inCPUs.size(); ++i) {
+			if(inCPUs[i] < 8*sizeof(DWORD_PTR)) lMask |= ((DWORD_PTR) 1) << inCPUs[i];
+		}
+		return lMask;
+	}
+#elif defined(PACC_THREADS_AFFINITY)
+	//! Fill \c outSet with CPUs \c inCPUs (all CPUs if empty); CPUs beyond CPU_SETSIZE are ignored.
+	void getSet(const std::vector<unsigned int>& inCPUs, cpu_set_t& outSet)
+	{
+		CPU_ZERO(&outSet);
+		if(inCPUs.empty()) {
+			for(unsigned int i = 0; i < CPU_SETSIZE; ++i) CPU_SET(i, &outSet);
+		}
+		for(unsigned int i = 0; i < inCPUs.size(); ++i) {
+			if(inCPUs[i] < CPU_SETSIZE) CPU_SET(inCPUs[i], &outSet);
+		}
+	}
+#endif
+	
+}
+
 /*! \brief Create thread.
 
 Note that method Thread::run must be called in order to start the execution of Thread::main.
@@ -163,7 +196,7 @@ void Threading::Thread::makeCancellationPoint(void)
 
 /*! \brief Create and startup thread.
 
-This function allocates memory for the native thread structure, and then creates the thread which starts up asynchronously. The calling thread will block until this thread as actually started to run. 
+This function allocates memory for the native thread structure, and then creates the thread which starts up asynchronously. The calling thread will block until this thread as actually started to run. A thread that has terminated can be run again; the native thread of its previous run is then joined first.
 
 Any error will raise a Threading:Exception. In particular, this method should not be called if the thread is already running.
 */
@@ -177,15 +210,48 @@ void Threading::Thread::run(void)
 	}
 	mCancel = false;
 	// allocate native structure
-	if(!mThread) mThread = new ThreadStruct;
 	ThreadStruct* lThread = (ThreadStruct*) mThread;
-	// create thread
+	if(!lThread) mThread = lThread = new ThreadStruct;
+	else {
+		// join the native thread of the previous run, which has terminated
 #ifdef PACC_THREADS_WIN32
-	if((lThread->mHandle = ::CreateThread(0, 0, (LPTHREAD_START_ROUTINE)startup, this, 0, &lThread->mId)) == 0)
+		::WaitForSingleObject(lThread->mHandle, INFINITE);
+		::CloseHandle(lThread->mHandle);
 #else // Unix
-	if(::pthread_create(lThread, 0, startup, this) != 0)  
+		::pthread_join(*lThread, 0);
 #endif
+	}
+	// create thread (suspended on Windows until its affinity is set)
+#ifdef PACC_THREADS_WIN32
+	bool lCreated = (lThread->mHandle = ::CreateThread(0, 0, (LPTHREAD_START_ROUTINE)startup, this, mAffinity.empty() ? 0 : CREATE_SUSPENDED, &lThread->mId)) != 0;
+	if(lCreated && !mAffinity.empty()) {
+		::SetThreadAffinityMask(lThread->mHandle, getMask(mAffinity));
+		::ResumeThread(lThread->mHandle);
+	}
+#elif defined(PACC_THREADS_AFFINITY)
+	pthread_attr_t lAttributes;
+	::pthread_attr_init(&lAttributes);
+	if(!mAffinity.empty()) {
+		cpu_set_t lSet;
+		getSet(mAffinity, lSet);
+		if(::pthread_attr_setaffinity_np(&lAttributes, sizeof(lSet), &lSet) != 0) {
+			::pthread_attr_destroy(&lAttributes);
+			// the native thread of the previous run was joined
+			delete lThread;
+			mThread = 0;
+			unlock();
+			throw Exception(eOtherError, "Thread::run() invalid CPU set!");
+		}
+	}
+	bool lCreated = ::pthread_create(lThread, &lAttributes, startup, this) == 0;
+	::pthread_attr_destroy(&lAttributes);
+#else // Unix
+	bool lCreated = ::pthread_create(lThread, 0, startup, this) == 0;
+#endif
+	if(!lCreated)
 	{
+		delete lThread;
+		mThread = 0;
 		unlock();
 		throw Exception(eOtherError, "Thread::run() can't create thread!");
 	}
@@ -194,6 +260,29 @@ void Threading::Thread::run(void)
 	unlock();
 }
 
+/*! \brief Restrict this thread to run on CPUs \c inCPUs (numbers as in class Topology), or let it run on any CPU if \c inCPUs is empty.
+
+The affinity of a thread that is not running is applied when it is created (see Thread::run); that of a running thread is changed immediately. Under Linux without glibc and on systems other than Windows, the affinity is only recorded. Any error raises a Threading::Exception (thrown by Thread::run for a thread that is not running), for instance if none of the CPUs is available to the process.
+*/
+void Threading::Thread::setAffinity(const std::vector<unsigned int>& inCPUs)
+{
+	lock();
+	mAffinity = inCPUs;
+	bool lSet = true;
+	if(mRunning) {
+		ThreadStruct* lThread = (ThreadStruct*) mThread;
+#if defined(PACC_THREADS_WIN32)
+		lSet = ::SetThreadAffinityMask(lThread->mHandle, getMask(mAffinity)) != 0;
+#elif defined(PACC_THREADS_AFFINITY)
+		cpu_set_t lCPUs;
+		getSet(mAffinity, lCPUs);
+		lSet = ::pthread_setaffinity_np(*lThread, sizeof(lCPUs), &lCPUs) == 0;
+#endif
+	}
+	unlock();
+	if(!lSet) throw Exception(eOtherError, "Thread::setAffinity() invalid CPU set!");
+}
+
 /*! \brief Sleep calling thread for \c inSeconds seconds. 
 
 A negative value will throw a Threading::Exception.
@@ -37,6 +37,8 @@
 #define PACC_Threading_Thread_hpp_
 
 #include "PACC/Threading/Condition.hpp"
+#include <atomic>
+#include <vector>
 
 namespace PACC { 
 	
@@ -49,6 +51,8 @@ namespace PACC {
 		This class incapsulates an abstract cross-platform thread. It should be subclassed in order to define virtual member function Thread::main which is called soon after thread creation (see Thread::run). The thread terminates when main returns or after a call to Thread::cancel is honored by a subsequent cancellation point. A cancellation point can be created by a call to Thread::makeCancellationPoint.
 		
 		This class should be compatible with any flavour of Unix that supports POSIX threads. It should also be compatible will any version of Windows that is supported by class Condition (refer to its documentation for more details). It has been tested under Linux, MacOS X, and Windows 2000/XP. 
+		
+		The CPUs on which a thread may run can be restricted with Thread::setAffinity, for instance according to a placement policy of class Topology. The affinity is given to the native thread at creation (see Thread::run), so that it never starts on another CPU. It is applied under Linux (with glibc) and Windows, and ignored on other systems.
 		*/
 		class Thread : public Condition {
 		 public:
@@ -56,16 +60,20 @@ namespace PACC {
 			virtual ~Thread(void);
 			
 			void cancel(void);
+			//! Return the CPUs on which this thread may run (all if empty), as set by Thread::setAffinity.
+			const std::vector<unsigned int>& getAffinity(void) const {return mAffinity;}
 			bool isRunning(void) const;
 			bool isSelf(void) const;
 			static void sleep(double inSeconds);
 			void run(void);
+			void setAffinity(const std::vector<unsigned int>& inCPUs);
 			void wait(bool inLock=true);
 			
 			protected:
 			void* mThread; //!< Opaque structure of native thread.
-			bool mCancel; //!< Should be canceled flag.
+			std::atomic<bool> mCancel; //!< Should be canceled flag (may be read without locking the thread).
 			bool mRunning; //!< Is running flag
+			std::vector<unsigned int> mAffinity; //!< CPUs on which thread may run (all if empty).
 			
 			/*! \brief Implements main procedure of thread.
 				
@@ -34,92 +34,873 @@
  */
 
 #include "PACC/Threading/ThreadPool.hpp"
+#include "PACC/Threading/TaskGroup.hpp"
+#include "PACC/Threading/TLS.hpp"
+#include "PACC/Util/Assert.hpp"
 #include "PACC/config.hpp"
+#include <algorithm>
+#include <chrono>
 
 using namespace std;
 using namespace PACC;
 
-/*! \brief Execute a pending task.
+namespace {
+	
+	//! Return the time of the steady clock, in seconds.
+	double getTime(void)
+	{
+		return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+	}
+	
+	//! Return the time of the steady clock, in nanoseconds.
+	unsigned long long getNanoseconds(void)
+	{
+		return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+	}
+	
+	//! Add \c inValue to counter \c ioCounter, which is only written by the calling thread.
+	void increase(atomic<unsigned long long>& ioCounter, unsigned long long inValue=1)
+	{
+		ioCounter.store(ioCounter.load(memory_order_relaxed)+inValue, memory_order_relaxed);
+	}
+	
+	//! Write the number of values, mean, percentiles and maximum of histogram \c inHistogram of nanoseconds into stream \c outStream, in microseconds, as text or as a JSON object if \c inJSON is true.
+	void writeSummary(ostream& outStream, const Threading::Histogram& inHistogram, bool inJSON)
+	{
+		const char* lNames[] = {"p50", "p90", "p99", "p999"};
+		const double lFractions[] = {0.5, 0.9, 0.99, 0.999};
+		if(inJSON) outStream << "{\"count\": " << inHistogram.getCount() << ", \"mean\": " << inHistogram.getMean()/1000;
+		else outStream << inHistogram.getCount() << " tasks, mean " << inHistogram.getMean()/1000;
+		for(unsigned int i = 0; i < 4; ++i) {
+			if(inJSON) outStream << ", \"" << lNames[i] << "\": " << inHistogram.getPercentile(lFractions[i])/1000.;
+			else outStream << ", " << lNames[i] << " " << inHistogram.getPercentile(lFractions[i])/1000.;
+		}
+		if(inJSON) outStream << ", \"max\": " << inHistogram.getMax()/1000. << "}";
+		else outStream << ", max " << inHistogram.getMax()/1000. << " us";
+	}
+	
+	//! Return the local storage of the slave thread that runs the calling thread (null for other threads).
+	Threading::TLS& getSlaveStorage(void)
+	{
+		static Threading::TLS lStorage;
+		return lStorage;
+	}
+	
+}
+
+/*! \brief Execute task \c inTask.
+
+This method changes the atomic state of the task prior to task execution and after task completion, without locking the task; the threads that wait for the task are only awakened after completion (see LightTask::complete).
+*/
+void Threading::SlaveThread::execute(LightTask* inTask)
+{
+	inTask->start();
+	// run task
+	inTask->main();
+	// the task may be deleted by its owner as soon as it is completed
+	const bool lDelete = inTask->mAutoDelete;
+	TaskGroup* lGroup = inTask->mGroup;
+	inTask->complete();
+	if(lDelete) delete inTask;
+	if(lGroup) lGroup->done();
+}
+
+/*! \brief Execute task \c inTask (see SlaveThread::execute), and record it into the statistics of this slave.
+
+The queue latency and run time of the task are only measured if the pool is timing its tasks (see ThreadPool::setTiming).
+*/
+void Threading::SlaveThread::process(LightTask* inTask)
+{
+	if(mPool->mTiming.load(memory_order_relaxed)) {
+		// the task may be deleted after execution
+		const unsigned long long lPushTime = inTask->mPushTime;
+		const unsigned long long lStart = getNanoseconds();
+		if(lPushTime != 0) mLatency.add(lStart > lPushTime ? lStart-lPushTime : 0);
+		execute(inTask);
+		mRunTime.add(getNanoseconds()-lStart);
+	} else execute(inTask);
+	increase(mCompleted);
+	mPool->takenTask();
+}
+
+//! Record the start of a sleep of this slave for a task.
+void Threading::SlaveThread::startSleep(void)
+{
+	mSleepStart.store(getNanoseconds(), memory_order_relaxed);
+}
+
+//! Record the end of a sleep of this slave for a task.
+void Threading::SlaveThread::stopSleep(void)
+{
+	increase(mSleep, getNanoseconds()-mSleepStart.load(memory_order_relaxed));
+	mSleepStart.store(0, memory_order_relaxed);
+}
 
-When awakened by its parent thread pool, this method removes the next task from the head of the queue and starts executing it immediately. It also broadcasts a signal to all waiting threads for this task, both prior to task execution and after task completion.
+/*! \brief Execute pending tasks.
+
+When awakened by its parent thread pool, this method removes the next task from the head of the queue and starts executing it immediately (see SlaveThread::execute). In work-stealing and lock-free modes, it executes the tasks returned by ThreadPool::findTask until the pool is deleted. In all modes, the method returns when the slave retires (see ThreadPool::retire).
 */
 void Threading::SlaveThread::main(void) 
 {
+	if(mPool->mMode != ThreadPool::eGlobalQueue) {
+		getSlaveStorage().setValue(this);
+		while(LightTask* lTask = mPool->findTask(this)) {
+			process(lTask);
+		}
+		getSlaveStorage().setValue(0);
+		return;
+	}
 	while(!mCancel)
 	{
-		// wait for available task
+		// wait for available task, for at most the idle timeout if the pool may shrink
 		mPool->lock();
-		while(mPool->mTasks.empty() && !mCancel) mPool->wait();
-		if(!mCancel)
+		bool lTimedOut = false;
+		while(mPool->mInjected.load() == 0 && !mCancel && !lTimedOut && mPool->mRetiring.load() == 0) {
+			++mPool->mIdle;
+			startSleep();
+			lTimedOut = !mPool->wait(mPool->mSlaves.load() > mPool->mMin.load() ? mPool->mIdleTimeout.load() : 0);
+			stopSleep();
+			--mPool->mIdle;
+			if(!lTimedOut) increase(mWakeups);
+		}
+		if(!mCancel && mPool->mInjected.load() == 0)
+		{
+			// idle slave retires
+			const bool lRetire = mPool->retire(this, lTimedOut);
+			mPool->unlock();
+			if(lRetire) return;
+		}
+		else if(!mCancel)
 		{
 			// dequeu next task
-			Task* lTask = mPool->mTasks.front();
-			mPool->mTasks.pop();
+			LightTask* lTask = mPool->popTask(true, mNode);
 			mPool->unlock();
-			// signal all that task is running
-			lTask->lock();
-			lTask->mRunning = true;
-			lTask->broadcast();
-			lTask->unlock();
-			// run task
-			lTask->main();
-			// signal all that task is completed
-			lTask->lock();
-			lTask->mRunning = false;
-			lTask->mCompleted = true;
-			lTask->broadcast();
-			lTask->unlock();
+			process(lTask);
 		}
 		else mPool->unlock();
 	}
 }
 
-//! Construct thread pool by allocating \c inSlaves threads.
-Threading::ThreadPool::ThreadPool(unsigned int inSlaves)
+//! Delete timer thread, and cancel the timers that have not expired yet.
+Threading::TimerThread::~TimerThread(void)
+{
+	mCondition.lock();
+	cancel();
+	mCondition.signal();
+	mCondition.unlock();
+	wait();
+}
+
+/*! \brief Add a timer that pushes task \c inTask after \c inDelay seconds, and then every \c inPeriod seconds if the period is not null; return the identifier of the timer.
+
+The timer thread is awakened only if the new timer expires before the time at which it planned to wake up.
+*/
+Threading::TimerWheel::Timer Threading::TimerThread::add(LightTask& inTask, double inDelay, double inPeriod)
+{
+	mCondition.lock();
+	const double lNext = mWheel.getNextTime();
+	TimerWheel::Timer lTimer = mWheel.add(inTask, getTime()+inDelay, inPeriod);
+	if(lNext < 0 || mWheel.getNextTime() < lNext) mCondition.signal();
+	mCondition.unlock();
+	return lTimer;
+}
+
+/*! \brief Advance the timer wheel, and push the tasks of the expired timers onto the thread pool, until the timer thread is deleted.
+
+The tasks are pushed as a single batch (see ThreadPool::pushBatch), after unlocking the condition, so that timers can be added and removed meanwhile. They are marked as queued before the condition is unlocked, so that a task whose timer is removed meanwhile is already pending (see ThreadPool::cancel).
+*/
+void Threading::TimerThread::main(void)
 {
-	// allocate slave threads
-	for(unsigned int i = 0; i < inSlaves; ++i) 
+	vector<LightTask*> lTasks;
+	mCondition.lock();
+	while(!mCancel) {
+		const double lNext = mWheel.getNextTime();
+		const double lNow = getTime();
+		if(lNext < 0) mCondition.wait();
+		else if(lNext > lNow) mCondition.wait(lNext-lNow);
+		mWheel.advance(getTime(), lTasks);
+		if(lTasks.empty()) continue;
+		for(unsigned int i = 0; i < lTasks.size(); ++i) lTasks[i]->reset();
+		mCondition.unlock();
+		mPool->pushBatch(&lTasks[0], lTasks.size());
+		lTasks.clear();
+		mCondition.lock();
+	}
+	mCondition.unlock();
+}
+
+//! Remove timer \c inTimer; return false if it does not exist (or a one-shot timer has already expired).
+bool Threading::TimerThread::remove(TimerWheel::Timer inTimer)
+{
+	mCondition.lock();
+	const bool lRemoved = mWheel.remove(inTimer);
+	mCondition.unlock();
+	return lRemoved;
+}
+
+/*! \brief Construct thread pool by allocating \c inSlaves threads, using scheduling mode \c inMode, and placing them according to policy \c inPlacement.
+
+In lock-free mode, argument \c inCapacity is the capacity of the lock-free queue (rounded up to a power of 2). The aging delay of background tasks is 1 second (see ThreadPool::setAging). The slaves are placed on the CPUs of the host topology (see Topology::getDefault and Topology::getPlacement) before they start; a slave that is not floating belongs to the node of its CPUs (see SlaveThread::getNode).
+
+The number of slaves is fixed, unless it is changed by ThreadPool::resize.
+*/
+Threading::ThreadPool::ThreadPool(unsigned int inSlaves, Mode inMode, unsigned int inCapacity, Topology::Placement inPlacement) : 
+	ThreadPool(inSlaves, inSlaves, inMode, inCapacity, inPlacement) {}
+
+/*! \brief Construct an elastic thread pool of \c inMin to \c inMax slaves, using scheduling mode \c inMode, and placing them according to policy \c inPlacement.
+
+The pool allocates and places \c inMax slaves, but only runs \c inMin of them (at least one). If a slave cannot be started (for instance because its CPUs are not available to the process), the slaves that were started are stopped, all slaves are deleted, and the Threading::Exception of Thread::run is rethrown. Arguments \c inMode, \c inCapacity and \c inPlacement have the same meaning as for a fixed pool. If \c inMin is less than \c inMax, a push runs an additional slave when more than 4 tasks wait per running slave, or when tasks have waited for 50 ms without any task completion, and an idle slave retires after 10 seconds (see ThreadPool::setGrowth and ThreadPool::setIdleTimeout). Otherwise, the pool has a fixed number of slaves.
+*/
+Threading::ThreadPool::ThreadPool(unsigned int inMin, unsigned int inMax, Mode inMode, unsigned int inCapacity, Topology::Placement inPlacement) : 
+	mNodeTasks(Topology::getDefault().getNodes()), mUrgent(0), mSequence(0), mAging(1), mMode(inMode), mPlacement(inPlacement), mRing(0), mIdle(0), mInjected(0), mQueued(0), mSearching(0), mDraining(false), mStopping(false), 
+	mSlaves(0), mMin(max(inMin, min(inMax, 1u))), mRetiring(0), mGrowthDepth(inMin < inMax ? 4 : 0), mGrowthWait(inMin < inMax ? 0.05 : 0), mIdleTimeout(inMin < inMax ? 10 : 0), mBacklogTime(0), mCreation(getNanoseconds()), mTiming(true), mTimerThread(0)
+{
+	PACC_AssertM(inMin <= inMax, "ThreadPool::ThreadPool() minimum number of slaves exceeds maximum!");
+	for(unsigned int i = 0; i < 3; ++i) mDepth[i] = 0;
+	if(mMode == eLockFreeQueue) mRing = new TaskRing(inCapacity);
+	const Topology& lTopology = Topology::getDefault();
+	const vector<vector<unsigned int> > lPlacement = lTopology.getPlacement(inPlacement, inMax);
+	// allocate slave threads before running them, as slaves may steal from each other
+	reserve(inMax);
+	for(unsigned int i = 0; i < inMax; ++i) 
 	{
-		SlaveThread* lThread = new SlaveThread(this);
+		SlaveThread* lThread = new SlaveThread(this, i, false);
+		if(!lPlacement[i].empty()) {
+			lThread->setAffinity(lPlacement[i]);
+			lThread->mNode = lTopology.getNode(lPlacement[i].front());
+		}
 		push_back(lThread);
 	}
+	mResize.lock();
+	try {addSlaves(mMin);}
+	catch(...) {
+		mResize.unlock();
+		// the destructor is not called for a pool that was not constructed
+		lock();
+		stopSlaves();
+		delete mRing;
+		throw;
+	}
+	mResize.unlock();
 }
 
 //! Delete thread pool.
 Threading::ThreadPool::~ThreadPool(void)
 {
+	// the timers that have not expired yet are cancelled
+	delete mTimerThread.load();
 	lock();
-	// wait for queue to become empty
-	while(!mTasks.empty()) 
-	{
-		// wait for last task in queue to at least start running
-		Task* lTask = mTasks.back();
-		lTask->lock();
-		unlock();
-		lTask->wait(false);
-		lTask->unlock();
+	// wait for all tasks to complete, including those pushed by running tasks
+	mDraining = true;
+	while(mQueued.load() > 0) wait();
+	stopSlaves();
+	delete mRing;
+}
+
+/*! \brief Run \c inCount idle slaves, which must not exceed the number of slaves that are not running.
+
+The resize mutex must be locked. A slave that has just retired may still be terminating, in which case this method waits for its termination before running it again. If a slave cannot be started, it is counted as idle again, and the exception of Thread::run is rethrown; the slaves that were already started keep running.
+*/
+void Threading::ThreadPool::addSlaves(unsigned int inCount)
+{
+	for(unsigned int i = 0; i < size() && inCount > 0; ++i) {
+		SlaveThread* lSlave = (*this)[i];
+		if(lSlave->mActive) continue;
+		lSlave->wait();
+		lSlave->mActive = true;
+		lSlave->mStart = getNanoseconds();
+		++mSlaves;
+		try {lSlave->run();}
+		catch(...) {
+			lSlave->mActive = false;
+			--mSlaves;
+			throw;
+		}
+		--inCount;
+	}
+}
+
+/*! \brief Cancel timer \c inTimer (see ThreadPool::schedule); return false if it does not exist, or if a one-shot timer has already expired.
+
+The timer pushes no task after this method returns. A task that the timer has already pushed, or is about to push, is not affected: it is pending (see LightTask::isPending) when this method returns, and must not be deleted before it completes. A periodic task may thus still be queued or running after its timer is cancelled, and should be waited for when it is pending.
+*/
+bool Threading::ThreadPool::cancel(Timer inTimer)
+{
+	TimerThread* lThread = mTimerThread.load(memory_order_acquire);
+	return lThread != 0 && lThread->remove(inTimer);
+}
+
+/*! \brief Return a snapshot of the statistics of this thread pool.
+
+The statistics of the slaves are merged without stopping them, so that the counters of a snapshot that is taken while tasks run may be off by the few tasks that are being recorded.
+*/
+Threading::ThreadPool::Stats Threading::ThreadPool::getStats(void) const
+{
+	Stats lStats;
+	lStats.mRunning = mSlaves.load();
+	lStats.mMaxSlaves = size();
+	lStats.mQueued = mQueued.load();
+	for(unsigned int i = 0; i < 3; ++i) lStats.mDepth[i] = getDepth((Priority) i);
+	lStats.mCompleted = lStats.mWakeups = lStats.mSteals = 0;
+	lStats.mBusy = lStats.mAlive = 0;
+	lStats.mSlaves.resize(size());
+	mResize.lock();
+	const unsigned long long lNow = getNanoseconds();
+	lStats.mElapsed = (lNow-mCreation)*1e-9;
+	for(unsigned int i = 0; i < size(); ++i) {
+		const SlaveThread* lSlave = (*this)[i];
+		Stats::Slave& lSlaveStats = lStats.mSlaves[i];
+		lSlaveStats.mRunning = lSlave->mActive;
+		lSlaveStats.mNode = lSlave->mNode;
+		lSlaveStats.mCompleted = lSlave->mCompleted.load(memory_order_relaxed);
+		lSlaveStats.mWakeups = lSlave->mWakeups.load(memory_order_relaxed);
+		lSlaveStats.mSteals = lSlave->mSteals.load(memory_order_relaxed);
+		const unsigned long long lAlive = lSlave->mAlive + (lSlave->mActive ? lNow-lSlave->mStart : 0);
+		// the current sleep of the slave is not yet recorded
+		const unsigned long long lSleepStart = lSlave->mSleepStart.load(memory_order_relaxed);
+		const unsigned long long lSleep = lSlave->mSleep.load(memory_order_relaxed) + (lSleepStart != 0 && lNow > lSleepStart ? lNow-lSleepStart : 0);
+		lSlaveStats.mAlive = lAlive*1e-9;
+		lSlaveStats.mBusy = lAlive > lSleep ? (lAlive-lSleep)*1e-9 : 0;
+		lStats.mLatency.merge(lSlave->mLatency);
+		lStats.mRunTime.merge(lSlave->mRunTime);
+		lStats.mCompleted += lSlaveStats.mCompleted;
+		lStats.mWakeups += lSlaveStats.mWakeups;
+		lStats.mSteals += lSlaveStats.mSteals;
+		lStats.mBusy += lSlaveStats.mBusy;
+		lStats.mAlive += lSlaveStats.mAlive;
+	}
+	mResize.unlock();
+	return lStats;
+}
+
+/*! \brief Return the next task for slave \c inSlave (work-stealing and lock-free modes).
+
+In work-stealing mode, the slave first takes a waiting high priority task (or normal task with a deadline), and then pops the bottom task of its own deque. Otherwise, it searches for a task in the priority levels (injection queue) and in the queue of its node, then in the deques of the other slaves, and finally takes a task that prefers another node, or a background task. When the last searching slave finds a task, it wakes up a sleeping slave, because other tasks may be available. In lock-free mode, the slave takes a waiting high priority task (or normal task with a deadline), then pops the head of the lock-free queue, and then takes a task from the priority levels (overflow queue). 
+
+If no task is found, the slave sleeps on the event count until a task is pushed, or for at most the idle timeout if the pool may shrink. This method returns a null pointer when the pool is deleted, or when the slave retires (see ThreadPool::retire).
+*/
+Threading::LightTask* Threading::ThreadPool::findTask(SlaveThread* inSlave)
+{
+	while(true) {
+		LightTask* lTask = 0;
+		// aged background tasks are only checked periodically, as the pool mutex must be locked
+		if(mUrgent.load() > 0 || (mDepth[eBackground].load() > 0 && ++inSlave->mTurns % 64 == 0)) lTask = takeInjectedTask(false, inSlave->mNode);
+		if(lTask) return lTask;
+		if(mMode == eLockFreeQueue) {
+			lTask = mRing->pop();
+			if(!lTask) lTask = takeInjectedTask(true, inSlave->mNode);
+			if(lTask) return lTask;
+		} else {
+			lTask = inSlave->mDeque.pop();
+			if(lTask) return lTask;
+			++mSearching;
+			lTask = takeInjectedTask(false, inSlave->mNode);
+			if(!lTask) lTask = stealTask(inSlave);
+			if(!lTask) lTask = takeInjectedTask(true, inSlave->mNode);
+			if(lTask) {
+				if(--mSearching == 0) mEvents.notify();
+				return lTask;
+			}
+			--mSearching;
+		}
+		// sleep until a task is pushed (the check is made after preparing to wait, see ThreadPool::push)
+		bool lTimedOut = false;
+		EventCount::Key lKey = mEvents.prepareWait();
+		if(hasTask() || mStopping.load() || mRetiring.load() > 0) mEvents.cancelWait();
+		else {
+			inSlave->startSleep();
+			lTimedOut = !mEvents.wait(lKey, mSlaves.load() > mMin.load() ? mIdleTimeout.load() : 0);
+			inSlave->stopSleep();
+			if(!lTimedOut) increase(inSlave->mWakeups);
+		}
+		if(mStopping.load() && !hasTask()) return 0;
+		if((lTimedOut || mRetiring.load() > 0) && !hasTask() && retire(inSlave, lTimedOut)) {
+			// a task pushed meanwhile may have been notified to this slave
+			if(hasTask()) mEvents.notify();
+			return 0;
+		}
+	}
+}
+
+/*! \brief Return the number of tasks of priority level \c inPriority that wait to be started.
+
+The normal level includes the tasks in the deques and in the lock-free queue, whose number is only approximate while slaves run.
+*/
+unsigned int Threading::ThreadPool::getDepth(Priority inPriority) const
+{
+	unsigned int lDepth = mDepth[inPriority].load();
+	if(inPriority == eNormal) {
+		if(mRing != 0) lDepth += mRing->size();
+		for(unsigned int i = 0; i < size(); ++i) lDepth += (*this)[i]->mDeque.size();
+	}
+	return lDepth;
+}
+
+//! Return the timer thread of this pool, which is created by the first call.
+Threading::TimerThread& Threading::ThreadPool::getTimerThread(void)
+{
+	TimerThread* lThread = mTimerThread.load(memory_order_acquire);
+	if(lThread) return *lThread;
+	mResize.lock();
+	lThread = mTimerThread.load(memory_order_relaxed);
+	if(lThread == 0) {
+		lThread = new TimerThread(this);
+		mTimerThread.store(lThread, memory_order_release);
+	}
+	mResize.unlock();
+	return *lThread;
+}
+
+//! Return whether any task is waiting in a queue of this pool (work-stealing and lock-free modes).
+bool Threading::ThreadPool::hasTask(void) const
+{
+	if(mInjected.load() > 0) return true;
+	if(mRing != 0) return !mRing->isEmpty();
+	for(unsigned int i = 0; i < size(); ++i) {
+		if(!(*this)[i]->mDeque.isEmpty()) return true;
+	}
+	return false;
+}
+
+/*! \brief Enqueue the \c inCount tasks of array \c inTasks as members of group \c inGroup (or of no group if null), with priority level \c inPriority and a deadline in \c inDeadline seconds (none if null), or onto the queue of node \c inNode (if not negative), and wake up as many slaves (or all idle slaves).
+
+The state of the tasks is reset before they are queued under a single lock of the pool mutex (or of the overflow queue in lock-free mode). This method is instantiated for arrays of LightTask and of Task pointers.
+*/
+template <class TaskType>
+void Threading::ThreadPool::enqueue(TaskType** inTasks, unsigned int inCount, TaskGroup* inGroup, Priority inPriority, double inDeadline, int inNode)
+{
+	if(inCount == 0) return;
+	const unsigned long long lPushTime = mTiming.load(memory_order_relaxed) ? getNanoseconds() : 0;
+	for(unsigned int i = 0; i < inCount; ++i) {
+		inTasks[i]->reset();
+		inTasks[i]->mGroup = inGroup;
+		inTasks[i]->mPushTime = lPushTime;
+	}
+	mQueued += inCount;
+	const bool lPrioritized = inPriority != eNormal || inDeadline > 0 || inNode >= 0;
+	// the deadline, or the push time of background tasks (for aging)
+	const double lTime = lPrioritized ? getTime() + max(inDeadline, 0.) : 0;
+	if(mMode == eLockFreeQueue) {
+		unsigned int i = 0;
+		if(!lPrioritized) {
+			while(i < inCount && mRing->push(inTasks[i])) ++i;
+		}
+		if(i < inCount) {
+			lock();
+			for(; i < inCount; ++i) pushTask(inTasks[i], inPriority, inDeadline > 0, lTime, inNode);
+			unlock();
+		}
+		mEvents.notify(inCount);
+		grow(inCount);
+		return;
+	}
+	if(mMode == eWorkStealing) {
+		SlaveThread* lSlave = (SlaveThread*) getSlaveStorage().getValue();
+		if(!lPrioritized && lSlave != 0 && lSlave->mPool == this) {
+			for(unsigned int i = 0; i < inCount; ++i) lSlave->mDeque.push(inTasks[i]);
+		} else {
+			lock();
+			for(unsigned int i = 0; i < inCount; ++i) pushTask(inTasks[i], inPriority, inDeadline > 0, lTime, inNode);
+			unlock();
+		}
+		// the push must be visible before checking for searching slaves (see ThreadPool::findTask)
+		atomic_thread_fence(memory_order_seq_cst);
+		if(inCount > 1) mEvents.notify(inCount);
+		else if(mSearching.load() == 0) mEvents.notify();
+		grow(inCount);
+		return;
+	}
+	// push tasks onto queue and signal availability
+	lock();
+	for(unsigned int i = 0; i < inCount; ++i) pushTask(inTasks[i], inPriority, inDeadline > 0, lTime, inNode);
+	// the pool destructor also waits on the pool condition
+	if(mDraining.load() || (mIdle > 0 && inCount >= mIdle)) broadcast();
+	else for(unsigned int i = 0; i < inCount && i < mIdle; ++i) signal();
+	unlock();
+	grow(inCount);
+}
+
+/*! \brief Run an additional slave if the \c inCount tasks that were just pushed leave too many tasks waiting, or if tasks have waited for too long without any task completion (see ThreadPool::setGrowth).
+
+The number of waiting tasks is estimated as the number of queued tasks minus the number of running slaves. No slave is added while another thread changes the running slaves, nor if it cannot be started.
+*/
+void Threading::ThreadPool::grow(unsigned int inCount)
+{
+	const unsigned int lSlaves = mSlaves.load();
+	const unsigned int lQueued = mQueued.load();
+	if(lSlaves >= size() || lQueued <= lSlaves) return;
+	const unsigned int lWaiting = lQueued - lSlaves;
+	const unsigned int lDepth = mGrowthDepth.load();
+	bool lGrow = lDepth > 0 && lWaiting > lDepth*lSlaves;
+	const double lWait = mGrowthWait.load();
+	if(!lGrow && lWait > 0) {
+		const double lTime = getTime();
+		// the pushed tasks are the first ones to wait
+		if(lWaiting <= inCount) mBacklogTime.store(lTime);
+		else lGrow = lTime - mBacklogTime.load() >= lWait;
+	}
+	if(lGrow && mResize.tryLock()) {
+		// the tasks are already queued, so that a slave that cannot be started leaves the pool with its running slaves
+		try {if(!mStopping.load() && mSlaves.load() < size()) addSlaves(1);}
+		catch(Exception&) {}
+		mResize.unlock();
+	}
+}
+
+/*! \brief Remove the next task from the priority levels, or return a null pointer if they are empty.
+
+The pool mutex must be locked. High priority tasks come first, then the normal tasks, and then, if \c inBackground is true, the tasks that prefer a node other than \c inNode and the background tasks. A background task is taken before the normal tasks if it has waited for the aging delay, or if its deadline has passed. Within a level, tasks with a deadline come first, in earliest deadline order, and then the other tasks in FIFO order; the tasks that prefer node \c inNode are taken between the normal tasks with a deadline and those without.
+*/
+Threading::LightTask* Threading::ThreadPool::popTask(bool inBackground, int inNode)
+{
+	Level* lLevel = 0;
+	int lNode = -1;
+	if(!mLevels[eHigh].isEmpty()) lLevel = &mLevels[eHigh];
+	else {
+		Level& lBackground = mLevels[eBackground];
+		bool lAged = false;
+		if(!lBackground.isEmpty()) {
+			const double lTime = getTime();
+			lAged = (!lBackground.mDeadlines.empty() && lBackground.mDeadlines.front().mTime <= lTime) || (!lBackground.mTasks.empty() && lTime-lBackground.mTasks.front().mTime >= mAging);
+		}
+		if(lAged) lLevel = &lBackground;
+		else if(!mLevels[eNormal].mDeadlines.empty()) lLevel = &mLevels[eNormal];
+		else if(inNode >= 0 && !mNodeTasks[inNode].empty()) lNode = inNode;
+		else if(!mLevels[eNormal].isEmpty()) lLevel = &mLevels[eNormal];
+		else if(inBackground) {
+			for(unsigned int i = 0; i < mNodeTasks.size() && lNode < 0; ++i) {
+				if(!mNodeTasks[i].empty()) lNode = i;
+			}
+			if(lNode < 0 && !lBackground.isEmpty()) lLevel = &lBackground;
+		}
+	}
+	LightTask* lTask;
+	if(lNode >= 0) {
+		lTask = mNodeTasks[lNode].front();
+		mNodeTasks[lNode].pop();
+		--mDepth[eNormal];
+		--mInjected;
+		return lTask;
+	}
+	if(lLevel == 0) return 0;
+	if(!lLevel->mDeadlines.empty()) {
+		lTask = lLevel->mDeadlines.front().mTask;
+		pop_heap(lLevel->mDeadlines.begin(), lLevel->mDeadlines.end());
+		lLevel->mDeadlines.pop_back();
+		if(lLevel != &mLevels[eBackground]) --mUrgent;
+	} else {
+		lTask = lLevel->mTasks.front().mTask;
+		lLevel->mTasks.pop();
+		if(lLevel == &mLevels[eHigh]) --mUrgent;
+	}
+	--mDepth[lLevel-mLevels];
+	--mInjected;
+	return lTask;
+}
+
+/*! \brief Add task \c inTask to priority level \c inPriority, with deadline \c inTime if \c inDeadline is true, or push time \c inTime otherwise (seconds of the steady clock), or to the queue of node \c inNode if it is not negative (normal level).
+
+The pool mutex must be locked.
+*/
+void Threading::ThreadPool::pushTask(LightTask* inTask, Priority inPriority, bool inDeadline, double inTime, int inNode)
+{
+	if(inNode >= 0) {
+		mNodeTasks[inNode].push(inTask);
+		++mDepth[eNormal];
+		++mInjected;
+		return;
+	}
+	QueuedTask lTask;
+	lTask.mTask = inTask;
+	lTask.mTime = inTime;
+	lTask.mSequence = mSequence++;
+	Level& lLevel = mLevels[inPriority];
+	if(inDeadline) {
+		lLevel.mDeadlines.push_back(lTask);
+		push_heap(lLevel.mDeadlines.begin(), lLevel.mDeadlines.end());
+	} else lLevel.mTasks.push(lTask);
+	if(inPriority == eHigh || (inPriority == eNormal && inDeadline)) ++mUrgent;
+	++mDepth[inPriority];
+	++mInjected;
+}
+
+/*! \brief Push task \c inTask onto the thread pool queue.
+
+The thread pool maintains a queue of task references that will be executed in FIFO order. In work-stealing mode, a task pushed from a task that runs in this pool goes to the deque of its slave thread, and a task pushed by any other thread goes to the injection queue; a sleeping slave is then awakened, unless another slave is already searching for tasks. In lock-free mode, the task goes to the lock-free queue, or to the overflow queue if the former is full, and a sleeping slave is awakened.
+*/
+void Threading::ThreadPool::push(LightTask& inTask)
+{
+	LightTask* lTask = &inTask;
+	enqueue(&lTask, 1, 0);
+}
+
+/*! \brief Push task \c inTask onto the thread pool queue, with priority level \c inPriority and a deadline in \c inDeadline seconds (none if null).
+
+The task is started after all waiting tasks of higher levels, and after the tasks of the same level that have an earlier deadline (a task without deadline is started after those with a deadline, in FIFO order). The deadline only orders the tasks; a task is never dropped when it is late.
+*/
+void Threading::ThreadPool::push(LightTask& inTask, Priority inPriority, double inDeadline)
+{
+	LightTask* lTask = &inTask;
+	enqueue(&lTask, 1, 0, inPriority, inDeadline);
+}
+
+/*! \brief Push the \c inCount tasks of array \c inTasks onto the thread pool queue.
+
+The tasks are queued as if pushed one by one in array order (see ThreadPool::push), but under a single lock of the pool, and at most \c inCount idle slaves are awakened at once.
+*/
+void Threading::ThreadPool::pushBatch(LightTask** inTasks, unsigned int inCount)
+{
+	enqueue(inTasks, inCount, 0);
+}
+
+//! Push the \c inCount tasks of array \c inTasks onto the thread pool queue (see ThreadPool::pushBatch).
+void Threading::ThreadPool::pushBatch(Task** inTasks, unsigned int inCount)
+{
+	enqueue(inTasks, inCount, 0);
+}
+
+/*! \brief Enable or disable the measure of the queue latency and run time of tasks, according to \c inTiming (enabled by default).
+
+Timing costs two reads of the steady clock per task, and one per push, which may be noticeable for tasks that only last a few microseconds. The other statistics are not affected.
+*/
+void Threading::ThreadPool::setTiming(bool inTiming)
+{
+	mTiming = inTiming;
+}
+
+/*! \brief Set the growth thresholds of an elastic pool: a push runs an additional slave when more than \c inDepth tasks wait per running slave, or when tasks have waited for \c inWait seconds without any task completion.
+
+A null argument disables its threshold. Slaves are only added when tasks are pushed, up to the maximum number of slaves.
+*/
+void Threading::ThreadPool::setGrowth(unsigned int inDepth, double inWait)
+{
+	mGrowthDepth = inDepth;
+	mGrowthWait = inWait;
+}
+
+/*! \brief Set the delay after which an idle slave retires to \c inDelay seconds, if more than the minimum number of slaves run.
+
+A null delay keeps idle slaves running. The delay applies to the slaves that start to wait for a task after this call.
+*/
+void Threading::ThreadPool::setIdleTimeout(double inDelay)
+{
+	mIdleTimeout = inDelay;
+}
+
+/*! \brief Push normal task \c inTask onto the queue of node \c inNode, so that it is preferably started by a slave that runs on this node (see Topology::Placement).
+
+The tasks of a node are started in FIFO order by the slaves of the node, after the high priority tasks and the normal tasks with a deadline, but before the other normal tasks. A slave of another node, or a floating slave, only starts them when it finds no other normal task (in work-stealing mode, after trying to steal from the other slaves), before the background tasks. Node tasks always go through the pool mutex. Argument \c inNode must be less than the number of nodes of the host (see Topology::getNodes).
+*/
+void Threading::ThreadPool::pushOnNode(LightTask& inTask, unsigned int inNode)
+{
+	PACC_AssertM(inNode < mNodeTasks.size(), "ThreadPool::pushOnNode() invalid node " << inNode << "!");
+	LightTask* lTask = &inTask;
+	enqueue(&lTask, 1, 0, eNormal, 0, inNode);
+}
+
+/*! \brief Set the number of running slaves to \c inSlaves, between 1 and the maximum number of slaves (see ThreadPool::getMaxSlaves).
+
+Additional slaves start immediately. Surplus slaves retire as soon as they are idle, after completing their current task, so that running tasks are never disturbed. The minimum number of slaves is set to \c inSlaves, so that the pool no longer shrinks below this number, but may still grow up to its maximum (see ThreadPool::setGrowth). If an additional slave cannot be started, the Threading::Exception of Thread::run is rethrown, and the slaves that were started keep running.
+*/
+void Threading::ThreadPool::resize(unsigned int inSlaves)
+{
+	inSlaves = min(max(inSlaves, 1u), (unsigned int) size());
+	mResize.lock();
+	if(mStopping.load()) {
+		mResize.unlock();
+		return;
+	}
+	mMin = inSlaves;
+	const unsigned int lSlaves = mSlaves.load();
+	mRetiring = lSlaves > inSlaves ? lSlaves - inSlaves : 0;
+	if(lSlaves < inSlaves) {
+		try {addSlaves(inSlaves - lSlaves);}
+		catch(...) {
+			mResize.unlock();
+			throw;
+		}
+	}
+	const bool lShrink = mRetiring.load() > 0;
+	mResize.unlock();
+	if(lShrink) {
+		// wake up the idle slaves, so that they retire
 		lock();
+		broadcast();
+		unlock();
+		mEvents.notifyAll();
+	}
+}
+
+/*! \brief Retire idle slave \c inSlave if more than the minimum number of slaves run, and if either ThreadPool::resize requested it, or \c inTimedOut is true (the slave was idle for the idle timeout); return whether the slave should terminate.
+
+In global queue mode, the pool mutex must be locked, so that no task can be pushed while the last idle slave retires.
+*/
+bool Threading::ThreadPool::retire(SlaveThread* inSlave, bool inTimedOut)
+{
+	mResize.lock();
+	bool lRetire = false;
+	if(!mStopping.load() && mSlaves.load() > mMin.load()) {
+		if(mRetiring.load() > 0) {
+			--mRetiring;
+			lRetire = true;
+		} else lRetire = inTimedOut;
+	}
+	if(lRetire) {
+		inSlave->mActive = false;
+		inSlave->mAlive += getNanoseconds()-inSlave->mStart;
+		--mSlaves;
 	}
-	// now cancel all threads
+	mResize.unlock();
+	return lRetire;
+}
+
+/*! \brief Push task \c inTask onto the thread pool after \c inDelay seconds; return the identifier of its timer (see ThreadPool::cancel).
+
+The timer has a resolution of one millisecond, and never expires early. The task must not be pending when the timer expires. The first timer of the pool creates its timer thread.
+*/
+Threading::ThreadPool::Timer Threading::ThreadPool::schedule(LightTask& inTask, double inDelay)
+{
+	return getTimerThread().add(inTask, inDelay, 0);
+}
+
+/*! \brief Push task \c inTask onto the thread pool after \c inDelay seconds, and then every \c inPeriod seconds, until its timer is cancelled (see ThreadPool::cancel); return the identifier of the timer.
+
+The occurrences are computed from the first one, so that they do not drift. An occurrence is skipped if the task is still pending, or if the timer thread is late, so that the task never runs concurrently with itself (see TimerWheel).
+*/
+Threading::ThreadPool::Timer Threading::ThreadPool::scheduleAtFixedRate(LightTask& inTask, double inDelay, double inPeriod)
+{
+	PACC_AssertM(inPeriod > 0, "ThreadPool::scheduleAtFixedRate() invalid period!");
+	return getTimerThread().add(inTask, inDelay, inPeriod);
+}
+
+/*! \brief Set the delay after which a waiting background task is promoted to the normal level to \c inDelay seconds.
+
+A null delay starts background tasks in FIFO order with the normal tasks.
+*/
+void Threading::ThreadPool::setAging(double inDelay)
+{
+	lock();
+	mAging = inDelay;
+	unlock();
+}
+
+//! Steal a task from the deque of a random slave other than \c inSlave (work-stealing mode); return a null pointer if no task was stolen.
+Threading::LightTask* Threading::ThreadPool::stealTask(SlaveThread* inSlave)
+{
+	const unsigned int lSlaves = size();
+	if(lSlaves < 2) return 0;
+	// xorshift generator for the first victim
+	inSlave->mSeed ^= inSlave->mSeed << 13;
+	inSlave->mSeed ^= inSlave->mSeed >> 17;
+	inSlave->mSeed ^= inSlave->mSeed << 5;
+	const unsigned int lFirst = inSlave->mSeed % lSlaves;
+	for(unsigned int i = 0; i < lSlaves; ++i) {
+		SlaveThread* lVictim = (*this)[(lFirst+i) % lSlaves];
+		if(lVictim == inSlave) continue;
+		if(LightTask* lTask = lVictim->mDeque.steal()) {
+			increase(inSlave->mSteals);
+			return lTask;
+		}
+	}
+	return 0;
+}
+
+/*! \brief Cancel all slaves, wait for their termination, and delete them.
+
+The pool mutex must be locked; it is unlocked before waiting. No slave can start or retire afterwards.
+*/
+void Threading::ThreadPool::stopSlaves(void)
+{
+	// cancel all threads, and prevent any slave from starting or retiring
+	mResize.lock();
 	for(unsigned int i = 0; i < size(); ++i) (*this)[i]->cancel();
+	mStopping = true;
+	mResize.unlock();
 	// signal them to wake up
 	broadcast();
 	unlock();
-	// then delete them (the thread destructor will wait for thread completion)
+	mEvents.notifyAll();
+	// wait for all of them to terminate, as slaves may still steal from each other
+	for(unsigned int i = 0; i < size(); ++i) (*this)[i]->wait();
+	// then delete them
 	for(unsigned int i = 0; i < size(); ++i) delete (*this)[i];
 }
 
-/*! \brief Push task \c inTask onto the thread pool queue.
-
-The thread pool maintains a queue of task references that will be executed in FIFO order.
-*/
-void Threading::ThreadPool::push(Task& inTask)
+//! Return the next task of the priority levels for a slave of node \c inNode, including the tasks of other nodes and background tasks if \c inBackground is true, or a null pointer if none (work-stealing and lock-free modes).
+Threading::LightTask* Threading::ThreadPool::takeInjectedTask(bool inBackground, int inNode)
 {
-	// reset task flags
-	inTask.reset();
-	// push task onto queue and signal availability
+	if(mInjected.load() == 0) return 0;
 	lock();
-	mTasks.push(&inTask);
-	signal();
+	LightTask* lTask = popTask(inBackground, inNode);
 	unlock();
+	return lTask;
+}
+
+//! Account for a task that was completed by a slave, and wake up the pool destructor after the last one.
+void Threading::ThreadPool::takenTask(void)
+{
+	// a completion restarts the wait of the growth threshold
+	if(mGrowthWait.load() > 0 && mSlaves.load() < size()) mBacklogTime.store(getTime());
+	if(--mQueued == 0 && mDraining.load()) {
+		lock();
+		broadcast();
+		unlock();
+	}
 }
+
+/*! \brief Write these statistics into output stream \c outStream, in text format.
+
+Latencies and run times are written in microseconds, and the busy time of each slave in percentage of its running time.
+*/
+void Threading::ThreadPool::Stats::write(ostream& outStream) const
+{
+	outStream << "thread pool: " << mRunning << "/" << mMaxSlaves << " slaves running, " << mElapsed << " s elapsed, utilization " << 100*getUtilization() << "%" << endl;
+	outStream << "  tasks: " << mCompleted << " completed, " << mQueued << " queued (waiting: " << mDepth[eHigh] << " high, " << mDepth[eNormal] << " normal, " << mDepth[eBackground] << " background)" << endl;
+	outStream << "  slaves: " << mWakeups << " wake ups, " << mSteals << " steals" << endl;
+	outStream << "  queue latency: ";
+	writeSummary(outStream, mLatency, false);
+	outStream << endl << "  run time: ";
+	writeSummary(outStream, mRunTime, false);
+	outStream << endl;
+	for(unsigned int i = 0; i < mSlaves.size(); ++i) {
+		const Slave& lSlave = mSlaves[i];
+		outStream << "  slave " << i << ": " << (lSlave.mRunning ? "running" : "idle");
+		if(lSlave.mNode >= 0) outStream << ", node " << lSlave.mNode;
+		outStream << ", " << lSlave.mCompleted << " tasks, busy " << (lSlave.mAlive > 0 ? 100*lSlave.mBusy/lSlave.mAlive : 0) << "%, " << lSlave.mWakeups << " wake ups, " << lSlave.mSteals << " steals" << endl;
+	}
+}
+
+/*! \brief Write these statistics into output stream \c outStream, as a JSON object.
+
+Times are written in seconds, except for the summaries of the latency and run time histograms (count, mean, percentiles p50, p90, p99 and p999, and max), which are written in microseconds.
+*/
+void Threading::ThreadPool::Stats::writeJSON(ostream& outStream) const
+{
+	outStream << "{\"elapsed\": " << mElapsed << ", \"running\": " << mRunning << ", \"max_slaves\": " << mMaxSlaves;
+	outStream << ", \"completed\": " << mCompleted << ", \"queued\": " << mQueued;
+	outStream << ", \"waiting\": {\"high\": " << mDepth[eHigh] << ", \"normal\": " << mDepth[eNormal] << ", \"background\": " << mDepth[eBackground] << "}";
+	outStream << ", \"wakeups\": " << mWakeups << ", \"steals\": " << mSteals << ", \"busy\": " << mBusy << ", \"alive\": " << mAlive << ", \"utilization\": " << getUtilization();
+	outStream << ", \"latency_us\": ";
+	writeSummary(outStream, mLatency, true);
+	outStream << ", \"run_time_us\": ";
+	writeSummary(outStream, mRunTime, true);
+	outStream << ", \"slaves\": [";
+	for(unsigned int i = 0; i < mSlaves.size(); ++i) {
+		const Slave& lSlave = mSlaves[i];
+		if(i > 0) outStream << ", ";
+		outStream << "{\"running\": " << (lSlave.mRunning ? "true" : "false") << ", \"node\": " << lSlave.mNode << ", \"completed\": " << lSlave.mCompleted;
+		outStream << ", \"wakeups\": " << lSlave.mWakeups << ", \"steals\": " << lSlave.mSteals << ", \"busy\": " << lSlave.mBusy << ", \"alive\": " << lSlave.mAlive << "}";
+	}
+	outStream << "]}";
+}
+
+/*!
+*/
+ostream& Threading::operator<<(ostream& outStream, const ThreadPool::Stats& inStats)
+{
+	inStats.write(outStream);
+	return outStream;
+}
+
+template void Threading::ThreadPool::enqueue<Threading::LightTask>(LightTask** inTasks, unsigned int inCount, TaskGroup* inGroup, Priority inPriority, double inDeadline, int inNode);
+template void Threading::ThreadPool::enqueue<Threading::Task>(Task** inTasks, unsigned int inCount, TaskGroup* inGroup, Priority inPriority, double inDeadline, int inNode);
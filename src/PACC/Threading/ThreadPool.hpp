@@ -36,9 +36,21 @@
 #ifndef PACC_Threading_ThreadPool_hpp_
 #define PACC_Threading_ThreadPool_hpp_
 
+#include "PACC/Threading/EventCount.hpp"
+#include "PACC/Threading/Future.hpp"
+#include "PACC/Threading/Histogram.hpp"
+#include "PACC/Threading/Mutex.hpp"
 #include "PACC/Threading/Thread.hpp"
 #include "PACC/Threading/Task.hpp"
+#include "PACC/Threading/TaskDeque.hpp"
+#include "PACC/Threading/TaskRing.hpp"
+#include "PACC/Threading/TimerWheel.hpp"
+#include "PACC/Threading/Topology.hpp"
+#include <atomic>
+#include <iostream>
 #include <queue>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace PACC {
@@ -57,13 +69,61 @@ namespace PACC {
 		*/
 		class SlaveThread : public Thread {
 			public:
-			//! Construct a slave thread for a thread pool.
-			SlaveThread(ThreadPool* inPool) : mPool(inPool) {run();}
+			//! Construct slave thread number \c inIndex of thread pool \c inPool, and run it if \c inRun is true.
+			SlaveThread(ThreadPool* inPool, unsigned int inIndex=0, bool inRun=true) : mPool(inPool), mIndex(inIndex), mSeed(2654435761u*inIndex+1), mTurns(0), mNode(-1), mActive(inRun), mCompleted(0), mWakeups(0), mSteals(0), mSleep(0), mSleepStart(0), mAlive(0), mStart(0) {if(inRun) run();}
 			//! Delete slave thread; wait for thread termination.
 			~SlaveThread(void) {wait(true);}
 			
+			//! Return the NUMA node on which this slave runs, or -1 if it floats.
+			int getNode(void) const {return mNode;}
+			
+			protected:
+			ThreadPool* mPool; //!< Pointer to parent thread pool
+			unsigned int mIndex; //!< Index of slave in its thread pool
+			unsigned int mSeed; //!< State of the random selection of victims (work-stealing mode)
+			unsigned int mTurns; //!< Number of searches for a task while background tasks wait (work-stealing and lock-free modes)
+			int mNode; //!< NUMA node of slave (-1 if floating)
+			bool mActive; //!< Slave is counted as running by its pool (protected by the resize mutex of the pool)
+			TaskDeque mDeque; //!< Local deque of tasks (work-stealing mode)
+			atomic<unsigned long long> mCompleted; //!< Number of completed tasks (written by slave only)
+			atomic<unsigned long long> mWakeups; //!< Number of wake ups after sleeping for a task (written by slave only)
+			atomic<unsigned long long> mSteals; //!< Number of tasks stolen from other slaves (written by slave only)
+			atomic<unsigned long long> mSleep; //!< Time spent sleeping for a task, except current sleep (nanoseconds, written by slave only)
+			atomic<unsigned long long> mSleepStart; //!< Start time of current sleep (nanoseconds of the steady clock, null if awake, written by slave only)
+			unsigned long long mAlive; //!< Time spent running in previous runs (nanoseconds, protected by the resize mutex of the pool)
+			unsigned long long mStart; //!< Start time of current run (nanoseconds of the steady clock, protected by the resize mutex of the pool)
+			Histogram mLatency; //!< Queue latency of the tasks started by slave (nanoseconds)
+			Histogram mRunTime; //!< Run time of the tasks completed by slave (nanoseconds)
+			
+			static void execute(LightTask* inTask);
+			void main(void);
+			void process(LightTask* inTask);
+			void startSleep(void);
+			void stopSleep(void);
+			
+			friend class TaskGraph;
+			friend class ThreadPool;
+		};
+		
+		/*! \brief Timer thread for the portable thread pool.
+		\author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+		\ingroup Threading
+		
+		This class defines the thread that drives the timer wheel of a thread pool (see ThreadPool::schedule). It sleeps on its condition until the wheel must be advanced, or until a timer that expires earlier is added, and pushes the tasks of the expired timers onto its pool.
+		*/
+		class TimerThread : public Thread {
+			public:
+			//! Construct timer thread of thread pool \c inPool, and run it.
+			explicit TimerThread(ThreadPool* inPool) : mPool(inPool) {run();}
+			~TimerThread(void);
+			
+			TimerWheel::Timer add(LightTask& inTask, double inDelay, double inPeriod);
+			bool remove(TimerWheel::Timer inTimer);
+			
 			protected:
 			ThreadPool* mPool; //!< Pointer to parent thread pool
+			Condition mCondition; //!< Condition of the timer wheel
+			TimerWheel mWheel; //!< Timers of the pool (protected by the condition)
 			
 			void main(void);
 		};
@@ -72,7 +132,27 @@ namespace PACC {
 			\author Marc Parizeau, Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
 			\ingroup Threading
 			
-			This class implements a thread pool of slave threads that process a FIFO queue of tasks derived from class Threading::Task. A task is simply an object with a Task::main method. Here is a simple usage example:
+			This class implements a thread pool of slave threads that process a FIFO queue of tasks derived from class Threading::Task, or from its lightweight base class Threading::LightTask. A task is simply an object with a Task::main method. 
+			
+			In work-stealing mode (see ThreadPool::Mode), each slave owns a lock-free deque of tasks (see TaskDeque). Tasks pushed by a task that runs in the pool go to the deque of its slave, which runs them in LIFO order, while tasks pushed by other threads go to a global injection queue. A slave that runs out of tasks takes tasks from the injection queue, then steals tasks from the deques of randomly selected slaves, before going to sleep. Tasks are thus no longer started in FIFO order, but the pool mutex is no longer taken by each push and each dequeue.
+			
+			In lock-free mode, tasks go through a bounded lock-free FIFO queue (see TaskRing) whose capacity is given to the constructor; tasks that are pushed while it is full go to an overflow queue protected by the pool mutex. 
+			
+			In both of these modes, idle slaves sleep on an event count (see EventCount), so that a push only makes a system call when a slave is actually sleeping.
+			
+			A task can be pushed with a priority level (see ThreadPool::Priority) and a deadline. Slaves always start the tasks of a higher level first, and, within a level, the tasks with a deadline in earliest deadline first order, before the other tasks in FIFO order. In work-stealing and lock-free modes, only the normal tasks without deadline go through the deques or the lock-free queue; the other tasks go through the prioritized queues of the pool mutex, which slaves check for high priority tasks and normal tasks with a deadline before their own deque or the lock-free queue, and for aged background tasks every 64 tasks. To prevent starvation, a background task is promoted to the normal level after waiting for the aging delay (see ThreadPool::setAging), or once its deadline has passed. Method ThreadPool::getDepth returns the number of waiting tasks of each level, for admission control.
+			
+			An elastic pool is constructed with a minimum and a maximum number of slaves. It starts with the minimum number, and runs an additional slave when a push finds that too many tasks wait, or that tasks have waited for too long (see ThreadPool::setGrowth); a slave that stays idle for the idle timeout retires (see ThreadPool::setIdleTimeout), until the minimum number is reached. Method ThreadPool::resize also changes the number of running slaves on demand. A slave only retires between tasks, so that running tasks are never disturbed. The pool vector always holds the maximum number of slaves, of which ThreadPool::getSlaves are running.
+			
+			The slaves can be placed on the CPUs of the host according to a placement policy given to the constructor (see Topology::Placement). With the node placement, the pool is split into one sub-pool per NUMA node, whose slaves run on the CPUs of their node. Method ThreadPool::pushOnNode pushes a task that prefers a node, for instance because it works on memory allocated by that node: it is started by a slave of that node when one is available, and by another slave only when the latter has no other normal task to run.
+			
+			Method ThreadPool::getStats returns a snapshot of the statistics of the pool: the number of completed and queued tasks, the queue latency of tasks (from push to start) and their run time, as log-linear histograms (see Histogram), and the busy time, wake ups and steals of each slave. Each slave records its own statistics without atomic read-modify-write operations, and the snapshot merges them. The counters and busy times only read the clock when slaves go to sleep, but the latency and run time histograms cost two reads of the steady clock per task (and one per push); they can be disabled for very short tasks (see ThreadPool::setTiming). The statistics are cumulative since the construction of the pool; the difference between two snapshots gives the statistics of an interval.
+			
+			Method ThreadPool::schedule pushes a task after a delay, and method ThreadPool::scheduleAtFixedRate pushes it periodically, until the timer is cancelled (see ThreadPool::cancel). The timers of the pool are held by a hierarchical timer wheel (see TimerWheel), driven by a single timer thread that is created by the first timer, so that thousands of timeouts and periodic jobs cost neither a thread each nor a logarithmic insertion.
+			
+			Method ThreadPool::submit runs any function (or callable object) in the pool, and returns a Future of its result. Continuations of futures (see Future::then) are pushed onto the pool when their antecedent result becomes available, so that no slave is blocked while waiting for it.
+			
+			Here is a simple usage example:
 			\code
 #include "Threading/Task.hpp"
 
@@ -98,17 +178,176 @@ int void main(int argc, char** argv)
 			*/
 		class ThreadPool : public vector<SlaveThread*>, public Condition {      
 			public:
-			ThreadPool(unsigned int inSlaves);
+			//! Scheduling modes of the thread pool.
+			enum Mode {
+				eGlobalQueue, //!< All tasks go through a single FIFO queue protected by the pool mutex.
+				eWorkStealing, //!< Each slave has its own deque of tasks, and idle slaves steal tasks from other slaves.
+				eLockFreeQueue //!< All tasks go through a single bounded lock-free FIFO queue.
+			};
+			
+			//! Priority levels of tasks.
+			enum Priority {
+				eHigh, //!< Latency-sensitive tasks, started before all others.
+				eNormal, //!< Default level.
+				eBackground //!< Tasks started when no other task waits (see ThreadPool::setAging).
+			};
+			
+			//! Identifier of a timer (see ThreadPool::schedule).
+			typedef TimerWheel::Timer Timer;
+			
+			//! Snapshot of the statistics of a thread pool (see ThreadPool::getStats).
+			struct Stats {
+				//! Statistics of a slave.
+				struct Slave {
+					bool mRunning; //!< Slave is running.
+					int mNode; //!< NUMA node of slave (-1 if floating).
+					unsigned long long mCompleted; //!< Number of tasks completed by slave.
+					unsigned long long mWakeups; //!< Number of wake ups after sleeping for a task.
+					unsigned long long mSteals; //!< Number of tasks stolen from other slaves (work-stealing mode).
+					double mBusy; //!< Time spent running or searching for tasks, rather than sleeping (seconds).
+					double mAlive; //!< Time spent running, since construction of the pool (seconds).
+				};
+				
+				double mElapsed; //!< Time since construction of the pool (seconds).
+				unsigned int mRunning; //!< Number of running slaves.
+				unsigned int mMaxSlaves; //!< Maximum number of slaves.
+				unsigned long long mCompleted; //!< Number of completed tasks.
+				unsigned int mQueued; //!< Number of tasks that are waiting or running.
+				unsigned int mDepth[3]; //!< Number of waiting tasks of each priority level (see ThreadPool::getDepth).
+				unsigned long long mWakeups; //!< Number of wake ups of slaves after sleeping for a task.
+				unsigned long long mSteals; //!< Number of tasks stolen by slaves (work-stealing mode).
+				double mBusy; //!< Time spent running or searching for tasks by all slaves (seconds).
+				double mAlive; //!< Time spent running by all slaves (seconds).
+				Histogram mLatency; //!< Queue latency of started tasks, from push to start (nanoseconds, see ThreadPool::setTiming).
+				Histogram mRunTime; //!< Run time of completed tasks (nanoseconds, see ThreadPool::setTiming).
+				vector<Slave> mSlaves; //!< Statistics of each slave.
+				
+				//! Return the fraction of the running time of slaves that was not spent sleeping.
+				double getUtilization(void) const {return mAlive > 0 ? mBusy/mAlive : 0;}
+				void write(ostream& outStream) const;
+				void writeJSON(ostream& outStream) const;
+			};
+			
+			ThreadPool(unsigned int inSlaves, Mode inMode=eGlobalQueue, unsigned int inCapacity=4096, Topology::Placement inPlacement=Topology::eFloating);
+			ThreadPool(unsigned int inMin, unsigned int inMax, Mode inMode=eGlobalQueue, unsigned int inCapacity=4096, Topology::Placement inPlacement=Topology::eFloating);
 			~ThreadPool(void);
 			
-			void push(Task& inTask);
+			bool cancel(Timer inTimer);
+			//! Return the delay (in seconds) after which a waiting background task is promoted to the normal level.
+			double getAging(void) const {return mAging;}
+			unsigned int getDepth(Priority inPriority) const;
+			//! Return the number of waiting tasks per running slave above which a push runs an additional slave (none if null).
+			unsigned int getGrowthDepth(void) const {return mGrowthDepth;}
+			//! Return the delay (in seconds) without completed task, while tasks wait, after which a push runs an additional slave (none if null).
+			double getGrowthWait(void) const {return mGrowthWait;}
+			//! Return the delay (in seconds) after which an idle slave retires, if more than the minimum number of slaves run (never if null).
+			double getIdleTimeout(void) const {return mIdleTimeout;}
+			//! Return the maximum number of running slaves (size of the pool vector).
+			unsigned int getMaxSlaves(void) const {return size();}
+			//! Return the minimum number of running slaves.
+			unsigned int getMinSlaves(void) const {return mMin;}
+			//! Return the scheduling mode of this thread pool.
+			Mode getMode(void) const {return mMode;}
+			//! Return the placement policy of the slaves of this thread pool.
+			Topology::Placement getPlacement(void) const {return mPlacement;}
+			//! Return the number of running slaves.
+			unsigned int getSlaves(void) const {return mSlaves;}
+			Stats getStats(void) const;
+			//! Return whether the queue latency and run time of tasks are measured.
+			bool isTiming(void) const {return mTiming;}
+			
+			void push(LightTask& inTask);
+			void push(LightTask& inTask, Priority inPriority, double inDeadline=0);
+			void pushBatch(LightTask** inTasks, unsigned int inCount);
+			void pushBatch(Task** inTasks, unsigned int inCount);
+			void pushOnNode(LightTask& inTask, unsigned int inNode);
+			void resize(unsigned int inSlaves);
+			Timer schedule(LightTask& inTask, double inDelay);
+			Timer scheduleAtFixedRate(LightTask& inTask, double inDelay, double inPeriod);
+			void setAging(double inDelay);
+			void setGrowth(unsigned int inDepth, double inWait);
+			void setIdleTimeout(double inDelay);
+			void setTiming(bool inTiming);
+			
+			/*! \brief Run function \c inFunction (or any callable object without argument) in this thread pool, and return the future of its result.
+			
+			The function is copied into a task that is deleted after completion. An exception thrown by the function is stored into the future, and rethrown by Future::get. A function that returns a reference gives a future of a copy of the referred value.
+			*/
+			template <class Function>
+			Future<typename decay<decltype(declval<Function&>()())>::type> submit(Function inFunction) {
+				typedef typename decay<decltype(declval<Function&>()())>::type Result;
+				shared_ptr<FutureValue<Result> > lState(new FutureValue<Result>(this));
+				push(*new FunctionTask<Result, Function>(lState, inFunction));
+				return Future<Result>(lState);
+			}
 			
 			protected:
-			queue<Task*> mTasks; //!< Queue of tasks.
+			//! Task waiting in a priority level.
+			struct QueuedTask {
+				LightTask* mTask; //!< Waiting task.
+				double mTime; //!< Deadline of task, or push time of a background task without deadline (seconds of the steady clock).
+				unsigned long long mSequence; //!< Push order of task (between equal deadlines).
+				//! Return whether this task should be started after task \c inTask (heap order).
+				bool operator<(const QueuedTask& inTask) const {return mTime > inTask.mTime || (mTime == inTask.mTime && mSequence > inTask.mSequence);}
+			};
+			
+			//! Waiting tasks of a priority level.
+			struct Level {
+				vector<QueuedTask> mDeadlines; //!< Heap of tasks with a deadline, earliest deadline first.
+				queue<QueuedTask> mTasks; //!< Tasks without deadline, in FIFO order.
+				//! Return whether no task waits in level.
+				bool isEmpty(void) const {return mDeadlines.empty() && mTasks.empty();}
+			};
+			
+			Level mLevels[3]; //!< Waiting tasks of each priority level (injection queue in work-stealing mode, overflow queue in lock-free mode, for the normal tasks without deadline).
+			vector<queue<LightTask*> > mNodeTasks; //!< Waiting normal tasks that prefer each NUMA node, in FIFO order.
+			atomic<unsigned int> mDepth[3]; //!< Number of tasks in each priority level.
+			atomic<unsigned int> mUrgent; //!< Number of tasks in the high level, and of tasks with a deadline in the normal level.
+			unsigned long long mSequence; //!< Number of tasks pushed onto the priority levels.
+			double mAging; //!< Delay after which a waiting background task is promoted (seconds).
+			Mode mMode; //!< Scheduling mode.
+			Topology::Placement mPlacement; //!< Placement policy of slaves.
+			TaskRing* mRing; //!< Lock-free queue of tasks (lock-free mode).
+			unsigned int mIdle; //!< Number of slaves that wait for a task on the pool condition (global queue mode).
+			EventCount mEvents; //!< Event count of sleeping slaves (work-stealing and lock-free modes).
+			atomic<unsigned int> mInjected; //!< Number of tasks in all priority levels.
+			atomic<unsigned int> mQueued; //!< Number of tasks that are waiting to run or running.
+			atomic<unsigned int> mSearching; //!< Number of slaves searching for tasks to steal (work-stealing mode).
+			atomic<bool> mDraining; //!< Pool is waiting for its queues to empty.
+			atomic<bool> mStopping; //!< Slaves should terminate.
+			atomic<unsigned int> mSlaves; //!< Number of running slaves.
+			atomic<unsigned int> mMin; //!< Minimum number of running slaves.
+			atomic<unsigned int> mRetiring; //!< Number of slaves that should retire as soon as they are idle (see ThreadPool::resize).
+			atomic<unsigned int> mGrowthDepth; //!< Number of waiting tasks per running slave above which a slave is added.
+			atomic<double> mGrowthWait; //!< Delay without completed task after which a slave is added (seconds).
+			atomic<double> mIdleTimeout; //!< Delay after which an idle slave retires (seconds).
+			atomic<double> mBacklogTime; //!< Time at which tasks started to wait, or at which the last task completed, if later (seconds of the steady clock).
+			Mutex mResize; //!< Mutex of the running state of slaves.
+			unsigned long long mCreation; //!< Construction time of pool (nanoseconds of the steady clock).
+			atomic<bool> mTiming; //!< Queue latency and run time of tasks are measured.
+			atomic<TimerThread*> mTimerThread; //!< Thread of the timer wheel (created by the first timer).
+			
+			template <class TaskType> void enqueue(TaskType** inTasks, unsigned int inCount, TaskGroup* inGroup, Priority inPriority=eNormal, double inDeadline=0, int inNode=-1);
+			void addSlaves(unsigned int inCount);
+			LightTask* findTask(SlaveThread* inSlave);
+			void grow(unsigned int inCount);
+			bool hasTask(void) const;
+			LightTask* popTask(bool inBackground, int inNode);
+			bool retire(SlaveThread* inSlave, bool inTimedOut);
+			void pushTask(LightTask* inTask, Priority inPriority, bool inDeadline, double inTime, int inNode);
+			LightTask* stealTask(SlaveThread* inSlave);
+			void stopSlaves(void);
+			LightTask* takeInjectedTask(bool inBackground, int inNode);
+			void takenTask(void);
+			TimerThread& getTimerThread(void);
 			
 			friend class SlaveThread;
+			friend class TaskGroup;
 		};
 		
+		//! Insert the statistics \c inStats of a thread pool into output stream \c outStream, in text format.
+		ostream& operator<<(ostream& outStream, const ThreadPool::Stats& inStats);
+		
 	} // end of Threading namespace
 	
 } // end of PACC namespace
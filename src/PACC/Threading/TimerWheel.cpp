@@ -0,0 +1,226 @@
+/*
+ *  Portable Agile C++ Classes (PACC)
+ *  Copyright (C) 2001-2003 by Marc Parizeau
+ *  http://manitou.gel.ulaval.ca/~parizeau/PACC
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *  Contact:
+ *  Laboratoire de Vision et Systemes Numeriques
+ *  Departement de genie electrique et de genie informatique
+ *  Universite Laval, Quebec, Canada, G1K 7P4
+ *  http://vision.gel.ulaval.ca
+ *
+ */
+
+/*!
+ * \file PACC/Threading/TimerWheel.cpp
+ * \brief Class methods for the hierarchical timer wheel.
+ * \author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+ */
+
+#include "PACC/Threading/TimerWheel.hpp"
+#include "PACC/Util/Assert.hpp"
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cmath>
+
+using namespace std;
+using namespace PACC;
+
+//! Construct empty wheel of resolution \c inResolution seconds, whose tick 0 is the current time.
+Threading::TimerWheel::TimerWheel(double inResolution) : mResolution(inResolution), mCurrent(0), mLast(0)
+{
+	PACC_AssertM(inResolution > 0, "TimerWheel::TimerWheel() invalid resolution!");
+	mOrigin = chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+	for(unsigned int i = 0; i < eLevels; ++i) {
+		mOccupied[i] = 0;
+		for(unsigned int j = 0; j < eSlots; ++j) mSlots[i][j] = 0;
+	}
+}
+
+//! Delete wheel and its timers, without returning their tasks.
+Threading::TimerWheel::~TimerWheel(void)
+{
+	clear();
+}
+
+/*! \brief Add a timer that returns task \c inTask at time \c inTime (seconds of the steady clock), and then every \c inPeriod seconds if the period is not null; return the identifier of the timer.
+
+A time that has already passed expires at the next advance of the wheel. The period is rounded to a whole number of ticks (at least one).
+*/
+Threading::TimerWheel::Timer Threading::TimerWheel::add(LightTask& inTask, double inTime, double inPeriod)
+{
+	Entry* lEntry = new Entry;
+	lEntry->mTimer = ++mLast;
+	lEntry->mTask = &inTask;
+	// round up, so that the timer never expires early
+	const double lTick = ceil((inTime-mOrigin)/mResolution);
+	lEntry->mTick = lTick <= mCurrent ? mCurrent+1 : (lTick >= (double) (1ULL << (eBits*eLevels-1)) ? 1ULL << (eBits*eLevels-1) : (unsigned long long) lTick);
+	lEntry->mPeriod = inPeriod > 0 ? max(1ULL, (unsigned long long) llround(inPeriod/mResolution)) : 0;
+	insert(lEntry);
+	mEntries[lEntry->mTimer] = lEntry;
+	return lEntry->mTimer;
+}
+
+/*! \brief Advance the wheel to time \c inTime (seconds of the steady clock), and append the tasks of the expired timers to \c outTasks.
+
+The tasks are appended in order of expiration. The expired one-shot timers are removed, and the periodic timers are added again for their next occurrence after \c inTime.
+*/
+void Threading::TimerWheel::advance(double inTime, vector<LightTask*>& outTasks)
+{
+	const unsigned long long lTarget = getTick(inTime);
+	while(!mEntries.empty()) {
+		// jump to the next tick that expires or cascades a slot
+		const unsigned long long lNext = getNextTick();
+		if(lNext > lTarget) break;
+		mCurrent = lNext;
+		// cascade the slots of the higher levels that start at this tick, from the highest level
+		for(unsigned int i = eLevels-1; i > 0; --i) {
+			if((mCurrent & ((1ULL << (eBits*i))-1)) != 0) continue;
+			for(Entry* lEntry = take(i, (mCurrent >> (eBits*i)) & (eSlots-1)); lEntry != 0;) {
+				Entry* lNextEntry = lEntry->mNext;
+				insert(lEntry);
+				lEntry = lNextEntry;
+			}
+		}
+		// expire the slot of the first level
+		for(Entry* lEntry = take(0, mCurrent & (eSlots-1)); lEntry != 0;) {
+			Entry* lNextEntry = lEntry->mNext;
+			if(lEntry->mPeriod == 0) {
+				outTasks.push_back(lEntry->mTask);
+				mEntries.erase(lEntry->mTimer);
+				delete lEntry;
+			} else {
+				if(!lEntry->mTask->isPending()) outTasks.push_back(lEntry->mTask);
+				// skip the missed occurrences
+				lEntry->mTick += lEntry->mPeriod;
+				if(lEntry->mTick <= lTarget) lEntry->mTick += ((lTarget-lEntry->mTick)/lEntry->mPeriod+1)*lEntry->mPeriod;
+				insert(lEntry);
+			}
+			lEntry = lNextEntry;
+		}
+	}
+	if(lTarget > mCurrent) mCurrent = lTarget;
+}
+
+//! Remove all timers, and append their tasks to \c outTasks if it is not null.
+void Threading::TimerWheel::clear(vector<LightTask*>* outTasks)
+{
+	for(unordered_map<Timer, Entry*>::iterator lEntry = mEntries.begin(); lEntry != mEntries.end(); ++lEntry) {
+		if(outTasks) outTasks->push_back(lEntry->second->mTask);
+		delete lEntry->second;
+	}
+	mEntries.clear();
+	for(unsigned int i = 0; i < eLevels; ++i) {
+		mOccupied[i] = 0;
+		for(unsigned int j = 0; j < eSlots; ++j) mSlots[i][j] = 0;
+	}
+}
+
+/*! \brief Return the next tick that expires timers or cascades a slot (ULLONG_MAX if the wheel is empty).
+
+The non-empty slots of a level all follow the slot of the current tick in that level, so that the first one is found in the bit mask of the level.
+*/
+unsigned long long Threading::TimerWheel::getNextTick(void) const
+{
+	unsigned long long lNext = ULLONG_MAX;
+	for(unsigned int i = 0; i < eLevels; ++i) {
+		const unsigned int lIndex = (mCurrent >> (eBits*i)) & (eSlots-1);
+		const unsigned long long lMask = lIndex == eSlots-1 ? 0 : mOccupied[i] & (~0ULL << (lIndex+1));
+		if(lMask == 0) continue;
+		const unsigned long long lBlock = (mCurrent >> (eBits*(i+1))) << (eBits*(i+1));
+		const unsigned long long lTick = lBlock | ((unsigned long long) __builtin_ctzll(lMask) << (eBits*i));
+		if(lTick < lNext) lNext = lTick;
+	}
+	return lNext;
+}
+
+/*! \brief Return the time (seconds of the steady clock) at which the wheel should next be advanced, or a negative value if it is empty.
+
+This time may only cascade timers to lower levels, without expiring any of them.
+*/
+double Threading::TimerWheel::getNextTime(void) const
+{
+	if(mEntries.empty()) return -1;
+	return mOrigin + getNextTick()*mResolution;
+}
+
+//! Return the last tick that started at time \c inTime (seconds of the steady clock).
+unsigned long long Threading::TimerWheel::getTick(double inTime) const
+{
+	const double lTick = floor((inTime-mOrigin)/mResolution);
+	return lTick <= 0 ? 0 : (lTick >= (double) (1ULL << (eBits*eLevels-1)) ? 1ULL << (eBits*eLevels-1) : (unsigned long long) lTick);
+}
+
+/*! \brief Insert timer \c ioEntry into the slot of its expiration tick.
+
+The level is given by the highest bit that differs between the expiration tick and the current tick.
+*/
+void Threading::TimerWheel::insert(Entry* ioEntry)
+{
+	const unsigned long long lDifference = ioEntry->mTick ^ mCurrent;
+	ioEntry->mLevel = lDifference == 0 ? 0 : (63-__builtin_clzll(lDifference))/eBits;
+	ioEntry->mSlot = (ioEntry->mTick >> (eBits*ioEntry->mLevel)) & (eSlots-1);
+	Entry*& lHead = mSlots[ioEntry->mLevel][ioEntry->mSlot];
+	ioEntry->mPrevious = 0;
+	ioEntry->mNext = lHead;
+	if(lHead) lHead->mPrevious = ioEntry;
+	lHead = ioEntry;
+	mOccupied[ioEntry->mLevel] |= 1ULL << ioEntry->mSlot;
+}
+
+/*! \brief Remove timer \c inTimer; return false if it does not exist (or a one-shot timer has already expired).
+
+The task of the timer is not returned.
+*/
+bool Threading::TimerWheel::remove(Timer inTimer)
+{
+	unordered_map<Timer, Entry*>::iterator lEntry = mEntries.find(inTimer);
+	if(lEntry == mEntries.end()) return false;
+	unlink(lEntry->second);
+	delete lEntry->second;
+	mEntries.erase(lEntry);
+	return true;
+}
+
+//! Empty slot \c inSlot of level \c inLevel, and return its timers in the order they were inserted (linked by Entry::mNext).
+Threading::TimerWheel::Entry* Threading::TimerWheel::take(unsigned int inLevel, unsigned int inSlot)
+{
+	Entry* lEntry = mSlots[inLevel][inSlot];
+	mSlots[inLevel][inSlot] = 0;
+	mOccupied[inLevel] &= ~(1ULL << inSlot);
+	// reverse the list, which holds the latest timer first
+	Entry* lFirst = 0;
+	while(lEntry) {
+		Entry* lNext = lEntry->mNext;
+		lEntry->mNext = lFirst;
+		lFirst = lEntry;
+		lEntry = lNext;
+	}
+	return lFirst;
+}
+
+//! Remove timer \c ioEntry from its slot.
+void Threading::TimerWheel::unlink(Entry* ioEntry)
+{
+	if(ioEntry->mPrevious) ioEntry->mPrevious->mNext = ioEntry->mNext;
+	else {
+		mSlots[ioEntry->mLevel][ioEntry->mSlot] = ioEntry->mNext;
+		if(ioEntry->mNext == 0) mOccupied[ioEntry->mLevel] &= ~(1ULL << ioEntry->mSlot);
+	}
+	if(ioEntry->mNext) ioEntry->mNext->mPrevious = ioEntry->mPrevious;
+}
@@ -0,0 +1,120 @@
+/*
+ *  Portable Agile C++ Classes (PACC)
+ *  Copyright (C) 2001-2003 by Marc Parizeau
+ *  http://manitou.gel.ulaval.ca/~parizeau/PACC
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *  Contact:
+ *  Laboratoire de Vision et Systemes Numeriques
+ *  Departement de genie electrique et de genie informatique
+ *  Universite Laval, Quebec, Canada, G1K 7P4
+ *  http://vision.gel.ulaval.ca
+ *
+ */
+
+/*!
+ * \file PACC/Threading/TimerWheel.hpp
+ * \brief Class definition for the hierarchical timer wheel.
+ * \author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+ */
+
+#ifndef PACC_Threading_TimerWheel_hpp_
+#define PACC_Threading_TimerWheel_hpp_
+
+#include "PACC/Threading/LightTask.hpp"
+#include <unordered_map>
+#include <vector>
+
+namespace PACC {
+	
+	using namespace std;
+	
+	namespace Threading {
+		
+		/*! \brief Hierarchical timer wheel of tasks.
+		\author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+		\ingroup Threading
+		
+		A timer wheel holds the tasks that wait for an expiration time, in units of its resolution (ticks, one millisecond by default). It has 8 levels of 64 slots: a timer that expires within 64 ticks goes to a slot of the first level, a timer that expires within 4096 ticks to a slot of the second level, and so on. When the current tick enters a slot of a higher level, the timers of that slot are cascaded to the lower levels, so that each timer is moved at most 8 times. Adding, removing and expiring a timer thus take a constant time, whatever the number of timers, unlike a heap. A bit mask of the occupied slots of each level finds the next expiration (or cascade) in constant time, so that an idle wheel is not advanced tick by tick.
+		
+		A timer is either a one-shot timer, which returns its task once, or a periodic timer, which returns its task at a fixed rate until it is removed: its occurrences are computed from its first expiration time, so that they do not drift, and the occurrences that were missed (because the wheel was advanced late) are skipped. An occurrence is also skipped if the task is still pending, so that a periodic task never runs concurrently with itself.
+		
+		The expiration times are in seconds of the steady clock, and the timers never expire early. This class is not thread-safe: it is driven by a single thread, such as the timer thread of a ThreadPool (see ThreadPool::schedule) or the thread of a Reactor.
+		*/
+		class TimerWheel {
+			public:
+			//! Identifier of a timer (never null).
+			typedef unsigned long long Timer;
+			
+			explicit TimerWheel(double inResolution=0.001);
+			~TimerWheel(void);
+			
+			Timer add(LightTask& inTask, double inTime, double inPeriod=0);
+			void advance(double inTime, vector<LightTask*>& outTasks);
+			void clear(vector<LightTask*>* outTasks=0);
+			double getNextTime(void) const;
+			//! Return the resolution of this wheel (seconds).
+			double getResolution(void) const {return mResolution;}
+			//! Return the number of timers.
+			unsigned int getSize(void) const {return mEntries.size();}
+			bool remove(Timer inTimer);
+			
+			protected:
+			//! Dimensions of the wheel.
+			enum {
+				eBits=6, //!< Number of bits of the slot index.
+				eSlots=64, //!< Number of slots per level.
+				eLevels=8 //!< Number of levels.
+			};
+			
+			//! Timer of a task.
+			struct Entry {
+				Timer mTimer; //!< Identifier of timer.
+				LightTask* mTask; //!< Waiting task.
+				unsigned long long mTick; //!< Expiration tick.
+				unsigned long long mPeriod; //!< Period in ticks (null for a one-shot timer).
+				Entry* mPrevious; //!< Previous timer of slot.
+				Entry* mNext; //!< Next timer of slot.
+				unsigned int mLevel; //!< Level of slot.
+				unsigned int mSlot; //!< Index of slot in its level.
+			};
+			
+			double mResolution; //!< Duration of a tick (seconds).
+			double mOrigin; //!< Time of tick 0 (seconds of the steady clock).
+			unsigned long long mCurrent; //!< Current tick (all timers expire later).
+			Timer mLast; //!< Identifier of the last added timer.
+			Entry* mSlots[eLevels][eSlots]; //!< Timers of each slot (head of doubly linked list, latest first).
+			unsigned long long mOccupied[eLevels]; //!< Bit mask of the non-empty slots of each level.
+			unordered_map<Timer, Entry*> mEntries; //!< Timers by identifier.
+			
+			unsigned long long getNextTick(void) const;
+			unsigned long long getTick(double inTime) const;
+			void insert(Entry* ioEntry);
+			Entry* take(unsigned int inLevel, unsigned int inSlot);
+			void unlink(Entry* ioEntry);
+			
+			private:
+			//! restrict (disable) copy constructor.
+			TimerWheel(const TimerWheel&);
+			//! restrict (disable) assignment operator.
+			void operator=(const TimerWheel&);
+		};
+		
+	} // end of Threading namespace
+	
+} // end of PACC namespace
+
+#endif // PACC_Threading_TimerWheel_hpp_
@@ -0,0 +1,225 @@
+/*
+ *  Portable Agile C++ Classes (PACC)
+ *  Copyright (C) 2001-2003 by Marc Parizeau
+ *  http://manitou.gel.ulaval.ca/~parizeau/PACC
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *  Contact:
+ *  Laboratoire de Vision et Systemes Numeriques
+ *  Departement de genie electrique et de genie informatique
+ *  Universite Laval, Quebec, Canada, G1K 7P4
+ *  http://vision.gel.ulaval.ca
+ *
+ */
+
+/*!
+ * \file PACC/Threading/Topology.cpp
+ * \brief Class methods for the processor topology.
+ * \author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+ */
+
+#include "PACC/Threading/Topology.hpp"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+using namespace std;
+using namespace PACC;
+
+namespace {
+	
+	//! Read the first line of file \c inName into \c outLine; return false if the file can not be read.
+	bool readLine(const string& inName, string& outLine)
+	{
+		ifstream lFile(inName.c_str());
+		return bool(getline(lFile, outLine));
+	}
+	
+	//! Return the number in file \c inName, or \c inDefault if the file can not be read or holds a negative number.
+	unsigned int readNumber(const string& inName, unsigned int inDefault)
+	{
+		string lLine;
+		if(!readLine(inName, lLine)) return inDefault;
+		istringstream lStream(lLine);
+		long lValue;
+		if(!(lStream >> lValue) || lValue < 0) return inDefault;
+		return (unsigned int) lValue;
+	}
+	
+}
+
+/*! \brief Discover the topology from the system directory \c inPath (normally /sys/devices/system).
+
+The online CPUs are read from file cpu/online, their core and package from files cpu/cpuN/topology/core_id and physical_package_id, and the CPUs of each online node from files node/online and node/nodeN/cpulist. A missing node directory (kernel without NUMA support) puts every CPU in node 0, and a missing cpu directory leaves a single node and package of std::thread::hardware_concurrency CPUs. Unlike Topology::getDefault, this constructor does not restrict the CPUs to the affinity mask of the process.
+*/
+Threading::Topology::Topology(const string& inPath) : mNodes(1)
+{
+	string lLine;
+	vector<unsigned int> lOnline;
+	if(readLine(inPath+"/cpu/online", lLine)) lOnline = parseList(lLine);
+	if(lOnline.empty()) {
+		const unsigned int lCount = max(thread::hardware_concurrency(), 1u);
+		for(unsigned int i = 0; i < lCount; ++i) lOnline.push_back(i);
+	}
+	mCPUs.resize(lOnline.size());
+	for(unsigned int i = 0; i < lOnline.size(); ++i) {
+		ostringstream lName;
+		lName << inPath << "/cpu/cpu" << lOnline[i] << "/topology/";
+		mCPUs[i].mId = lOnline[i];
+		mCPUs[i].mCore = readNumber(lName.str()+"core_id", lOnline[i]);
+		mCPUs[i].mPackage = readNumber(lName.str()+"physical_package_id", 0);
+		mCPUs[i].mNode = 0;
+	}
+	if(!readLine(inPath+"/node/online", lLine)) return;
+	const vector<unsigned int> lNodes = parseList(lLine);
+	for(unsigned int i = 0; i < lNodes.size(); ++i) {
+		ostringstream lName;
+		lName << inPath << "/node/node" << lNodes[i] << "/cpulist";
+		if(!readLine(lName.str(), lLine)) continue;
+		const vector<unsigned int> lList = parseList(lLine);
+		for(unsigned int j = 0; j < mCPUs.size(); ++j) {
+			if(binary_search(lList.begin(), lList.end(), mCPUs[j].mId)) mCPUs[j].mNode = lNodes[i];
+		}
+	}
+	for(unsigned int i = 0; i < mCPUs.size(); ++i) mNodes = max(mNodes, mCPUs[i].mNode+1);
+}
+
+/*! \brief Return the topology of the host.
+
+The topology is discovered from /sys/devices/system on first call (see Topology::Topology). Under Linux, it only keeps the CPUs of the affinity mask of the process (e.g. as set by command taskset or by a container), so that the placements of Topology::getPlacement are always valid; the node numbers are not changed.
+*/
+const Threading::Topology& Threading::Topology::getDefault(void)
+{
+	static const Topology lDefault = []() {
+		Topology lTopology;
+#if defined(__linux__)
+		cpu_set_t lSet;
+		CPU_ZERO(&lSet);
+		if(::sched_getaffinity(0, sizeof(lSet), &lSet) == 0) {
+			vector<CPU> lAllowed;
+			for(unsigned int i = 0; i < lTopology.mCPUs.size(); ++i) {
+				if(lTopology.mCPUs[i].mId < CPU_SETSIZE && CPU_ISSET(lTopology.mCPUs[i].mId, &lSet)) lAllowed.push_back(lTopology.mCPUs[i]);
+			}
+			if(!lAllowed.empty()) lTopology.mCPUs.swap(lAllowed);
+		}
+#endif
+		return lTopology;
+	}();
+	return lDefault;
+}
+
+//! Return the node of CPU number \c inCPU, or -1 if it does not belong to this topology.
+int Threading::Topology::getNode(unsigned int inCPU) const
+{
+	for(unsigned int i = 0; i < mCPUs.size(); ++i) {
+		if(mCPUs[i].mId == inCPU) return mCPUs[i].mNode;
+	}
+	return -1;
+}
+
+//! Return the numbers of the CPUs of node \c inNode, in increasing order.
+vector<unsigned int> Threading::Topology::getNodeCPUs(unsigned int inNode) const
+{
+	vector<unsigned int> lCPUs;
+	for(unsigned int i = 0; i < mCPUs.size(); ++i) {
+		if(mCPUs[i].mNode == inNode) lCPUs.push_back(mCPUs[i].mId);
+	}
+	return lCPUs;
+}
+
+/*! \brief Return the numbers of the CPUs in the order in which placement \c inPlacement (compact or scatter) assigns them to threads.
+
+The compact order sorts the CPUs by node, package, core and number, so that the hyperthreads of a core are consecutive. The scatter order takes the first hyperthread of the first core of each node in turn, then of the second core of each node, and so on, before the second hyperthreads of the cores.
+*/
+vector<unsigned int> Threading::Topology::getOrder(Placement inPlacement) const
+{
+	vector<CPU> lCPUs(mCPUs);
+	sort(lCPUs.begin(), lCPUs.end(), [](const CPU& inLeft, const CPU& inRight) {
+		if(inLeft.mNode != inRight.mNode) return inLeft.mNode < inRight.mNode;
+		if(inLeft.mPackage != inRight.mPackage) return inLeft.mPackage < inRight.mPackage;
+		if(inLeft.mCore != inRight.mCore) return inLeft.mCore < inRight.mCore;
+		return inLeft.mId < inRight.mId;
+	});
+	vector<unsigned int> lOrder(lCPUs.size());
+	if(inPlacement == eScatter) {
+		// key of each CPU: rank of hyperthread in its core, rank of core in its node, and node
+		vector<pair<pair<unsigned int, unsigned int>, pair<unsigned int, unsigned int> > > lKeys(lCPUs.size());
+		unsigned int lCore = 0, lThread = 0;
+		for(unsigned int i = 0; i < lCPUs.size(); ++i) {
+			if(i > 0 && lCPUs[i].mNode != lCPUs[i-1].mNode) lCore = lThread = 0;
+			else if(i > 0 && (lCPUs[i].mPackage != lCPUs[i-1].mPackage || lCPUs[i].mCore != lCPUs[i-1].mCore)) {
+				++lCore;
+				lThread = 0;
+			} else if(i > 0) ++lThread;
+			lKeys[i] = make_pair(make_pair(lThread, lCore), make_pair(lCPUs[i].mNode, lCPUs[i].mId));
+		}
+		sort(lKeys.begin(), lKeys.end());
+		for(unsigned int i = 0; i < lKeys.size(); ++i) lOrder[i] = lKeys[i].second.second;
+	} else {
+		for(unsigned int i = 0; i < lCPUs.size(); ++i) lOrder[i] = lCPUs[i].mId;
+	}
+	return lOrder;
+}
+
+/*! \brief Return the CPU sets of \c inThreads threads placed according to policy \c inPlacement.
+
+Element i of the returned vector is the affinity of thread i (see Thread::setAffinity), which is empty for floating threads. With compact and scatter placements, each thread runs on a single CPU; when there are more threads than CPUs, the CPUs are reused in the same order. With the node placement, the threads are split into consecutive blocks of nearly equal size, one per node that has CPUs, and each thread may run on any CPU of its node.
+*/
+vector<vector<unsigned int> > Threading::Topology::getPlacement(Placement inPlacement, unsigned int inThreads) const
+{
+	vector<vector<unsigned int> > lSets(inThreads);
+	if(inPlacement == eFloating || mCPUs.empty()) return lSets;
+	if(inPlacement == eNodes) {
+		vector<vector<unsigned int> > lNodes;
+		for(unsigned int i = 0; i < mNodes; ++i) {
+			vector<unsigned int> lCPUs = getNodeCPUs(i);
+			if(!lCPUs.empty()) lNodes.push_back(lCPUs);
+		}
+		for(unsigned int i = 0; i < inThreads; ++i) lSets[i] = lNodes[(unsigned long long) i*lNodes.size()/inThreads];
+		return lSets;
+	}
+	const vector<unsigned int> lOrder = getOrder(inPlacement);
+	for(unsigned int i = 0; i < inThreads; ++i) lSets[i].assign(1, lOrder[i % lOrder.size()]);
+	return lSets;
+}
+
+/*! \brief Return the numbers of a list in the format of the Linux system files (e.g. "0-3,8,10-11"), in increasing order.
+
+Malformed items are ignored.
+*/
+vector<unsigned int> Threading::Topology::parseList(const string& inList)
+{
+	vector<unsigned int> lNumbers;
+	istringstream lStream(inList);
+	string lItem;
+	while(getline(lStream, lItem, ',')) {
+		unsigned int lFirst, lLast;
+		char lDash;
+		istringstream lRange(lItem);
+		if(!(lRange >> lFirst)) continue;
+		if(!(lRange >> lDash)) lLast = lFirst;
+		else if(lDash != '-' || !(lRange >> lLast) || lLast < lFirst) continue;
+		for(unsigned int i = lFirst; i <= lLast; ++i) lNumbers.push_back(i);
+	}
+	sort(lNumbers.begin(), lNumbers.end());
+	lNumbers.erase(unique(lNumbers.begin(), lNumbers.end()), lNumbers.end());
+	return lNumbers;
+}
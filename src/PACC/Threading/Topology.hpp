@@ -0,0 +1,98 @@
+/*
+ *  Portable Agile C++ Classes (PACC)
+ *  Copyright (C) 2001-2003 by Marc Parizeau
+ *  http://manitou.gel.ulaval.ca/~parizeau/PACC
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *  Contact:
+ *  Laboratoire de Vision et Systemes Numeriques
+ *  Departement de genie electrique et de genie informatique
+ *  Universite Laval, Quebec, Canada, G1K 7P4
+ *  http://vision.gel.ulaval.ca
+ *
+ */
+
+/*!
+ * \file PACC/Threading/Topology.hpp
+ * \brief Class definition for the processor topology.
+ * \author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+ */
+
+#ifndef PACC_Threading_Topology_hpp_
+#define PACC_Threading_Topology_hpp_
+
+#include <string>
+#include <vector>
+
+namespace PACC {
+	
+	using namespace std;
+	
+	namespace Threading {
+		
+		/*! \brief Processor topology of the host.
+		\author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+		\ingroup Threading
+		
+		This class describes the logical processors (CPUs) on which the process may run, with their core, package (socket) and NUMA node. Under Linux, the topology is read from directories /sys/devices/system/cpu and /sys/devices/system/node, and restricted to the CPUs of the process affinity mask. Elsewhere, or if these directories can not be read, the host is described as a single node and package of std::thread::hardware_concurrency CPUs without hyperthreads.
+		
+		Method Topology::getPlacement computes the CPU sets of a group of threads for a placement policy (see Topology::Placement), which ThreadPool and Socket::TCPServer apply to their threads with Thread::setAffinity.
+		*/
+		class Topology {
+		 public:
+			//! Logical processor.
+			struct CPU {
+				unsigned int mId; //!< Number of CPU (as used by Thread::setAffinity).
+				unsigned int mCore; //!< Number of core in its package; hyperthreads of a core share this number.
+				unsigned int mPackage; //!< Number of package (socket).
+				unsigned int mNode; //!< Number of NUMA node.
+			};
+			
+			//! Placement policies of a group of threads.
+			enum Placement {
+				eFloating, //!< Threads may run on any CPU (no affinity).
+				eCompact, //!< Thread i runs on the i-th CPU, filling the cores of a node (hyperthreads included) before the next node.
+				eScatter, //!< Thread i runs on the i-th CPU, alternating between nodes, and between cores before hyperthreads.
+				eNodes //!< Threads are split in equal blocks (one per node), and each thread may run on any CPU of its node.
+			};
+			
+			explicit Topology(const string& inPath="/sys/devices/system");
+			
+			//! Return the topology of the host, discovered on first call.
+			static const Topology& getDefault(void);
+			
+			//! Return the CPUs of this topology, by increasing number.
+			const vector<CPU>& getCPUs(void) const {return mCPUs;}
+			int getNode(unsigned int inCPU) const;
+			vector<unsigned int> getNodeCPUs(unsigned int inNode) const;
+			//! Return the number of NUMA nodes (one more than the highest node number).
+			unsigned int getNodes(void) const {return mNodes;}
+			vector<vector<unsigned int> > getPlacement(Placement inPlacement, unsigned int inThreads) const;
+			
+			static vector<unsigned int> parseList(const string& inList);
+			
+		 protected:
+			vector<CPU> mCPUs; //!< CPUs by increasing number.
+			unsigned int mNodes; //!< Number of NUMA nodes.
+			
+			vector<unsigned int> getOrder(Placement inPlacement) const;
+		};
+		
+	} // end of Threading namespace
+	
+} // end of PACC namespace
+
+#endif // PACC_Threading_Topology_hpp_
@@ -39,7 +39,10 @@
  */
 
 #include "PACC/Util/Assert.hpp"
+#include "PACC/Util/CPUFeatures.hpp"
 #include "PACC/Util/Date.hpp"
+#include "PACC/Util/LazyPermutation.hpp"
+#include "PACC/Util/Parallel.hpp"
 #include "PACC/Util/Randomizer.hpp"
 #include "PACC/Util/RandomPermutation.hpp"
 #include "PACC/Util/SignalHandler.hpp"
@@ -0,0 +1,70 @@
+/*
+ *  Portable Agile C++ Classes (PACC)
+ *  Copyright (C) 2001-2003 by Marc Parizeau
+ *  http://manitou.gel.ulaval.ca/~parizeau/PACC
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *  Contact:
+ *  Laboratoire de Vision et Systemes Numeriques
+ *  Departement de genie electrique et de genie informatique
+ *  Universite Laval, Quebec, Canada, G1K 7P4
+ *  http://vision.gel.ulaval.ca
+ *
+ */
+
+/*!
+ * \file PACC/Util/ByteOrder.hpp
+ * \brief Functions for the portable encoding of integers in binary buffers.
+ * \author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+ */
+
+#ifndef PACC_ByteOrder_hpp_
+#define PACC_ByteOrder_hpp_
+
+namespace PACC {
+	
+	//! Write the 16 least significant bits of \c inValue in little-endian order into buffer \c outBuffer.
+	inline void writeLittleEndian16(unsigned char* outBuffer, unsigned long inValue)
+	{
+		outBuffer[0] = (unsigned char) (inValue & 0xFF);
+		outBuffer[1] = (unsigned char) ((inValue >> 8) & 0xFF);
+	}
+	
+	//! Write the 32 least significant bits of \c inValue in little-endian order into buffer \c outBuffer.
+	inline void writeLittleEndian32(unsigned char* outBuffer, unsigned long inValue)
+	{
+		outBuffer[0] = (unsigned char) (inValue & 0xFF);
+		outBuffer[1] = (unsigned char) ((inValue >> 8) & 0xFF);
+		outBuffer[2] = (unsigned char) ((inValue >> 16) & 0xFF);
+		outBuffer[3] = (unsigned char) ((inValue >> 24) & 0xFF);
+	}
+	
+	//! Return the 16 bits integer stored in little-endian order in buffer \c inBuffer.
+	inline unsigned long readLittleEndian16(const unsigned char* inBuffer)
+	{
+		return (unsigned long) inBuffer[0] | ((unsigned long) inBuffer[1] << 8);
+	}
+	
+	//! Return the 32 bits integer stored in little-endian order in buffer \c inBuffer.
+	inline unsigned long readLittleEndian32(const unsigned char* inBuffer)
+	{
+		return (unsigned long) inBuffer[0] | ((unsigned long) inBuffer[1] << 8) 
+			| ((unsigned long) inBuffer[2] << 16) | ((unsigned long) inBuffer[3] << 24);
+	}
+	
+} // end of PACC namespace
+
+#endif
@@ -0,0 +1,150 @@
+/*
+ *  Portable Agile C++ Classes (PACC)
+ *  Copyright (C) 2001-2003 by Marc Parizeau
+ *  http://manitou.gel.ulaval.ca/~parizeau/PACC
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *  Contact:
+ *  Laboratoire de Vision et Systemes Numeriques
+ *  Departement de genie electrique et de genie informatique
+ *  Universite Laval, Quebec, Canada, G1K 7P4
+ *  http://vision.gel.ulaval.ca
+ *
+ */
+
+/*!
+ * \file PACC/Util/CPUFeatures.cpp
+ * \brief Class methods for the run time detection of processor features.
+ * \author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+ */
+
+#include "PACC/Util/CPUFeatures.hpp"
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <cpuid.h>
+#define PACC_CPUID_GNU
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define PACC_CPUID_MSVC
+#endif
+
+using namespace PACC;
+
+namespace {
+	
+#if defined(PACC_CPUID_GNU) || defined(PACC_CPUID_MSVC)
+	//! Return registers eax, ebx, ecx and edx of instruction cpuid for leaf \c inLeaf and subleaf \c inSubLeaf through \c outRegisters.
+	bool callCPUID(unsigned int inLeaf, unsigned int inSubLeaf, unsigned int outRegisters[4])
+	{
+#ifdef PACC_CPUID_GNU
+		if(__get_cpuid_max(0, 0) < inLeaf) return false;
+		__cpuid_count(inLeaf, inSubLeaf, outRegisters[0], outRegisters[1], outRegisters[2], outRegisters[3]);
+#else
+		int lRegisters[4];
+		__cpuid(lRegisters, 0);
+		if((unsigned int) lRegisters[0] < inLeaf) return false;
+		__cpuidex(lRegisters, inLeaf, inSubLeaf);
+		for(int i = 0; i < 4; ++i) outRegisters[i] = lRegisters[i];
+#endif
+		return true;
+	}
+	
+	//! Return the extended control register XCR0 (state components enabled by the operating system).
+	unsigned long long getXCR0(void)
+	{
+#ifdef PACC_CPUID_GNU
+		unsigned int lEAX, lEDX;
+		__asm__ __volatile__("xgetbv" : "=a"(lEAX), "=d"(lEDX) : "c"(0));
+		return ((unsigned long long) lEDX << 32) | lEAX;
+#else
+		return _xgetbv(0);
+#endif
+	}
+#endif
+	
+	//! Return the level of the host processor.
+	CPUFeatures::Level detectLevel(void)
+	{
+#if defined(PACC_CPUID_GNU) || defined(PACC_CPUID_MSVC)
+		unsigned int lBasic[4], lExtended[4];
+		if(!callCPUID(1, 0, lBasic)) return CPUFeatures::eGeneric;
+		if((lBasic[3] & (1U << 26)) == 0) return CPUFeatures::eGeneric;
+		// AVX states must be enabled by the operating system (bits OSXSAVE and AVX)
+		const bool lOSXSave = (lBasic[2] & (1U << 27)) != 0 && (lBasic[2] & (1U << 28)) != 0;
+		if(!lOSXSave || !callCPUID(7, 0, lExtended)) return CPUFeatures::eSSE2;
+		const unsigned long long lXCR0 = getXCR0();
+		if((lXCR0 & 0x6) != 0x6 || (lExtended[1] & (1U << 5)) == 0) return CPUFeatures::eSSE2;
+		// AVX-512 subsets F (16), DQ (17), BW (30) and VL (31), with opmask and ZMM states
+		const unsigned int cAVX512Bits = (1U << 16) | (1U << 17) | (1U << 30) | (1U << 31);
+		if((lXCR0 & 0xE6) != 0xE6 || (lExtended[1] & cAVX512Bits) != cAVX512Bits) return CPUFeatures::eAVX2;
+		return CPUFeatures::eAVX512;
+#elif defined(__aarch64__) || defined(_M_ARM64) || defined(__ARM_NEON)
+		return CPUFeatures::eNEON;
+#else
+		return CPUFeatures::eGeneric;
+#endif
+	}
+	
+	//! Return the level used by the kernels, according to environment variable PACC_CPU_LEVEL.
+	CPUFeatures::Level selectLevel(void)
+	{
+		const CPUFeatures::Level lDetected = CPUFeatures::getDetectedLevel();
+		const char* lName = getenv("PACC_CPU_LEVEL");
+		if(lName == 0) return lDetected;
+		for(int i = CPUFeatures::eGeneric; i <= CPUFeatures::eNEON; ++i) {
+			const CPUFeatures::Level lLevel = (CPUFeatures::Level) i;
+			if(strcmp(lName, CPUFeatures::getLevelName(lLevel)) != 0) continue;
+			if(lLevel == CPUFeatures::eGeneric || lLevel == lDetected) return lLevel;
+			// lower to the best level supported by the processor
+			if(lLevel == CPUFeatures::eNEON || lDetected == CPUFeatures::eNEON) return CPUFeatures::eGeneric;
+			return (lLevel < lDetected ? lLevel : lDetected);
+		}
+		return lDetected;
+	}
+	
+}
+
+/*!
+The detection is made only once.
+*/
+CPUFeatures::Level CPUFeatures::getDetectedLevel(void)
+{
+	static const Level lLevel = detectLevel();
+	return lLevel;
+}
+
+/*!
+The level is selected only once, on the first call. It is the level detected by 
+CPUFeatures::getDetectedLevel, unless it was lowered by environment variable PACC_CPU_LEVEL.
+*/
+CPUFeatures::Level CPUFeatures::getLevel(void)
+{
+	static const Level lLevel = selectLevel();
+	return lLevel;
+}
+
+const char* CPUFeatures::getLevelName(Level inLevel)
+{
+	switch(inLevel) {
+		case eSSE2: return "sse2";
+		case eAVX2: return "avx2";
+		case eAVX512: return "avx512";
+		case eNEON: return "neon";
+		default: return "generic";
+	}
+}
@@ -0,0 +1,122 @@
+/*
+ *  Portable Agile C++ Classes (PACC)
+ *  Copyright (C) 2001-2003 by Marc Parizeau
+ *  http://manitou.gel.ulaval.ca/~parizeau/PACC
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *  Contact:
+ *  Laboratoire de Vision et Systemes Numeriques
+ *  Departement de genie electrique et de genie informatique
+ *  Universite Laval, Quebec, Canada, G1K 7P4
+ *  http://vision.gel.ulaval.ca
+ *
+ */
+
+/*!
+ * \file PACC/Util/CPUFeatures.hpp
+ * \brief Class definition for the run time detection of processor features.
+ * \author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+ */
+
+#ifndef PACC_CPUFeatures_hpp_
+#define PACC_CPUFeatures_hpp_
+
+#include "PACC/config.hpp"
+
+// Kernels are cloned for several x86 instruction sets only with compilers that support target attributes
+#if defined(PACC_CPU_DISPATCH) && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define PACC_CPU_DISPATCH_X86
+#define PACC_TARGET_SSE2 __attribute__((target("sse2")))
+#define PACC_TARGET_AVX2 __attribute__((target("avx2")))
+#define PACC_TARGET_AVX512 __attribute__((target("avx2,avx512f,avx512bw,avx512dq,avx512vl"), optimize("fp-contract=off")))
+#endif
+
+// Kernel bodies must be inlined into each of their clones
+#if defined(__GNUC__)
+#define PACC_FORCE_INLINE inline __attribute__((always_inline))
+#elif defined(_MSC_VER)
+#define PACC_FORCE_INLINE __forceinline
+#else
+#define PACC_FORCE_INLINE inline
+#endif
+
+namespace PACC {
+	
+	/*!\brief Run time detection of processor features.
+	\author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+	\ingroup Util
+	
+	This class detects the vector instruction sets of the host processor (using instruction 
+	cpuid on x86 processors), so that a single binary can select, at run time, the fastest 
+	implementation of its compute kernels. Method CPUFeatures::getLevel returns the level used 
+	by the kernels, and method CPUFeatures::select returns the implementation that matches this 
+	level. Each kernel makes its selection only once, on its first call.
+	
+	The level can be lowered by setting environment variable PACC_CPU_LEVEL to one of "generic", 
+	"sse2", "avx2", "avx512" or "neon" before the first call, for instance to test or benchmark 
+	the different implementations. A level that is not supported by the processor is lowered to 
+	the best supported level.
+	
+	On x86 processors with compilers that support target attributes (gcc, clang), and unless 
+	option PACC_CPU_DISPATCH is disabled at configuration time, the Math kernels (matrix 
+	product, column reductions, normal transforms) and the Tokenizer scanning are compiled for 
+	the SSE2, AVX2 and AVX-512 instruction sets. On other platforms, the generic kernels are 
+	compiled for the baseline instruction set of the build, which includes NEON on 64 bits ARM 
+	processors. The floating point kernels do not use fused multiply-add instructions, so that 
+	their results are identical for all levels.
+	*/
+	class CPUFeatures {
+	 public:
+		//! Vector instruction set levels.
+		enum Level {
+			eGeneric, //!< No specific instruction set (portable code).
+			eSSE2,    //!< x86 SSE2 instructions.
+			eAVX2,    //!< x86 AVX2 instructions.
+			eAVX512,  //!< x86 AVX-512 instructions (F, BW, DQ and VL subsets).
+			eNEON     //!< ARM NEON instructions.
+		};
+		
+		//! Return the instruction set level supported by the processor.
+		static Level getDetectedLevel(void);
+		
+		//! Return the instruction set level used by the kernels (possibly lowered by environment variable PACC_CPU_LEVEL).
+		static Level getLevel(void);
+		
+		//! Return the name of instruction set level \c inLevel.
+		static const char* getLevelName(Level inLevel);
+		
+		/*! \brief Return the implementation of a kernel that matches the current level.
+		
+		Any null implementation is replaced by that of the next lower level; the generic 
+		implementation \c inGeneric must be defined.
+		*/
+		template <typename Function>
+		static Function select(Function inGeneric, Function inSSE2, Function inAVX2, Function inAVX512) {
+			const Level lLevel = getLevel();
+			if(lLevel == eAVX512 && inAVX512) return inAVX512;
+			if((lLevel == eAVX512 || lLevel == eAVX2) && inAVX2) return inAVX2;
+			if(lLevel >= eSSE2 && lLevel <= eAVX512 && inSSE2) return inSSE2;
+			return inGeneric;
+		}
+		
+	 private:
+		CPUFeatures(void); // disable constructor
+		
+	};
+	
+} // end of PACC namespace
+
+#endif // PACC_CPUFeatures_hpp_
@@ -0,0 +1,85 @@
+/*
+ *  Portable Agile C++ Classes (PACC)
+ *  Copyright (C) 2001-2003 by Marc Parizeau
+ *  http://manitou.gel.ulaval.ca/~parizeau/PACC
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *  Contact:
+ *  Laboratoire de Vision et Systemes Numeriques
+ *  Departement de genie electrique et de genie informatique
+ *  Universite Laval, Quebec, Canada, G1K 7P4
+ *  http://vision.gel.ulaval.ca
+ *
+ */
+
+/*!
+ * \file PACC/Util/LazyPermutation.cpp
+ * \brief Class methods for the lazy random permutation.
+ * \author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+ */
+
+#include "PACC/Util/LazyPermutation.hpp"
+
+using namespace std;
+using namespace PACC;
+
+/*!
+*/
+LazyPermutation::LazyPermutation(unsigned long long inSize, Randomizer& inRand)
+{
+	resize(inSize, inRand);
+}
+
+/*!
+New round keys are drawn from \c inRand; the size of the permutation is unchanged.
+*/
+LazyPermutation& LazyPermutation::permutate(Randomizer& inRand)
+{
+	for(unsigned int i = 0; i < cRounds; ++i) {
+		// separate statements, as the order of evaluation of operands is unspecified
+		const unsigned long long lHigh = inRand.getInteger();
+		const unsigned long long lLow = inRand.getInteger();
+		mKeys[i] = (lHigh << 32) | lLow;
+	}
+	return *this;
+}
+
+/*!
+*/
+void LazyPermutation::resize(unsigned long long inSize, Randomizer& inRand)
+{
+	mSize = inSize;
+	// find smallest h such that 2^2h >= size
+	mHalfBits = 1;
+	while(mHalfBits < 32 && (1ULL << (2*mHalfBits)) < mSize) ++mHalfBits;
+	mHalfMask = (1ULL << mHalfBits) - 1;
+	permutate(inRand);
+}
+
+/*!
+The permutation is divided into \c inParts contiguous ranges of (almost) equal sizes, and 
+the iterators over range \c inPart (in [0,\c inParts[) are returned in \c outBegin and \c outEnd. 
+Each range can then be processed independently, for instance by a different thread.
+*/
+void LazyPermutation::split(unsigned int inPart, unsigned int inParts, const_iterator& outBegin, const_iterator& outEnd) const
+{
+	PACC_AssertM(inPart < inParts, "LazyPermutation::split() invalid part!");
+	const unsigned long long lQuotient = mSize / inParts, lRemainder = mSize % inParts;
+	const unsigned long long lBegin = inPart*lQuotient + (inPart < lRemainder ? inPart : lRemainder);
+	const unsigned long long lEnd = lBegin + lQuotient + (inPart < lRemainder ? 1 : 0);
+	outBegin = const_iterator(this, lBegin);
+	outEnd = const_iterator(this, lEnd);
+}
@@ -0,0 +1,158 @@
+/*
+ *  Portable Agile C++ Classes (PACC)
+ *  Copyright (C) 2001-2003 by Marc Parizeau
+ *  http://manitou.gel.ulaval.ca/~parizeau/PACC
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *  Contact:
+ *  Laboratoire de Vision et Systemes Numeriques
+ *  Departement de genie electrique et de genie informatique
+ *  Universite Laval, Quebec, Canada, G1K 7P4
+ *  http://vision.gel.ulaval.ca
+ *
+ */
+
+/*!
+ * \file PACC/Util/LazyPermutation.hpp
+ * \brief Class definition for the lazy random permutation.
+ * \author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+ */
+
+#ifndef PACC_LazyPermutation_hpp_
+#define PACC_LazyPermutation_hpp_
+
+#include "PACC/Util/Randomizer.hpp"
+#include "PACC/Util/Assert.hpp"
+#include <iterator>
+
+namespace PACC {
+	
+	using namespace std;
+	
+	/*!\brief Lazy random permutation generator.
+	\author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+	\ingroup Util
+	
+	Like a RandomPermutation, a lazy permutation of size X maps indices 0 to X-1 onto integers 0 to X-1 
+	in random order. But instead of storing the permuted integers, the i-th element is computed on 
+	demand by a keyed bijection, which requires constant memory and constant expected time. This 
+	allows the random traversal of huge index spaces (e.g. 10^9 samples of a dataset).
+	
+	The bijection is a balanced Feistel network of LazyPermutation::cRounds rounds over the smallest 
+	even number of bits 2h such that 2^2h >= X. Values outside [0,X[ are mapped again through the 
+	network until they fall in range (cycle walking); since 2^2h < 4X, less than 4 encryptions are 
+	needed on average. The round keys are drawn from a Randomizer.
+	
+	For parallel processing, method LazyPermutation::split returns the iterators over a 
+	contiguous range of the permutation for each worker.
+	*/
+	class LazyPermutation {
+	 public:
+		//! Number of rounds of the Feistel network (fewer rounds give measurable biases on small sizes).
+		enum {cRounds = 8};
+		
+		/*! \brief Iterator over the elements of a lazy permutation.
+		
+		The element is computed when the iterator is dereferenced.
+		*/
+		class const_iterator {
+		 public:
+			typedef forward_iterator_tag iterator_category; //!< Iterator category.
+			typedef unsigned long long value_type; //!< Type of elements.
+			typedef long long difference_type; //!< Type of distance between iterators.
+			typedef const unsigned long long* pointer; //!< Pointer to element (not used).
+			typedef unsigned long long reference; //!< Elements are returned by value.
+			
+			//! Construct an iterator at index \c inIndex of permutation \c inPermutation.
+			const_iterator(const LazyPermutation* inPermutation=0, unsigned long long inIndex=0) : mPermutation(inPermutation), mIndex(inIndex) {}
+			
+			//! Return element at current index.
+			unsigned long long operator*(void) const {return (*mPermutation)[mIndex];}
+			//! Move to next index.
+			const_iterator& operator++(void) {++mIndex; return *this;}
+			//! Move to next index, and return iterator at previous index.
+			const_iterator operator++(int) {const_iterator lPrevious(*this); ++mIndex; return lPrevious;}
+			//! Return whether this iterator is at the same index as iterator \c inIterator.
+			bool operator==(const const_iterator& inIterator) const {return mIndex == inIterator.mIndex;}
+			//! Return whether this iterator is not at the same index as iterator \c inIterator.
+			bool operator!=(const const_iterator& inIterator) const {return mIndex != inIterator.mIndex;}
+			//! Return current index.
+			unsigned long long getIndex(void) const {return mIndex;}
+			
+		 protected:
+			const LazyPermutation* mPermutation; //!< Iterated permutation.
+			unsigned long long mIndex; //!< Current index.
+		};
+		
+		//! Initialize permutation of size \c inSize, shuffled using number generator \c inRand.
+		explicit LazyPermutation(unsigned long long inSize=0, Randomizer& inRand=PACC::rand);
+		
+		//! Return element at index \c inIndex.
+		unsigned long long operator[](unsigned long long inIndex) const {
+			PACC_AssertM(inIndex < mSize, "LazyPermutation::operator[] index out of range!");
+			unsigned long long lValue = encrypt(inIndex);
+			while(lValue >= mSize) lValue = encrypt(lValue);
+			return lValue;
+		}
+		
+		//! Return iterator at first element.
+		const_iterator begin(void) const {return const_iterator(this, 0);}
+		//! Return iterator after last element.
+		const_iterator end(void) const {return const_iterator(this, mSize);}
+		
+		//! Shuffle permutation randomly using number generator \c inRand.
+		LazyPermutation& permutate(Randomizer& inRand=PACC::rand);
+		
+		//! Resize permutation to \c inSize elements, and shuffle it using number generator \c inRand.
+		void resize(unsigned long long inSize, Randomizer& inRand=PACC::rand);
+		
+		//! Return number of elements.
+		unsigned long long size(void) const {return mSize;}
+		
+		void split(unsigned int inPart, unsigned int inParts, const_iterator& outBegin, const_iterator& outEnd) const;
+		
+	 protected:
+		unsigned long long mSize; //!< Number of elements.
+		unsigned int mHalfBits; //!< Number of bits of each half of the Feistel network.
+		unsigned long long mHalfMask; //!< Mask of the bits of each half.
+		unsigned long long mKeys[cRounds]; //!< Round keys.
+		
+		//! Return the image of \c inValue (in [0,2^2h[) by the Feistel network.
+		unsigned long long encrypt(unsigned long long inValue) const {
+			unsigned long long lLeft = inValue >> mHalfBits;
+			unsigned long long lRight = inValue & mHalfMask;
+			for(unsigned int i = 0; i < cRounds; ++i) {
+				const unsigned long long lTemp = lLeft ^ (mix(lRight ^ mKeys[i]) & mHalfMask);
+				lLeft = lRight;
+				lRight = lTemp;
+			}
+			return (lLeft << mHalfBits) | lRight;
+		}
+		
+		//! Return the MurmurHash3 finalizer of \c inValue (round function).
+		static unsigned long long mix(unsigned long long inValue) {
+			inValue ^= inValue >> 33;
+			inValue *= 0xff51afd7ed558ccdULL;
+			inValue ^= inValue >> 33;
+			inValue *= 0xc4ceb9fe1a85ec53ULL;
+			inValue ^= inValue >> 33;
+			return inValue;
+		}
+	};
+	
+} // end of namespace PACC
+
+#endif
@@ -0,0 +1,107 @@
+/*
+ *  Portable Agile C++ Classes (PACC)
+ *  Copyright (C) 2001-2003 by Marc Parizeau
+ *  http://manitou.gel.ulaval.ca/~parizeau/PACC
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *  Contact:
+ *  Laboratoire de Vision et Systemes Numeriques
+ *  Departement de genie electrique et de genie informatique
+ *  Universite Laval, Quebec, Canada, G1K 7P4
+ *  http://vision.gel.ulaval.ca
+ *
+ */
+
+/*!
+ * \file PACC/Util/Parallel.cpp
+ * \brief Class methods for the parallel execution of large loops.
+ * \author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+ */
+
+#include "PACC/Util/Parallel.hpp"
+#include <cstdlib>
+
+#ifdef PACC_PARALLEL_OPENMP
+#include <omp.h>
+#endif
+
+using namespace PACC;
+
+namespace {
+	
+	//! Default minimum amount of work for parallel loops.
+	const unsigned long cDefaultThreshold = 65536;
+	
+	//! Return the initial threshold, possibly set by environment variable PACC_PARALLEL_THRESHOLD.
+	unsigned long selectThreshold(void)
+	{
+		const char* lValue = getenv("PACC_PARALLEL_THRESHOLD");
+		if(lValue == 0 || *lValue == 0) return cDefaultThreshold;
+		char* lEnd = 0;
+		const unsigned long lThreshold = strtoul(lValue, &lEnd, 10);
+		return (*lEnd == 0 ? lThreshold : cDefaultThreshold);
+	}
+	
+	//! Return a reference to the current threshold.
+	unsigned long& getThresholdReference(void)
+	{
+		static unsigned long lThreshold = selectThreshold();
+		return lThreshold;
+	}
+	
+}
+
+/*!
+ */
+int Parallel::getThreadCount(void)
+{
+#ifdef PACC_PARALLEL_OPENMP
+	return omp_get_max_threads();
+#else
+	return 1;
+#endif
+}
+
+/*!
+ The default threshold is 65536 element operations, unless environment variable 
+ PACC_PARALLEL_THRESHOLD is set to another value.
+ */
+unsigned long Parallel::getThreshold(void)
+{
+	return getThresholdReference();
+}
+
+/*!
+ Loops never run in parallel without OpenMP, nor when they are already nested in a 
+ parallel region.
+ */
+bool Parallel::isParallel(unsigned long inWork)
+{
+#ifdef PACC_PARALLEL_OPENMP
+	return inWork >= getThresholdReference() && !omp_in_parallel() && omp_get_max_threads() > 1;
+#else
+	(void) inWork;
+	return false;
+#endif
+}
+
+/*!
+ A threshold of 0 runs all loops in parallel.
+ */
+void Parallel::setThreshold(unsigned long inThreshold)
+{
+	getThresholdReference() = inThreshold;
+}
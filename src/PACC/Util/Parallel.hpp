@@ -0,0 +1,102 @@
+/*
+ *  Portable Agile C++ Classes (PACC)
+ *  Copyright (C) 2001-2003 by Marc Parizeau
+ *  http://manitou.gel.ulaval.ca/~parizeau/PACC
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *  Contact:
+ *  Laboratoire de Vision et Systemes Numeriques
+ *  Departement de genie electrique et de genie informatique
+ *  Universite Laval, Quebec, Canada, G1K 7P4
+ *  http://vision.gel.ulaval.ca
+ *
+ */
+
+/*!
+ * \file PACC/Util/Parallel.hpp
+ * \brief Class definition for the parallel execution of large loops.
+ * \author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+ */
+
+#ifndef PACC_Parallel_hpp_
+#define PACC_Parallel_hpp_
+
+#include "PACC/config.hpp"
+
+// Loops are run by OpenMP threads only when option PACC_USE_PARALLEL_STL is enabled at configuration time
+#if defined(PACC_PARALLEL_STL) && defined(_OPENMP)
+#define PACC_PARALLEL_OPENMP
+#if defined(_MSC_VER)
+#define PACC_PARALLEL_FOR(inWork) __pragma(omp parallel for if(PACC::Parallel::isParallel(inWork)))
+#else
+#define PACC_PARALLEL_PRAGMA(inText) _Pragma(#inText)
+#define PACC_PARALLEL_FOR(inWork) PACC_PARALLEL_PRAGMA(omp parallel for if(PACC::Parallel::isParallel(inWork)))
+#endif
+#else
+#define PACC_PARALLEL_FOR(inWork)
+#endif
+
+namespace PACC {
+	
+	/*!\brief Parallel execution of large loops.
+	\author Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
+	\ingroup Util
+	
+	When option PACC_USE_PARALLEL_STL is enabled at configuration time, and OpenMP is found, 
+	the Math element-wise operations, reductions and products, the extremum searches of class 
+	Vector, the serialization of matrices, and the initialization of random permutations are 
+	split among OpenMP threads. Macro PACC_PARALLEL_FOR, placed in front of a \c for loop with 
+	signed integer indexes, runs this loop in parallel when its amount of work (a number of 
+	element operations) reaches the threshold returned by Parallel::getThreshold, and serially 
+	otherwise. The threshold can be set by method Parallel::setThreshold or by environment 
+	variable PACC_PARALLEL_THRESHOLD. Without OpenMP, the macro is empty and all loops are serial.
+	
+	Parallel loops split their work into fixed chunks and combine the partial results in chunk 
+	order, so that their results are the same as those of the serial loops. The permutations of 
+	Randomizer::shuffle remain serial, so that random streams stay reproducible.
+	*/
+	class Parallel {
+	 public:
+		//! Return the first index of chunk \c inChunk when \c inSize elements are split into \c inChunks chunks.
+		static unsigned int getChunkBegin(unsigned int inSize, int inChunk, int inChunks) {
+			return (unsigned int) ((unsigned long long) inSize * inChunk / inChunks);
+		}
+		
+		//! Return the number of chunks into which work \c inWork is split (1 if it is run serially).
+		static int getChunkCount(unsigned long inWork) {
+			return isParallel(inWork) ? getThreadCount() : 1;
+		}
+		
+		//! Return the maximum number of threads of parallel loops (1 without OpenMP).
+		static int getThreadCount(void);
+		
+		//! Return the minimum amount of work for which loops run in parallel.
+		static unsigned long getThreshold(void);
+		
+		//! Return whether a loop with work \c inWork runs in parallel.
+		static bool isParallel(unsigned long inWork);
+		
+		//! Set the minimum amount of work for which loops run in parallel to \c inThreshold.
+		static void setThreshold(unsigned long inThreshold);
+		
+	 private:
+		Parallel(void); // disable constructor
+		
+	};
+	
+} // end of PACC namespace
+
+#endif // PACC_Parallel_hpp_
@@ -36,6 +36,7 @@
 #ifndef PACC_RandomPermutation_hpp_
 #define PACC_RandomPermutation_hpp_
 
+#include "PACC/Util/Parallel.hpp"
 #include "PACC/Util/Randomizer.hpp"
 #include <algorithm>
 #include <vector>
@@ -54,12 +55,14 @@ namespace PACC {
 	 public:
 		//! Initialize permutation of size \c inSize, without any shuffling.
 		RandomPermutation(unsigned int inSize=0) : vector<unsigned int>(inSize) {
-			for(unsigned int i=0; i < inSize; ++i) (*this)[i] = i;
+			const int lSize = inSize;
+			PACC_PARALLEL_FOR(inSize)
+			for(int i=0; i < lSize; ++i) (*this)[i] = i;
 		}
 		
-		//! Shuffle permutation randomly using number generator \c inRand.
+		//! Shuffle permutation randomly using number generator \c inRand (see Randomizer::shuffle); the shuffle is always serial, so that it is reproducible.
 		RandomPermutation &permutate(Randomizer &inRand=PACC::rand) {
-			random_shuffle(begin(), end(), inRand);
+			inRand.shuffle(begin(), end());
 			return *this;
 		}
 		
@@ -34,13 +34,401 @@
  */
 
 #include "PACC/Util/Randomizer.hpp"
+#include "PACC/Util/Assert.hpp"
+#include "PACC/Util/ByteOrder.hpp"
+#include "PACC/Math/NormalTransform.hpp"
+#include "PACC/Math/Matrix.hpp"
+#include "PACC/Threading/Mutex.hpp"
+#include "PACC/Threading/TLS.hpp"
+#include <cmath>
+#include <cstring>
 #include <sstream>
+#include <stdexcept>
 
 using namespace std;
 using namespace PACC;
 
 Randomizer PACC::rand;
 
+namespace {
+	
+	//! Number of blocks of the ziggurat.
+	const unsigned int cZigBlocks = 128;
+	//! Start of the right tail of the ziggurat.
+	const double cZigTail = 3.442619855899;
+	//! Area of each block of the ziggurat.
+	const double cZigArea = 9.91256303526217e-3;
+	
+	/*! \brief Tables of the ziggurat for the normal distribution.
+	
+	Block i covers abscissa [0,mX[i]], and mRatio[i]=mX[i+1]/mX[i] is the fraction of this block 
+	that lies entirely under the density (block 0 is the base strip which includes the tail).
+	*/
+	struct ZigguratTables {
+		double mX[cZigBlocks+1]; //!< Right edge of each block.
+		double mRatio[cZigBlocks]; //!< Ratio of right edges of consecutive blocks.
+		
+		ZigguratTables(void) {
+			double lF = exp(-0.5*cZigTail*cZigTail);
+			mX[0] = cZigArea / lF;
+			mX[1] = cZigTail;
+			mX[cZigBlocks] = 0;
+			for(unsigned int i = 2; i < cZigBlocks; ++i) {
+				mX[i] = sqrt(-2*log(cZigArea/mX[i-1] + lF));
+				lF = exp(-0.5*mX[i]*mX[i]);
+			}
+			for(unsigned int i = 0; i < cZigBlocks; ++i) mRatio[i] = mX[i+1] / mX[i];
+		}
+	};
+	
+	//! Identifier of the binary state of a Randomizer ("PRND" in little-endian order).
+	const unsigned long cStateMagic = 0x444E5250UL;
+	//! Version of the binary state of a Randomizer.
+	const unsigned long cStateVersion = 1;
+	
+	//! Number of integers drawn at once by the bulk methods.
+	const unsigned int cFillBlock = 512;
+	
+	/*! \brief Return integer \c inValue (less than 2^52) converted to double.
+	
+	The integer is written in the mantissa of 2^52, which is then subtracted. Unlike a plain cast 
+	of a 64 bits integer, this conversion can be vectorized without AVX-512.
+	*/
+	inline double convertToDouble(MTRand::uint32 inValue)
+	{
+		const unsigned long long lBits = 0x4330000000000000ULL | (unsigned long long) inValue;
+		double lValue;
+		memcpy(&lValue, &lBits, sizeof(lValue));
+		return lValue - 4503599627370496.0;
+	}
+	
+	//! Compute the 128 bits product of \c inA and \c inB, returned in \c outHigh and \c outLow.
+	inline void multiplyWide(unsigned long long inA, unsigned long long inB, unsigned long long& outHigh, unsigned long long& outLow)
+	{
+#ifdef __SIZEOF_INT128__
+		const unsigned __int128 lProduct = (unsigned __int128) inA * inB;
+		outHigh = (unsigned long long) (lProduct >> 64);
+		outLow = (unsigned long long) lProduct;
+#else
+		const unsigned long long lA0 = inA & 0xFFFFFFFFULL, lA1 = inA >> 32;
+		const unsigned long long lB0 = inB & 0xFFFFFFFFULL, lB1 = inB >> 32;
+		const unsigned long long lP00 = lA0*lB0, lP01 = lA0*lB1, lP10 = lA1*lB0, lP11 = lA1*lB1;
+		const unsigned long long lMiddle = (lP00 >> 32) + (lP01 & 0xFFFFFFFFULL) + (lP10 & 0xFFFFFFFFULL);
+		outHigh = lP11 + (lP01 >> 32) + (lP10 >> 32) + (lMiddle >> 32);
+		outLow = (lMiddle << 32) | (lP00 & 0xFFFFFFFFULL);
+#endif
+	}
+	
+	//! Machine word used to store the coefficients of polynomials over GF(2).
+	typedef unsigned long long PolyWord;
+	//! Polynomial over GF(2); bit i%64 of word i/64 is the coefficient of x^i.
+	typedef vector<PolyWord> Polynomial;
+	
+	//! Degree of the characteristic polynomial of the Mersenne Twister (dimension of its state).
+	const unsigned int cDegree = 19937;
+	//! Number of words needed to store a polynomial of degree less than cDegree.
+	const unsigned int cWords = cDegree/64 + 1;
+	//! Base 2 logarithm of the distance between the streams returned by Randomizer::split.
+	const unsigned int cStreamLog2 = 128;
+	//! Number of draws from which Randomizer::discard jumps ahead instead of drawing (a jump costs about as much as these draws).
+	const unsigned long long cDiscardJump = 1ULL << 25;
+	
+	//! Add (xor) the \c inSize words of polynomial \c inPoly multiplied by x^\c inShift to polynomial \c ioResult.
+	inline void addShifted(PolyWord* ioResult, const PolyWord* inPoly, unsigned int inSize, unsigned int inShift)
+	{
+		const unsigned int lBitShift = inShift % 64;
+		ioResult += inShift / 64;
+		if(lBitShift == 0) {
+			for(unsigned int i = 0; i < inSize; ++i) ioResult[i] ^= inPoly[i];
+		} else {
+			PolyWord lCarry = 0;
+			for(unsigned int i = 0; i < inSize; ++i) {
+				ioResult[i] ^= (inPoly[i] << lBitShift) | lCarry;
+				lCarry = inPoly[i] >> (64-lBitShift);
+			}
+			if(lCarry != 0) ioResult[inSize] ^= lCarry;
+		}
+	}
+	
+	//! Polynomial with its 64 possible shifts within a word, for fast word-aligned additions.
+	struct ShiftedPolynomial {
+		vector<Polynomial> mShifts; //!< Polynomial multiplied by x^0 to x^63.
+		
+		//! Construct the shifts of polynomial \c inPoly.
+		explicit ShiftedPolynomial(const Polynomial& inPoly) : mShifts(64, Polynomial(inPoly.size()+1, 0)) {
+			for(unsigned int i = 0; i < 64; ++i) addShifted(&mShifts[i][0], &inPoly[0], inPoly.size(), i);
+		}
+		
+		//! Add (xor) this polynomial multiplied by x^\c inShift to polynomial \c ioResult.
+		void addTo(PolyWord* ioResult, unsigned int inShift) const {
+			const Polynomial& lShifted = mShifts[inShift%64];
+			ioResult += inShift / 64;
+			for(unsigned int i = 0; i < lShifted.size(); ++i) ioResult[i] ^= lShifted[i];
+		}
+	};
+	
+	//! Reduce polynomial \c ioPoly modulo polynomial \c inModulus of degree cDegree.
+	void reduce(Polynomial& ioPoly, const ShiftedPolynomial& inModulus)
+	{
+		for(unsigned int i = ioPoly.size()*64; i-- > cDegree;) {
+			if((ioPoly[i/64] >> (i%64)) & 1) inModulus.addTo(&ioPoly[0], i-cDegree);
+		}
+		ioPoly.resize(cWords);
+	}
+	
+	//! Return the product of polynomials \c inA and \c inB modulo polynomial \c inModulus.
+	Polynomial multiply(const Polynomial& inA, const Polynomial& inB, const ShiftedPolynomial& inModulus)
+	{
+		const ShiftedPolynomial lShiftedB(inB);
+		Polynomial lResult(inA.size()+inB.size()+2, 0);
+		for(unsigned int i = 0; i < inA.size()*64; ++i) {
+			if((inA[i/64] >> (i%64)) & 1) lShiftedB.addTo(&lResult[0], i);
+		}
+		reduce(lResult, inModulus);
+		return lResult;
+	}
+	
+	//! Return the square of polynomial \c inA modulo polynomial \c inModulus.
+	Polynomial square(const Polynomial& inA, const ShiftedPolynomial& inModulus)
+	{
+		// over GF(2), squaring only spreads the coefficients: (sum a_i x^i)^2 = sum a_i x^2i
+		Polynomial lResult(2*inA.size()+2, 0);
+		for(unsigned int i = 0; i < inA.size(); ++i) {
+			for(unsigned int j = 0; j < 2; ++j) {
+				PolyWord lWord = (inA[i] >> (32*j)) & 0xFFFFFFFFULL;
+				lWord = (lWord | (lWord << 16)) & 0x0000FFFF0000FFFFULL;
+				lWord = (lWord | (lWord << 8)) & 0x00FF00FF00FF00FFULL;
+				lWord = (lWord | (lWord << 4)) & 0x0F0F0F0F0F0F0F0FULL;
+				lWord = (lWord | (lWord << 2)) & 0x3333333333333333ULL;
+				lWord = (lWord | (lWord << 1)) & 0x5555555555555555ULL;
+				lResult[2*i+j] = lWord;
+			}
+		}
+		reduce(lResult, inModulus);
+		return lResult;
+	}
+	
+	/*! \brief Return the characteristic polynomial of the Mersenne Twister state transition.
+	
+	The polynomial is the minimal polynomial of a bit sequence produced by the generator, which 
+	is found using the Berlekamp-Massey algorithm on 2*cDegree bits. Because the characteristic 
+	polynomial is primitive, it does not depend on the seed nor on the chosen output bit.
+	*/
+	Polynomial computeCharacteristic(void)
+	{
+		// sequence of least significant output bits, stored in reverse order
+		const unsigned int lLength = 2*cDegree;
+		MTRand lGenerator(5489UL);
+		Polynomial lSequence(lLength/64 + 2, 0);
+		for(unsigned int i = 0; i < lLength; ++i) {
+			const unsigned int lIndex = lLength-1-i;
+			lSequence[lIndex/64] |= PolyWord(lGenerator.randInt() & 1) << (lIndex%64);
+		}
+		// Berlekamp-Massey algorithm over GF(2)
+		Polynomial lConnection(lSequence.size(), 0), lPrevious(lSequence.size(), 0);
+		lConnection[0] = lPrevious[0] = 1;
+		unsigned int lLFSRLength = 0, lPreviousLength = 0, lGap = 1;
+		for(unsigned int n = 0; n < lLength; ++n) {
+			// compute discrepancy sum_{i=0..L} c_i s_{n-i}
+			const unsigned int lOffset = lLength-1-n;
+			const unsigned int lOffsetWord = lOffset / 64, lOffsetBit = lOffset % 64;
+			PolyWord lSum = 0;
+			for(unsigned int k = 0; k <= lLFSRLength/64; ++k) {
+				PolyWord lWindow = lSequence[lOffsetWord+k] >> lOffsetBit;
+				if(lOffsetBit != 0) lWindow |= lSequence[lOffsetWord+k+1] << (64-lOffsetBit);
+				lSum ^= lConnection[k] & lWindow;
+			}
+			lSum ^= lSum >> 32; lSum ^= lSum >> 16; lSum ^= lSum >> 8;
+			lSum ^= lSum >> 4; lSum ^= lSum >> 2; lSum ^= lSum >> 1;
+			if((lSum & 1) == 0) {
+				++lGap;
+			} else if(2*lLFSRLength <= n) {
+				Polynomial lTemp = lConnection;
+				addShifted(&lConnection[0], &lPrevious[0], lPreviousLength/64+1, lGap);
+				lPreviousLength = lLFSRLength;
+				lLFSRLength = n+1-lLFSRLength;
+				lPrevious.swap(lTemp);
+				lGap = 1;
+			} else {
+				addShifted(&lConnection[0], &lPrevious[0], lPreviousLength/64+1, lGap);
+				++lGap;
+			}
+		}
+		PACC_AssertM(lLFSRLength == cDegree, "computeCharacteristic() invalid polynomial degree!");
+		// the characteristic polynomial is the reciprocal of the connection polynomial
+		Polynomial lCharacteristic(cWords, 0);
+		for(unsigned int i = 0; i <= cDegree; ++i) {
+			if((lConnection[i/64] >> (i%64)) & 1) lCharacteristic[(cDegree-i)/64] |= PolyWord(1) << ((cDegree-i)%64);
+		}
+		return lCharacteristic;
+	}
+	
+	//! Polynomials needed to jump the Mersenne Twister ahead by any number of steps, or by multiples of 2^cStreamLog2 steps.
+	struct JumpPolynomials {
+		Polynomial mCharacteristic; //!< Characteristic polynomial P(x) of the state transition.
+		ShiftedPolynomial mModulus; //!< Shifts of the characteristic polynomial.
+		Polynomial mStep; //!< Polynomial x.
+		Polynomial mStream; //!< Polynomial x^(2^cStreamLog2) mod P(x).
+		
+		JumpPolynomials(void) : mCharacteristic(computeCharacteristic()), mModulus(mCharacteristic), mStep(cWords, 0) {
+			mStep[0] = 2;
+			mStream = mStep;
+			for(unsigned int i = 0; i < cStreamLog2; ++i) mStream = square(mStream, mModulus);
+		}
+	};
+	
+	/*! \brief Return polynomial x^(\c inCount*s-1) mod P(x), for \c inCount > 0, where s is 2^cStreamLog2 if \c inStreams is true, and 1 otherwise.
+	
+	The jump polynomial is computed by binary exponentiation, and then divided by x. Since 
+	P(0)=1, the inverse of x modulo P(x) is (P(x)-1)/x.
+	*/
+	Polynomial computeJump(unsigned long long inCount, bool inStreams)
+	{
+		static const JumpPolynomials lPolynomials;
+		Polynomial lResult, lPower = inStreams ? lPolynomials.mStream : lPolynomials.mStep;
+		for(; inCount != 0; inCount >>= 1) {
+			if(inCount & 1) lResult = (lResult.empty() ? lPower : multiply(lResult, lPower, lPolynomials.mModulus));
+			if(inCount > 1) lPower = square(lPower, lPolynomials.mModulus);
+		}
+		// divide by x modulo P(x)
+		if(lResult[0] & 1) {
+			for(unsigned int i = 0; i < cWords; ++i) lResult[i] ^= lPolynomials.mCharacteristic[i];
+		}
+		for(unsigned int i = 0; i < cWords; ++i) {
+			lResult[i] = (lResult[i] >> 1) | (i+1 < cWords ? lResult[i+1] << 63 : 0);
+		}
+		return lResult;
+	}
+	
+	/*! \brief State of the Mersenne Twister as a circular window of MTRand::N consecutive words.
+	
+	Words are indexed from the head of the window, which holds the next value to output.
+	*/
+	struct TwisterWindow {
+		MTRand::uint32 mWords[MTRand::N]; //!< Circular buffer of state words.
+		unsigned int mHead; //!< Position of the first word of the window.
+		
+		//! Construct a null window.
+		TwisterWindow(void) : mHead(0) {
+			for(unsigned int i = 0; i < MTRand::N; ++i) mWords[i] = 0;
+		}
+		
+		//! Advance window by one step of the Mersenne Twister recurrence.
+		void step(void) {
+			const unsigned int cM = 397;
+			const unsigned int lNext = (mHead+1 == MTRand::N ? 0 : mHead+1);
+			const unsigned int lMiddle = (mHead+cM < MTRand::N ? mHead+cM : mHead+cM-MTRand::N);
+			const MTRand::uint32 lMixed = (mWords[mHead] & 0x80000000UL) | (mWords[lNext] & 0x7fffffffUL);
+			mWords[mHead] = mWords[lMiddle] ^ (lMixed >> 1) ^ (-(mWords[lNext] & 1UL) & 0x9908b0dfUL);
+			mHead = lNext;
+		}
+		
+		//! Add (xor) window \c inWindow, whose head is at position 0, to this window.
+		void add(const TwisterWindow& inWindow) {
+			const unsigned int lSplit = MTRand::N - mHead;
+			for(unsigned int i = 0; i < lSplit; ++i) mWords[mHead+i] ^= inWindow.mWords[i];
+			for(unsigned int i = lSplit; i < MTRand::N; ++i) mWords[i-lSplit] ^= inWindow.mWords[i];
+		}
+		
+		//! Return this window (whose head must be at position 0) multiplied by polynomial \c inPoly of the state transition.
+		TwisterWindow apply(const Polynomial& inPoly) const {
+			// Horner's rule: p(T)w = (...((p_d T + p_{d-1}) T + ...) T + p_0) w
+			TwisterWindow lResult;
+			for(unsigned int i = cDegree+1; i-- > 0;) {
+				lResult.step();
+				if((inPoly[i/64] >> (i%64)) & 1) lResult.add(*this);
+			}
+			return lResult;
+		}
+	};
+	
+	//! Delete thread local generator \c inRandomizer.
+	void deleteLocal(void* inRandomizer)
+	{
+		delete (Randomizer*) inRandomizer;
+	}
+	
+	//! Master generator and storage of the thread local generators.
+	struct LocalStreams {
+		Threading::Mutex mMutex; //!< Lock for the master generator.
+		Randomizer mMaster; //!< Master generator (stream 0).
+		Randomizer mNext; //!< Stream of the next thread that requests its local generator.
+		Threading::TLS mStorage; //!< Generator of each thread.
+		
+		LocalStreams(void) : mNext(mMaster), mStorage(deleteLocal) {}
+		
+		//! Set generator of the calling thread to \c inRandomizer.
+		void setLocal(const Randomizer& inRandomizer) {
+			Randomizer* lRandomizer = (Randomizer*) mStorage.getValue();
+			if(lRandomizer != 0) *lRandomizer = inRandomizer;
+			else mStorage.setValue(new Randomizer(inRandomizer));
+		}
+	};
+	
+	//! Return the thread local generators.
+	LocalStreams& getLocalStreams(void)
+	{
+		static LocalStreams lStreams;
+		return lStreams;
+	}
+	
+}
+
+/*!
+The binary state is made of the identifier and version of the format, the 624 words of the 
+Mersenne Twister state, and the number of words left before the next reload, all stored as 
+32 bits little-endian integers. Buffer \c outBuffer must hold at least 
+Randomizer::getBinaryStateSize bytes. Return the number of bytes written.
+*/
+unsigned int Randomizer::saveState(void* outBuffer) const
+{
+	unsigned char* lBuffer = (unsigned char*) outBuffer;
+	writeLittleEndian32(lBuffer, cStateMagic);
+	writeLittleEndian32(lBuffer+4, cStateVersion);
+	for(unsigned int i = 0; i < N; ++i) writeLittleEndian32(lBuffer+8+4*i, state[i]);
+	writeLittleEndian32(lBuffer+8+4*N, left);
+	return getBinaryStateSize();
+}
+
+/*!
+See Randomizer::saveState(void*) for details.
+*/
+void Randomizer::saveState(ostream& outStream) const
+{
+	unsigned char lBuffer[4*(N+3)];
+	outStream.write((const char*) lBuffer, saveState(lBuffer));
+}
+
+/*!
+Return the number of bytes read.
+\throw runtime_error if the buffer does not contain a valid binary state.
+*/
+unsigned int Randomizer::loadState(const void* inBuffer)
+{
+	const unsigned char* lBuffer = (const unsigned char*) inBuffer;
+	if(readLittleEndian32(lBuffer) != cStateMagic || readLittleEndian32(lBuffer+4) != cStateVersion) {
+		throw runtime_error("Randomizer::loadState() invalid binary state!");
+	}
+	const MTRand::uint32 lLeft = readLittleEndian32(lBuffer+8+4*N);
+	if(lLeft > N) throw runtime_error("Randomizer::loadState() invalid binary state!");
+	for(unsigned int i = 0; i < N; ++i) state[i] = readLittleEndian32(lBuffer+8+4*i);
+	left = lLeft;
+	pNext = &state[N-left];
+	return getBinaryStateSize();
+}
+
+/*!
+\throw runtime_error if the stream does not contain a valid binary state.
+*/
+void Randomizer::loadState(istream& inStream)
+{
+	unsigned char lBuffer[4*(N+3)];
+	if(!inStream.read((char*) lBuffer, getBinaryStateSize())) {
+		throw runtime_error("Randomizer::loadState() unable to read binary state!");
+	}
+	loadState(lBuffer);
+}
+
 /*! Return state of generator.
 */
 string Randomizer::getState(void) const
@@ -63,3 +451,309 @@ void Randomizer::setState(const string& inState)
 	lStream >> left;
 	pNext = &state[N-left];
 }
+
+/*! 
+This method implements the ziggurat method of G. Marsaglia and W.W. Tsang (Journal of Statistical Software, 
+Vol. 5, No. 8, 2000), with the modifications proposed by J.A. Doornik ("An Improved Ziggurat Method to 
+Generate Normal Random Samples", 2005) to avoid the correlation between the block index and the abscissa. 
+Most draws only require two uniform deviates, one multiplication and one comparison; the exponential 
+function is only evaluated for the 1.5% of draws that fall on the edge of a block.
+
+\attention This method does not return the same sequence as Randomizer::getGaussian.
+*/
+double Randomizer::getGaussianZiggurat(const double& inMean, const double& inStdDev)
+{
+	static const ZigguratTables lTables;
+	for(;;) {
+		const double lU = 2*randExc()-1;
+		const unsigned int lBlock = randInt() & (cZigBlocks-1);
+		// fast path: point lies inside the rectangle under the density
+		if(fabs(lU) < lTables.mRatio[lBlock]) return inMean + inStdDev*lU*lTables.mX[lBlock];
+		if(lBlock == 0) {
+			// sample from the tail using the method of Marsaglia (1964)
+			double lX, lY;
+			do {
+				lX = log(randDblExc()) / cZigTail;
+				lY = log(randDblExc());
+			} while(-2*lY < lX*lX);
+			return inMean + inStdDev*(lU < 0 ? lX-cZigTail : cZigTail-lX);
+		}
+		// point lies on the edge of the block; accept it if it is under the density
+		const double lX = lU*lTables.mX[lBlock];
+		const double lF0 = exp(-0.5*(lTables.mX[lBlock]*lTables.mX[lBlock] - lX*lX));
+		const double lF1 = exp(-0.5*(lTables.mX[lBlock+1]*lTables.mX[lBlock+1] - lX*lX));
+		if(lF1 + randExc()*(lF0-lF1) < 1.0) return inMean + inStdDev*lX;
+	}
+}
+
+/*!
+The tempering of the Mersenne Twister is applied to whole blocks of its state, which allows 
+the compiler to vectorize it. This method returns the same sequence as repeated calls to 
+Randomizer::getInteger(void).
+*/
+void Randomizer::fillInteger(unsigned long int* outBuffer, unsigned int inSize)
+{
+	while(inSize > 0) {
+		if(left == 0) reload();
+		const unsigned int lCount = (inSize < left ? inSize : left);
+		for(unsigned int i = 0; i < lCount; ++i) {
+			MTRand::uint32 lValue = pNext[i];
+			lValue ^= (lValue >> 11);
+			lValue ^= (lValue << 7) & 0x9d2c5680UL;
+			lValue ^= (lValue << 15) & 0xefc60000UL;
+			outBuffer[i] = lValue ^ (lValue >> 18);
+		}
+		pNext += lCount;
+		left -= lCount;
+		outBuffer += lCount;
+		inSize -= lCount;
+	}
+}
+
+/*!
+The two integers are drawn from a single 64 bits random integer r, using the batched version of 
+Lemire's method by N. Brackett-Rozinsky and D. Lemire ("Batched Ranged Random Integer Generation", 
+Software: Practice and Experience, 2024): the first integer is the upper half of r*\c inRange1, 
+and the second is the upper half of the product of its lower half by \c inRange2. The pair is 
+unbiased, and rejections are very rare when the product of both ranges is small relative to 2^64.
+
+\attention Both ranges must be in [1,2^32].
+*/
+void Randomizer::getIntegerPair(unsigned long int inRange1, unsigned long int inRange2, unsigned long int& outValue1, unsigned long int& outValue2)
+{
+	const unsigned long long lRange = (unsigned long long) inRange1 * inRange2;
+	unsigned long long lThreshold = 0;
+	unsigned long long lHigh1, lHigh2, lLow;
+	do {
+		// draw the upper half first, as the order of evaluation of operands is unspecified
+		const unsigned long long lUpper = randInt();
+		const unsigned long long lRandom = (lUpper << 32) | randInt();
+		multiplyWide(lRandom, inRange1, lHigh1, lLow);
+		multiplyWide(lLow, inRange2, lHigh2, lLow);
+		// compute threshold (with a division) only when rejection is possible
+		if(lLow < lRange && lThreshold == 0) lThreshold = (0-lRange) % lRange;
+	} while(lLow < lThreshold);
+	outValue1 = (unsigned long int) lHigh1;
+	outValue2 = (unsigned long int) lHigh2;
+}
+
+/*!
+The integers are drawn in pairs from blocks of 64 bits random integers (see Randomizer::getIntegerPair), 
+which requires half the random draws of Randomizer::operator()(unsigned long). This is useful, for 
+instance, to draw the contestants of tournament selections.
+*/
+void Randomizer::fillInteger(unsigned long int* outBuffer, unsigned int inSize, unsigned long int inRange)
+{
+	if(inRange > 0xFFFFFFFFUL) {
+		for(unsigned int i = 0; i < inSize; ++i) outBuffer[i] = (*this)(inRange);
+		return;
+	}
+	const unsigned long long lRange = (unsigned long long) inRange * inRange;
+	const unsigned long long lThreshold = (0-lRange) % lRange;
+	MTRand::uint32 lIntegers[cFillBlock];
+	for(unsigned int lStart = 0; lStart+1 < inSize; lStart += cFillBlock) {
+		const unsigned int lCount = (inSize-lStart < cFillBlock ? (inSize-lStart) & ~1U : cFillBlock);
+		fillInteger(lIntegers, lCount);
+		unsigned long int* lValues = outBuffer + lStart;
+		for(unsigned int i = 0; i < lCount; i += 2) {
+			const unsigned long long lRandom = ((unsigned long long) lIntegers[i] << 32) | lIntegers[i+1];
+			unsigned long long lHigh1, lHigh2, lLow;
+			multiplyWide(lRandom, inRange, lHigh1, lLow);
+			multiplyWide(lLow, inRange, lHigh2, lLow);
+			if(lLow < lThreshold) getIntegerPair(inRange, inRange, lValues[i], lValues[i+1]);
+			else {
+				lValues[i] = (unsigned long int) lHigh1;
+				lValues[i+1] = (unsigned long int) lHigh2;
+			}
+		}
+	}
+	if(inSize % 2 != 0) outBuffer[inSize-1] = (*this)(inRange);
+}
+
+/*!
+This method returns the same sequence as repeated calls to Randomizer::getFloat(const double&, const double&).
+*/
+void Randomizer::fillUniform(double* outBuffer, unsigned int inSize, const double& inLow, const double& inHigh)
+{
+	const double lRange = inHigh - inLow;
+	MTRand::uint32 lIntegers[cFillBlock];
+	for(unsigned int lStart = 0; lStart < inSize; lStart += cFillBlock) {
+		const unsigned int lCount = (inSize-lStart < cFillBlock ? inSize-lStart : cFillBlock);
+		fillInteger(lIntegers, lCount);
+		double* lValues = outBuffer + lStart;
+		for(unsigned int i = 0; i < lCount; ++i) {
+			lValues[i] = inLow + (convertToDouble(lIntegers[i]) * (1.0/4294967295.0)) * lRange;
+		}
+	}
+}
+
+/*!
+See Randomizer::fillUniform(double*, unsigned int, const double&, const double&) for details.
+*/
+void Randomizer::fillUniform(Matrix& outMatrix, const double& inLow, const double& inHigh)
+{
+	const unsigned int lSize = outMatrix.getRows() * outMatrix.getCols();
+	if(lSize > 0) fillUniform(&outMatrix(0,0), lSize, inLow, inHigh);
+}
+
+/*!
+Each value is made of two 32 bits integers. This method returns the same sequence as repeated 
+calls to Randomizer::getFloat53.
+*/
+void Randomizer::fillUniform53(double* outBuffer, unsigned int inSize, const double& inLow, const double& inHigh)
+{
+	const double lRange = inHigh - inLow;
+	MTRand::uint32 lIntegers[cFillBlock];
+	for(unsigned int lStart = 0; lStart < inSize; lStart += cFillBlock/2) {
+		const unsigned int lCount = (inSize-lStart < cFillBlock/2 ? inSize-lStart : cFillBlock/2);
+		fillInteger(lIntegers, 2*lCount);
+		double* lValues = outBuffer + lStart;
+		for(unsigned int i = 0; i < lCount; ++i) {
+			const double lHigh = convertToDouble(lIntegers[2*i] >> 5);
+			const double lLow = convertToDouble(lIntegers[2*i+1] >> 6);
+			lValues[i] = inLow + ((lHigh * 67108864.0 + lLow) * (1.0/9007199254740992.0)) * lRange;
+		}
+	}
+}
+
+/*!
+See Randomizer::fillUniform53(double*, unsigned int, const double&, const double&) for details.
+*/
+void Randomizer::fillUniform53(Matrix& outMatrix, const double& inLow, const double& inHigh)
+{
+	const unsigned int lSize = outMatrix.getRows() * outMatrix.getCols();
+	if(lSize > 0) fillUniform53(&outMatrix(0,0), lSize, inLow, inHigh);
+}
+
+/*!
+The buffer is first filled with 53 bits uniform deviates (see Randomizer::fillUniform53), which 
+are then transformed in bulk using NormalTransform::applyBoxMuller (both values of each 
+Box-Muller pair are kept). For large buffers, this is much faster than calling 
+Randomizer::getGaussian for each value, but the sequence of values is not the same.
+*/
+void Randomizer::fillGaussian(double* outBuffer, unsigned int inSize, const double& inMean, const double& inStdDev)
+{
+	fillUniform53(outBuffer, inSize);
+	// the inverse cumulative distribution used for an odd last value requires a deviate in ]0,1[
+	if(inSize % 2 != 0) outBuffer[inSize-1] = randDblExc();
+	NormalTransform::applyBoxMuller(outBuffer, inSize);
+	if(inMean != 0 || inStdDev != 1) {
+		for(unsigned int i = 0; i < inSize; ++i) outBuffer[i] = inMean + inStdDev*outBuffer[i];
+	}
+}
+
+/*!
+See Randomizer::fillGaussian(double*, unsigned int, const double&, const double&) for details.
+*/
+void Randomizer::fillGaussian(Matrix& outMatrix, const double& inMean, const double& inStdDev)
+{
+	const unsigned int lSize = outMatrix.getRows() * outMatrix.getCols();
+	if(lSize > 0) fillGaussian(&outMatrix(0,0), lSize, inMean, inStdDev);
+}
+
+/*!
+Small numbers of draws are drawn one by one; larger ones jump ahead (see Randomizer::jump), at a 
+cost that does not depend on the number of draws.
+*/
+void Randomizer::discard(unsigned long long inDraws)
+{
+	if(inDraws < cDiscardJump) {
+		for(; inDraws > 0; --inDraws) randInt();
+	} else jumpAhead(inDraws, false);
+}
+
+/*!
+The jump is computed using the method of H. Haramoto, M. Matsumoto, T. Nishimura, F. Panneton and 
+P. L'Ecuyer ("Efficient Jump Ahead for F2-Linear Random Number Generators", INFORMS Journal on 
+Computing, Vol. 20, No. 3, 2008): the state is multiplied by the polynomial x^J modulo the 
+characteristic polynomial of the generator, using Horner's rule. The characteristic polynomial 
+is computed once, on the first jump. 
+
+After the jump, this generator returns the values that it would have returned after 
+\c inStreams*2^128 draws of 32 bits integers.
+*/
+void Randomizer::jump(unsigned long inStreams)
+{
+	if(inStreams != 0) jumpAhead(inStreams, true);
+}
+
+//! Jump generator ahead by \c inCount*2^128 draws if \c inStreams is true, or by \c inCount draws otherwise (see Randomizer::jump).
+void Randomizer::jumpAhead(unsigned long long inCount, bool inStreams)
+{
+	// extend state with the next values of the recurrence, as needed
+	MTRand::uint32 lExtended[2*N+1];
+	const unsigned int lStart = N-left;
+	for(unsigned int i = 0; i < N; ++i) lExtended[i] = state[i];
+	for(unsigned int i = N; i <= lStart+N; ++i) lExtended[i] = twist(lExtended[i-N+M], lExtended[i-N], lExtended[i-N+1]);
+	// the window starting after the next value lies in the image of the state transition, 
+	// so that it can be multiplied by x^(J-1) mod P(x) to obtain the window starting at J
+	TwisterWindow lWindow;
+	for(unsigned int i = 0; i < N; ++i) lWindow.mWords[i] = lExtended[lStart+1+i];
+	lWindow = lWindow.apply(computeJump(inCount, inStreams));
+	for(unsigned int i = 0; i < N; ++i) state[i] = lWindow.mWords[(lWindow.mHead+i) % N];
+	left = N;
+	pNext = state;
+}
+
+/*!
+Stream 0 is a copy of this generator, and stream \e i is this generator jumped ahead by 
+\e i*2^128 draws (see Randomizer::jump).
+*/
+Randomizer Randomizer::split(unsigned long inStream) const
+{
+	Randomizer lStream(*this);
+	lStream.jump(inStream);
+	return lStream;
+}
+
+/*!
+The first call to this method by a thread allocates its generator, which is the next stream 
+of the master generator (see Randomizer::split). The master generator is initialized from 
+/dev/urandom unless it is seeded with Randomizer::setLocalSeed. The generator of a thread 
+is deleted when the thread terminates (POSIX threads only).
+
+Because each thread uses its own generator, this method is thread safe. But the returned 
+generator should not be shared with other threads.
+*/
+Randomizer& Randomizer::local(void)
+{
+	LocalStreams& lStreams = getLocalStreams();
+	Randomizer* lRandomizer = (Randomizer*) lStreams.mStorage.getValue();
+	if(lRandomizer == 0) {
+		lStreams.mMutex.lock();
+		lRandomizer = new Randomizer(lStreams.mNext);
+		lStreams.mNext.jump();
+		lStreams.mMutex.unlock();
+		lStreams.mStorage.setValue(lRandomizer);
+	}
+	return *lRandomizer;
+}
+
+/*!
+The generator of the calling thread is reset to stream 0 of the new master generator, and 
+threads that later call Randomizer::local for the first time will get streams 1, 2, 3, etc. 
+in the order of their calls. Generators already allocated by other threads are not modified; 
+use Randomizer::setLocalStream to reset them when the order of calls is not deterministic.
+*/
+void Randomizer::setLocalSeed(unsigned long int inSeed)
+{
+	LocalStreams& lStreams = getLocalStreams();
+	lStreams.mMutex.lock();
+	lStreams.mMaster.seed(inSeed);
+	lStreams.mNext = lStreams.mMaster.split(1);
+	lStreams.mMutex.unlock();
+	lStreams.setLocal(lStreams.mMaster);
+}
+
+/*!
+Stream \c inStream of the master generator does not depend on the order of the calls to 
+Randomizer::local, which makes the computations of a pool of threads reproducible. 
+*/
+void Randomizer::setLocalStream(unsigned long inStream)
+{
+	LocalStreams& lStreams = getLocalStreams();
+	lStreams.mMutex.lock();
+	Randomizer lMaster(lStreams.mMaster);
+	lStreams.mMutex.unlock();
+	lStreams.setLocal(lMaster.split(inStream));
+}
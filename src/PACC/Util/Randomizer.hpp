@@ -37,6 +37,8 @@
 #define PACC_Randomizer_hpp_
 
 #include "PACC/Util/MTRand.hpp"
+#include <algorithm>
+#include <iostream>
 #include <vector>
 #include <string>
 
@@ -44,6 +46,9 @@ namespace PACC {
 	
 	using namespace std;
 	
+	// Forward declarations
+	class Matrix;
+	
 	/*!
 	\brief Random number generator
 	 \author Marc Parizeau and Christian Gagn&eacute;, Laboratoire de vision et syst&egrave;mes num&eacute;riques, Universit&eacute; Laval
@@ -55,6 +60,26 @@ namespace PACC {
 	 Its implementation is based on the \c %MTRand class by Richard J. Wagner <http://www-personal.engin.umich.edu/~wagnerr/MersenneTwister.html>
 	 
 	 It can generate uniformly distributed booleans, integers and floats, or gaussian distributed floats.
+	 Gaussian floats can either be drawn one at a time using the Box-Muller method (Randomizer::getGaussian) 
+	 or the ziggurat method (Randomizer::getGaussianZiggurat), or in bulk (Randomizer::fillGaussian).
+	 
+	 The bulk methods (Randomizer::fillInteger, Randomizer::fillUniform, Randomizer::fillUniform53 
+	 and Randomizer::fillGaussian) produce whole buffers, vectors or matrices of random numbers 
+	 much faster than repeated calls to their scalar counterparts. Except for Randomizer::fillGaussian, 
+	 they return exactly the same sequences as their scalar counterparts, and both can be mixed.
+	 
+	 A generator is not thread safe. For parallel computations, Randomizer::split returns independent 
+	 streams of a same generator: stream \e i starts \e i*2^128 draws ahead of the original generator, 
+	 so that streams never overlap in practice (the period of the generator is 2^19937-1). 
+	 Randomizer::local returns a generator specific to the calling thread, taken from the 
+	 streams of a master generator that can be seeded with Randomizer::setLocalSeed. 
+	 Randomizer::discard skips any number of draws, jumping ahead when the number is large.
+	 
+	 The state of the generator can be saved and restored either as a text string (Randomizer::getState 
+	 and Randomizer::setState), or in a compact binary format (Randomizer::saveState and 
+	 Randomizer::loadState) which is much faster. The binary format starts with an identifier and a 
+	 version number, and stores all integers in little-endian order, so that it can be exchanged 
+	 between platforms.
 	 */
 	class Randomizer : protected MTRand {
 	 public:
@@ -72,8 +97,41 @@ namespace PACC {
 		//! Initialize the generator with state \c inState.
 		Randomizer(const string& inState) {setState(inState);}
 		
-		//! Return a uniformly distributed random integer in range [0,\c inValue[.
-		unsigned long int operator()(unsigned long inValue) {return randInt(inValue-1);}
+		/*! \brief Return a uniformly distributed random integer in range [0,\c inValue[, for \c inValue in [1,2^32].
+		
+		This operator uses the multiply-shift method of D. Lemire ("Fast Random Integer Generation in 
+		an Interval", ACM Transactions on Modeling and Computer Simulation, Vol. 29, No. 1, 2019): the 
+		result is the upper half of the product of a 32 bits random integer by \c inValue, and a 
+		division is only needed in the rare case where the product must be checked for rejection.
+		*/
+		unsigned long int operator()(unsigned long inValue) {
+			unsigned long long lProduct = (unsigned long long) randInt() * inValue;
+			if((lProduct & 0xFFFFFFFFULL) < inValue) {
+				const unsigned long long lThreshold = (0x100000000ULL - inValue) % inValue;
+				while((lProduct & 0xFFFFFFFFULL) < lThreshold) lProduct = (unsigned long long) randInt() * inValue;
+			}
+			return (unsigned long int) (lProduct >> 32);
+		}
+		
+		void getIntegerPair(unsigned long int inRange1, unsigned long int inRange2, unsigned long int& outValue1, unsigned long int& outValue2);
+		
+		/*! \brief Shuffle randomly the elements in range [\c inBegin,\c inEnd[ (at most 2^32 elements).
+		
+		This method implements the Fisher-Yates shuffle, with two random indices drawn at once from a 
+		single 64 bits random integer (see Randomizer::getIntegerPair). It replaces \c std::random_shuffle 
+		(which is deprecated) with a Randomizer.
+		*/
+		template <class RandomIterator>
+		void shuffle(RandomIterator inBegin, RandomIterator inEnd) {
+			unsigned long int lSize = inEnd - inBegin;
+			for(; lSize > 2; lSize -= 2) {
+				unsigned long int lFirst, lSecond;
+				getIntegerPair(lSize, lSize-1, lFirst, lSecond);
+				std::swap(inBegin[lSize-1], inBegin[lFirst]);
+				std::swap(inBegin[lSize-2], inBegin[lSecond]);
+			}
+			if(lSize == 2) std::swap(inBegin[1], inBegin[(*this)(2)]);
+		}
 		
 		//! Return a uniformly distributed random boolean.
 		bool getBoolean(void) {return randInt(1);}
@@ -93,12 +151,55 @@ namespace PACC {
 		double getFloat53(const double& inLow=0, const double& inHigh=1) {return inLow+rand53()*(inHigh-inLow);}
 		//! Return a gaussian distributed random float with mean \c inMean and standard deviation \c inStdDev. Default is N(0,1).
 		double getGaussian(const double& inMean=0, const double& inStdDev=1) {return randNorm(inMean, inStdDev);}
+		//! Return a gaussian distributed random float with mean \c inMean and standard deviation \c inStdDev, using the ziggurat method. Default is N(0,1).
+		double getGaussianZiggurat(const double& inMean=0, const double& inStdDev=1);
+		
+		//! Fill buffer \c outBuffer with \c inSize uniformly distributed random integers in range [0,2^32[.
+		void fillInteger(unsigned long int* outBuffer, unsigned int inSize);
+		//! Fill buffer \c outBuffer with \c inSize uniformly distributed random integers in range [0,\c inRange[, for \c inRange in [1,2^32].
+		void fillInteger(unsigned long int* outBuffer, unsigned int inSize, unsigned long int inRange);
+		//! Fill buffer \c outBuffer with \c inSize uniformly distributed random floats in range [\c inLow,\c inHigh]. Default is [0,1].
+		void fillUniform(double* outBuffer, unsigned int inSize, const double& inLow=0, const double& inHigh=1);
+		//! Fill matrix \c outMatrix with uniformly distributed random floats in range [\c inLow,\c inHigh]. Default is [0,1].
+		void fillUniform(Matrix& outMatrix, const double& inLow=0, const double& inHigh=1);
+		//! Fill buffer \c outBuffer with \c inSize 53 bits uniformly distributed random floats in range [\c inLow,\c inHigh[. Default is [0,1[.
+		void fillUniform53(double* outBuffer, unsigned int inSize, const double& inLow=0, const double& inHigh=1);
+		//! Fill matrix \c outMatrix with 53 bits uniformly distributed random floats in range [\c inLow,\c inHigh[. Default is [0,1[.
+		void fillUniform53(Matrix& outMatrix, const double& inLow=0, const double& inHigh=1);
+		//! Fill buffer \c outBuffer with \c inSize gaussian distributed random floats with mean \c inMean and standard deviation \c inStdDev.
+		void fillGaussian(double* outBuffer, unsigned int inSize, const double& inMean=0, const double& inStdDev=1);
+		//! Fill matrix \c outMatrix with gaussian distributed random floats with mean \c inMean and standard deviation \c inStdDev.
+		void fillGaussian(Matrix& outMatrix, const double& inMean=0, const double& inStdDev=1);
+		
+		//! Advance generator by \c inDraws draws of 32 bits integers, as if they were drawn and discarded.
+		void discard(unsigned long long inDraws);
+		//! Jump generator ahead by \c inStreams*2^128 draws.
+		void jump(unsigned long inStreams=1);
+		//! Return independent stream \c inStream of this generator.
+		Randomizer split(unsigned long inStream) const;
+		
+		//! Return the generator of the calling thread.
+		static Randomizer& local(void);
+		//! Seed the master generator of thread local generators with \c inSeed.
+		static void setLocalSeed(unsigned long int inSeed);
+		//! Set the generator of the calling thread to stream \c inStream of the master generator.
+		static void setLocalStream(unsigned long inStream);
+		
+		//! Return size in bytes of the binary state of generator.
+		unsigned int getBinaryStateSize(void) const {return 4*(N+3);}
+		unsigned int saveState(void* outBuffer) const;
+		void saveState(ostream& outStream) const;
+		unsigned int loadState(const void* inBuffer);
+		void loadState(istream& inStream);
 		
 		//! Return state of generator.
 		string getState(void) const;
 		//! Set state of generator.
 		void setState(const string& inState);
 		
+	 protected:
+		void jumpAhead(unsigned long long inCount, bool inStreams);
+		
 	};
 
 	extern Randomizer rand; //!< Global random number generator
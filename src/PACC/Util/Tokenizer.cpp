@@ -35,13 +35,107 @@
 
 #include "PACC/Util/Tokenizer.hpp"
 #include "PACC/Util/Assert.hpp"
+#include "PACC/Util/CPUFeatures.hpp"
+#include <algorithm>
 #include <stdexcept>
 #include <cstdlib>
 #include <cstring>
 
+#ifdef PACC_CPU_DISPATCH_X86
+#include <immintrin.h>
+#endif
+
 using namespace std;
 using namespace PACC;
 
+namespace {
+	
+	//! Maximum number of delimiters compared in parallel by the vectorized scanning kernels.
+	const unsigned int cMaxScanDelimiters = 16;
+	
+	//! Signature of the scanning kernels.
+	typedef unsigned int (*ScanFunction)(const char*, unsigned int, const char*, const string&);
+	
+	/*! \brief Return the number of leading characters of buffer \c inBuffer of size \c inSize that are not delimiters.
+	
+	Table \c inDelimiters is non zero for delimiters, and string \c inDelimiterList contains all delimiters. 
+	*/
+	unsigned int scanGeneric(const char* inBuffer, unsigned int inSize, const char* inDelimiters, const string&)
+	{
+		const unsigned char* lBuffer = (const unsigned char*) inBuffer;
+		unsigned int i = 0;
+		while(i < inSize && inDelimiters[lBuffer[i]] == 0) ++i;
+		return i;
+	}
+	
+#ifdef PACC_CPU_DISPATCH_X86
+	// The vectorized kernels compare 16, 32 or 64 characters at a time with each delimiter.
+	
+	PACC_TARGET_SSE2 unsigned int scanSSE2(const char* inBuffer, unsigned int inSize, const char* inDelimiters, const string& inDelimiterList)
+	{
+		const unsigned int lCount = inDelimiterList.size();
+		if(lCount > cMaxScanDelimiters) return scanGeneric(inBuffer, inSize, inDelimiters, inDelimiterList);
+		__m128i lDelimiters[cMaxScanDelimiters];
+		for(unsigned int k = 0; k < lCount; ++k) lDelimiters[k] = _mm_set1_epi8(inDelimiterList[k]);
+		unsigned int i = 0;
+		for(; i+16 <= inSize; i += 16) {
+			const __m128i lChars = _mm_loadu_si128((const __m128i*) (inBuffer+i));
+			__m128i lMatches = _mm_setzero_si128();
+			for(unsigned int k = 0; k < lCount; ++k) lMatches = _mm_or_si128(lMatches, _mm_cmpeq_epi8(lChars, lDelimiters[k]));
+			const unsigned int lMask = _mm_movemask_epi8(lMatches);
+			if(lMask != 0) return i + __builtin_ctz(lMask);
+		}
+		return i + scanGeneric(inBuffer+i, inSize-i, inDelimiters, inDelimiterList);
+	}
+	
+	PACC_TARGET_AVX2 unsigned int scanAVX2(const char* inBuffer, unsigned int inSize, const char* inDelimiters, const string& inDelimiterList)
+	{
+		const unsigned int lCount = inDelimiterList.size();
+		if(lCount > cMaxScanDelimiters) return scanGeneric(inBuffer, inSize, inDelimiters, inDelimiterList);
+		__m256i lDelimiters[cMaxScanDelimiters];
+		for(unsigned int k = 0; k < lCount; ++k) lDelimiters[k] = _mm256_set1_epi8(inDelimiterList[k]);
+		unsigned int i = 0;
+		for(; i+32 <= inSize; i += 32) {
+			const __m256i lChars = _mm256_loadu_si256((const __m256i*) (inBuffer+i));
+			__m256i lMatches = _mm256_setzero_si256();
+			for(unsigned int k = 0; k < lCount; ++k) lMatches = _mm256_or_si256(lMatches, _mm256_cmpeq_epi8(lChars, lDelimiters[k]));
+			const unsigned int lMask = _mm256_movemask_epi8(lMatches);
+			if(lMask != 0) return i + __builtin_ctz(lMask);
+		}
+		return i + scanGeneric(inBuffer+i, inSize-i, inDelimiters, inDelimiterList);
+	}
+	
+	PACC_TARGET_AVX512 unsigned int scanAVX512(const char* inBuffer, unsigned int inSize, const char* inDelimiters, const string& inDelimiterList)
+	{
+		const unsigned int lCount = inDelimiterList.size();
+		if(lCount > cMaxScanDelimiters) return scanGeneric(inBuffer, inSize, inDelimiters, inDelimiterList);
+		__m512i lDelimiters[cMaxScanDelimiters];
+		for(unsigned int k = 0; k < lCount; ++k) lDelimiters[k] = _mm512_set1_epi8(inDelimiterList[k]);
+		unsigned int i = 0;
+		for(; i+64 <= inSize; i += 64) {
+			const __m512i lChars = _mm512_loadu_si512((const void*) (inBuffer+i));
+			__mmask64 lMask = 0;
+			for(unsigned int k = 0; k < lCount; ++k) lMask |= _mm512_cmpeq_epi8_mask(lChars, lDelimiters[k]);
+			if(lMask != 0) return i + __builtin_ctzll(lMask);
+		}
+		return i + scanGeneric(inBuffer+i, inSize-i, inDelimiters, inDelimiterList);
+	}
+#endif
+	
+	//! Scan buffer \c inBuffer with the kernel selected for the processor (see scanGeneric).
+	unsigned int scan(const char* inBuffer, unsigned int inSize, const char* inDelimiters, const string& inDelimiterList)
+	{
+#ifdef PACC_CPU_DISPATCH_X86
+		static const ScanFunction lScan = CPUFeatures::select<ScanFunction>(scanGeneric, scanSSE2, scanAVX2, scanAVX512);
+#else
+		static const ScanFunction lScan = scanGeneric;
+#endif
+		if(inDelimiterList.empty()) return inSize;
+		return lScan(inBuffer, inSize, inDelimiters, inDelimiterList);
+	}
+	
+}
+
 /*!
 The internal read buffer size can be set with argument \c inBufSize (default=1024). This buffer can also be disactivated by setting this argument to 0. The internal read buffer can greatly accelerate the parse of the stream. A size between 512 and 1024 appears to give good results in most circumstances. 
 
@@ -141,23 +235,17 @@ bool Tokenizer::getNextToken(string& outToken)
 			if(lChar == '\n') ++mLine;
 		} while(mDelimiters[lChar] == eWhiteSpace);
 		outToken = lChar;
-		// append until next white space or single char token
-		char lOutBuffer[100];
-		while(mDelimiters[lChar] == 0 && mBufPtr != mBuffer) {
-			unsigned lOutCount = 0;
-			while(lOutCount < sizeof(lOutBuffer)) {
-				if(mBufCount == 0 && fillBuffer() == 0) break;
-				lChar = *(mBufPtr++); --mBufCount;
-				if(mDelimiters[lChar] != 0) {
-					// put character back into buffer
-					--mBufPtr; ++mBufCount;
-					break;
-				}
-				lOutBuffer[lOutCount++] = lChar;
+		// append spans of the buffer until next white space or single char token
+		if(mDelimiters[lChar] == 0) {
+			while(mBufCount > 0 || fillBuffer() > 0) {
+				const unsigned int lSpan = scan(mBufPtr, mBufCount, mDelimiters, mDelimiterList);
+				outToken.append(mBufPtr, lSpan);
 				// check for end-of-line counter
-				if(lChar == '\n') ++mLine;
+				if(mDelimiters[(unsigned char) '\n'] == 0) mLine += count(mBufPtr, mBufPtr+lSpan, '\n');
+				mBufPtr += lSpan; mBufCount -= lSpan;
+				// stop on delimiter (left in buffer)
+				if(mBufCount > 0) break;
 			}
-			outToken.append(lOutBuffer, lOutCount);
 		}
 	}
 	return !outToken.empty();
@@ -237,6 +325,7 @@ void Tokenizer::setDelimiters(const string &inWhiteSpace, const string &inSingle
 		PACC_AssertM(mDelimiters[(unsigned)*i] == 0, "a delimiter cannot be both white space and single char token!");
 		mDelimiters[(unsigned)*i] = eSingleChar;
 	}
+	mDelimiterList = inWhiteSpace + inSingleCharTokens;
 }
 
 /*!
@@ -113,6 +113,7 @@ namespace PACC {
 		string mName; //!< Name of default input stream.
 		istream* mStream; //!< Default input stream.
 		char mDelimiters[256]; //!< Single character tokens.
+		string mDelimiterList; //!< Characters of all delimiters (used for scanning tokens).
 		char* mBuffer; //!< Input read buffer.
 		unsigned int mBufSize; //!< Size of the input read buffer.
 		char* mBufPtr; //!< Pointer to next character in the read buffer.